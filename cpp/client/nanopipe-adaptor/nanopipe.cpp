@@ -11,6 +11,8 @@
 
 // use as:
 //  ./nanopipe <nanomsg-socket-name> <pipe-name>
+// or, to read frames from ndnrtc-client shared memory sink:
+//  ./nanopipe shm:<sink-name> <pipe-name>
 
 // ffmpeg command to read from pipe and re-encode into mp4 file (mind frame resolution and pipe name):
 // $ ffmpeg -f rawvideo -vcodec rawvideo -s 320x240 -pix_fmt argb -i /tmp/ndnrtc-frames -vf vflip -vf hflip -c:v libx264 -preset ultrafast -qp 0 video.mp4
@@ -36,6 +38,7 @@
 
 #include <ndnrtc/interfaces.hpp>
 #include "ipc-shim.h"
+#include "shm-ring.h"
 
 using namespace std;
 static bool processFrames = true;
@@ -151,6 +154,56 @@ void listenSocket(string socketName, function<void(int, uint8_t*, size_t)> onNew
     }
 }
 
+void listenRing(string ringName, function<void(int, uint8_t*, size_t)> onNewFrame)
+{
+    shmr_ring *ring = NULL;
+    uint64_t next = 0;
+
+    cout << "waiting for shared memory ring " << ringName << endl;
+
+    while (processFrames && !(ring = shmr_open(ringName.c_str())))
+        usleep(100000);
+
+    if (!ring)
+        return;
+
+    cout << "listening for frames on " << ringName << endl;
+
+    while (processFrames)
+    {
+        shmr_frame frame;
+        int ret = shmr_nextFrame(ring, &next, 1000, &frame);
+
+        if (ret == SHMR_OK)
+        {
+            cout << "read frame " << frame.info_->playbackNo_ << " ("
+                << frame.info_->dataSize_ << " bytes), timestamp " << frame.info_->timestamp_
+                << " ndn name " << frame.info_->ndnName_ << endl;
+            // frame is written to the pipe right from shared memory
+            onNewFrame(frame.info_->playbackNo_, (uint8_t*)frame.data_, frame.info_->dataSize_);
+
+            if (shmr_releaseFrame(ring, &frame) != SHMR_OK)
+                cout << "frame " << frame.idx_ << " was overwritten while being read" << endl;
+        }
+        else if (ret == SHMR_TIMEOUT)
+            cout << "no frames for 1 second" << endl;
+        else if (ret == SHMR_CLOSED)
+        {
+            cout << "ring " << ringName << " was closed by writer, re-opening" << endl;
+            shmr_close(ring);
+            next = 0;
+
+            while (processFrames && !(ring = shmr_open(ringName.c_str())))
+                usleep(100000);
+
+            if (!ring)
+                return;
+        }
+    }
+
+    shmr_close(ring);
+}
+
 //******************************************************************************
 void handler(int sig) {
     processFrames = false;
@@ -174,7 +227,7 @@ void handler(int sig) {
 }
 
 void usage(char const *argv[]){
-    cout << "\tusage: " << argv[0] << " <nanomsg socket name> <pipe name>" << endl;
+    cout << "\tusage: " << argv[0] << " <nanomsg socket name | shm:<sink name>> <pipe name>" << endl;
 }
 
 int main(int argc, char const *argv[])
@@ -196,10 +249,15 @@ int main(int argc, char const *argv[])
     try {
         int pipe = -1;
         createPipe(pipeName);
-        listenSocket(nanomsgSocket, [pipeName, &pipe](int frameNo, uint8_t *frameBuffer, size_t bufferSize){
+        auto onNewFrame = [pipeName, &pipe](int frameNo, uint8_t *frameBuffer, size_t bufferSize){
             if (pipe < 0) pipe = openPipe(pipeName);
             if (pipe > 0) writeExactly(frameBuffer, bufferSize, pipe);
-        });
+        };
+
+        if (nanomsgSocket.find("shm:") == 0)
+            listenRing(nanomsgSocket.substr(4), onNewFrame);
+        else
+            listenSocket(nanomsgSocket, onNewFrame);
     }
     catch (std::exception &e){
         cout << "Failed due to exception: " << e.what() << endl;
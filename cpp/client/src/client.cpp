@@ -225,6 +225,10 @@ LocalStream Client::initLocalStream(const ProducerStreamParams &p)
         {
             source.reset(new PipeFrameSource(p.source_.name_));
         }
+        else if (p.source_.type_ == "shm")
+        {
+            source.reset(new SharedMemoryFrameSource(p.source_.name_));
+        }
         else
             throw runtime_error("Uknown source type "+p.source_.type_);
 
@@ -306,6 +310,13 @@ RendererInternal *Client::setupRenderer(const ConsumerStreamParams &p)
                                             if (p.sink_.writeFrameInfo_) sink->setWriteFrameInfo(true);
                                             return sink;
                                         }, rendererIo_);
+        else if (p.sink_.type_ == "shm")
+            return new RendererInternal(p.sink_.name_,
+                                        [p](const std::string &s) -> boost::shared_ptr<IFrameSink> {
+                                            boost::shared_ptr<IFrameSink> sink = boost::make_shared<SharedMemorySink>(s);
+                                            if (p.sink_.writeFrameInfo_) sink->setWriteFrameInfo(true);
+                                            return sink;
+                                        }, rendererIo_);
         else if (p.sink_.type_ == "nano")
         {
 #ifdef HAVE_LIBNANOMSG
@@ -399,6 +399,7 @@ int loadStreamParams(const Setting &s, ClientMediaStreamParams &params)
 
         s.lookupValue("base_prefix", params.sessionPrefix_);                // consumer
         s.lookupValue("segment_size", params.producerParams_.segmentSize_); // producer
+        s.lookupValue("cache_budget_mb", params.producerParams_.cacheBudgetMb_); // producer
 
         try 
         {
@@ -495,6 +496,7 @@ int loadThreadParams(const Setting &s, VideoThreadParams &params)
         lookupNumber(coderSettings, "encode_height", params.coderParams_.encodeHeight_);
         lookupNumber(coderSettings, "encode_width", params.coderParams_.encodeWidth_);
         coderSettings.lookupValue("drop_frames", params.coderParams_.dropFramesOn_);
+        lookupNumber(coderSettings, "temporal_layers", params.coderParams_.temporalLayers_);
     }
     return EXIT_SUCCESS;
 }
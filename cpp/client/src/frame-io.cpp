@@ -13,8 +13,10 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
+#include <algorithm>
 
 #include "frame-io.hpp"
+#include "shm-ring.h"
 
 #ifdef HAVE_NANOMSG
 #include "ipc-shim.h"
@@ -159,6 +161,56 @@ void PipeSink::openPipe(const std::string &path)
     pipe_ = open(path.c_str(), O_WRONLY | O_NONBLOCK | O_EXCL);
 }
 
+//******************************************************************************
+SharedMemorySink::SharedMemorySink(const std::string &name, unsigned int nSlots)
+    : name_(name), nSlots_(nSlots), slotSize_(0), ring_(nullptr),
+    writeFrameInfo_(false), isLastWriteSuccessful_(false)
+{
+    if (name_ == "")
+        throw std::runtime_error("invalid shared memory sink name provided");
+}
+
+SharedMemorySink::~SharedMemorySink()
+{
+    shmr_destroy(ring_);
+}
+
+IFrameSink &SharedMemorySink::operator<<(const RawFrame &frame)
+{
+    if (frame.getFrameSizeInBytes() > slotSize_)
+    {
+        // new ring replaces the old one: readers of the old ring are notified
+        // that it has been closed and re-open it by name
+        shmr_ring *ring = shmr_create(name_.c_str(), nSlots_, frame.getFrameSizeInBytes());
+
+        if (!ring)
+            throw std::runtime_error("couldn't create shared memory sink " + name_ +
+                                     ": " + shmr_lastError());
+
+        shmr_destroy(ring_);
+        ring_ = ring;
+        slotSize_ = frame.getFrameSizeInBytes();
+    }
+
+    shmr_slot_header *info = nullptr;
+    uint8_t *buf = shmr_beginWrite(ring_, &info);
+
+    info->width_ = frame.getWidth();
+    info->height_ = frame.getHeight();
+    info->format_ = SHMR_FORMAT_ARGB;
+    info->dataSize_ = frame.getFrameSizeInBytes();
+    info->timestamp_ = frame.getFrameInfo().timestamp_;
+    info->playbackNo_ = frame.getFrameInfo().playbackNo_;
+    info->isKey_ = frame.getFrameInfo().isKey_;
+    memset(info->ndnName_, 0, SHMR_NAME_LEN);
+    if (writeFrameInfo_)
+        strncpy(info->ndnName_, frame.getFrameInfo().ndnName_.c_str(), SHMR_NAME_LEN - 1);
+    memcpy(buf, frame.getBuffer().get(), frame.getFrameSizeInBytes());
+
+    isLastWriteSuccessful_ = (shmr_commitWrite(ring_) == SHMR_OK);
+    return *this;
+}
+
 #ifdef HAVE_LIBNANOMSG
 #include <iostream>
 
@@ -336,4 +388,86 @@ void
 PipeFrameSource::closePipe()
 {
     close(pipe_);
-}
\ No newline at end of file
+}
+
+//******************************************************************************
+SharedMemoryFrameSource::SharedMemoryFrameSource(const std::string &name, int timeoutMs)
+    : name_(name), timeoutMs_(timeoutMs), ring_(nullptr), next_(0),
+    readError_(false), errorMsg_("")
+{
+    if (name_ == "")
+        throw std::runtime_error("invalid shared memory source name provided");
+
+    ring_ = shmr_open(name_.c_str());
+}
+
+SharedMemoryFrameSource::~SharedMemoryFrameSource()
+{
+    shmr_close(ring_);
+}
+
+IFrameSource &SharedMemoryFrameSource::operator>>(RawFrame &frame) noexcept
+{
+    readError_ = false;
+    errorMsg_ = "";
+
+    if (!ring_ && !(ring_ = shmr_open(name_.c_str())))
+    {
+        readError_ = true;
+        errorMsg_ = std::string("shared memory ring is not available: ") + shmr_lastError();
+        return *this;
+    }
+
+    shmr_frame shmFrame;
+    int res = SHMR_OK;
+
+    do
+    {
+        res = shmr_nextFrame(ring_, &next_, timeoutMs_, &shmFrame);
+
+        if (res == SHMR_OK)
+        {
+            if (shmFrame.info_->dataSize_ > frame.getFrameSizeInBytes())
+            {
+                std::stringstream ss;
+                ss << "frame " << shmFrame.info_->playbackNo_ << " ("
+                   << shmFrame.info_->width_ << "x" << shmFrame.info_->height_ << ", "
+                   << shmFrame.info_->dataSize_ << " bytes) from shared memory ring " << name_
+                   << " does not fit into " << frame.getWidth() << "x" << frame.getHeight()
+                   << " frame (" << frame.getFrameSizeInBytes() << " bytes)";
+                readError_ = true;
+                errorMsg_ = ss.str();
+                return *this;
+            }
+
+            memcpy(frame.getBuffer().get(), shmFrame.data_, shmFrame.info_->dataSize_);
+            frame.setFrameInfo({shmFrame.info_->timestamp_, shmFrame.info_->playbackNo_,
+                                std::string(shmFrame.info_->ndnName_), shmFrame.info_->isKey_ != 0});
+            res = shmr_releaseFrame(ring_, &shmFrame);
+        }
+        else if (res == SHMR_CLOSED)
+        {
+            // writer has re-created the ring (i.e. frame size changed)
+            shmr_close(ring_);
+            next_ = 0;
+            if (!(ring_ = shmr_open(name_.c_str())))
+            {
+                readError_ = true;
+                errorMsg_ = std::string("shared memory ring was closed: ") + shmr_lastError();
+                return *this;
+            }
+        }
+    } while (res == SHMR_OVERWRITTEN || res == SHMR_CLOSED);
+
+    if (res == SHMR_TIMEOUT)
+    {
+        // writer may have re-created the ring - reopen it next time
+        shmr_close(ring_);
+        ring_ = nullptr;
+        next_ = 0;
+        readError_ = true;
+        errorMsg_ = "timeout waiting for frame from shared memory ring " + name_;
+    }
+
+    return *this;
+}
@@ -164,6 +164,36 @@ class NanoMsgSink : public IFrameSink
 };
 #endif
 
+/**
+ * Shared memory frame sink
+ * - writes frames into a POSIX shared memory ring (see shm-ring.h) which
+ *      can be read by other processes in place, without extra copies
+ * - ring is created upon first frame, slot size equals frame size
+ * - never blocks: readers that are too slow miss frames
+ */
+class SharedMemorySink : public IFrameSink
+{
+  public:
+    SharedMemorySink(const std::string &name, unsigned int nSlots = 4);
+    ~SharedMemorySink();
+
+    IFrameSink &operator<<(const RawFrame &frame);
+    std::string getName() { return name_; }
+
+    bool isLastWriteSuccessful() { return isLastWriteSuccessful_; }
+    bool isBusy() { return false; }
+    void setWriteFrameInfo(bool b) { writeFrameInfo_ = b; }
+    bool isWritingFrameInfo() const { return writeFrameInfo_; }
+
+  private:
+    std::string name_;
+    unsigned int nSlots_;
+    unsigned long slotSize_;
+    struct _shmr_ring *ring_;
+    bool writeFrameInfo_;
+    std::atomic<bool> isLastWriteSuccessful_;
+};
+
 //******************************************************************************
 class IFrameSource
 {
@@ -233,4 +263,33 @@ class PipeFrameSource : public IFrameSource {
     void closePipe();
 };
 
+/**
+ * Shared memory frame source
+ * - reads frames from a shared memory ring created by SharedMemorySink or
+ *      any other process using shm-ring writer API
+ * - blocks until next frame is available; if reading is too slow, skips
+ *      to the latest frame
+ */
+class SharedMemoryFrameSource : public IFrameSource
+{
+  public:
+    SharedMemoryFrameSource(const std::string &name, int timeoutMs = 1000);
+    ~SharedMemoryFrameSource();
+
+    IFrameSource &operator>>(RawFrame &frame) noexcept;
+    std::string getName() const { return name_; }
+    bool isError() const { return readError_; }
+    std::string getErrorMsg() const { return errorMsg_; }
+    bool isEof() const { return false; }
+    void rewind() { /*do nothing*/ }
+
+  private:
+    std::string name_;
+    int timeoutMs_;
+    struct _shmr_ring *ring_;
+    uint64_t next_;
+    bool readError_;
+    std::string errorMsg_;
+};
+
 #endif
@@ -27,6 +27,7 @@
 #include "client.hpp"
 #include <ndnrtc/helpers/key-chain-manager.hpp>
 #include <ndnrtc/helpers/face-processor.hpp>
+#include <ndnrtc/frame-trace.hpp>
 
 using namespace std;
 using namespace ndnrtc;
@@ -36,7 +37,7 @@ using namespace ndn;
 struct Args
 {
     unsigned int runTimeSec_, samplePeriod_;
-    std::string configFile_, identity_, instance_, policy_;
+    std::string configFile_, identity_, instance_, policy_, traceFile_;
     ndnlog::NdnLoggerDetailLevel logLevel_;
 };
 
@@ -66,14 +67,14 @@ int main(int argc, char **argv)
     signal(SIGABRT, handler);
     signal(SIGSEGV, handler);
 
-    char *configFile = NULL, *identity = NULL, *instance = NULL, *policy = NULL;
+    char *configFile = NULL, *identity = NULL, *instance = NULL, *policy = NULL, *traceFile = NULL;
     int c;
     unsigned int runTimeSec = 0;           // default app run time (sec)
     unsigned int statSamplePeriodMs = 100; // default statistics sample interval (ms)
     ndnlog::NdnLoggerDetailLevel logLevel = ndnlog::NdnLoggerDetailLevelDefault;
 
     opterr = 0;
-    while ((c = getopt(argc, argv, "vn:i:t:c:s:p:")) != -1)
+    while ((c = getopt(argc, argv, "vn:i:t:c:s:p:r:")) != -1)
         switch (c)
         {
         case 'c':
@@ -97,6 +98,9 @@ int main(int argc, char **argv)
         case 'p':
             policy = optarg;
             break;
+        case 'r':
+            traceFile = optarg;
+            break;
         case '?':
             if (optopt == 'c')
                 fprintf(stderr, "Option -%c requires an argument.\n", optopt);
@@ -116,7 +120,7 @@ int main(int argc, char **argv)
         std::cout << "usage: " << argv[0] << " -c <config file> -s <signing identity> "
                                              "-p <verification policy file> "
                                              "-t <app run time in seconds> [-n <statistics sample interval in milliseconds> "
-                                             "-i <instance name> -v <verbose mode>]"
+                                             "-i <instance name> -r <frame trace file> -v <verbose mode>]"
                   << std::endl;
         exit(1);
     }
@@ -129,6 +133,7 @@ int main(int argc, char **argv)
     args.identity_ = std::string(identity);
     args.policy_ = std::string(policy);
     args.instance_ = (instance ? std::string(instance) : "client0");
+    args.traceFile_ = (traceFile ? std::string(traceFile) : "");
 
     return run(args);
 }
@@ -149,8 +154,12 @@ int run(const struct Args &args)
                 << "\n\tpolicy file: " << args.policy_
                 << "\n\tstatistics sampling: " << args.samplePeriod_
                 << "\n\tinstance name: " << args.instance_
+                << "\n\tframe trace file: " << args.traceFile_
                 << std::endl;
 
+    if (args.traceFile_ != "")
+        trace::FrameTracer::getSharedInstance().enable();
+
     boost::asio::io_service io;
     boost::shared_ptr<boost::asio::io_service::work> work(boost::make_shared<boost::asio::io_service::work>(io));
     boost::thread t([&io, &err]() {
@@ -223,6 +232,15 @@ int run(const struct Args &args)
 
     LogInfo("") << "Client run completed" << std::endl;
 
+    if (args.traceFile_ != "")
+    {
+        trace::FrameTracer::getSharedInstance().disable();
+        if (trace::FrameTracer::getSharedInstance().writeChromeTrace(args.traceFile_))
+            LogInfo("") << "Frame trace written to " << args.traceFile_ << std::endl;
+        else
+            LogError("") << "Failed to write frame trace to " << args.traceFile_ << std::endl;
+    }
+
     rendererWork.reset();
     rendererThread.join();
     rendererIo.stop();
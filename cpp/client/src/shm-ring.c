@@ -0,0 +1,430 @@
+//
+// shm-ring.c
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+#include "shm-ring.h"
+
+#define SHMR_ALIGN 64
+#define SHMR_POLL_USEC 100
+
+struct _shmr_ring {
+    char name_[SHMR_NAME_LEN];
+    int fd_;
+    int isWriter_;
+    size_t size_;
+    uint8_t *base_;
+    shmr_header *header_;
+    uint64_t writeIdx_;
+};
+
+static __thread char lastError_[256];
+
+static void setError(const char *msg)
+{
+    snprintf(lastError_, sizeof(lastError_), "%s: %s (%d)", msg, strerror(errno), errno);
+}
+
+static size_t alignUp(size_t size)
+{
+    return (size + SHMR_ALIGN - 1) & ~((size_t)SHMR_ALIGN - 1);
+}
+
+static void makeShmName(const char *name, char *shmName)
+{
+    size_t i, len = strlen(name);
+
+    if (len > SHMR_NAME_LEN - 2)
+        len = SHMR_NAME_LEN - 2;
+
+    shmName[0] = '/';
+    for (i = 0; i < len; ++i)
+        shmName[i + 1] = (name[i] == '/' ? '_' : name[i]);
+    shmName[len + 1] = 0;
+}
+
+static shmr_slot_header* getSlot(shmr_ring *ring, uint64_t idx)
+{
+    return (shmr_slot_header*)(ring->base_ + alignUp(sizeof(shmr_header)) +
+                               (idx % ring->header_->nSlots_) * ring->header_->slotStride_);
+}
+
+static uint8_t* getSlotData(shmr_slot_header *slot)
+{
+    return (uint8_t*)slot + alignUp(sizeof(shmr_slot_header));
+}
+
+static int64_t monotonicUsec()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+// waits until futex value changes from val or timeout expires
+static void waitChange(shmr_ring *ring, uint32_t val, int64_t timeoutUsec)
+{
+    __atomic_add_fetch(&ring->header_->nWaiters_, 1, __ATOMIC_SEQ_CST);
+#ifdef __linux__
+    struct timespec ts;
+    ts.tv_sec = timeoutUsec / 1000000;
+    ts.tv_nsec = (timeoutUsec % 1000000) * 1000;
+    syscall(SYS_futex, &ring->header_->futex_, FUTEX_WAIT, val,
+            (timeoutUsec < 0 ? NULL : &ts), NULL, 0);
+#else
+    if (__atomic_load_n(&ring->header_->futex_, __ATOMIC_ACQUIRE) == val)
+        usleep((timeoutUsec < 0 || timeoutUsec > SHMR_POLL_USEC) ? SHMR_POLL_USEC : timeoutUsec);
+#endif
+    __atomic_sub_fetch(&ring->header_->nWaiters_, 1, __ATOMIC_SEQ_CST);
+}
+
+static void wakeAll(shmr_ring *ring)
+{
+    __atomic_add_fetch(&ring->header_->futex_, 1, __ATOMIC_SEQ_CST);
+#ifdef __linux__
+    if (__atomic_load_n(&ring->header_->nWaiters_, __ATOMIC_SEQ_CST) > 0)
+        syscall(SYS_futex, &ring->header_->futex_, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+#endif
+}
+
+// marks segment left by previous writer closed, so its readers re-open the
+// ring, and returns its generation
+static uint32_t closePrevious(const char *shmName)
+{
+    uint32_t generation = 0;
+    int fd = shm_open(shmName, O_RDWR, 0);
+    struct stat st;
+
+    if (fd < 0)
+        return 0;
+
+    if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(shmr_header))
+    {
+        shmr_ring prev;
+        prev.base_ = (uint8_t*)mmap(NULL, sizeof(shmr_header), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+        if (prev.base_ != MAP_FAILED)
+        {
+            prev.header_ = (shmr_header*)prev.base_;
+            if (__atomic_load_n(&prev.header_->magic_, __ATOMIC_ACQUIRE) == SHMR_MAGIC &&
+                prev.header_->version_ == SHMR_VERSION)
+            {
+                generation = prev.header_->generation_;
+                __atomic_store_n(&prev.header_->isClosed_, 1, __ATOMIC_RELEASE);
+                wakeAll(&prev);
+            }
+            munmap(prev.base_, sizeof(shmr_header));
+        }
+    }
+
+    close(fd);
+    return generation;
+}
+
+// checks whether ring's name still refers to ring's segment
+static int isLinked(shmr_ring *ring)
+{
+    struct stat own, linked;
+    int fd = shm_open(ring->name_, O_RDONLY, 0);
+    int res = 0;
+
+    if (fd < 0)
+        return 0;
+
+    res = (fstat(ring->fd_, &own) == 0 && fstat(fd, &linked) == 0 &&
+           own.st_dev == linked.st_dev && own.st_ino == linked.st_ino);
+    close(fd);
+    return res;
+}
+
+//******************************************************************************
+shmr_ring* shmr_create(const char *name, uint32_t nSlots, uint32_t slotSize)
+{
+    if (nSlots == 0 || slotSize == 0)
+    {
+        errno = EINVAL;
+        setError("invalid ring size");
+        return NULL;
+    }
+
+    shmr_ring *ring = (shmr_ring*)calloc(1, sizeof(shmr_ring));
+    makeShmName(name, ring->name_);
+    ring->isWriter_ = 1;
+
+    // remove segment left by previous writer, if any
+    uint32_t generation = closePrevious(ring->name_) + 1;
+    shm_unlink(ring->name_);
+    ring->fd_ = shm_open(ring->name_, O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (ring->fd_ < 0)
+    {
+        setError("can't create shared memory segment");
+        free(ring);
+        return NULL;
+    }
+
+    size_t slotStride = alignUp(alignUp(sizeof(shmr_slot_header)) + slotSize);
+    ring->size_ = alignUp(sizeof(shmr_header)) + nSlots * slotStride;
+
+    if (ftruncate(ring->fd_, ring->size_) < 0)
+    {
+        setError("can't resize shared memory segment");
+        close(ring->fd_);
+        shm_unlink(ring->name_);
+        free(ring);
+        return NULL;
+    }
+
+    ring->base_ = (uint8_t*)mmap(NULL, ring->size_, PROT_READ | PROT_WRITE, MAP_SHARED, ring->fd_, 0);
+    if (ring->base_ == MAP_FAILED)
+    {
+        setError("can't map shared memory segment");
+        close(ring->fd_);
+        shm_unlink(ring->name_);
+        free(ring);
+        return NULL;
+    }
+
+    memset(ring->base_, 0, ring->size_);
+    ring->header_ = (shmr_header*)ring->base_;
+    ring->header_->version_ = SHMR_VERSION;
+    ring->header_->nSlots_ = nSlots;
+    ring->header_->slotSize_ = slotSize;
+    ring->header_->slotStride_ = (uint32_t)slotStride;
+    ring->header_->writerPid_ = (uint32_t)getpid();
+    ring->header_->generation_ = generation;
+    // readers check magic to see if the ring is initialized
+    __atomic_store_n(&ring->header_->magic_, SHMR_MAGIC, __ATOMIC_RELEASE);
+
+    return ring;
+}
+
+uint8_t* shmr_beginWrite(shmr_ring *ring, shmr_slot_header **info)
+{
+    shmr_slot_header *slot = getSlot(ring, ring->writeIdx_);
+
+    __atomic_store_n(&slot->seq_, 2 * ring->writeIdx_ + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    *info = slot;
+    return getSlotData(slot);
+}
+
+int shmr_commitWrite(shmr_ring *ring)
+{
+    shmr_slot_header *slot = getSlot(ring, ring->writeIdx_);
+
+    __atomic_store_n(&slot->seq_, 2 * ring->writeIdx_ + 2, __ATOMIC_RELEASE);
+    ring->writeIdx_++;
+    __atomic_store_n(&ring->header_->writeCount_, ring->writeIdx_, __ATOMIC_RELEASE);
+    wakeAll(ring);
+
+    return SHMR_OK;
+}
+
+int shmr_write(shmr_ring *ring, const shmr_slot_header *info, const void *data, size_t dataSize)
+{
+    if (dataSize > ring->header_->slotSize_)
+    {
+        errno = EMSGSIZE;
+        setError("frame does not fit into ring slot");
+        return SHMR_ERROR;
+    }
+
+    shmr_slot_header *slot = NULL;
+    uint8_t *buf = shmr_beginWrite(ring, &slot);
+
+    slot->timestamp_ = info->timestamp_;
+    slot->playbackNo_ = info->playbackNo_;
+    slot->width_ = info->width_;
+    slot->height_ = info->height_;
+    slot->format_ = info->format_;
+    slot->isKey_ = info->isKey_;
+    slot->dataSize_ = (uint32_t)dataSize;
+    memcpy(slot->ndnName_, info->ndnName_, SHMR_NAME_LEN);
+    slot->ndnName_[SHMR_NAME_LEN - 1] = 0;
+    memcpy(buf, data, dataSize);
+
+    return shmr_commitWrite(ring);
+}
+
+void shmr_destroy(shmr_ring *ring)
+{
+    if (!ring)
+        return;
+
+    if (ring->isWriter_)
+    {
+        __atomic_store_n(&ring->header_->isClosed_, 1, __ATOMIC_RELEASE);
+        wakeAll(ring);
+    }
+
+    // don't unlink segment if it has been re-created by another writer
+    if (ring->isWriter_ && isLinked(ring))
+        shm_unlink(ring->name_);
+    munmap(ring->base_, ring->size_);
+    close(ring->fd_);
+    free(ring);
+}
+
+//******************************************************************************
+shmr_ring* shmr_open(const char *name)
+{
+    shmr_ring *ring = (shmr_ring*)calloc(1, sizeof(shmr_ring));
+    makeShmName(name, ring->name_);
+
+    ring->fd_ = shm_open(ring->name_, O_RDWR, 0);
+    if (ring->fd_ < 0)
+    {
+        setError("can't open shared memory segment");
+        free(ring);
+        return NULL;
+    }
+
+    struct stat st;
+    if (fstat(ring->fd_, &st) < 0 || (size_t)st.st_size < sizeof(shmr_header))
+    {
+        errno = (errno ? errno : EAGAIN);
+        setError("shared memory segment is not initialized");
+        close(ring->fd_);
+        free(ring);
+        return NULL;
+    }
+
+    ring->size_ = st.st_size;
+    ring->base_ = (uint8_t*)mmap(NULL, ring->size_, PROT_READ | PROT_WRITE, MAP_SHARED, ring->fd_, 0);
+    if (ring->base_ == MAP_FAILED)
+    {
+        setError("can't map shared memory segment");
+        close(ring->fd_);
+        free(ring);
+        return NULL;
+    }
+
+    ring->header_ = (shmr_header*)ring->base_;
+    if (__atomic_load_n(&ring->header_->magic_, __ATOMIC_ACQUIRE) != SHMR_MAGIC ||
+        ring->header_->version_ != SHMR_VERSION)
+    {
+        errno = EPROTO;
+        setError("shared memory segment is not a frame ring");
+        munmap(ring->base_, ring->size_);
+        close(ring->fd_);
+        free(ring);
+        return NULL;
+    }
+
+    return ring;
+}
+
+int shmr_acquireFrame(shmr_ring *ring, uint64_t idx, shmr_frame *frame)
+{
+    if (idx >= __atomic_load_n(&ring->header_->writeCount_, __ATOMIC_ACQUIRE))
+        return SHMR_NOT_READY;
+
+    shmr_slot_header *slot = getSlot(ring, idx);
+    uint64_t seq = __atomic_load_n(&slot->seq_, __ATOMIC_ACQUIRE);
+
+    if (seq != 2 * idx + 2)
+        return (seq > 2 * idx + 2 ? SHMR_OVERWRITTEN : SHMR_NOT_READY);
+
+    frame->idx_ = idx;
+    frame->info_ = slot;
+    frame->data_ = getSlotData(slot);
+
+    return SHMR_OK;
+}
+
+int shmr_releaseFrame(shmr_ring *ring, const shmr_frame *frame)
+{
+    (void)ring;
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    uint64_t seq = __atomic_load_n(&frame->info_->seq_, __ATOMIC_RELAXED);
+
+    return (seq == 2 * frame->idx_ + 2 ? SHMR_OK : SHMR_OVERWRITTEN);
+}
+
+int shmr_nextFrame(shmr_ring *ring, uint64_t *next, int timeoutMs, shmr_frame *frame)
+{
+    int64_t deadline = (timeoutMs < 0 ? -1 : monotonicUsec() + (int64_t)timeoutMs * 1000);
+
+    while (1)
+    {
+        uint32_t futex = __atomic_load_n(&ring->header_->futex_, __ATOMIC_ACQUIRE);
+        uint64_t count = __atomic_load_n(&ring->header_->writeCount_, __ATOMIC_ACQUIRE);
+
+        if (*next < count)
+        {
+            // reader is too slow - skip to the latest frame
+            if (count - *next >= ring->header_->nSlots_)
+                *next = count - 1;
+
+            int res = shmr_acquireFrame(ring, *next, frame);
+            if (res == SHMR_OK)
+            {
+                (*next)++;
+                return SHMR_OK;
+            }
+            continue;
+        }
+        else if (*next > count) // writer has restarted
+            *next = count;
+
+        // all frames have been read and writer won't write any more
+        if (__atomic_load_n(&ring->header_->isClosed_, __ATOMIC_ACQUIRE) &&
+            *next >= __atomic_load_n(&ring->header_->writeCount_, __ATOMIC_ACQUIRE))
+            return SHMR_CLOSED;
+
+        int64_t remaining = -1;
+        if (deadline >= 0)
+        {
+            remaining = deadline - monotonicUsec();
+            if (remaining <= 0)
+                return SHMR_TIMEOUT;
+        }
+
+        waitChange(ring, futex, remaining);
+    }
+}
+
+uint64_t shmr_writeCount(shmr_ring *ring)
+{
+    return __atomic_load_n(&ring->header_->writeCount_, __ATOMIC_ACQUIRE);
+}
+
+uint32_t shmr_generation(shmr_ring *ring)
+{
+    return ring->header_->generation_;
+}
+
+const shmr_header* shmr_getHeader(shmr_ring *ring)
+{
+    return ring->header_;
+}
+
+void shmr_close(shmr_ring *ring)
+{
+    shmr_destroy(ring);
+}
+
+const char* shmr_lastError()
+{
+    return lastError_;
+}
@@ -0,0 +1,147 @@
+//
+// shm-ring.h
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+// Shared memory frame ring.
+// Single writer publishes raw frames into a POSIX shared memory segment
+// split into N fixed-size slots; any number of reader processes map the
+// same segment and read frames in place (no copies, no kernel round-trip).
+// Writer never blocks: slow readers simply miss frames, which is detected
+// by per-slot sequence numbers (seqlock). Readers sleep on a futex (Linux)
+// and are woken up by the writer on every new frame; on other platforms
+// readers poll.
+// Ring geometry is fixed. To change it, writer re-creates the ring under the
+// same name: old segment is marked closed (readers get SHMR_CLOSED once they
+// have read all frames from it and should re-open the ring by name) and new
+// segment gets the next generation number.
+//
+// Memory layout:
+//      [shmr_header][slot 0: shmr_slot_header | data][slot 1 ...]...
+//
+// Reader usage:
+//      shmr_ring *ring = shmr_open("my-sink.1280x720");
+//      uint64_t next = 0;
+//      shmr_frame frame;
+//      while (running)
+//      {
+//          int res = shmr_nextFrame(ring, &next, 100, &frame);
+//          if (res == SHMR_OK)
+//          {
+//              process(frame.data_, frame.info_->dataSize_);
+//              if (shmr_releaseFrame(ring, &frame) != SHMR_OK)
+//                  ; // frame was overwritten while being processed
+//          }
+//          else if (res == SHMR_CLOSED)
+//          {
+//              shmr_close(ring);
+//              ring = shmr_open("my-sink.1280x720"), next = 0;
+//          }
+//      }
+//      shmr_close(ring);
+
+#ifndef __shm_ring_h__
+#define __shm_ring_h__
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SHMR_MAGIC 0x4e52464d  // 'NRFM'
+#define SHMR_VERSION 2
+#define SHMR_NAME_LEN 256
+
+#define SHMR_OK 0
+#define SHMR_ERROR -1
+#define SHMR_TIMEOUT -2
+#define SHMR_OVERWRITTEN -3
+#define SHMR_NOT_READY -4
+#define SHMR_CLOSED -5
+
+// pixel formats of the frames in the ring
+enum shmr_format {
+    SHMR_FORMAT_ARGB = 0,
+    SHMR_FORMAT_I420 = 1,
+    SHMR_FORMAT_NV12 = 2
+};
+
+typedef struct _shmr_header {
+    uint32_t magic_;
+    uint32_t version_;
+    uint32_t nSlots_;
+    uint32_t slotSize_;         // size of slot payload in bytes
+    uint32_t slotStride_;       // distance between slots in bytes
+    uint32_t futex_;            // incremented on every frame, readers wait on it
+    uint32_t nWaiters_;         // number of readers waiting on futex
+    uint32_t writerPid_;
+    uint32_t generation_;       // incremented every time ring is re-created
+    uint32_t isClosed_;         // set when writer destroys or re-creates the ring
+    uint64_t writeCount_;       // number of frames written so far
+} shmr_header;
+
+typedef struct _shmr_slot_header {
+    uint64_t seq_;              // 2*idx+1 while frame idx is written, 2*idx+2 when done
+    uint64_t timestamp_;        // producer's timestamp (ms)
+    int32_t playbackNo_;
+    uint32_t width_, height_;
+    uint32_t format_;
+    uint32_t dataSize_;
+    uint32_t isKey_;
+    char ndnName_[SHMR_NAME_LEN];
+} shmr_slot_header;
+
+typedef struct _shmr_ring shmr_ring;
+
+typedef struct _shmr_frame {
+    uint64_t idx_;                  // frame index (0-based count of frames written)
+    const shmr_slot_header *info_;
+    const uint8_t *data_;
+} shmr_frame;
+
+//******************************************************************************
+// writer API
+// creates (or re-creates) shared memory ring. name is converted to a valid
+// POSIX shared memory name ('/' is prepended, other slashes are replaced).
+// existing ring with the same name is marked closed
+shmr_ring* shmr_create(const char *name, uint32_t nSlots, uint32_t slotSize);
+// returns pointer to the slot data buffer of the next frame. frame becomes
+// visible to readers after shmr_commitWrite call
+uint8_t* shmr_beginWrite(shmr_ring *ring, shmr_slot_header **info);
+int shmr_commitWrite(shmr_ring *ring);
+// copies frame into the ring (begin, copy, commit)
+int shmr_write(shmr_ring *ring, const shmr_slot_header *info, const void *data, size_t dataSize);
+// marks ring closed, unmaps and unlinks shared memory segment
+void shmr_destroy(shmr_ring *ring);
+
+//******************************************************************************
+// reader API
+// opens existing ring. returns NULL if ring does not exist (yet)
+shmr_ring* shmr_open(const char *name);
+// waits until frame with index *next is available and acquires it.
+// if reader lags behind by more than the ring size, skips to the latest frame.
+// on success, *next is set to the index of the frame following acquired one.
+// returns SHMR_CLOSED if all frames have been read and writer has closed or
+// re-created the ring. timeoutMs < 0 waits indefinitely
+int shmr_nextFrame(shmr_ring *ring, uint64_t *next, int timeoutMs, shmr_frame *frame);
+// acquires frame with given index without waiting
+int shmr_acquireFrame(shmr_ring *ring, uint64_t idx, shmr_frame *frame);
+// returns SHMR_OK if frame was not overwritten by the writer while it was
+// held by the reader, SHMR_OVERWRITTEN otherwise
+int shmr_releaseFrame(shmr_ring *ring, const shmr_frame *frame);
+uint64_t shmr_writeCount(shmr_ring *ring);
+uint32_t shmr_generation(shmr_ring *ring);
+const shmr_header* shmr_getHeader(shmr_ring *ring);
+void shmr_close(shmr_ring *ring);
+
+const char* shmr_lastError();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -89,6 +89,10 @@ void VideoSource::sourceFrame()
         }
 
         *source_ >> *frame_;
+
+        if (source_->isError() && !source_->isEof())
+            LogWarn("") << "error reading from source " << source_->getName()
+                        << ": " << source_->getErrorMsg() << endl;
     } while (source_->isEof());
 
     framesSourced_++;
@@ -25,6 +25,7 @@
 #include "client/src/video-source.hpp"
 #include "../tests/mock-objects/external-capturer-mock.hpp"
 #include "statistics.hpp"
+#include "src/encoder-resource-manager.hpp"
 
 std::string test_path = "";
 
@@ -131,6 +132,12 @@ void runProducer(std::string sourceFile, boost::shared_ptr<RawFrame> frame,
               stat[Indicator::PublishedSegmentsNum]/stat[Indicator::PublishedNum],
               (int)stat[Indicator::SignNum], stat[Indicator::SignNum]/runTimeSec,
               stat[Indicator::EncodedNum]/runTimeSec);
+
+    for (auto e:EncoderResourceManager::getSharedInstance()->getEncoders())
+        GT_PRINTF("encoder %s: cores %d/%d, weight %.0f, avg encode time %.2fms\n",
+                  e.description_.c_str(), e.nCores_,
+                  EncoderResourceManager::getSharedInstance()->getCoreBudget(),
+                  e.weight_, e.encodeTimeMs_);
 }
 
 unsigned int runtime = 5000;
@@ -730,6 +737,71 @@ TEST(BenchmarkLocalStream, VideoStream1280x720_1200_500_100)
                 runtime);
 }
 
+MediaStreamParams simulcastParams()
+{
+    MediaStreamParams msp("camera");
+    
+    msp.type_ = MediaStreamParams::MediaStreamTypeVideo;
+    msp.synchronizedStreamName_ = "mic";
+    msp.producerParams_.freshnessMs_ = 2000;
+    msp.producerParams_.segmentSize_ = 1000;
+    
+    CaptureDeviceParams cdp;
+    cdp.deviceId_ = 10;
+    msp.captureDevice_ = cdp;
+    
+    {
+        VideoThreadParams atp("hi", sampleVideoCoderParams());
+        atp.coderParams_.encodeWidth_ = 1280;
+        atp.coderParams_.encodeHeight_ = 720;
+        atp.coderParams_.startBitrate_ = 1200;
+        atp.coderParams_.maxBitrate_ = 1200;
+        msp.addMediaThread(atp);
+    }
+    
+    {
+        VideoThreadParams atp("mid", sampleVideoCoderParams());
+        atp.coderParams_.encodeWidth_ = 640;
+        atp.coderParams_.encodeHeight_ = 360;
+        atp.coderParams_.startBitrate_ = 300;
+        atp.coderParams_.maxBitrate_ = 300;
+        msp.addMediaThread(atp);
+    }
+
+    {
+        VideoThreadParams atp("low", sampleVideoCoderParams());
+        atp.coderParams_.encodeWidth_ = 320;
+        atp.coderParams_.encodeHeight_ = 180;
+        atp.coderParams_.startBitrate_ = 100;
+        atp.coderParams_.maxBitrate_ = 100;
+        msp.addMediaThread(atp);
+    }
+
+    return msp;
+}
+
+// same simulcast stream, encoders share different process-wide core budgets
+TEST(BenchmarkLocalStream, CoreBudget1280x720_1200_500_100)
+{
+    unsigned int hwCores = boost::thread::hardware_concurrency();
+    std::vector<unsigned int> budgets({1, 2, 4});
+
+    if (hwCores > 4)
+        budgets.push_back(hwCores);
+
+    for (auto nCores:budgets)
+    {
+        GT_PRINTF("core budget: %d\n", nCores);
+        EncoderResourceManager::getSharedInstance()->setCoreBudget(nCores);
+        runProducer(test_path+"/../res/test-source-1280x720.argb",
+                    boost::make_shared<ArgbFrame>(1280,720),
+                    simulcastParams(),
+                    runtime);
+    }
+
+    EncoderResourceManager::getSharedInstance()->setCoreBudget(hwCores);
+}
+
 int main(int argc, char **argv) {
 	::testing::InitGoogleTest(&argc, argv);
 
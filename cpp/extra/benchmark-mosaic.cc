@@ -0,0 +1,143 @@
+//
+// benchmark-mosaic.cc
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#include <stdlib.h>
+#include <string.h>
+#include <boost/make_shared.hpp>
+
+#include "gtest/gtest.h"
+#include "../tests/tests-helpers.hpp"
+#include "src/mosaic-renderer-impl.hpp"
+#include "src/clock.hpp"
+#include "src/webrtc.hpp"
+
+using namespace ndnrtc;
+using namespace ndnrtc::statistics;
+
+namespace {
+	const unsigned int OutputFps = 30;
+	const unsigned int nIterations = 100;
+
+	class NilReleaser : public IRenderBufferReleaser {
+	public:
+		void releaseFrame(const PlanarFrame& frame) {}
+	};
+
+	WebRtcVideoFrame makeFrame(int w, int h)
+	{
+		rtc::scoped_refptr<WebRtcVideoFrameBuffer> buffer = WebRtcVideoFrameBuffer::Create(w, h);
+
+		for (int row = 0; row < h; ++row)
+			for (int col = 0; col < w; ++col)
+				buffer->MutableDataY()[row*buffer->StrideY()+col] = (uint8_t)(row+col);
+		for (int row = 0; row < (h+1)/2; ++row)
+		{
+			memset(buffer->MutableDataU() + row*buffer->StrideU(), 0x60, (w+1)/2);
+			memset(buffer->MutableDataV() + row*buffer->StrideV(), 0x70, (w+1)/2);
+		}
+
+		return WebRtcVideoFrame(buffer, webrtc::kVideoRotation_0, 0);
+	}
+
+	PlanarFrame planarFrame(const WebRtcVideoFrame& frame)
+	{
+		PlanarFrame pf;
+		pf.bufferIdx_ = 0;
+		pf.width_ = frame.width();
+		pf.height_ = frame.height();
+		pf.nPlanes_ = 3;
+		pf.planes_[0] = frame.video_frame_buffer()->DataY();
+		pf.planes_[1] = frame.video_frame_buffer()->DataU();
+		pf.planes_[2] = frame.video_frame_buffer()->DataV();
+		pf.strides_[0] = frame.video_frame_buffer()->StrideY();
+		pf.strides_[1] = frame.video_frame_buffer()->StrideU();
+		pf.strides_[2] = frame.video_frame_buffer()->StrideV();
+		return pf;
+	}
+
+	// average time per stream of one output tick, when every stream has
+	// a new frame for every tick
+	double mosaicTimePerStreamMs(int frameWidth, int frameHeight, unsigned int nGrid,
+		unsigned int nWorkers, double &tickMs)
+	{
+		MosaicRendererImpl mosaic(1920, 1080, nWorkers);
+		NilReleaser releaser;
+		WebRtcVideoFrame frame = makeFrame(frameWidth, frameHeight);
+		std::vector<IExternalPlanarRenderer*> tiles;
+
+		for (unsigned int row = 0; row < nGrid; ++row)
+			for (unsigned int col = 0; col < nGrid; ++col)
+				tiles.push_back(mosaic.addTile({(int)(col*1920/nGrid), (int)(row*1080/nGrid),
+					(int)(1920/nGrid), (int)(1080/nGrid)}));
+
+		int64_t start = clock::microsecondTimestamp();
+		for (unsigned int i = 0; i < nIterations; ++i)
+		{
+			for (auto t:tiles)
+				t->renderFrame(FrameInfo({0, (int)i, "", false}), planarFrame(frame), &releaser);
+			mosaic.compose(nullptr);
+		}
+
+		tickMs = (double)(clock::microsecondTimestamp()-start)/1000./nIterations;
+		return tickMs/tiles.size();
+	}
+
+	// average time per stream of rendering through IExternalRenderer:
+	// full resolution ARGB conversion (tile scaling is not counted)
+	double argbTimePerStreamMs(int frameWidth, int frameHeight)
+	{
+		WebRtcVideoFrame frame = makeFrame(frameWidth, frameHeight);
+		std::vector<uint8_t> argb(frameWidth*frameHeight*4);
+
+		int64_t start = clock::microsecondTimestamp();
+		for (unsigned int i = 0; i < nIterations; ++i)
+			ConvertFromI420(frame, webrtc::kBGRA, 0, argb.data());
+
+		return (double)(clock::microsecondTimestamp()-start)/1000./nIterations;
+	}
+
+	void runBenchmark(int frameWidth, int frameHeight, unsigned int nGrid)
+	{
+		double tickMs = 0;
+		double budgetMs = 1000./OutputFps;
+		double argbMs = argbTimePerStreamMs(frameWidth, frameHeight);
+		double mosaicMs = mosaicTimePerStreamMs(frameWidth, frameHeight, nGrid, 1, tickMs);
+
+		GT_PRINTF("%dx%d streams, %dx%d grid on 1920x1080@%d\n",
+			frameWidth, frameHeight, nGrid, nGrid, OutputFps);
+		GT_PRINTF("ARGB renderer: %.3fms/stream, %.1f streams per core\n",
+			argbMs, budgetMs/argbMs);
+		GT_PRINTF("mosaic: %.3fms/stream, %.1f streams per core (tick %.2fms)\n",
+			mosaicMs, budgetMs/mosaicMs, tickMs);
+
+		for (unsigned int nWorkers = 2; nWorkers <= boost::thread::hardware_concurrency(); nWorkers *= 2)
+		{
+			mosaicTimePerStreamMs(frameWidth, frameHeight, nGrid, nWorkers, tickMs);
+			GT_PRINTF("mosaic, %d workers: tick %.2fms\n", nWorkers, tickMs);
+		}
+	}
+}
+
+TEST(BenchmarkMosaic, Streams640x360_Grid4x4)
+{
+	runBenchmark(640, 360, 4);
+}
+
+TEST(BenchmarkMosaic, Streams1280x720_Grid4x4)
+{
+	runBenchmark(1280, 720, 4);
+}
+
+TEST(BenchmarkMosaic, Streams1280x720_Grid6x6)
+{
+	runBenchmark(1280, 720, 6);
+}
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
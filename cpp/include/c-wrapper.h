@@ -59,6 +59,8 @@ extern "C" {
                                            int width, int height);
     typedef void (*FrameFetched) (const cFrameInfo finfo, int width, int height, 
                                   const unsigned char* buffer);
+    // called when frame passed without copying is no longer used by the library
+    typedef void (*FrameReleased) (void* userData);
 
 	// params
 	//	base prefix
@@ -94,6 +96,20 @@ extern "C" {
 			const unsigned char* uBuffer,
 			const unsigned char* vBuffer);
 
+	// same as above, but frame planes are not copied - they must stay valid
+	// until releasedFunc is called with given userData
+	int ndnrtc_LocalVideoStream_incomingI420FrameNoCopy(ndnrtc::LocalVideoStream *stream,
+			const unsigned int width,
+			const unsigned int height,
+			const unsigned int strideY,
+			const unsigned int strideU,
+			const unsigned int strideV,
+			const unsigned char* yBuffer,
+			const unsigned char* uBuffer,
+			const unsigned char* vBuffer,
+			FrameReleased releasedFunc,
+			void* userData);
+
 	int ndnrtc_LocalVideoStream_incomingNV21Frame(ndnrtc::LocalVideoStream *stream,
 			const unsigned int width,
 			const unsigned int height,
@@ -128,6 +144,12 @@ extern "C" {
     // see statistics.cpp for possible values
     double ndnrtc_getStatistic(ndnrtc::IStream *stream, const char* statName);
 
+    // returns value (in milliseconds) at given percentile (0..100) of the 
+    // latency distribution; possible names: "latency", "drd", "assembly",
+    // "decode", "lateness" (see statistics.cpp)
+    double ndnrtc_getStatisticPercentile(ndnrtc::IStream *stream, const char* histName,
+                                         double percentile);
+
     // fetch frame from local storage of the local stream
     void ndnrtc_FrameFetcher_fetch(ndnrtc::IStream *stream,
                                    const char* frameName, 
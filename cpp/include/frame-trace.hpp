@@ -0,0 +1,198 @@
+//
+//  frame-trace.hpp
+//  ndnrtc
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#ifndef __ndnrtc__frame_trace__
+#define __ndnrtc__frame_trace__
+
+#include <stdint.h>
+#include <string>
+#include <iostream>
+#include <vector>
+#include <boost/atomic.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/tss.hpp>
+
+namespace ndnrtc {
+    namespace trace {
+        /**
+         * Frame lifecycle stages. Producer stages come first, followed by
+         * consumer stages.
+         */
+        enum class Stage : uint8_t {
+            // producer
+            Capture = 0,
+            Scale,
+            Encode,
+            Fec,
+            Sign,
+            Cache,
+            InterestArrival,
+            // consumer
+            SegmentReceived,
+            Assembled,
+            Verified,
+            Decode,
+            Render
+        };
+
+        typedef struct _TraceEvent {
+            int64_t timestampUsec_;
+            int64_t durationUsec_;  // -1 for instant events
+            int64_t flowId_;        // frame playback number
+            Stage stage_;
+        } TraceEvent;
+
+        /**
+         * Single-writer ring of trace events owned by one thread.
+         * When the ring is full, oldest events are overwritten.
+         * snapshot() and clear() may be called from other threads while
+         * the owner keeps pushing: clear() never touches the write position
+         * and snapshot() drops events that could have been overwritten
+         * while they were being copied.
+         */
+        class TraceRing {
+        public:
+            TraceRing(size_t capacity, unsigned int threadIdx);
+
+            void push(const TraceEvent& event);
+            std::vector<TraceEvent> snapshot() const;
+            void clear() { tail_ = head_.load(boost::memory_order_acquire); }
+
+            unsigned int getThreadIdx() const { return threadIdx_; }
+
+        private:
+            std::vector<TraceEvent> events_;
+            // writer announces slot it's about to write (writing_) and
+            // publishes it (head_) when done
+            boost::atomic<uint64_t> head_, tail_, writing_;
+            unsigned int threadIdx_;
+        };
+
+        /**
+         * FrameTracer collects per-frame lifecycle events from all threads
+         * into per-thread ring buffers and exports them in Chrome trace
+         * event format (JSON), which can be opened in chrome://tracing or
+         * Perfetto UI. Frame playback number is used as the flow ID, so all
+         * stages of a frame are linked together.
+         * Recording is cheap (no locks after the first event on a thread)
+         * and does nothing unless tracer has been enabled. Tracepoints are
+         * compiled only if NDNRTC_FRAME_TRACE is defined (configure with
+         * --enable-frame-trace).
+         * Timestamps are taken from system clock (microseconds since epoch),
+         * so producer and consumer traces can be merged.
+         */
+        class FrameTracer {
+        public:
+            static FrameTracer& getSharedInstance();
+
+            /**
+             * Enables tracing
+             * @param eventsPerThread Size of each per-thread ring buffer
+             */
+            void enable(size_t eventsPerThread = 1<<16);
+            void disable() { enabled_ = false; }
+            bool isEnabled() const { return enabled_; }
+
+            /**
+             * Discards all recorded events
+             */
+            void clear();
+
+            /**
+             * Records events on behalf of calling thread. Negative flowId
+             * means current flow of calling thread.
+             */
+            void complete(Stage stage, int64_t flowId, int64_t startUsec, int64_t durationUsec);
+            void instant(Stage stage, int64_t flowId, int64_t timestampUsec);
+
+            /**
+             * Writes all recorded events as Chrome trace JSON
+             */
+            void writeChromeTrace(std::ostream& os) const;
+            bool writeChromeTrace(const std::string& fileName) const;
+
+            /**
+             * Current flow ID of calling thread (set by FlowScope), -1 if none
+             */
+            int64_t getCurrentFlow() const;
+            void setCurrentFlow(int64_t flowId);
+
+            static int64_t now();
+            static const char* stageName(Stage stage);
+
+        private:
+            FrameTracer();
+            FrameTracer(const FrameTracer&) = delete;
+
+            struct ThreadContext {
+                boost::shared_ptr<TraceRing> ring_;
+                int64_t flowId_;
+            };
+
+            boost::atomic<bool> enabled_;
+            size_t eventsPerThread_;
+            mutable boost::mutex mutex_;
+            std::vector<boost::shared_ptr<TraceRing>> rings_;
+            boost::thread_specific_ptr<ThreadContext> context_;
+
+            ThreadContext* getContext();
+        };
+
+        /**
+         * Records complete event for the lifetime of the object
+         */
+        class TraceScope {
+        public:
+            TraceScope(Stage stage, int64_t flowId);
+            TraceScope(Stage stage);
+            ~TraceScope();
+
+        private:
+            Stage stage_;
+            int64_t flowId_, startUsec_;
+        };
+
+        /**
+         * Sets current flow ID of calling thread for the lifetime of the object
+         * so that nested tracepoints that don't know frame number (i.e. in
+         * packet publisher) can be attributed to the right frame
+         */
+        class FlowScope {
+        public:
+            FlowScope(int64_t flowId);
+            ~FlowScope();
+
+        private:
+            int64_t prevFlowId_;
+        };
+    }
+}
+
+#define FRAME_TRACE_CONCAT_(a, b) a##b
+#define FRAME_TRACE_CONCAT(a, b) FRAME_TRACE_CONCAT_(a, b)
+
+#if defined (NDNRTC_FRAME_TRACE)
+
+#define FrameTraceScope(stage, frameNo) ndnrtc::trace::TraceScope FRAME_TRACE_CONCAT(frameTraceScope_, __LINE__)(ndnrtc::trace::Stage::stage, frameNo)
+#define FrameTraceStep(stage) ndnrtc::trace::TraceScope FRAME_TRACE_CONCAT(frameTraceScope_, __LINE__)(ndnrtc::trace::Stage::stage)
+#define FrameTraceInstant(stage, frameNo) ndnrtc::trace::FrameTracer::getSharedInstance().instant(ndnrtc::trace::Stage::stage, frameNo, ndnrtc::trace::FrameTracer::now())
+#define FrameTraceInstantAt(stage, frameNo, timestampUsec) ndnrtc::trace::FrameTracer::getSharedInstance().instant(ndnrtc::trace::Stage::stage, frameNo, timestampUsec)
+#define FrameTraceFlow(frameNo) ndnrtc::trace::FlowScope FRAME_TRACE_CONCAT(frameTraceFlow_, __LINE__)(frameNo)
+
+#else
+
+#define FrameTraceScope(stage, frameNo)
+#define FrameTraceStep(stage)
+#define FrameTraceInstant(stage, frameNo)
+#define FrameTraceInstantAt(stage, frameNo, timestampUsec)
+#define FrameTraceFlow(frameNo)
+
+#endif
+
+#endif /* defined(__ndnrtc__frame_trace__) */
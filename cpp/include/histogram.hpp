@@ -0,0 +1,106 @@
+//
+//  histogram.hpp
+//  ndnrtc
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#ifndef ndnrtc_histogram_h
+#define ndnrtc_histogram_h
+
+#include <stdint.h>
+#include <atomic>
+#include <memory>
+
+namespace ndnrtc {
+    namespace statistics {
+        /**
+         * Histogram implements HdrHistogram-style log-linear bucketing of
+         * integer values. Values are grouped into power-of-two buckets, each
+         * split into linear sub-buckets, which keeps relative error bounded
+         * by the number of significant digits requested while using a small
+         * fixed amount of memory.
+         * Recording is lock-free and can be performed from any thread.
+         * Reading (percentiles, min/max, etc.) is safe to do concurrently with
+         * recording, but the result is not an atomic snapshot.
+         * Histograms with equal configuration can be merged cheaply; merging
+         * histograms with different configuration is also supported, at the
+         * cost of re-bucketing.
+         */
+        class Histogram {
+        public:
+            /**
+             * Creates histogram
+             * @param lowestTrackableValue Lowest value that can be
+             *          distinguished from 0 (must be >= 1)
+             * @param highestTrackableValue Highest value to track; larger
+             *          values are clamped to this value
+             * @param significantDigits Value precision (1 to 5)
+             */
+            Histogram(int64_t lowestTrackableValue = 1,
+                      int64_t highestTrackableValue = 60000000,
+                      unsigned int significantDigits = 2);
+            Histogram(const Histogram& histogram);
+            ~Histogram(){}
+
+            Histogram& operator=(const Histogram& histogram);
+
+            /**
+             * Records value in the histogram. Negative values are recorded
+             * as 0, values above highest trackable value are clamped.
+             */
+            void recordValue(int64_t value) { recordValues(value, 1); }
+            void recordValues(int64_t value, uint64_t count);
+
+            /**
+             * Adds all values recorded in other histogram to this one
+             */
+            void add(const Histogram& other);
+
+            /**
+             * Clears all recorded values
+             */
+            void reset();
+
+            uint64_t getTotalCount() const { return totalCount_.load(std::memory_order_relaxed); }
+            int64_t getMin() const;
+            int64_t getMax() const;
+            double getMean() const;
+
+            /**
+             * Returns value at given percentile (0..100). The value returned
+             * is the highest value equivalent (within histogram precision) to
+             * the value at percentile, capped by maximum recorded value.
+             * Returns 0 if histogram is empty.
+             */
+            int64_t getValueAtPercentile(double percentile) const;
+
+            int64_t getLowestTrackableValue() const { return lowest_; }
+            int64_t getHighestTrackableValue() const { return highest_; }
+            unsigned int getSignificantDigits() const { return significantDigits_; }
+
+        private:
+            int64_t lowest_, highest_;
+            unsigned int significantDigits_;
+            int unitMagnitude_, subBucketHalfCountMagnitude_;
+            int32_t subBucketCount_, subBucketHalfCount_, bucketCount_, countsLen_;
+            int64_t subBucketMask_;
+
+            std::unique_ptr<std::atomic<uint64_t>[]> counts_;
+            std::atomic<uint64_t> totalCount_;
+            std::atomic<int64_t> sum_, min_, max_;
+
+            void setup();
+            void copyCounts(const Histogram& histogram);
+            bool isCompatible(const Histogram& histogram) const;
+
+            int32_t countsIndexFor(int64_t value) const;
+            int32_t bucketIndexFor(int64_t value) const;
+            int64_t valueFromIndex(int32_t index) const;
+            int64_t highestEquivalentValue(int64_t value) const;
+        };
+    }
+}
+
+#endif
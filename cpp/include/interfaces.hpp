@@ -65,6 +65,98 @@ namespace ndnrtc
                                  const uint8_t* buffer) = 0;
     };
 
+    /**
+     * Planar YUV frame passed to IExternalPlanarRenderer or to
+     * LocalVideoStream (for publishing without copying).
+     * I420 frames have 3 planes (Y, U, V), NV12 frames have 2 planes
+     * (Y, interleaved UV). Plane pointers stay valid until the frame is
+     * released by the renderer (or by the library, respectively).
+     */
+    typedef struct _PlanarFrame {
+        unsigned int bufferIdx_;    // index of the swap buffer holding the frame
+                                    // (any caller's tag for published frames)
+        int width_, height_;
+        unsigned int nPlanes_;
+        const uint8_t* planes_[3];
+        int strides_[3];
+    } PlanarFrame;
+
+    /**
+     * Used by IExternalPlanarRenderer to return swap buffers back to the
+     * library.
+     */
+    class IRenderBufferReleaser
+    {
+    public:
+        /**
+         * Releases swap buffer holding the frame. Can be called from any
+         * thread and at any time after renderFrame call, including after
+         * the stream has been stopped or destroyed: swap buffers are kept
+         * until released.
+         */
+        virtual void releaseFrame(const PlanarFrame& frame) = 0;
+    };
+
+    /**
+     * Implemented by the owner of frame buffers that are published without
+     * copying (see LocalVideoStream::incomingI420Frame(const PlanarFrame&, ...)).
+     */
+    class IFrameBufferOwner
+    {
+    public:
+        /**
+         * Called once library no longer needs frame's planes and owner may
+         * re-use or free them. Called exactly once per published frame, on
+         * any thread (usually, on one of the encoding threads). May be called
+         * before the publishing call returns (i.e. if frame was dropped).
+         */
+        virtual void releaseFrame(const PlanarFrame& frame) = 0;
+    };
+
+    /**
+     * This interface defines external renderers that receive decoded frames
+     * in planar YUV format, without colour conversion to RGB.
+     * Library keeps a pool of swap buffers (3 by default, i.e. triple
+     * buffering). Each decoded frame is placed into a free swap buffer and
+     * passed to renderFrame. Renderer keeps the buffer for as long as it
+     * needs (i.e. until the frame has been uploaded to GPU) and releases it
+     * asynchronously, so decoding of next frames is not blocked by the
+     * renderer. If renderer holds all swap buffers, new frames are dropped
+     * until one of the buffers is released.
+     * I420 frames are passed without copying: planes point directly to the
+     * decoder's output buffer. NV12 frames are interleaved into
+     * library-owned buffers which are reused between frames.
+     */
+    class IExternalPlanarRenderer
+    {
+    public:
+        enum PixelFormat { kI420, kNV12 };
+
+        /**
+         * Pixel format of the frames renderer expects. Called once, when
+         * rendering starts.
+         */
+        virtual PixelFormat getPixelFormat() const = 0;
+
+        /**
+         * Number of swap buffers renderer may hold at the same time. Called
+         * once, when rendering starts.
+         */
+        virtual unsigned int getSwapBuffersNum() const { return 3; }
+
+        /**
+         * This method is called every time new frame is available for
+         * rendering. It is called on decoding thread, therefore, it should
+         * return as soon as possible.
+         * @param frameInfo Frame info
+         * @param frame Planar frame data
+         * @param releaser Object which must be used to release the frame
+         *          once renderer no longer needs it
+         */
+        virtual void renderFrame(const FrameInfo& frameInfo, const PlanarFrame& frame,
+                                 IRenderBufferReleaser* releaser) = 0;
+    };
+
     /**
      * This class is used for delivering raw ARGB frames to the library.
      * After calling initPublishing, library returns a pointer of object
@@ -209,6 +209,18 @@ namespace ndnrtc {
 			const unsigned char* uBuffer,
 			const unsigned char* vBuffer) override;
 
+		/**
+		 * Encode and publish I420 frame without copying it.
+		 * Frame planes are passed to encoders directly and must stay valid
+		 * and unchanged until owner's releaseFrame is called for this frame.
+		 * Saves at least one frame copy compared to incomingI420Frame above,
+		 * which is significant for high capture resolutions.
+		 * @param frame I420 frame (must have 3 planes)
+		 * @param owner Frame buffer owner, notified once frame is released
+		 * @return playback number of a frame, if is was published, -1 if it wasn't
+		 */
+		int incomingI420Frame(const PlanarFrame& frame, IFrameBufferOwner* owner);
+
 		/**
 		 * Encode and publish NV21 frame data.
 		 * This initiates encoding of raw frames for each video thread and
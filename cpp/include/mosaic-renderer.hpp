@@ -0,0 +1,105 @@
+//
+// mosaic-renderer.hpp
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#ifndef __mosaic_renderer_h__
+#define __mosaic_renderer_h__
+
+#include <vector>
+#include <boost/shared_ptr.hpp>
+
+#include "interfaces.hpp"
+#include "statistics.hpp"
+#include "simple-log.hpp"
+
+namespace ndnrtc {
+	class MosaicRendererImpl;
+
+	/**
+	 * Composes decoded video of several remote streams into one output frame
+	 * (i.e. for control room video walls).
+	 * Each tile of the mosaic provides an IExternalPlanarRenderer which should
+	 * be passed to RemoteVideoStream::start(). Tiles receive decoded I420
+	 * frames straight from the streams' decoders, without colour conversion
+	 * or copying, and keep only the latest frame. On every output tick, tiles
+	 * which received new frames are scaled into their rectangles of the
+	 * output frame in parallel, on worker threads (libyuv SIMD scaling,
+	 * aspect ratio is preserved), and one composed frame is passed to the
+	 * output renderer.
+	 * Output renderer holds composed frames the same way as it would hold
+	 * frames of a remote stream (see IExternalPlanarRenderer) - if all output
+	 * swap buffers are held, output tick is skipped.
+	 *
+	 * Lifetime of frames:
+	 *  - tile keeps the latest frame of its' stream (and stream's swap
+	 *    buffer) until next frame arrives, tile is removed or mosaic is
+	 *    destroyed; the stream may be stopped, restarted with another
+	 *    renderer or destroyed meanwhile - its' swap buffers are kept until
+	 *    released by the tile; last frame of a stopped stream stays on the
+	 *    tile until it is removed;
+	 *  - output renderer may release composed frames after stop(), but
+	 *    before the mosaic is destroyed; mosaic can be restarted while
+	 *    previous output holds frames only if new output has the same pixel
+	 *    format and number of swap buffers.
+	 */
+	class MosaicRenderer {
+	public:
+		typedef struct _Tile {
+			int x_, y_;
+			int width_, height_;
+		} Tile;
+
+		/**
+		 * @param width Output frame width
+		 * @param height Output frame height
+		 * @param nWorkers Number of scaling threads (0 - number of CPU cores)
+		 */
+		MosaicRenderer(unsigned int width, unsigned int height,
+			unsigned int nWorkers = 0);
+		~MosaicRenderer();
+
+		/**
+		 * Adds tile to the mosaic. Tile rectangle is aligned to even pixels.
+		 * @return Renderer that should be passed to RemoteVideoStream::start
+		 */
+		IExternalPlanarRenderer* addTile(const Tile& tile);
+
+		/**
+		 * Splits output frame into a grid of equal tiles.
+		 * @return Tiles' renderers, row by row
+		 */
+		std::vector<IExternalPlanarRenderer*> addGrid(unsigned int nColumns,
+			unsigned int nRows);
+
+		/**
+		 * Removes tile. Stream rendering into the tile must be stopped
+		 * beforehand: tile's frame is released back to the stream.
+		 */
+		void removeTile(IExternalPlanarRenderer* tileRenderer);
+		size_t getTilesNum() const;
+
+		/**
+		 * Starts composing output frames.
+		 * @param fps Output frame rate
+		 * @param output Renderer for composed frames (I420 or NV12)
+		 * @throws std::runtime_error if output's pixel format or number of
+		 *          swap buffers differs from previous output's, while
+		 *          previous output still holds frames
+		 */
+		void start(unsigned int fps, IExternalPlanarRenderer* output);
+		void stop();
+
+		statistics::StatisticsStorage getStatistics() const;
+		void setLogger(boost::shared_ptr<ndnlog::new_api::Logger> logger);
+
+	private:
+		MosaicRenderer(const MosaicRenderer&) = delete;
+
+		boost::shared_ptr<MosaicRendererImpl> pimpl_;
+	};
+}
+
+#endif
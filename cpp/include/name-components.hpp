@@ -66,7 +66,8 @@ namespace ndnrtc {
     public:
         NamespaceInfo():apiVersion_(0), isMeta_(false), isParity_(false), 
             isDelta_(false), hasSeqNo_(false), class_(SampleClass::Unknown),
-            segmentClass_(SegmentClass::Unknown), sampleNo_(0), segNo_(0), metaVersion_(0){}
+            segmentClass_(SegmentClass::Unknown), sampleNo_(0), segNo_(0), metaVersion_(0),
+            temporalLayer_(0){}
 
         ndn::Name basePrefix_;
         unsigned int apiVersion_;
@@ -79,6 +80,7 @@ namespace ndnrtc {
         unsigned int segNo_;
         unsigned int metaVersion_;
         uint64_t streamTimestamp_;
+        unsigned int temporalLayer_; // temporal (SVC) layer of delta sample
 
         ndn::Name getPrefix(int filter = (prefix_filter::Segment)) const;
         ndn::Name getSuffix(int filter = (suffix_filter::Segment)) const;
@@ -104,6 +106,13 @@ namespace ndnrtc {
         static ndn::Name
         ndnrtcSuffix();
 
+        /**
+         * Sample class component for delta samples of given temporal layer:
+         * "d" for base layer, "d1", "d2", etc. for upper layers.
+         */
+        static std::string
+        deltaComponent(unsigned int temporalLayer = 0);
+
         static ndn::Name
         streamPrefix(MediaStreamParams::MediaStreamType type, std::string basePrefix);
 
@@ -151,9 +151,11 @@ namespace ndnrtc
         unsigned int startBitrate_, maxBitrate_;
         unsigned int encodeWidth_, encodeHeight_;
         bool dropFramesOn_;
+        unsigned int temporalLayers_;   // number of temporal (SVC) layers, 1 - no SVC
         
         VideoCoderParams():codecFrameRate_(30),gop_(30),startBitrate_(1000),
-        maxBitrate_(5000),encodeWidth_(1280),encodeHeight_(720),dropFramesOn_(false){}
+        maxBitrate_(5000),encodeWidth_(1280),encodeHeight_(720),dropFramesOn_(false),
+        temporalLayers_(1){}
         
         void write(std::ostream& os) const
         {
@@ -164,6 +166,8 @@ namespace ndnrtc
             << maxBitrate_ << " Kbit/s; "
             << encodeWidth_ << "x" << encodeHeight_ << "; Drop: "
             << (dropFramesOn_?"YES":"NO");
+            if (temporalLayers_ > 1)
+                os << "; Temporal layers: " << temporalLayers_;
         }
         
         bool operator==(const VideoCoderParams& rhs) const
@@ -174,7 +178,8 @@ namespace ndnrtc
             this->maxBitrate_ == rhs.maxBitrate_ &&
             this->encodeWidth_ == rhs.encodeWidth_ &&
             this->encodeHeight_ == rhs.encodeHeight_ &&
-            this->dropFramesOn_ == rhs.dropFramesOn_;
+            this->dropFramesOn_ == rhs.dropFramesOn_ &&
+            this->temporalLayers_ == rhs.temporalLayers_;
         }
         
         bool operator!=(const VideoCoderParams& rhs) const
@@ -221,10 +226,12 @@ namespace ndnrtc
             unsigned int sampleKeyMs_;
         } FreshnessPeriodParams;
 
-        GeneralProducerParams():segmentSize_(8000), freshness_({10, 15, 900}){}
+        GeneralProducerParams():segmentSize_(8000), freshness_({10, 15, 900}),
+            cacheBudgetMb_(64){}
 
         unsigned int segmentSize_;
         FreshnessPeriodParams freshness_;
+        unsigned int cacheBudgetMb_; // producer content cache size limit
         
         void write(std::ostream& os) const
         {
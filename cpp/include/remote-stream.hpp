@@ -20,6 +20,7 @@ namespace ndnrtc {
 	class RemoteStreamImpl;
 	class IRemoteStreamObserver;
     class IExternalRenderer;
+    class IExternalPlanarRenderer;
     
     /**
      * Main class for handling remote streams - streams published by remote producers.
@@ -53,6 +54,13 @@ namespace ndnrtc {
                                 // fails or recovers after failure; user should invoke isVerified()
         } Event;
 
+        // Interest pipeline sizing strategies
+        typedef enum _PipelineStrategy {
+            PipelineStrategyDefault,    // pipeline is sized by sample rate and average DRD
+            PipelineStrategyBbr         // pipeline is sized by estimated bottleneck rate and
+                                        // minimal DRD and shrinks when DRD grows (queue builds up)
+        } PipelineStrategy;
+
         /**
          * Indicates, whether metadata was sucesfully fetched.
          * Upon creation, stream performs asynchronous metadata fetching. Stream can't start fetching
@@ -104,6 +112,34 @@ namespace ndnrtc {
          */
 		void setTargetBufferSize(unsigned int bufferSizeMs);
 
+        /**
+         * Sets strategy for sizing the pipeline of outstanding Interests.
+         * Must be called before start(), throws otherwise.
+         * @param strategy Pipeline strategy, PipelineStrategyDefault is used by default
+         */
+        void setPipelineStrategy(PipelineStrategy strategy);
+
+        /**
+         * Makes target playback buffer length follow given percentile of sample
+         * arrival delays instead of default DRD-based estimation. Buffer grows
+         * as soon as delays grow and shrinks gradually when network is calm.
+         * @param percentile Percentile of arrival delay distribution (e.g. 95),
+         *                   0 switches back to default estimation
+         */
+        void setJitterPercentile(double percentile);
+
+        /**
+         * Enables fast join mode, which cuts time to first frame when
+         * (re-)joining a stream:
+         *  - metadata of the stream is taken from process-wide cache, if
+         *    the stream was fetched before, and is refreshed in background;
+         *  - latest key frame is requested as soon as stream timestamp is
+         *    known, in parallel with thread metadata.
+         * Should be called right after stream object is created, before
+         * start(). Disabled by default.
+         */
+        void setFastJoin(bool enabled);
+
         /**
          * Indicates, whether last received data packet was verified succesfully.
          * User may monitor for VerificationState event for changes.
@@ -217,6 +253,15 @@ namespace ndnrtc {
 		void start(const std::string& threadName, 
 			IExternalRenderer* renderer);
 
+        /**
+         * Starts fetching video frames from the remote producer
+         * @param threadName Thread name to fetch media from
+         * @param renderer Pointer to IExternalPlanarRenderer object which will receive
+         *                 decoded video frames in planar YUV format.
+         */
+        void start(const std::string& threadName,
+            IExternalPlanarRenderer* renderer);
+
         typedef struct _FetchingRuleSet {
             uint32_t seedKeyNo_;    // seed keyframe number
             bool skipDelta_;        // whether all delta frames must be skipped
@@ -233,6 +278,89 @@ namespace ndnrtc {
          */
         void start(const FetchingRuleSet& ruleset,
             IExternalRenderer* renderer);
+
+        /**
+         * Starts fetching video frames according to the given fetching ruleset
+         * @param ruleset Rule set for fetching frames
+         * @param renderer Pointer to IExternalPlanarRenderer object which will receive
+         *                 decoded video frames in planar YUV format.
+         */
+        void start(const FetchingRuleSet& ruleset,
+            IExternalPlanarRenderer* renderer);
+
+        typedef struct _PreviewSettings {
+            uint32_t keyStep_;      // fetch every keyStep_-th key frame (1 - every key frame)
+            float scale_;           // size of rendered frames relative to thread's
+                                    // resolution, (0, 1]
+        } PreviewSettings;
+
+        /**
+         * Starts fetching stream preview: only key frames of the thread are
+         * fetched (every settings.keyStep_-th) and decoded, with no delta
+         * frames, buffering or latency control. Costs a fraction of live
+         * stream's bandwidth and CPU, suitable for showing many streams as
+         * thumbnails. Switching thread restarts preview on the new thread.
+         * @param threadName Thread name to fetch key frames from
+         * @param settings Preview settings
+         * @param renderer Pointer to IExternalRenderer object which will receive callbacks with
+         *                 decoded video frame pixel buffers.
+         */
+        void start(const std::string& threadName, const PreviewSettings& settings,
+            IExternalRenderer* renderer);
+
+        /**
+         * Starts fetching stream preview.
+         * @see start(const std::string&, const PreviewSettings&, IExternalRenderer*)
+         */
+        void start(const std::string& threadName, const PreviewSettings& settings,
+            IExternalPlanarRenderer* renderer);
+
+        /**
+         * Enables or disables automatic thread switching. When enabled, stream
+         * monitors network conditions (throughput, timeouts, DRD growth) and
+         * switches to lower bitrate thread on congestion or probes higher bitrate
+         * thread when network allows. User is notified with ThreadSwitched event
+         * on every switch. Has no effect for streams created from thread prefix.
+         * Disabled by default.
+         */
+        void setRateAdaptation(bool enabled);
+
+        // Policies for fetching parity (FEC) segments
+        typedef enum _ParityPolicy {
+            ParityPolicyAlways,     // parity segments are requested together with data segments
+            ParityPolicyOnDemand    // parity segments are requested only when data segments
+                                    // time out or miss retransmission deadline
+        } ParityPolicy;
+
+        /**
+         * Sets policy for fetching parity segments. On-demand policy saves
+         * bandwidth on clean links at the cost of one extra round-trip for
+         * recovering lost segments. Statistics indicators ParityFetchedNum and
+         * ParityUsedNum may be used to compare these policies.
+         * @param policy Parity policy, ParityPolicyAlways is used by default
+         */
+        void setParityPolicy(ParityPolicy policy);
+
+        /**
+         * Limits fetching to temporal layers up to maxLayer (0 - base layer
+         * only). Applies to threads encoded with temporal layers only: delta
+         * frames of upper layers are not requested, reducing frame rate and
+         * bandwidth without switching threads. All layers are fetched by
+         * default.
+         * @param maxLayer Highest temporal layer to fetch
+         */
+        void setMaxTemporalLayer(unsigned int maxLayer);
+
+        /**
+         * Enables fetching deduplication for live streams. Remote video
+         * streams of the same thread in one process with shared fetching
+         * enabled use one fetch engine: the first stream fetches and verifies
+         * data, the others receive its' segments and run their own buffering
+         * and playback. If the fetching stream stops, one of the others takes
+         * over. Thread switches restart fetching. Should be called before
+         * start(). Disabled by default.
+         */
+        void setSharedFetching(bool enabled);
 	};
     
     /**
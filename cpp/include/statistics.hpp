@@ -14,12 +14,15 @@
 
 #include <string>
 #include <map>
+#include <vector>
 #include <stdexcept>
 #include <iostream>
 #include <iomanip>
 
 #include <boost/shared_ptr.hpp>
 
+#include "histogram.hpp"
+
 namespace ndnrtc {
     namespace statistics {
         enum class Indicator {
@@ -43,6 +46,13 @@ namespace ndnrtc {
                 BufferTargetSize,               // RemoteStreamImpl
                 BufferPlayableSize,             // PlaybackQueue
                 BufferReservedSize,             // PlaybackQueue
+                JitterDelayPercentile,          // LatencyControl
+                JitterAchievedSize,             // LatencyControl
+                CatchUpSkippedNum,              // PlaybackQueue
+                PlayoutSpeed,                   // PlayoutImpl
+                DecodeQueueSize,                // DecodeStage
+                DecodePendingNum,               // DecodeStage
+                DecodeDroppedNum,               // DecodeStage
                 CurrentProducerFramerate,       // BufferControl
                 VerifySuccess,                  // SampleValidator
                 VerifyFailure,                  // SampleValidator
@@ -60,6 +70,28 @@ namespace ndnrtc {
                 SkippedNum,                     // VideoPlayout
                 LatencyEstimated,
                 
+                // latency distributions (derived from histograms, ms)
+                LatencyP50,                     // PlayoutImpl
+                LatencyP95,                     // PlayoutImpl
+                LatencyP99,                     // PlayoutImpl
+                LatencyMax,                     // PlayoutImpl
+                DrdP50,                         // Buffer
+                DrdP95,                         // Buffer
+                DrdP99,                         // Buffer
+                DrdMax,                         // Buffer
+                AssemblyP50,                    // Buffer
+                AssemblyP95,                    // Buffer
+                AssemblyP99,                    // Buffer
+                AssemblyMax,                    // Buffer
+                DecodeP50,                      // DecodeStage
+                DecodeP95,                      // DecodeStage
+                DecodeP99,                      // DecodeStage
+                DecodeMax,                      // DecodeStage
+                LatenessP50,                    // PlayoutImpl
+                LatenessP95,                    // PlayoutImpl
+                LatenessP99,                    // PlayoutImpl
+                LatenessMax,                    // PlayoutImpl
+                
                 // pipeliner
                 SegmentsDeltaAvgNum,            // SampleEstimator
                 SegmentsKeyAvgNum,              // SampleEstimator
@@ -69,6 +101,10 @@ namespace ndnrtc {
                 RebufferingsNum,                // PipelineControlStateMachine
                 RequestedNum,                   // Pipeliner
                 RequestedKeyNum,                // Pipeliner
+                ParityRequestedNum,             // Pipeliner
+                ParityFetchedNum,               // Pipeliner
+                LayerSkippedNum,                // Pipeliner
+                ParityUsedNum,                  // VideoPlayout
                 DW,                             // InterestControl
                 W,                              // InterestControl
                 SegmentsReceivedNum,            // SegmentController
@@ -81,6 +117,9 @@ namespace ndnrtc {
                 State,                          // PipelineControlStateMachine
                 DoubleRtFrames,                 // Pipeliner
                 DoubleRtFramesKey,              // Pipeliner
+                ThroughputEstimate,             // RateAdaptationModule
+                ThreadSwitchesNum,              // RemoteVideoStreamImpl
+                TimeToFirstFrame,               // RemoteVideoStreamImpl
                 
                 // DRD estimator
                 DrdOriginalEstimation,          // BufferControl
@@ -105,19 +144,54 @@ namespace ndnrtc {
                 // DroppedNum, // borrowed from buffer (above)
                 EncodedNum,
                 
+                // scaler
+                ScaledNum,                      // ScalingPyramid
+                ScaleSkippedNum,                // ScalingPyramid
+                ScaleTime,                      // ScalingPyramid
+                
+                // content cache
+                CacheHitNum,                    // RingContentCache
+                CacheMissNum,                   // RingContentCache
+                CacheEvictedNum,                // RingContentCache
+                CacheBytes,                     // RingContentCache
+                
+                // mosaic
+                MosaicComposedNum,              // MosaicRendererImpl
+                MosaicSkippedNum,               // MosaicRendererImpl
+                MosaicTilesScaledNum,           // MosaicRendererImpl
+                MosaicComposeTime,              // MosaicRendererImpl
+                
+                // shared fetching
+                SharedSegmentsNum,              // RemoteVideoStreamImpl
+                
                 // capturer
                 CapturedNum
         };
         
+        /**
+         * Distributions tracked by statistics storage. All values are
+         * recorded in microseconds.
+         */
+        enum class HistogramIndicator {
+                CaptureToPlay,      // producer publish time to playout (PlayoutImpl)
+                SegmentDrd,         // per-segment data retrieval delay (Buffer)
+                SlotAssembly,       // first segment to fully assembled slot (Buffer)
+                Decode,             // time spent decoding a frame (DecodeStage)
+                PlayoutLateness     // sample playout past its scheduled time (PlayoutImpl)
+        };
+        
         class StatisticsStorage {
         public:
                 typedef std::map<Indicator, double> StatRepo;
+                typedef std::map<HistogramIndicator, boost::shared_ptr<Histogram>> HistogramRepo;
                 static const std::map<Indicator, std::string> IndicatorNames;
                 static const std::map<Indicator, std::string> IndicatorKeywords;
+                static const std::map<HistogramIndicator, std::string> HistogramKeywords;
                 
                 static StatisticsStorage*
                 createConsumerStatistics()
-                { return new StatisticsStorage(StatisticsStorage::ConsumerStatRepo); }
+                { return new StatisticsStorage(StatisticsStorage::ConsumerStatRepo,
+                                               StatisticsStorage::ConsumerHistograms); }
                 
                 static StatisticsStorage*
                 createProducerStatistics()
@@ -125,7 +199,8 @@ namespace ndnrtc {
                 
                 StatisticsStorage(const StatisticsStorage& statisticsStorage):
                 inidicatorNames_(StatisticsStorage::IndicatorNames),
-                indicators_(statisticsStorage.getIndicators()){}
+                indicators_(statisticsStorage.getIndicators()),
+                histograms_(statisticsStorage.copyHistograms()){}
                 ~StatisticsStorage(){}
                 
                 // may throw an exception if indicator is not present in the repo
@@ -133,13 +208,32 @@ namespace ndnrtc {
                 updateIndicator(const statistics::Indicator& indicator,
                                 const double& value) throw(std::out_of_range);
                 
+                /**
+                 * Returns a copy of indicators. Percentile indicators are 
+                 * calculated from the histograms at the moment of the call.
+                 */
                 StatRepo
                 getIndicators() const;
                 
+                /**
+                 * Records value (in microseconds) into the histogram. Lock-free.
+                 * Does nothing if this storage does not track the histogram.
+                 */
+                void
+                recordValue(const statistics::HistogramIndicator& histogram,
+                            int64_t valueUsec);
+                
+                /**
+                 * Returns histogram or nullptr if this storage does not track it
+                 */
+                boost::shared_ptr<const Histogram>
+                getHistogram(const statistics::HistogramIndicator& histogram) const;
+                
                 StatisticsStorage&
                 operator=(const StatisticsStorage& other)
                 {
                     indicators_ = other.getIndicators();
+                    histograms_ = other.copyHistograms();
                     return *this;
                 }
                 
@@ -164,12 +258,18 @@ namespace ndnrtc {
                     return os;
                 }
         private:
-                StatisticsStorage(const StatRepo& indicators):indicators_(indicators){}
+                StatisticsStorage(const StatRepo& indicators,
+                                  const std::vector<HistogramIndicator>& histograms = 
+                                    std::vector<HistogramIndicator>());
                 
                 const std::map<Indicator, std::string> inidicatorNames_;
                 static const StatRepo ConsumerStatRepo;
                 static const StatRepo ProducerStatRepo;
+                static const std::vector<HistogramIndicator> ConsumerHistograms;
                 StatRepo indicators_;
+                HistogramRepo histograms_;
+                
+                HistogramRepo copyHistograms() const;
         };
 
         class StatObject {
@@ -26,15 +26,16 @@ AudioStreamImpl::AudioStreamImpl(const std::string &basePrefix,
     if (settings_.params_.type_ == MediaStreamParams::MediaStreamType::MediaStreamTypeVideo)
         throw runtime_error("Wrong media stream parameters type supplied (video instead of audio)");
 
-    PublisherSettings ps;
+    StreamPublisherSettings ps;
     ps.sign_ = true;
     ps.keyChain_ = settings_.keyChain_;
     ps.memoryCache_ = cache_.get();
     ps.segmentWireLength_ = MAX_NDN_PACKET_SIZE;
     ps.freshnessPeriodMs_ = settings.params_.producerParams_.freshness_.sampleMs_;
+    ps.wireFormat_ = wireFormat(NameComponents::nameApiVersion());
     ps.statStorage_ = statStorage_.get();
 
-    samplePublisher_ = boost::make_shared<CommonPacketPublisher>(ps);
+    samplePublisher_ = boost::make_shared<CommonStreamPublisher>(ps);
     samplePublisher_->setDescription("sample-publisher-" + settings_.params_.streamName_);
 
     description_ = "astream-" + settings_.params_.streamName_;
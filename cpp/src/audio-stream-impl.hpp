@@ -56,7 +56,7 @@ class AudioStreamImpl : public MediaStreamBase,
         uint64_t bundleNo_;
     };
 
-    boost::shared_ptr<CommonPacketPublisher> samplePublisher_;
+    boost::shared_ptr<CommonStreamPublisher> samplePublisher_;
     std::map<std::string, boost::shared_ptr<AudioThread>> threads_;
     std::map<std::string, boost::shared_ptr<MetaKeeper>> metaKeepers_;
     std::vector<boost::shared_ptr<AudioBundlePacket>> bundlePool_;
@@ -234,6 +234,26 @@ double ndnrtc_getStatistic(ndnrtc::IStream *stream, const char* statName)
     return 0;
 }
 
+double ndnrtc_getStatisticPercentile(ndnrtc::IStream *stream, const char* histName,
+                                     double percentile)
+{
+    if (stream)
+    {
+        std::string hname(histName);
+        for (auto p:statistics::StatisticsStorage::HistogramKeywords)
+            if (p.second == hname)
+            {
+                statistics::StatisticsStorage storage = stream->getStatistics();
+                boost::shared_ptr<const statistics::Histogram> h = storage.getHistogram(p.first);
+                if (h)
+                    return (double)h->getValueAtPercentile(percentile)/1000.;
+                break;
+            }
+    }
+
+    return 0;
+}
+
 static std::map<std::string, boost::shared_ptr<FrameFetcher>> FrameFetchers;
 void ndnrtc_FrameFetcher_fetch(ndnrtc::IStream *stream,
                                const char* frameName, 
@@ -284,6 +304,47 @@ int ndnrtc_LocalVideoStream_incomingI420Frame(ndnrtc::LocalVideoStream *stream,
 	return -1;
 }
 
+// forwards frame release to C callback, lives until frame is released
+class CallbackFrameOwner : public IFrameBufferOwner
+{
+public:
+	CallbackFrameOwner(FrameReleased releasedFunc, void* userData):
+		releasedFunc_(releasedFunc), userData_(userData){}
+
+	void releaseFrame(const PlanarFrame&)
+	{
+		if (releasedFunc_) releasedFunc_(userData_);
+		delete this;
+	}
+
+private:
+	FrameReleased releasedFunc_;
+	void* userData_;
+};
+
+int ndnrtc_LocalVideoStream_incomingI420FrameNoCopy(ndnrtc::LocalVideoStream *stream,
+			const unsigned int width,
+			const unsigned int height,
+			const unsigned int strideY,
+			const unsigned int strideU,
+			const unsigned int strideV,
+			const unsigned char* yBuffer,
+			const unsigned char* uBuffer,
+			const unsigned char* vBuffer,
+			FrameReleased releasedFunc,
+			void* userData)
+{
+	if (stream)
+	{
+		PlanarFrame frame({0, (int)width, (int)height, 3, 
+			{yBuffer, uBuffer, vBuffer}, {(int)strideY, (int)strideU, (int)strideV}});
+		return stream->incomingI420Frame(frame, new CallbackFrameOwner(releasedFunc, userData));
+	}
+
+	if (releasedFunc) releasedFunc(userData);
+	return -1;
+}
+
 int ndnrtc_LocalVideoStream_incomingNV21Frame(ndnrtc::LocalVideoStream *stream,
 			const unsigned int width,
 			const unsigned int height,
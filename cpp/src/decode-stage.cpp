@@ -0,0 +1,211 @@
+//
+// decode-stage.cpp
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#include "decode-stage.hpp"
+
+#include <boost/make_shared.hpp>
+#include <boost/thread/lock_guard.hpp>
+
+#include "statistics.hpp"
+#include "clock.hpp"
+#include "frame-trace.hpp"
+
+using namespace ndnrtc;
+using namespace ndnrtc::statistics;
+
+const unsigned int DecodeStage::QueueCapacity = 3;
+const unsigned int DecodeStage::MaxPendingFrames = 8;
+
+//******************************************************************************
+DecodeStage::EncodedFrame::EncodedFrame(const FrameInfo &frameInfo,
+                                        const webrtc::EncodedImage &image)
+    : frameInfo_(frameInfo), data_(image._buffer, image._buffer + image._length), image_(image)
+{
+    // playout releases buffer slot right after frame was passed, so
+    // encoded data must be copied before it is decoded on another thread
+    image_._buffer = data_.data();
+    image_._size = data_.size();
+}
+
+//******************************************************************************
+DecodeStage::DecodeStage(const boost::shared_ptr<StatisticsStorage> &storage,
+                         OnDecodedImage onPresent, bool presentOnDecode)
+    : sstorage_(storage), onPresent_(onPresent), nPending_(0), epoch_(0),
+      decodingEpoch_(0), waitForKey_(true), presentOnDecode_(presentOnDecode)
+{
+    description_ = "decode-stage";
+    startMyThread();
+}
+
+DecodeStage::~DecodeStage()
+{
+    // decode thread refers to this object, can't leave it running
+    stopMyThread(true);
+}
+
+void DecodeStage::setDecoder(const boost::shared_ptr<IEncodedFrameConsumer> &decoder)
+{
+    boost::lock_guard<boost::mutex> scopedLock(mutex_);
+    decoder_ = decoder;
+}
+
+void DecodeStage::processFrame(const FrameInfo &frameInfo, const webrtc::EncodedImage &image)
+{
+    unsigned int epoch;
+    bool enqueue = false;
+
+    {
+        boost::lock_guard<boost::mutex> scopedLock(mutex_);
+
+        if (nPending_ >= MaxPendingFrames && !waitForKey_)
+        {
+            LogWarnC << "decoder is behind by " << nPending_
+                     << " frames. dropping frames until next key" << std::endl;
+            waitForKey_ = true;
+        }
+
+        if (waitForKey_ && !frameInfo.isKey_)
+        {
+            LogDebugC << "drop " << frameInfo.playbackNo_ << "p (waiting for key)" << std::endl;
+            (*sstorage_)[Indicator::DecodeDroppedNum]++;
+        }
+        else
+        {
+            waitForKey_ = false;
+            enqueue = true;
+            nPending_++;
+        }
+
+        epoch = epoch_;
+        updateStats();
+    }
+
+    if (enqueue)
+    {
+        boost::shared_ptr<EncodedFrame> frame = boost::make_shared<EncodedFrame>(frameInfo, image);
+        dispatchOnMyThread([this, frame, epoch]() {
+            decode(frame, epoch);
+        });
+    }
+
+    if (!presentOnDecode_)
+        present(frameInfo.playbackNo_);
+}
+
+void DecodeStage::frameDecoded(const FrameInfo &frameInfo, const WebRtcVideoFrame &frame)
+{
+    boost::lock_guard<boost::mutex> scopedLock(mutex_);
+
+    if (decodingEpoch_ != epoch_)
+        return;
+
+    decoded_.push_back(std::make_pair(frameInfo, frame));
+    while (decoded_.size() > QueueCapacity)
+    {
+        LogDebugC << "decoded queue is full. drop " << decoded_.front().first.playbackNo_
+                  << "p" << std::endl;
+
+        decoded_.pop_front();
+        (*sstorage_)[Indicator::DecodeDroppedNum]++;
+    }
+    updateStats();
+}
+
+void DecodeStage::flush()
+{
+    boost::lock_guard<boost::mutex> scopedLock(mutex_);
+
+    LogDebugC << "flush (" << nPending_ << " pending, "
+              << decoded_.size() << " decoded)" << std::endl;
+
+    epoch_++;
+    nPending_ = 0;
+    waitForKey_ = true;
+    decoded_.clear();
+    updateStats();
+}
+
+size_t DecodeStage::getPendingNum() const
+{
+    boost::lock_guard<boost::mutex> scopedLock(mutex_);
+    return nPending_;
+}
+
+size_t DecodeStage::getQueueSize() const
+{
+    boost::lock_guard<boost::mutex> scopedLock(mutex_);
+    return decoded_.size();
+}
+
+#pragma mark - private
+void DecodeStage::decode(const boost::shared_ptr<EncodedFrame> &frame, unsigned int epoch)
+{
+    boost::shared_ptr<IEncodedFrameConsumer> decoder;
+    {
+        boost::lock_guard<boost::mutex> scopedLock(mutex_);
+        // frame was queued before flush
+        if (epoch != epoch_)
+            return;
+
+        decoder = decoder_;
+        decodingEpoch_ = epoch;
+    }
+
+    if (decoder)
+    {
+        FrameTraceScope(Decode, frame->frameInfo_.playbackNo_);
+        int64_t decodeStartUsec = clock::microsecondTimestamp();
+
+        decoder->processFrame(frame->frameInfo_, frame->image_);
+        sstorage_->recordValue(HistogramIndicator::Decode,
+                               clock::microsecondTimestamp() - decodeStartUsec);
+    }
+
+    {
+        boost::lock_guard<boost::mutex> scopedLock(mutex_);
+        if (epoch == epoch_ && nPending_)
+            nPending_--;
+        updateStats();
+    }
+
+    if (presentOnDecode_)
+        present(frame->frameInfo_.playbackNo_);
+}
+
+void DecodeStage::present(PacketNumber dueNo)
+{
+    boost::shared_ptr<DecodedFrame> frame;
+    {
+        boost::lock_guard<boost::mutex> scopedLock(mutex_);
+
+        if (decoded_.empty() || decoded_.front().first.playbackNo_ > dueNo)
+            return;
+
+        // newest due frame supersedes older ones
+        while (decoded_.size() > 1 && decoded_[1].first.playbackNo_ <= dueNo)
+        {
+            LogDebugC << "drop decoded " << decoded_.front().first.playbackNo_
+                      << "p (superseded by " << decoded_[1].first.playbackNo_
+                      << "p)" << std::endl;
+
+            decoded_.pop_front();
+            (*sstorage_)[Indicator::DecodeDroppedNum]++;
+        }
+
+        frame = boost::make_shared<DecodedFrame>(decoded_.front());
+        decoded_.pop_front();
+        updateStats();
+    }
+
+    onPresent_(frame->first, frame->second);
+}
+
+void DecodeStage::updateStats()
+{
+    (*sstorage_)[Indicator::DecodeQueueSize] = decoded_.size();
+    (*sstorage_)[Indicator::DecodePendingNum] = nPending_;
+}
@@ -0,0 +1,109 @@
+//
+// decode-stage.hpp
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#ifndef __decode_stage_h__
+#define __decode_stage_h__
+
+#include <deque>
+#include <boost/thread/mutex.hpp>
+
+#include "ndnrtc-object.hpp"
+#include "threading-capability.hpp"
+#include "video-decoder.hpp"
+
+namespace ndnrtc
+{
+namespace statistics
+{
+class StatisticsStorage;
+}
+
+/**
+ * DecodeStage decouples decoding from playout timing. It is registered as
+ * frame consumer with VideoPlayout instead of the decoder: encoded frames
+ * passed by playout are copied and decoded on the stage's own thread, so
+ * slow decoding (key frames, recovery) does not delay playout timer.
+ * Decoded frames are queued and presented (passed to OnDecodedImage
+ * callback) on playout ticks: every frame passed by playout presents the
+ * newest decoded frame which is due by then (its' playback number is not
+ * greater than playback number of the passed frame), older decoded frames
+ * are dropped. Thus, frames decoded in a burst after a slow key frame are
+ * still presented at playout pace, one frame per tick.
+ * If decoder falls behind by more than MaxPendingFrames, encoded frames are
+ * dropped until the next key frame. If decoded queue grows beyond
+ * QueueCapacity, oldest decoded frames are dropped.
+ * Frames that are not paced by playout (i.e. preview key frames) may be
+ * presented on decode thread as soon as they are decoded instead.
+ * Destructor waits for the frame being decoded, so decoder's callback may
+ * safely refer to the stage.
+ */
+class DecodeStage : public NdnRtcComponent,
+                    public IEncodedFrameConsumer,
+                    public ThreadingCapability
+{
+  public:
+    static const unsigned int QueueCapacity;
+    static const unsigned int MaxPendingFrames;
+
+    /**
+     * @param onPresent Called with frames to present, on the thread that
+     *          passes frames (playout thread) or on decode thread if
+     *          presentOnDecode is set
+     * @param presentOnDecode Present frames as soon as they are decoded
+     */
+    DecodeStage(const boost::shared_ptr<statistics::StatisticsStorage> &storage,
+                OnDecodedImage onPresent, bool presentOnDecode = false);
+    ~DecodeStage();
+
+    /**
+     * Sets decoder which will be invoked on decode thread. Decoder's
+     * OnDecodedImage callback must be bound to frameDecoded().
+     */
+    void setDecoder(const boost::shared_ptr<IEncodedFrameConsumer> &decoder);
+
+    // called by playout for every frame due for playback (playout tick)
+    void processFrame(const FrameInfo &, const webrtc::EncodedImage &) override;
+    // called by decoder (on decode thread)
+    void frameDecoded(const FrameInfo &, const WebRtcVideoFrame &);
+
+    /**
+     * Drops all pending and decoded frames. Next frame passed for decoding
+     * must be a key frame.
+     */
+    void flush() override;
+
+    size_t getPendingNum() const;
+    size_t getQueueSize() const;
+
+  private:
+    class EncodedFrame
+    {
+      public:
+        EncodedFrame(const FrameInfo &frameInfo, const webrtc::EncodedImage &image);
+
+        FrameInfo frameInfo_;
+        std::vector<uint8_t> data_;
+        webrtc::EncodedImage image_;
+    };
+
+    typedef std::pair<FrameInfo, WebRtcVideoFrame> DecodedFrame;
+
+    mutable boost::mutex mutex_;
+    boost::shared_ptr<statistics::StatisticsStorage> sstorage_;
+    boost::shared_ptr<IEncodedFrameConsumer> decoder_;
+    OnDecodedImage onPresent_;
+    std::deque<DecodedFrame> decoded_;
+    unsigned int nPending_, epoch_, decodingEpoch_;
+    bool waitForKey_, presentOnDecode_;
+
+    void decode(const boost::shared_ptr<EncodedFrame> &frame, unsigned int epoch);
+    void present(PacketNumber dueNo);
+    void updateStats();
+};
+}
+
+#endif
@@ -0,0 +1,417 @@
+//
+// digest-engine.cpp
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#include "digest-engine.hpp"
+
+#include <algorithm>
+#include <string.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define DIGEST_ENGINE_X86 1
+#include <cpuid.h>
+#include <immintrin.h>
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#define TARGET_SHA __attribute__((target("sha,sse4.1,ssse3")))
+#else
+#define DIGEST_ENGINE_X86 0
+#endif
+
+using namespace ndnrtc;
+
+const size_t DigestEngine::DigestSize;
+const size_t DigestEngine::MultiBufferLanes;
+
+namespace
+{
+const uint32_t H0[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+    0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+
+const uint32_t K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+const uint8_t ZeroBlock[64] = {0};
+
+inline uint32_t loadBe32(const uint8_t *p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+inline void storeBe32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+}
+
+inline uint32_t rotr(uint32_t x, unsigned int n) { return (x >> n) | (x << (32 - n)); }
+
+// message split into 64-byte blocks: full blocks are read in place, last
+// one or two blocks (remainder and padding) are built in tail_
+class Message
+{
+  public:
+    Message() : data_(nullptr), nFull_(0), nTail_(0) {}
+    Message(const uint8_t *data, size_t size)
+        : data_(data), nFull_(size / 64)
+    {
+        size_t remainder = size % 64;
+        uint64_t nBits = (uint64_t)size * 8;
+
+        nTail_ = (remainder + 9 <= 64 ? 1 : 2);
+        memset(tail_, 0, sizeof(tail_));
+        if (remainder)
+            memcpy(tail_, data + nFull_ * 64, remainder);
+        tail_[remainder] = 0x80;
+        for (int i = 0; i < 8; ++i)
+            tail_[nTail_ * 64 - 1 - i] = (uint8_t)(nBits >> (8 * i));
+    }
+
+    size_t getBlocksNum() const { return nFull_ + nTail_; }
+    const uint8_t *getBlock(size_t idx) const
+    {
+        return (idx < nFull_ ? data_ + idx * 64 : tail_ + (idx - nFull_) * 64);
+    }
+
+  private:
+    const uint8_t *data_;
+    size_t nFull_, nTail_;
+    uint8_t tail_[128];
+};
+
+void writeDigest(const uint32_t state[8], DigestEngine::Digest &digest)
+{
+    for (int i = 0; i < 8; ++i)
+        storeBe32(digest.data() + 4 * i, state[i]);
+}
+
+//******************************************************************************
+void compressScalar(uint32_t state[8], const uint8_t *block)
+{
+    uint32_t w[64];
+
+    for (int t = 0; t < 16; ++t)
+        w[t] = loadBe32(block + 4 * t);
+    for (int t = 16; t < 64; ++t)
+    {
+        uint32_t s0 = rotr(w[t - 15], 7) ^ rotr(w[t - 15], 18) ^ (w[t - 15] >> 3);
+        uint32_t s1 = rotr(w[t - 2], 17) ^ rotr(w[t - 2], 19) ^ (w[t - 2] >> 10);
+        w[t] = w[t - 16] + s0 + w[t - 7] + s1;
+    }
+
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3],
+             e = state[4], f = state[5], g = state[6], h = state[7];
+
+    for (int t = 0; t < 64; ++t)
+    {
+        uint32_t t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + K[t] + w[t];
+        uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+    state[5] += f;
+    state[6] += g;
+    state[7] += h;
+}
+
+void hashScalar(const Message &m, DigestEngine::Digest &digest)
+{
+    uint32_t state[8];
+
+    memcpy(state, H0, sizeof(state));
+    for (size_t i = 0; i < m.getBlocksNum(); ++i)
+        compressScalar(state, m.getBlock(i));
+    writeDigest(state, digest);
+}
+
+#if DIGEST_ENGINE_X86
+//******************************************************************************
+bool cpuSupports(DigestEngine::Implementation impl)
+{
+    unsigned int eax, ebx, ecx, edx;
+
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+        return false;
+
+    bool ssse3 = ecx & (1 << 9), sse41 = ecx & (1 << 19), osxsave = ecx & (1 << 27);
+
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+        return false;
+
+    bool avx2 = ebx & (1 << 5), sha = ebx & (1 << 29);
+
+    if (impl == DigestEngine::Implementation::ShaExtensions)
+        return sha && sse41 && ssse3;
+
+    if (impl == DigestEngine::Implementation::MultiBuffer && avx2 && osxsave)
+    {
+        // OS must save YMM registers on context switch
+        uint32_t xcrLo, xcrHi;
+        __asm__("xgetbv" : "=a"(xcrLo), "=d"(xcrHi) : "c"(0));
+        return (xcrLo & 0x6) == 0x6;
+    }
+
+    return false;
+}
+
+//******************************************************************************
+TARGET_SHA void hashShaExtensions(const Message &m, DigestEngine::Digest &digest)
+{
+    const __m128i byteSwap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+    __m128i tmp = _mm_loadu_si128((const __m128i *)&H0[0]);
+    __m128i state1 = _mm_loadu_si128((const __m128i *)&H0[4]);
+
+    tmp = _mm_shuffle_epi32(tmp, 0xB1);            // CDAB
+    state1 = _mm_shuffle_epi32(state1, 0x1B);      // EFGH
+    __m128i state0 = _mm_alignr_epi8(tmp, state1, 8); // ABEF
+    state1 = _mm_blend_epi16(state1, tmp, 0xF0);   // CDGH
+
+    for (size_t i = 0; i < m.getBlocksNum(); ++i)
+    {
+        const uint8_t *block = m.getBlock(i);
+        __m128i abefSave = state0, cdghSave = state1;
+        __m128i msg[4];
+
+        // 16 groups of 4 rounds, message schedule is computed 3 groups ahead
+        for (int g = 0; g < 16; ++g)
+        {
+            if (g < 4)
+                msg[g] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(block + 16 * g)), byteSwap);
+
+            __m128i &cur = msg[g % 4];
+            __m128i rk = _mm_add_epi32(cur, _mm_loadu_si128((const __m128i *)&K[4 * g]));
+
+            state1 = _mm_sha256rnds2_epu32(state1, state0, rk);
+            if (g >= 3 && g <= 14)
+            {
+                __m128i &next = msg[(g + 1) % 4];
+                next = _mm_add_epi32(next, _mm_alignr_epi8(cur, msg[(g + 3) % 4], 4));
+                next = _mm_sha256msg2_epu32(next, cur);
+            }
+            rk = _mm_shuffle_epi32(rk, 0x0E);
+            state0 = _mm_sha256rnds2_epu32(state0, state1, rk);
+            if (g >= 1 && g <= 12)
+                msg[(g + 3) % 4] = _mm_sha256msg1_epu32(msg[(g + 3) % 4], cur);
+        }
+
+        state0 = _mm_add_epi32(state0, abefSave);
+        state1 = _mm_add_epi32(state1, cdghSave);
+    }
+
+    uint32_t state[8];
+
+    tmp = _mm_shuffle_epi32(state0, 0x1B);        // FEBA
+    state1 = _mm_shuffle_epi32(state1, 0xB1);     // DCHG
+    state0 = _mm_blend_epi16(tmp, state1, 0xF0);  // DCBA
+    state1 = _mm_alignr_epi8(state1, tmp, 8);     // ABEF
+    _mm_storeu_si128((__m128i *)&state[0], state0);
+    _mm_storeu_si128((__m128i *)&state[4], state1);
+    writeDigest(state, digest);
+}
+
+//******************************************************************************
+#define ROTR8(x, n) _mm256_or_si256(_mm256_srli_epi32((x), (n)), _mm256_slli_epi32((x), 32 - (n)))
+
+// hashes up to 8 messages, each in its own 32-bit lane; lanes of messages
+// that are shorter than the longest one are masked out once they're done
+TARGET_AVX2 void hashMultiBuffer(const Message *const *messages, size_t n,
+                                 DigestEngine::Digest *const *digests)
+{
+    __m256i state[8];
+    size_t nBlocks = 0;
+
+    for (int i = 0; i < 8; ++i)
+        state[i] = _mm256_set1_epi32((int)H0[i]);
+    for (size_t l = 0; l < n; ++l)
+        nBlocks = std::max(nBlocks, messages[l]->getBlocksNum());
+
+    for (size_t b = 0; b < nBlocks; ++b)
+    {
+        const uint8_t *blocks[8];
+        int32_t active[8];
+
+        for (size_t l = 0; l < 8; ++l)
+        {
+            bool isActive = (l < n && b < messages[l]->getBlocksNum());
+            blocks[l] = (isActive ? messages[l]->getBlock(b) : ZeroBlock);
+            active[l] = (isActive ? -1 : 0);
+        }
+
+        __m256i w[64];
+        for (int t = 0; t < 16; ++t)
+            w[t] = _mm256_set_epi32((int)loadBe32(blocks[7] + 4 * t), (int)loadBe32(blocks[6] + 4 * t),
+                                    (int)loadBe32(blocks[5] + 4 * t), (int)loadBe32(blocks[4] + 4 * t),
+                                    (int)loadBe32(blocks[3] + 4 * t), (int)loadBe32(blocks[2] + 4 * t),
+                                    (int)loadBe32(blocks[1] + 4 * t), (int)loadBe32(blocks[0] + 4 * t));
+        for (int t = 16; t < 64; ++t)
+        {
+            __m256i s0 = _mm256_xor_si256(_mm256_xor_si256(ROTR8(w[t - 15], 7), ROTR8(w[t - 15], 18)),
+                                          _mm256_srli_epi32(w[t - 15], 3));
+            __m256i s1 = _mm256_xor_si256(_mm256_xor_si256(ROTR8(w[t - 2], 17), ROTR8(w[t - 2], 19)),
+                                          _mm256_srli_epi32(w[t - 2], 10));
+            w[t] = _mm256_add_epi32(_mm256_add_epi32(w[t - 16], s0), _mm256_add_epi32(w[t - 7], s1));
+        }
+
+        __m256i a = state[0], b_ = state[1], c = state[2], d = state[3],
+                e = state[4], f = state[5], g = state[6], h = state[7];
+
+        for (int t = 0; t < 64; ++t)
+        {
+            __m256i bigSigma1 = _mm256_xor_si256(_mm256_xor_si256(ROTR8(e, 6), ROTR8(e, 11)), ROTR8(e, 25));
+            __m256i ch = _mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g));
+            __m256i t1 = _mm256_add_epi32(_mm256_add_epi32(h, bigSigma1),
+                                          _mm256_add_epi32(_mm256_add_epi32(ch, _mm256_set1_epi32((int)K[t])), w[t]));
+            __m256i bigSigma0 = _mm256_xor_si256(_mm256_xor_si256(ROTR8(a, 2), ROTR8(a, 13)), ROTR8(a, 22));
+            __m256i maj = _mm256_or_si256(_mm256_and_si256(a, b_), _mm256_and_si256(c, _mm256_or_si256(a, b_)));
+            __m256i t2 = _mm256_add_epi32(bigSigma0, maj);
+
+            h = g;
+            g = f;
+            f = e;
+            e = _mm256_add_epi32(d, t1);
+            d = c;
+            c = b_;
+            b_ = a;
+            a = _mm256_add_epi32(t1, t2);
+        }
+
+        __m256i mask = _mm256_loadu_si256((const __m256i *)active);
+        __m256i round[8] = {a, b_, c, d, e, f, g, h};
+
+        for (int i = 0; i < 8; ++i)
+            state[i] = _mm256_blendv_epi8(state[i], _mm256_add_epi32(state[i], round[i]), mask);
+    }
+
+    uint32_t lanes[8][8]; // [word][lane]
+    for (int i = 0; i < 8; ++i)
+        _mm256_storeu_si256((__m256i *)lanes[i], state[i]);
+
+    for (size_t l = 0; l < n; ++l)
+    {
+        uint32_t s[8];
+        for (int i = 0; i < 8; ++i)
+            s[i] = lanes[i][l];
+        writeDigest(s, *digests[l]);
+    }
+}
+#else
+bool cpuSupports(DigestEngine::Implementation impl) { return false; }
+#endif
+}
+
+//******************************************************************************
+DigestEngine::Implementation DigestEngine::getImplementation()
+{
+    static const Implementation impl = (isSupported(Implementation::ShaExtensions) ? Implementation::ShaExtensions : (isSupported(Implementation::MultiBuffer) ? Implementation::MultiBuffer : Implementation::Scalar));
+    return impl;
+}
+
+bool DigestEngine::isSupported(Implementation impl)
+{
+    return (impl == Implementation::Scalar || cpuSupports(impl));
+}
+
+std::string DigestEngine::toString(Implementation impl)
+{
+    switch (impl)
+    {
+    case Implementation::MultiBuffer:
+        return "avx2-multibuffer";
+    case Implementation::ShaExtensions:
+        return "sha-ni";
+    default:
+        return "scalar";
+    }
+}
+
+void DigestEngine::sha256(const std::vector<Buffer> &buffers, std::vector<Digest> &digests)
+{
+    sha256(buffers, digests, getImplementation());
+}
+
+void DigestEngine::sha256(const std::vector<Buffer> &buffers, std::vector<Digest> &digests,
+                          Implementation impl)
+{
+    std::vector<Message> messages;
+
+    messages.reserve(buffers.size());
+    for (auto &b : buffers)
+        messages.push_back(Message(b.data_, b.size_));
+    digests.resize(buffers.size());
+
+    if (impl != Implementation::Scalar && !isSupported(impl))
+        impl = Implementation::Scalar;
+
+#if DIGEST_ENGINE_X86
+    if (impl == Implementation::ShaExtensions)
+    {
+        for (size_t i = 0; i < messages.size(); ++i)
+            hashShaExtensions(messages[i], digests[i]);
+        return;
+    }
+
+    if (impl == Implementation::MultiBuffer)
+    {
+        // group messages of similar length so that lanes finish together
+        std::vector<size_t> order(messages.size());
+        for (size_t i = 0; i < order.size(); ++i)
+            order[i] = i;
+        std::stable_sort(order.begin(), order.end(), [&messages](size_t a, size_t b) {
+            return messages[a].getBlocksNum() > messages[b].getBlocksNum();
+        });
+
+        size_t idx = 0;
+        for (; idx + 1 < order.size(); idx += MultiBufferLanes)
+        {
+            const Message *batch[MultiBufferLanes];
+            Digest *batchDigests[MultiBufferLanes];
+            size_t n = std::min(MultiBufferLanes, order.size() - idx);
+
+            for (size_t l = 0; l < n; ++l)
+            {
+                batch[l] = &messages[order[idx + l]];
+                batchDigests[l] = &digests[order[idx + l]];
+            }
+            hashMultiBuffer(batch, n, batchDigests);
+        }
+        // single message left - not worth a vector pass
+        if (idx < order.size())
+            hashScalar(messages[order[idx]], digests[order[idx]]);
+        return;
+    }
+#endif
+
+    for (size_t i = 0; i < messages.size(); ++i)
+        hashScalar(messages[i], digests[i]);
+}
+
+DigestEngine::Digest DigestEngine::sha256(const uint8_t *data, size_t size)
+{
+    std::vector<Digest> digests;
+    sha256(std::vector<Buffer>({Buffer({data, size})}), digests);
+    return digests[0];
+}
@@ -0,0 +1,71 @@
+//
+// digest-engine.hpp
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#ifndef __digest_engine_h__
+#define __digest_engine_h__
+
+#include <array>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace ndnrtc
+{
+/**
+ * Batch SHA-256 hashing.
+ * Data segments are small (few KB) and are always hashed in groups (all
+ * segments of a sample), so hashing them one by one wastes most of the CPU's
+ * vector units. Engine picks the fastest implementation available at runtime:
+ *  - SHA extensions (SHA-NI) - one buffer at a time, in hardware;
+ *  - AVX2 multi-buffer - up to 8 buffers hashed in parallel, one per 32-bit
+ *    vector lane;
+ *  - scalar - portable fallback.
+ * All implementations produce identical digests.
+ */
+class DigestEngine
+{
+  public:
+    static const size_t DigestSize = 32;
+    static const size_t MultiBufferLanes = 8;
+
+    typedef std::array<uint8_t, DigestSize> Digest;
+    typedef struct _Buffer
+    {
+        const uint8_t *data_;
+        size_t size_;
+    } Buffer;
+
+    enum class Implementation
+    {
+        Scalar,
+        MultiBuffer,  // AVX2
+        ShaExtensions // SHA-NI
+    };
+
+    /**
+     * Returns implementation used by default - the fastest one supported
+     * by CPU.
+     */
+    static Implementation getImplementation();
+    static bool isSupported(Implementation impl);
+    static std::string toString(Implementation impl);
+
+    /**
+     * Hashes all buffers. Digests vector is resized to the number of buffers.
+     */
+    static void sha256(const std::vector<Buffer> &buffers, std::vector<Digest> &digests);
+    /**
+     * Same as above, but with explicit implementation. Falls back to scalar
+     * if requested implementation is not supported.
+     */
+    static void sha256(const std::vector<Buffer> &buffers, std::vector<Digest> &digests,
+                       Implementation impl);
+    static Digest sha256(const uint8_t *data, size_t size);
+};
+}
+
+#endif
@@ -0,0 +1,175 @@
+//
+// encoder-resource-manager.cpp
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#include "encoder-resource-manager.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+#include <sstream>
+#include <boost/thread.hpp>
+#include <boost/thread/lock_guard.hpp>
+
+using namespace ndnrtc;
+using namespace ndnlog;
+
+const double EncoderResourceManager::ReferencePixelRate = 1280. * 720. * 30.;
+const double EncoderResourceManager::ReferenceBitrateKbps = 2000.;
+
+//******************************************************************************
+EncoderResourceManager *EncoderResourceManager::getSharedInstance()
+{
+    static EncoderResourceManager manager;
+    return &manager;
+}
+
+double EncoderResourceManager::getWeight(const VideoCoderParams &params)
+{
+    double pixelRate = (double)params.encodeWidth_ * (double)params.encodeHeight_ * params.codecFrameRate_;
+    double bitrateKbps = (double)std::max(params.startBitrate_, params.maxBitrate_);
+
+    return pixelRate / ReferencePixelRate + bitrateKbps / ReferenceBitrateKbps;
+}
+
+std::vector<unsigned int>
+EncoderResourceManager::allocate(unsigned int nCores, const std::vector<double> &weights)
+{
+    // every encoder gets at least one core, even if budget is exceeded
+    std::vector<unsigned int> cores(weights.size(), 1);
+
+    if (nCores <= weights.size())
+        return cores;
+
+    double total = std::accumulate(weights.begin(), weights.end(), 0.);
+    unsigned int remaining = nCores - weights.size(), allocated = 0;
+    std::vector<std::pair<double, size_t>> remainders;
+
+    for (size_t i = 0; i < weights.size(); ++i)
+    {
+        double share = (total > 0 ? weights[i] / total : 1. / (double)weights.size()) * remaining;
+        unsigned int whole = (unsigned int)std::floor(share);
+
+        cores[i] += whole;
+        allocated += whole;
+        remainders.push_back(std::make_pair(share - whole, i));
+    }
+
+    // cores left after rounding go to the largest remainders
+    std::stable_sort(remainders.begin(), remainders.end(),
+                     [](const std::pair<double, size_t> &a, const std::pair<double, size_t> &b) {
+                         return a.first > b.first;
+                     });
+    for (size_t i = 0; allocated < remaining && i < remainders.size(); ++i, ++allocated)
+        cores[remainders[i].second]++;
+
+    return cores;
+}
+
+//******************************************************************************
+EncoderResourceManager::EncoderResourceManager()
+    : coreBudget_(std::max(1u, boost::thread::hardware_concurrency()))
+{
+    description_ = "encoder-resources";
+}
+
+EncoderResourceManager::~EncoderResourceManager()
+{
+}
+
+unsigned int
+EncoderResourceManager::addEncoder(IEncoderResourceClient *client,
+                                   const VideoCoderParams &params)
+{
+    boost::lock_guard<boost::mutex> scopedLock(mutex_);
+    std::stringstream description;
+
+    description << params.encodeWidth_ << "x" << params.encodeHeight_
+                << "@" << params.maxBitrate_;
+    Encoder encoder({description.str(), getWeight(params), 0});
+
+    encoders_[client] = encoder;
+    rebalance();
+
+    LogInfoC << "added encoder " << encoder.description_
+             << " weight " << encoder.weight_
+             << " cores " << encoders_[client].nCores_ << "/" << coreBudget_ << std::endl;
+
+    return encoders_[client].nCores_;
+}
+
+void EncoderResourceManager::removeEncoder(IEncoderResourceClient *client)
+{
+    boost::lock_guard<boost::mutex> scopedLock(mutex_);
+
+    if (encoders_.find(client) != encoders_.end())
+    {
+        LogInfoC << "removed encoder " << encoders_[client].description_ << std::endl;
+
+        encoders_.erase(client);
+        rebalance();
+    }
+}
+
+void EncoderResourceManager::setCoreBudget(unsigned int nCores)
+{
+    boost::lock_guard<boost::mutex> scopedLock(mutex_);
+
+    coreBudget_ = std::max(1u, nCores);
+    rebalance();
+
+    LogInfoC << "core budget " << coreBudget_ << std::endl;
+}
+
+unsigned int EncoderResourceManager::getCores(IEncoderResourceClient *client) const
+{
+    boost::lock_guard<boost::mutex> scopedLock(mutex_);
+    auto it = encoders_.find(client);
+
+    return (it == encoders_.end() ? 0 : it->second.nCores_);
+}
+
+std::vector<EncoderResourceManager::EncoderInfo>
+EncoderResourceManager::getEncoders() const
+{
+    boost::lock_guard<boost::mutex> scopedLock(mutex_);
+    std::vector<EncoderInfo> encoders;
+
+    for (auto &it : encoders_)
+        encoders.push_back(EncoderInfo({it.second.description_, it.second.weight_,
+                                        it.second.nCores_, it.first->getEncodeTimeMs()}));
+
+    return encoders;
+}
+
+#pragma mark - private
+void EncoderResourceManager::rebalance()
+{
+    std::vector<double> weights;
+    for (auto &it : encoders_)
+        weights.push_back(it.second.weight_);
+
+    if (encoders_.size() > coreBudget_)
+        LogWarnC << encoders_.size() << " encoders exceed core budget of "
+                 << coreBudget_ << std::endl;
+
+    std::vector<unsigned int> cores = allocate(coreBudget_, weights);
+    size_t idx = 0;
+
+    for (auto &it : encoders_)
+    {
+        unsigned int nCores = cores[idx++];
+
+        if (it.second.nCores_ != nCores)
+        {
+            LogDebugC << "encoder " << it.second.description_ << " cores "
+                      << it.second.nCores_ << " -> " << nCores << std::endl;
+
+            it.second.nCores_ = nCores;
+            it.first->onCoresAllocated(nCores);
+        }
+    }
+}
@@ -0,0 +1,106 @@
+//
+// encoder-resource-manager.hpp
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#ifndef __encoder_resource_manager_h__
+#define __encoder_resource_manager_h__
+
+#include <map>
+#include <vector>
+#include <boost/thread/mutex.hpp>
+
+#include "params.hpp"
+#include "ndnrtc-object.hpp"
+
+namespace ndnrtc
+{
+class IEncoderResourceClient
+{
+  public:
+    // called when number of cores allocated for encoder has changed
+    virtual void onCoresAllocated(unsigned int nCores) = 0;
+    // average time spent in encoding one frame, in milliseconds
+    virtual double getEncodeTimeMs() const = 0;
+};
+
+/**
+ * Process-wide CPU core budget for video encoders.
+ * Every encoder registers with the manager and receives a share of the
+ * core budget proportional to its weight (see getWeight). Each encoder gets
+ * at least one core, remaining cores are distributed by weight. Shares are
+ * recomputed every time an encoder is added or removed or core budget is
+ * changed, so simulcast threads of all local streams never ask for more
+ * cores than available in total. Budget defaults to the number of hardware
+ * threads.
+ */
+class EncoderResourceManager : public NdnRtcComponent
+{
+  public:
+    typedef struct _EncoderInfo
+    {
+        std::string description_; // <width>x<height>@<bitrate>
+        double weight_;
+        unsigned int nCores_;
+        double encodeTimeMs_;
+    } EncoderInfo;
+
+    // reference encoder (720p30 at 2Mbps) has weight of 2
+    static const double ReferencePixelRate;
+    static const double ReferenceBitrateKbps;
+
+    static EncoderResourceManager *getSharedInstance();
+
+    /**
+     * Registers encoder. Other encoders are rebalanced.
+     * @return Number of cores allocated for this encoder
+     */
+    unsigned int addEncoder(IEncoderResourceClient *client,
+                            const VideoCoderParams &params);
+    void removeEncoder(IEncoderResourceClient *client);
+
+    void setCoreBudget(unsigned int nCores);
+    unsigned int getCoreBudget() const { return coreBudget_; }
+
+    unsigned int getCores(IEncoderResourceClient *client) const;
+    std::vector<EncoderInfo> getEncoders() const;
+
+    /**
+     * Encoder weight - amount of work encoder does per second. Pixel rate
+     * and bitrate are measured in different units, so each is taken as a
+     * fraction of the reference encoder's and the two fractions are added
+     * up with equal importance.
+     * @see ReferencePixelRate, ReferenceBitrateKbps
+     */
+    static double getWeight(const VideoCoderParams &params);
+    /**
+     * Splits nCores between encoders of given weights.
+     */
+    static std::vector<unsigned int> allocate(unsigned int nCores,
+                                              const std::vector<double> &weights);
+
+    ~EncoderResourceManager();
+
+  private:
+    EncoderResourceManager();
+    EncoderResourceManager(EncoderResourceManager const &) = delete;
+    void operator=(EncoderResourceManager const &) = delete;
+
+    typedef struct _Encoder
+    {
+        std::string description_;
+        double weight_;
+        unsigned int nCores_;
+    } Encoder;
+
+    mutable boost::mutex mutex_;
+    unsigned int coreBudget_;
+    std::map<IEncoderResourceClient *, Encoder> encoders_;
+
+    void rebalance();
+};
+}
+
+#endif
@@ -12,6 +12,7 @@
 
 #include <ndn-cpp/interest.hpp>
 #include <ndn-cpp/data.hpp>
+#include <boost/range/iterator_range.hpp>
 
 #include "fec.hpp"
 #include "clock.hpp"
@@ -19,6 +20,7 @@
 #include "name-components.hpp"
 #include "simple-log.hpp"
 #include "statistics.hpp"
+#include "frame-trace.hpp"
 
 using namespace std;
 using namespace ndnrtc;
@@ -26,13 +28,21 @@ using namespace ndnrtc::statistics;
 using namespace ndn;
 
 //******************************************************************************
-SlotSegment::SlotSegment(const boost::shared_ptr<const ndn::Interest>& i):
-interest_(i),
-requestTimeUsec_(clock::microsecondTimestamp()),
-arrivalTimeUsec_(0),
-requestNo_(1),
-isVerified_(false)
+SlotSegment::SlotSegment(const boost::shared_ptr<const ndn::Interest>& i)
 {
+    reset(i);
+}
+
+void
+SlotSegment::reset(const boost::shared_ptr<const ndn::Interest>& i)
+{
+    interest_ = i;
+    data_.reset();
+    requestTimeUsec_ = clock::microsecondTimestamp();
+    arrivalTimeUsec_ = 0;
+    requestNo_ = 1;
+    isVerified_ = false;
+
     if (!NameComponents::extractInfo(interest_->getName(), interestInfo_))
     {
         stringstream ss;
@@ -41,6 +51,13 @@ isVerified_(false)
     }
 }
 
+void
+SlotSegment::release()
+{
+    interest_.reset();
+    data_.reset();
+}
+
 const NamespaceInfo&
 SlotSegment::getInfo() const
 {
@@ -115,9 +132,9 @@ BufferSlot::segmentsRequested(const std::vector<boost::shared_ptr<const ndn::Int
     if (state_ == Ready || state_ == Locked) 
         throw std::runtime_error("Can't add more segments because slot is ready or locked");
 
-    for (auto i:interests)
+    for (auto& i:interests)
     {
-        boost::shared_ptr<SlotSegment> segment(boost::make_shared<SlotSegment>(i));
+        boost::shared_ptr<SlotSegment> segment(newSegment(i));
         
         if (!segment->getInfo().hasSeqNo_ || !segment->getInfo().hasSegNo_)
             throw std::runtime_error("No rightmost interests allowed: Interest should have segment-level info");
@@ -132,13 +149,16 @@ BufferSlot::segmentsRequested(const std::vector<boost::shared_ptr<const ndn::Int
             throw std::runtime_error("Interest names should differ only after sample sequence number");
 
         Name segmentKey = segment->getInfo().getSuffix(suffix_filter::Segment);
+        SegmentMap::iterator it = requested_.find(segmentKey);
         
-        if (requested_.find(segmentKey) != requested_.end())
+        if (it != requested_.end())
         {
             nRtx_++;
-            requested_[segmentKey]->incrementRequestNum();
+            it->second->incrementRequestNum();
+            segment->release();
+            spareSegments_.push_back(segment);
         }
-        else requested_[segmentKey] = segment;
+        else requested_.emplace(segmentKey, segment);
 
         if (state_ == Free) state_ = New;
     }
@@ -149,8 +169,16 @@ BufferSlot::clear()
 {
     name_.clear();
     nameInfo_ = NamespaceInfo();
-    requested_.clear();
+    lastFetched_.reset();
     fetched_.clear();
+    // keep segments nobody else holds for re-use
+    for (auto& it:requested_)
+        if (it.second.unique())
+        {
+            it.second->release();
+            spareSegments_.push_back(it.second);
+        }
+    requested_.clear();
     consistency_ = Inconsistent;
     requestTimeUsec_ = 0;
     assembledSize_ = 0;
@@ -186,14 +214,16 @@ BufferSlot::segmentReceived(const boost::shared_ptr<WireSegment>& segment)
         requested_.find(segmentKey) == requested_.end())
         throw std::runtime_error("Adding segment that was not previously requested");
     
-    if (fetched_.find(segmentKey) == fetched_.end())
+    SegmentMap::iterator it = fetched_.find(segmentKey);
+    if (it == fetched_.end())
     {
-        lastFetched_ = fetched_[segmentKey] = requested_[segmentKey];
-        fetched_[segmentKey]->setData(segment);
-        updateConsistencyState(fetched_[segmentKey]);
+        it = fetched_.emplace(segmentKey, requested_[segmentKey]).first;
+        lastFetched_ = it->second;
+        it->second->setData(segment);
+        updateConsistencyState(it->second);
     }
 
-    return fetched_[segmentKey];
+    return it->second;
 }
 
 std::vector<ndn::Name>
@@ -225,7 +255,7 @@ BufferSlot::getPendingInterests() const
 {
     std::vector<boost::shared_ptr<const ndn::Interest>> pendingInterests;
 
-    for (auto it:requested_)
+    for (auto& it:requested_)
         if (fetched_.find(it.first) == fetched_.end())
             pendingInterests.push_back(it.second->getInterest());
 
@@ -237,7 +267,7 @@ BufferSlot::getFetchedSegments() const
 {
     std::vector<boost::shared_ptr<const SlotSegment>> segments;
     
-    for (auto it:fetched_)
+    for (auto& it:fetched_)
         segments.push_back(it.second);
 
     return segments;
@@ -300,6 +330,20 @@ BufferSlot::getHeader() const
     return fetched_.at(nameInfo_.getSuffix(suffix_filter::Segment))->getData()->packetHeader();
 }
 
+boost::shared_ptr<SlotSegment>
+BufferSlot::newSegment(const boost::shared_ptr<const ndn::Interest>& interest)
+{
+    if (spareSegments_.size())
+    {
+        boost::shared_ptr<SlotSegment> segment = spareSegments_.back();
+        spareSegments_.pop_back();
+        segment->reset(interest);
+        return segment;
+    }
+
+    return boost::make_shared<SlotSegment>(interest);
+}
+
 void
 BufferSlot::updateConsistencyState(const boost::shared_ptr<SlotSegment>& segment)
 {
@@ -373,9 +417,9 @@ VideoFrameSlot::readPacket(const BufferSlot& slot, bool& recovered)
 
     // check if recovery is possible
     Name parityKey(NameComponents::NameComponentParity);
-    std::map<ndn::Name, boost::shared_ptr<SlotSegment>> 
+    boost::iterator_range<BufferSlot::SegmentMap::const_iterator>
         dataSegments(slot.fetched_.begin(), slot.fetched_.lower_bound(parityKey));
-    std::map<ndn::Name, boost::shared_ptr<SlotSegment>> 
+    boost::iterator_range<BufferSlot::SegmentMap::const_iterator>
         paritySegments(slot.fetched_.upper_bound(parityKey), slot.fetched_.end());
 
     if ((!paritySegments.size() && 
@@ -393,8 +437,11 @@ VideoFrameSlot::readPacket(const BufferSlot& slot, bool& recovered)
     if (paritySegments.size()) 
         firstParitySeg = boost::dynamic_pointer_cast<WireData<VideoFrameSegmentHeader>>(paritySegments.begin()->second->getData());
 
-    size_t segmentSize = firstSeg->segment().getPayload().size();
-    size_t paritySegSize = (paritySegments.size() ? firstParitySeg->segment().getPayload().size() : 0);
+    // all data segments but the last one have payload of FEC symbol length,
+    // which is also the payload length of every parity segment; without
+    // parity, all data segments must be present, so first one is full
+    size_t paritySegSize = (paritySegments.size() ? firstParitySeg->getPayload().size() : 0);
+    size_t segmentSize = (paritySegments.size() ? paritySegSize : firstSeg->getPayload().size());
     unsigned int nDataSegmentsExpected = firstSeg->getSlicesNum();
     unsigned int nParitySegmentsExpected = (paritySegments.size() ? paritySegments.begin()->second->getData()->getSlicesNum() : 0);
 
@@ -402,7 +449,7 @@ VideoFrameSlot::readPacket(const BufferSlot& slot, bool& recovered)
     storage_->resize(segmentSize*(nDataSegmentsExpected+nParitySegmentsExpected));
 
     int segNo = 0;
-    for (auto it:dataSegments)
+    for (auto& it:dataSegments)
     {
         const boost::shared_ptr<WireData<VideoFrameSegmentHeader>> wd = 
             boost::dynamic_pointer_cast<WireData<VideoFrameSegmentHeader>>(it.second->getData());
@@ -413,8 +460,8 @@ VideoFrameSlot::readPacket(const BufferSlot& slot, bool& recovered)
         if (segNo < nDataSegmentsExpected)
         {
             storage_->insert(storage_->begin()+segmentSize*segNo, 
-                wd->segment().getPayload().begin(),
-                wd->segment().getPayload().end());
+                wd->getPayload().begin(),
+                wd->getPayload().end());
             fecList_[segNo] = FEC_RLIST_SYMREADY;
             segNo++;
         }
@@ -424,7 +471,7 @@ VideoFrameSlot::readPacket(const BufferSlot& slot, bool& recovered)
     if (dataSegments.size() < nDataSegmentsExpected)
     {
         segNo = 0;
-        for (auto it:paritySegments)
+        for (auto& it:paritySegments)
         {
             const boost::shared_ptr<WireData<VideoFrameSegmentHeader>> wd =
             boost::dynamic_pointer_cast<WireData<VideoFrameSegmentHeader>>(it.second->getData());
@@ -435,8 +482,8 @@ VideoFrameSlot::readPacket(const BufferSlot& slot, bool& recovered)
             if (segNo < nParitySegmentsExpected)
             {
                 storage_->insert(storage_->begin()+nDataSegmentsExpected*segmentSize+paritySegSize*segNo, 
-                    wd->segment().getPayload().begin(),
-                    wd->segment().getPayload().end());            
+                    wd->getPayload().begin(),
+                    wd->getPayload().end());            
 
                 fecList_[nDataSegmentsExpected+segNo] = FEC_RLIST_SYMREADY;
                 segNo++;
@@ -467,7 +514,7 @@ VideoFrameSlot::readSegmentHeader(const BufferSlot& slot)
         throw std::runtime_error("Wrong slot supplied: can not read video "
             "packet from audio slot");
 
-    std::map<ndn::Name, boost::shared_ptr<SlotSegment>> 
+    boost::iterator_range<BufferSlot::SegmentMap::const_iterator>
         dataSegments(slot.fetched_.begin(), slot.fetched_.lower_bound(Name(NameComponents::NameComponentParity)));
 
     if (!dataSegments.size())
@@ -476,7 +523,7 @@ VideoFrameSlot::readSegmentHeader(const BufferSlot& slot)
     boost::shared_ptr<WireData<VideoFrameSegmentHeader>> seg = 
             boost::dynamic_pointer_cast<WireData<VideoFrameSegmentHeader>>(dataSegments.begin()->second->getData());
 
-    return seg->segment().getHeader();
+    return seg->getHeader();
 }
 
 //******************************************************************************
@@ -499,18 +546,18 @@ AudioBundleSlot::readBundle(const BufferSlot& slot)
 
     boost::shared_ptr<WireData<DataSegmentHeader>> firstSeg = 
             boost::dynamic_pointer_cast<WireData<DataSegmentHeader>>(slot.fetched_.begin()->second->getData());
-    size_t segmentSize = firstSeg->segment().getPayload().size();
+    size_t segmentSize = firstSeg->getPayload().size();
     unsigned int nDataSegmentsExpected = firstSeg->getSlicesNum();
 
     storage_->resize(segmentSize*nDataSegmentsExpected);
 
-    for (auto it:slot.fetched_)
+    for (auto& it:slot.fetched_)
     {
         const boost::shared_ptr<WireData<DataSegmentHeader>> wd = 
             boost::dynamic_pointer_cast<WireData<DataSegmentHeader>>(it.second->getData());
         storage_->insert(storage_->begin(), 
-                wd->segment().getPayload().begin(),
-                wd->segment().getPayload().end());
+                wd->getPayload().begin(),
+                wd->getPayload().end());
     }
 
     return boost::make_shared<ImmutableAudioBundlePacket>(storage_);
@@ -563,7 +610,7 @@ Buffer::reset()
 {   
     boost::lock_guard<boost::recursive_mutex> scopedLock(mutex_);
     
-    for (auto s:activeSlots_)
+    for (auto& s:activeSlots_)
         pool_->push(s.second);
     activeSlots_.clear();
  
@@ -578,7 +625,7 @@ bool
 Buffer::requested(const std::vector<boost::shared_ptr<const ndn::Interest>>& interests)
 {
     std::map<Name, std::vector<boost::shared_ptr<const Interest>>> slotInterests;
-    for (auto i:interests)
+    for (auto& i:interests)
     {
         NamespaceInfo nameInfo;
 
@@ -592,7 +639,7 @@ Buffer::requested(const std::vector<boost::shared_ptr<const ndn::Interest>>& int
         slotInterests[nameInfo.getPrefix(prefix_filter::Sample)].push_back(i);
     }
 
-    for (auto it:slotInterests)
+    for (auto& it:slotInterests)
     {
         bool newRequest = false;
         boost::lock_guard<boost::recursive_mutex> scopedLock(mutex_);
@@ -644,6 +691,8 @@ Buffer::received(const boost::shared_ptr<WireSegment>& segment)
     receipt.segment_ = activeSlots_[key]->segmentReceived(segment);
     receipt.slot_ = activeSlots_[key];
     receipt.oldState_ = oldState;
+    sstorage_->recordValue(HistogramIndicator::SegmentDrd, receipt.segment_->getDrdUsec());
+    FrameTraceInstant(SegmentReceived, receipt.segment_->getPlaybackNo());
     
     if (receipt.slot_->getState() == BufferSlot::Ready)
     {
@@ -652,6 +701,9 @@ Buffer::received(const boost::shared_ptr<WireSegment>& segment)
             LogTraceC << "►►►" << receipt.slot_->dump(true)
                 << " " << shortdump() << std::endl;
             
+            sstorage_->recordValue(HistogramIndicator::SlotAssembly, 
+                                   receipt.slot_->getAssemblingTime());
+            FrameTraceInstant(Assembled, receipt.segment_->getPlaybackNo());
             (*sstorage_)[Indicator::AssembledNum]++;
             if (receipt.slot_->getNameInfo().class_ == SampleClass::Key)
             {
@@ -695,13 +747,29 @@ Buffer::getSlotsNum(const ndn::Name& prefix, int stateMask) const
     boost::lock_guard<boost::recursive_mutex> scopedLock(mutex_);
     unsigned int nSlots = 0;
 
-    for (auto it:activeSlots_)
+    for (auto& it:activeSlots_)
         if (prefix.match(it.first) && it.second->getState()&stateMask)
             nSlots++;
 
     return nSlots;
 }
 
+bool
+Buffer::cancel(const ndn::Name& slotPrefix)
+{
+    boost::lock_guard<boost::recursive_mutex> scopedLock(mutex_);
+    std::map<Name, boost::shared_ptr<BufferSlot>>::iterator it = activeSlots_.find(slotPrefix);
+
+    if (it == activeSlots_.end() ||
+        it->second->getState() & (BufferSlot::Ready | BufferSlot::Locked))
+        return false;
+
+    LogDebugC << "cancel " << it->second->dump() << std::endl;
+    invalidate(slotPrefix);
+
+    return true;
+}
+
 void
 Buffer::attach(IBufferObserver* observer)
 {
@@ -921,6 +989,43 @@ PlaybackQueue::size() const
     return (--queue_.end())->timestamp() - queue_.begin()->timestamp() + samplePeriod();
 }
 
+int64_t
+PlaybackQueue::skipToKey(int64_t minSizeMs)
+{
+    boost::lock_guard<boost::recursive_mutex> scopedLock(mutex_);
+
+    if (queue_.size() < 2)
+        return 0;
+
+    int64_t endTimestamp = (--queue_.end())->timestamp() + samplePeriod();
+    std::set<Sample>::iterator key = queue_.end();
+
+    for (std::set<Sample>::iterator it = ++queue_.begin(); it != queue_.end(); ++it)
+        if (!it->slot()->getNameInfo().isDelta_ &&
+            endTimestamp - it->timestamp() >= minSizeMs)
+            key = it;
+
+    if (key == queue_.end())
+        return 0;
+
+    int64_t skippedMs = key->timestamp() - queue_.begin()->timestamp();
+    int nSkipped = 0;
+
+    for (std::set<Sample>::iterator it = queue_.begin(); it != key; ++nSkipped)
+    {
+        buffer_->releaseSlot(it->slot());
+        it = queue_.erase(it);
+    }
+
+    LogDebugC << "skipped " << nSkipped << " samples (" << skippedMs << "ms) to "
+              << key->slot()->dump() << std::endl;
+
+    (*sstorage_)[Indicator::CatchUpSkippedNum] += nSkipped;
+    (*sstorage_)[Indicator::BufferPlayableSize] = size();
+
+    return skippedMs;
+}
+
 int64_t
 PlaybackQueue::pendingSize() const
 {
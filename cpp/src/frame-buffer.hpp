@@ -13,6 +13,7 @@
 
 #include <boost/thread/mutex.hpp>
 #include <boost/thread.hpp>
+#include <boost/container/flat_map.hpp>
 #include <ndn-cpp/name.hpp>
 
 #include "name-components.hpp"
@@ -40,6 +41,17 @@ namespace ndnrtc
 
         SlotSegment(const boost::shared_ptr<const ndn::Interest>&);
 
+        /**
+         * Re-initializes segment with new Interest as if it has just been
+         * created. Used for recycling segments without reallocation.
+         */
+        void reset(const boost::shared_ptr<const ndn::Interest>&);
+
+        /**
+         * Releases Interest and received data held by this segment.
+         */
+        void release();
+
         const NamespaceInfo& getInfo() const;
         void setData(const boost::shared_ptr<WireSegment>& data);
         const boost::shared_ptr<WireSegment>& getData() const { return data_; }
@@ -143,7 +155,9 @@ namespace ndnrtc
         /**
          * Clears all internal structures of this slot and returns to Free state
          * as if slot has just been created. No memory deallocation/reallocation is
-         * performed, thus operation is not expensive.
+         * performed, thus operation is not expensive: slot segments which are
+         * not referenced outside of the slot are kept for re-use by the next
+         * sample assembled in this slot.
          */
         void
         clear();
@@ -207,7 +221,7 @@ namespace ndnrtc
          * @return CommonHeader structure
          * @see CommonSamplePacket
          */
-        const _CommonHeader getHeader() const;
+        const _CommonHeader &getHeader() const;
 
         std::string
         dump(bool showLastSegment = false) const;
@@ -219,9 +233,14 @@ namespace ndnrtc
         friend ManifestValidator;
         friend Buffer;
 
+        // flat maps keep their capacity when cleared, so slots recycled by
+        // SlotPool don't allocate map nodes for every segment
+        typedef boost::container::flat_map<ndn::Name, boost::shared_ptr<SlotSegment>> SegmentMap;
+
         ndn::Name name_;
         NamespaceInfo nameInfo_;
-        std::map<ndn::Name, boost::shared_ptr<SlotSegment>> requested_, fetched_;
+        SegmentMap requested_, fetched_;
+        std::vector<boost::shared_ptr<SlotSegment>> spareSegments_;
         boost::shared_ptr<SlotSegment> lastFetched_;
         unsigned int consistency_, nRtx_, assembledSize_;
         unsigned int nDataSegments_, nParitySegments_;
@@ -232,6 +251,7 @@ namespace ndnrtc
         mutable boost::shared_ptr<Manifest> manifest_;
         mutable Verification verified_;
 
+        boost::shared_ptr<SlotSegment> newSegment(const boost::shared_ptr<const ndn::Interest>& interest);
         virtual void updateConsistencyState(const boost::shared_ptr<SlotSegment>& segment);
         void updateAssembledLevel();
     };
@@ -323,6 +343,7 @@ namespace ndnrtc
         virtual BufferReceipt received(const boost::shared_ptr<WireSegment>&) = 0;
         virtual bool isRequested(const boost::shared_ptr<WireSegment>&) const = 0;
         virtual unsigned int getSlotsNum(const ndn::Name&, int) const = 0;
+        virtual bool cancel(const ndn::Name&) = 0;
         virtual std::string shortdump() const = 0;
         virtual void attach(IBufferObserver* observer) = 0;
         virtual void detach(IBufferObserver* observer) = 0;
@@ -341,6 +362,15 @@ namespace ndnrtc
         bool isRequested(const boost::shared_ptr<WireSegment>& segment) const;
         unsigned int getSlotsNum(const ndn::Name& prefix, int stateMask) const;
 
+        /**
+         * Cancels requested sample which has not been assembled yet. Segments
+         * of cancelled sample that arrive later are ignored.
+         * @param slotPrefix Sample prefix (without segment components)
+         * @return true if sample was cancelled, false if it was not requested
+         *          or was already assembled
+         */
+        bool cancel(const ndn::Name& slotPrefix);
+
         void attach(IBufferObserver* observer);
         void detach(IBufferObserver* observer);
         boost::shared_ptr<SlotPool> getPool() const { return pool_; }
@@ -389,6 +419,7 @@ namespace ndnrtc
         virtual int64_t pendingSize() const = 0;
         virtual double sampleRate() const = 0;
         virtual double samplePeriod() const = 0;
+        virtual int64_t skipToKey(int64_t minSizeMs) = 0;
         virtual void attach(IPlaybackQueueObserver*) = 0;
         virtual void detach(IPlaybackQueueObserver*) = 0;
     };
@@ -422,6 +453,14 @@ namespace ndnrtc
          */
         int64_t pendingSize() const;
 
+        /**
+         * Drops samples preceding the latest key frame which still leaves at 
+         * least minSizeMs of playable content in the queue.
+         * @return Duration in milliseconds of dropped content, 0 if nothing 
+         *         was dropped
+         */
+        int64_t skipToKey(int64_t minSizeMs);
+
         void attach(IPlaybackQueueObserver* observer);
         void detach(IPlaybackQueueObserver* observer);
 
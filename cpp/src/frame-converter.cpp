@@ -6,12 +6,24 @@
 //
 
 #include <webrtc/common_video/libyuv/include/webrtc_libyuv.h>
+#include <webrtc/common_video/include/video_frame_buffer.h>
 #include "frame-converter.hpp"
+#include "frame-trace.hpp"
 #include <stdexcept>
 
 using namespace ndnrtc;
 using namespace webrtc;
 #include <iostream>
+
+namespace {
+	void copyPlane(const uint8_t* src, int srcStride, uint8_t* dst, int dstStride,
+		int width, int height)
+	{
+		for (int row = 0; row < height; ++row)
+			memcpy(dst + row*dstStride, src + row*srcStride, width);
+	}
+}
+
 WebRtcVideoFrame RawFrameConverter::operator<<(const struct _8bitFixedSizeRawFrameWrapper& wr)
 {
     // NOTE: after many hours debugging and reading bytes, it is still uknown 
@@ -27,16 +39,12 @@ WebRtcVideoFrame RawFrameConverter::operator<<(const struct _8bitFixedSizeRawFra
 
 WebRtcVideoFrame RawFrameConverter::convert(const ArgbRawFrameWrapper& wr, const VideoType& commonVideoType)
 {             
-	// make conversion to I420
-
-	int stride_y = wr.width_;
-	int stride_uv = (wr.width_ + 1) / 2;
-	int target_width = wr.width_;
-	int target_height = wr.height_;
+	FrameTraceStep(Capture);
 
-	frameBuffer_ = I420Buffer::Create(wr.width_, wr.height_, stride_y, stride_uv, stride_uv);
+	// make conversion to I420
+	WebRtcSmartPtr<WebRtcVideoFrameBuffer> buffer = pool_.CreateBuffer(wr.width_, wr.height_);
 
-	if (!frameBuffer_)
+	if (!buffer)
 		throw std::runtime_error("Failed to allocate I420 frame");
 
 	const int conversionResult = ConvertToI420(commonVideoType,
@@ -45,40 +53,41 @@ WebRtcVideoFrame RawFrameConverter::convert(const ArgbRawFrameWrapper& wr, const
                                                wr.width_, wr.height_,
                                                wr.frameSize_,
                                                kVideoRotation_0,
-                                               frameBuffer_.get());
+                                               buffer.get());
 	if (conversionResult < 0)
 		throw std::runtime_error("Failed to convert capture frame to I420");
 
+	frameBuffer_ = buffer;
 	return WebRtcVideoFrame(frameBuffer_, webrtc::kVideoRotation_0, 0);
 }
 
 WebRtcVideoFrame RawFrameConverter::operator<<(const I420RawFrameWrapper& wr)
 {
-	frameBuffer_ = I420Buffer::Create(wr.width_, wr.height_, wr.strideY_, wr.strideU_, wr.strideV_);
+	FrameTraceStep(Capture);
+
+	WebRtcSmartPtr<WebRtcVideoFrameBuffer> buffer = pool_.CreateBuffer(wr.width_, wr.height_);
+
+	if (!buffer)
+		throw std::runtime_error("Failed to allocate I420 frame");
 
-	unsigned int ySize = wr.strideY_*wr.height_;
-	unsigned int uSize = wr.strideU_*(wr.height_+1)/2;
-	unsigned int vSize = wr.strideV_*(wr.height_+1)/2;
-	memcpy(frameBuffer_->MutableDataY(), wr.yBuffer_, ySize);
-	memcpy(frameBuffer_->MutableDataU(), wr.uBuffer_, uSize);
-	memcpy(frameBuffer_->MutableDataV(), wr.vBuffer_, vSize);
+	int chromaWidth = (wr.width_+1)/2, chromaHeight = (wr.height_+1)/2;
+	copyPlane(wr.yBuffer_, wr.strideY_, buffer->MutableDataY(), buffer->StrideY(), wr.width_, wr.height_);
+	copyPlane(wr.uBuffer_, wr.strideU_, buffer->MutableDataU(), buffer->StrideU(), chromaWidth, chromaHeight);
+	copyPlane(wr.vBuffer_, wr.strideV_, buffer->MutableDataV(), buffer->StrideV(), chromaWidth, chromaHeight);
 
+	frameBuffer_ = buffer;
 	return WebRtcVideoFrame(frameBuffer_, webrtc::kVideoRotation_0, 0);
 }
 
 WebRtcVideoFrame RawFrameConverter::operator<<(const YUV_NV21FrameWrapper& wr)
 {             
+	FrameTraceStep(Capture);
+
 	// make conversion to I420
 	const VideoType commonVideoType = RawVideoTypeToCommonVideoVideoType(kVideoNV21);
+	WebRtcSmartPtr<WebRtcVideoFrameBuffer> buffer = pool_.CreateBuffer(wr.width_, wr.height_);
 
-	int stride_y = wr.width_;
-	int stride_uv = (wr.width_ + 1) / 2;
-	int target_width = wr.width_;
-	int target_height = wr.height_;
-
-	frameBuffer_ = I420Buffer::Create(wr.width_, wr.height_, stride_y, stride_uv, stride_uv);
-
-	if (!frameBuffer_)
+	if (!buffer)
 		throw std::runtime_error("Failed to allocate I420 frame");
 
 	const int conversionResult = ConvertToI420(commonVideoType,
@@ -87,9 +96,25 @@ WebRtcVideoFrame RawFrameConverter::operator<<(const YUV_NV21FrameWrapper& wr)
                                                wr.width_, wr.height_,
                                                wr.strideY_+wr.strideUV_,
                                                kVideoRotation_0,
-                                               frameBuffer_.get());
+                                               buffer.get());
 	if (conversionResult < 0)
 		throw std::runtime_error("Failed to convert capture frame to I420");
 
+	frameBuffer_ = buffer;
 	return WebRtcVideoFrame(frameBuffer_, webrtc::kVideoRotation_0, 0);
 }
+
+WebRtcVideoFrame RawFrameConverter::wrap(const I420RawFrameWrapper& wr,
+	const boost::function<void()>& onReleased)
+{
+	FrameTraceStep(Capture);
+
+	// planes are referenced directly, callback fires when the last frame
+	// holding this buffer (i.e. encoder's input frame) is destroyed
+	rtc::scoped_refptr<VideoFrameBuffer> buffer(
+		new rtc::RefCountedObject<WrappedI420Buffer>(wr.width_, wr.height_,
+			wr.yBuffer_, wr.strideY_, wr.uBuffer_, wr.strideU_, wr.vBuffer_, wr.strideV_,
+			rtc::Callback0<void>(onReleased)));
+
+	return WebRtcVideoFrame(buffer, webrtc::kVideoRotation_0, 0);
+}
@@ -5,6 +5,9 @@
 //  Copyright 2013-2016 Regents of the University of California
 //
 
+#include <boost/function.hpp>
+#include <webrtc/common_video/include/i420_buffer_pool.h>
+
 #include "webrtc.hpp"
 
 namespace ndnrtc {
@@ -43,6 +46,9 @@ namespace ndnrtc {
 	 * FrameConverter converts wrappers of raw video frames into a
 	 * WebRTC raw video frame object. Converted object is stored inside the
 	 * converter and is valid as long as converter lives.
+	 * Converted frames are allocated from a buffer pool: buffer is re-used
+	 * once all frames referencing it are released. Pool is not thread-safe,
+	 * converter must be used on one (capture) thread.
 	 */
 	class RawFrameConverter 
 	{
@@ -54,7 +60,17 @@ namespace ndnrtc {
 		WebRtcVideoFrame operator<<(const I420RawFrameWrapper&);
 		WebRtcVideoFrame operator<<(const YUV_NV21FrameWrapper&);
 
+		/**
+		 * Wraps I420 planes into a frame without copying. Planes must stay
+		 * valid until onReleased is called, which happens once the last
+		 * reference to the frame is released (possibly, on another thread).
+		 * Wrapped frame is not stored inside the converter.
+		 */
+		WebRtcVideoFrame wrap(const I420RawFrameWrapper&,
+			const boost::function<void()>& onReleased);
+
 	private:
+		webrtc::I420BufferPool pool_;
 		WebRtcSmartPtr<WebRtcVideoFrameBuffer> frameBuffer_;
 
         WebRtcVideoFrame convert(const struct _8bitFixedSizeRawFrameWrapper&, 
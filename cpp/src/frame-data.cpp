@@ -15,6 +15,7 @@
 
 #include "ndnrtc-common.hpp"
 #include "frame-data.hpp"
+#include "object-pool.hpp"
 
 using namespace std;
 using namespace webrtc;
@@ -53,14 +54,23 @@ AudioBundlePacket::merge(const std::vector<ImmutableHeaderPacket<DataSegmentHead
 boost::shared_ptr<WireSegment>
 WireSegment::createSegment(const NamespaceInfo &namespaceInfo,
                            const boost::shared_ptr<ndn::Data> &data,
-                           const boost::shared_ptr<const ndn::Interest> &interest)
+                           const boost::shared_ptr<const ndn::Interest> &interest,
+                           const boost::shared_ptr<ObjectPool> &pool)
 {
-    if (namespaceInfo.streamType_ == MediaStreamParams::MediaStreamType::MediaStreamTypeVideo &&
-        (namespaceInfo.segmentClass_ == SegmentClass::Data || namespaceInfo.segmentClass_ == SegmentClass::Parity))
+    bool isVideoSegment = namespaceInfo.streamType_ == MediaStreamParams::MediaStreamType::MediaStreamTypeVideo &&
+                          (namespaceInfo.segmentClass_ == SegmentClass::Data || namespaceInfo.segmentClass_ == SegmentClass::Parity);
+
+    if (pool)
+    {
+        if (isVideoSegment)
+            return pool->make<WireData<VideoFrameSegmentHeader>>(namespaceInfo, data, interest);
+        return pool->make<WireData<DataSegmentHeader>>(namespaceInfo, data, interest);
+    }
+
+    if (isVideoSegment)
         return boost::make_shared<WireData<VideoFrameSegmentHeader>>(namespaceInfo, data, interest);
 
     return boost::make_shared<WireData<DataSegmentHeader>>(namespaceInfo, data, interest);
-    ;
 }
 
 }
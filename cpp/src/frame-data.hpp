@@ -57,7 +57,7 @@ class DataSegment : protected DataPacket::Blob
     void setHeader(const DataSegmentHeader &header) { header_ = reinterpret_cast<const Header &>(header); }
     const Header &getHeader() const { return header_; }
     const DataPacket::Blob &getPayload() const { return *this; }
-    size_t size() const { return DataSegment<Header>::wireLength(Blob::size()); }
+    size_t size() const { return DataPacket::wireLength(Blob::size(), HeaderTraits<Header>::wireSize(header_)); }
 
     /**
      * Creates new NetworkData object which has data copied using begin 
@@ -71,6 +71,39 @@ class DataSegment : protected DataPacket::Blob
         return sp;
     }
 
+    /**
+     * Creates new NetworkData object in given wire format. For V2 format,
+     * prefix, segment header and payload are copied into a single 
+     * pre-allocated buffer. Packet header, if provided, is stored after
+     * segment header (V2 only; V1 segment 0 has packet header in payload).
+     * Segments must be sliced with packetHeaderReserve() bytes reserved
+     * so that segment 0 doesn't exceed segment wire length.
+     * @see WireFormat
+     * @see slice()
+     */
+    const boost::shared_ptr<NetworkData> getNetworkData(WireFormat format,
+                                                        const CommonHeader *packetHeader = nullptr) const
+    {
+        if (format != WireFormat::V2)
+            return getNetworkData();
+
+        SegmentPrefixV2 prefix;
+        prefix.format_ = (uint8_t)WireFormat::V2;
+        prefix.flags_ = (packetHeader ? SegmentFlagPacketHeader : 0);
+        prefix.headerSize_ = HeaderTraits<Header>::wireSize(header_);
+
+        std::vector<uint8_t> data;
+        data.reserve(size() + (packetHeader ? sizeof(CommonHeader) : 0));
+        data.insert(data.end(), (const uint8_t *)&prefix, (const uint8_t *)&prefix + sizeof(prefix));
+        data.insert(data.end(), (const uint8_t *)&header_, (const uint8_t *)&header_ + prefix.headerSize_);
+        if (packetHeader)
+            data.insert(data.end(), (const uint8_t *)packetHeader,
+                        (const uint8_t *)packetHeader + sizeof(CommonHeader));
+        data.insert(data.end(), begin_, end_);
+
+        return boost::make_shared<NetworkData>(data);
+    }
+
     /**
      * This calculates total wire length for a segment with given payload 
      * length
@@ -89,18 +122,53 @@ class DataSegment : protected DataPacket::Blob
         return (payloadLength < 0) ? 0 : payloadLength;
     }
 
-    static size_t numSlices(const NetworkData &nd,
-                            size_t segmentWireLength)
+    /**
+     * Number of bytes every segment must reserve for the copy of packet
+     * header in given wire format. Only segment 0 carries the header, but
+     * all segments reserve it so that data segments have equal payload
+     * length, which is also the FEC symbol length.
+     */
+    static size_t packetHeaderReserve(WireFormat format)
+    {
+        return (format == WireFormat::V2 ? sizeof(CommonHeader) : 0);
+    }
+
+    /**
+     * Maximum payload length of segments sliced for given wire length with
+     * given header reserve
+     * @see packetHeaderReserve()
+     */
+    static size_t slicePayloadLength(size_t segmentWireLength, size_t headerReserve = 0)
     {
         size_t payloadLength = DataSegment<Header>::payloadLength(segmentWireLength);
+        return (payloadLength <= headerReserve ? 0 : payloadLength - headerReserve);
+    }
+
+    /**
+     * Number of segments for given data. Payload of every segment is shorter
+     * by headerReserve bytes.
+     * @see packetHeaderReserve()
+     */
+    static size_t numSlices(const NetworkData &nd,
+                            size_t segmentWireLength,
+                            size_t headerReserve = 0)
+    {
+        size_t payloadLength = slicePayloadLength(segmentWireLength, headerReserve);
+
+        if (payloadLength == 0)
+            return 0;
+        if (nd.getLength() <= payloadLength)
+            return 1;
+
         return (nd.getLength() / payloadLength) + (nd.getLength() % payloadLength ? 1 : 0);
     }
 
     static std::vector<DataSegment<Header>> slice(const NetworkData &nd,
-                                                  size_t segmentWireLength)
+                                                  size_t segmentWireLength,
+                                                  size_t headerReserve = 0)
     {
         std::vector<DataSegment<Header>> segments;
-        size_t payloadLength = DataSegment<Header>::payloadLength(segmentWireLength);
+        size_t payloadLength = slicePayloadLength(segmentWireLength, headerReserve);
 
         if (payloadLength == 0)
             return segments;
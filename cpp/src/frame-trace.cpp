@@ -0,0 +1,300 @@
+//
+//  frame-trace.cpp
+//  libndnrtc
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#include "frame-trace.hpp"
+
+#include <unistd.h>
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <boost/make_shared.hpp>
+#include <boost/thread/lock_guard.hpp>
+#include <boost/chrono.hpp>
+
+using namespace ndnrtc::trace;
+
+namespace {
+    typedef struct _ThreadEvent {
+        TraceEvent event_;
+        unsigned int threadIdx_;
+
+        bool operator<(const _ThreadEvent& other) const
+        { return event_.timestampUsec_ < other.event_.timestampUsec_; }
+    } ThreadEvent;
+
+    bool isProducerStage(Stage stage)
+    {
+        return stage <= Stage::InterestArrival;
+    }
+}
+
+//******************************************************************************
+TraceRing::TraceRing(size_t capacity, unsigned int threadIdx):
+events_(capacity), head_(0), tail_(0), writing_(0), threadIdx_(threadIdx)
+{
+}
+
+void
+TraceRing::push(const TraceEvent& event)
+{
+    uint64_t head = head_.load(boost::memory_order_relaxed);
+    writing_.store(head+1, boost::memory_order_relaxed);
+    boost::atomic_thread_fence(boost::memory_order_release);
+    events_[head % events_.size()] = event;
+    head_.store(head+1, boost::memory_order_release);
+}
+
+std::vector<TraceEvent>
+TraceRing::snapshot() const
+{
+    uint64_t head = head_.load(boost::memory_order_acquire);
+    uint64_t first = std::max(tail_.load(boost::memory_order_acquire),
+                              (head > events_.size() ? head - events_.size() : 0));
+    std::vector<TraceEvent> events;
+
+    if (first >= head)
+        return events;
+
+    events.reserve(head-first);
+    for (uint64_t i = first; i < head; ++i)
+        events.push_back(events_[i % events_.size()]);
+
+    // writer may have wrapped around while we were copying: event i is
+    // intact only if its slot has not been (or is not being) reused
+    boost::atomic_thread_fence(boost::memory_order_acquire);
+    uint64_t writing = writing_.load(boost::memory_order_relaxed);
+
+    if (writing > first + events_.size())
+    {
+        uint64_t nStale = std::min<uint64_t>(writing - events_.size() - first, events.size());
+        events.erase(events.begin(), events.begin() + nStale);
+    }
+
+    return events;
+}
+
+//******************************************************************************
+FrameTracer&
+FrameTracer::getSharedInstance()
+{
+    static FrameTracer tracer;
+    return tracer;
+}
+
+FrameTracer::FrameTracer():
+enabled_(false), eventsPerThread_(1<<16)
+{
+}
+
+void
+FrameTracer::enable(size_t eventsPerThread)
+{
+    boost::lock_guard<boost::mutex> scopedLock(mutex_);
+    eventsPerThread_ = eventsPerThread;
+    enabled_ = true;
+}
+
+void
+FrameTracer::clear()
+{
+    boost::lock_guard<boost::mutex> scopedLock(mutex_);
+    for (auto& r:rings_) r->clear();
+}
+
+void
+FrameTracer::complete(Stage stage, int64_t flowId, int64_t startUsec, int64_t durationUsec)
+{
+    if (!enabled_) return;
+
+    ThreadContext* ctx = getContext();
+    TraceEvent e({startUsec, durationUsec, (flowId < 0 ? ctx->flowId_ : flowId), stage});
+    ctx->ring_->push(e);
+}
+
+void
+FrameTracer::instant(Stage stage, int64_t flowId, int64_t timestampUsec)
+{
+    if (!enabled_) return;
+
+    ThreadContext* ctx = getContext();
+    TraceEvent e({timestampUsec, -1, (flowId < 0 ? ctx->flowId_ : flowId), stage});
+    ctx->ring_->push(e);
+}
+
+void
+FrameTracer::writeChromeTrace(std::ostream& os) const
+{
+    std::vector<ThreadEvent> events;
+    {
+        boost::lock_guard<boost::mutex> scopedLock(mutex_);
+        for (auto& r:rings_)
+            for (auto& e:r->snapshot())
+                events.push_back(ThreadEvent({e, r->getThreadIdx()}));
+    }
+
+    std::stable_sort(events.begin(), events.end());
+
+    // find first and last event of each flow to mark flow start/finish
+    std::map<int64_t, std::pair<size_t, size_t>> flows;
+    for (size_t i = 0; i < events.size(); ++i)
+    {
+        if (events[i].event_.flowId_ < 0) continue;
+
+        std::map<int64_t, std::pair<size_t, size_t>>::iterator it = flows.find(events[i].event_.flowId_);
+        if (it == flows.end())
+            flows[events[i].event_.flowId_] = std::make_pair(i, i);
+        else
+            it->second.second = i;
+    }
+
+    int pid = (int)getpid();
+    bool first = true;
+
+    os << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    for (size_t i = 0; i < events.size(); ++i)
+    {
+        const TraceEvent& e = events[i].event_;
+        const char* cat = (isProducerStage(e.stage_) ? "producer" : "consumer");
+
+        if (!first) os << ",";
+        first = false;
+
+        os << "\n{\"name\":\"" << stageName(e.stage_) << "\""
+           << ",\"cat\":\"" << cat << "\""
+           << ",\"ph\":\"" << (e.durationUsec_ < 0 ? "i" : "X") << "\""
+           << ",\"ts\":" << e.timestampUsec_;
+        if (e.durationUsec_ >= 0)
+            os << ",\"dur\":" << e.durationUsec_;
+        else
+            os << ",\"s\":\"t\"";
+        os << ",\"pid\":" << pid
+           << ",\"tid\":" << events[i].threadIdx_
+           << ",\"args\":{\"frame\":" << e.flowId_ << "}}";
+
+        if (e.flowId_ >= 0)
+        {
+            std::pair<size_t, size_t> bounds = flows[e.flowId_];
+            if (bounds.first == bounds.second) continue;
+
+            const char* ph = (i == bounds.first ? "s" : (i == bounds.second ? "f" : "t"));
+            os << ",\n{\"name\":\"frame\",\"cat\":\"frame\",\"ph\":\"" << ph << "\""
+               << ",\"id\":" << e.flowId_
+               << ",\"ts\":" << e.timestampUsec_
+               << ",\"pid\":" << pid
+               << ",\"tid\":" << events[i].threadIdx_;
+            if (i != bounds.first) os << ",\"bp\":\"e\"";
+            os << "}";
+        }
+    }
+    os << "\n]}" << std::endl;
+}
+
+bool
+FrameTracer::writeChromeTrace(const std::string& fileName) const
+{
+    std::ofstream f(fileName.c_str(), std::ofstream::out);
+    if (!f.is_open()) return false;
+
+    writeChromeTrace(f);
+    return f.good();
+}
+
+int64_t
+FrameTracer::getCurrentFlow() const
+{
+    ThreadContext* ctx = context_.get();
+    return (ctx ? ctx->flowId_ : -1);
+}
+
+void
+FrameTracer::setCurrentFlow(int64_t flowId)
+{
+    getContext()->flowId_ = flowId;
+}
+
+int64_t
+FrameTracer::now()
+{
+    return boost::chrono::duration_cast<boost::chrono::microseconds>(
+        boost::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+const char*
+FrameTracer::stageName(Stage stage)
+{
+    switch (stage)
+    {
+        case Stage::Capture: return "capture";
+        case Stage::Scale: return "scale";
+        case Stage::Encode: return "encode";
+        case Stage::Fec: return "fec";
+        case Stage::Sign: return "sign";
+        case Stage::Cache: return "cache";
+        case Stage::InterestArrival: return "interest";
+        case Stage::SegmentReceived: return "segment";
+        case Stage::Assembled: return "assembled";
+        case Stage::Verified: return "verified";
+        case Stage::Decode: return "decode";
+        case Stage::Render: return "render";
+        default: return "unknown";
+    }
+}
+
+#pragma mark - private
+FrameTracer::ThreadContext*
+FrameTracer::getContext()
+{
+    ThreadContext* ctx = context_.get();
+
+    if (!ctx)
+    {
+        ctx = new ThreadContext();
+        ctx->flowId_ = -1;
+        {
+            boost::lock_guard<boost::mutex> scopedLock(mutex_);
+            ctx->ring_ = boost::make_shared<TraceRing>(eventsPerThread_, rings_.size());
+            rings_.push_back(ctx->ring_);
+        }
+        context_.reset(ctx);
+    }
+
+    return ctx;
+}
+
+//******************************************************************************
+TraceScope::TraceScope(Stage stage, int64_t flowId):
+stage_(stage), flowId_(flowId),
+startUsec_(FrameTracer::getSharedInstance().isEnabled() ? FrameTracer::now() : 0)
+{
+}
+
+TraceScope::TraceScope(Stage stage):
+TraceScope(stage, FrameTracer::getSharedInstance().getCurrentFlow())
+{
+}
+
+TraceScope::~TraceScope()
+{
+    if (startUsec_)
+        FrameTracer::getSharedInstance().complete(stage_, flowId_, startUsec_,
+                                                  FrameTracer::now() - startUsec_);
+}
+
+//******************************************************************************
+FlowScope::FlowScope(int64_t flowId):
+prevFlowId_(FrameTracer::getSharedInstance().getCurrentFlow())
+{
+    if (FrameTracer::getSharedInstance().isEnabled())
+        FrameTracer::getSharedInstance().setCurrentFlow(flowId);
+}
+
+FlowScope::~FlowScope()
+{
+    if (FrameTracer::getSharedInstance().isEnabled())
+        FrameTracer::getSharedInstance().setCurrentFlow(prevFlowId_);
+}
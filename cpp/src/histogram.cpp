@@ -0,0 +1,272 @@
+//
+//  histogram.cpp
+//  libndnrtc
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#include "histogram.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+using namespace ndnrtc::statistics;
+
+namespace {
+    inline int leadingZeros(int64_t value)
+    {
+        return __builtin_clzll((uint64_t)value);
+    }
+
+    inline void updateMin(std::atomic<int64_t>& min, int64_t value)
+    {
+        int64_t current = min.load(std::memory_order_relaxed);
+        while (value < current &&
+               !min.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+    }
+
+    inline void updateMax(std::atomic<int64_t>& max, int64_t value)
+    {
+        int64_t current = max.load(std::memory_order_relaxed);
+        while (value > current &&
+               !max.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+    }
+}
+
+Histogram::Histogram(int64_t lowestTrackableValue, int64_t highestTrackableValue,
+                     unsigned int significantDigits):
+lowest_(lowestTrackableValue), highest_(highestTrackableValue),
+significantDigits_(significantDigits),
+totalCount_(0), sum_(0),
+min_(std::numeric_limits<int64_t>::max()), max_(0)
+{
+    if (lowest_ < 1)
+        throw std::invalid_argument("Histogram lowest trackable value must be >= 1");
+    if (highest_ < 2*lowest_)
+        throw std::invalid_argument("Histogram highest trackable value must be >= 2*lowest");
+    if (significantDigits_ < 1 || significantDigits_ > 5)
+        throw std::invalid_argument("Histogram significant digits must be in range [1, 5]");
+
+    setup();
+}
+
+Histogram::Histogram(const Histogram& histogram):
+lowest_(histogram.lowest_), highest_(histogram.highest_),
+significantDigits_(histogram.significantDigits_),
+totalCount_(0), sum_(0),
+min_(std::numeric_limits<int64_t>::max()), max_(0)
+{
+    setup();
+    copyCounts(histogram);
+}
+
+Histogram&
+Histogram::operator=(const Histogram& histogram)
+{
+    if (this != &histogram)
+    {
+        lowest_ = histogram.lowest_;
+        highest_ = histogram.highest_;
+        significantDigits_ = histogram.significantDigits_;
+        setup();
+        copyCounts(histogram);
+    }
+    return *this;
+}
+
+void
+Histogram::recordValues(int64_t value, uint64_t count)
+{
+    if (value < 0) value = 0;
+    if (value > highest_) value = highest_;
+
+    int32_t idx = countsIndexFor(value);
+    counts_[idx].fetch_add(count, std::memory_order_relaxed);
+    totalCount_.fetch_add(count, std::memory_order_relaxed);
+    sum_.fetch_add(value*(int64_t)count, std::memory_order_relaxed);
+    updateMin(min_, value);
+    updateMax(max_, value);
+}
+
+void
+Histogram::add(const Histogram& other)
+{
+    if (isCompatible(other))
+    {
+        for (int32_t i = 0; i < countsLen_; ++i)
+        {
+            uint64_t c = other.counts_[i].load(std::memory_order_relaxed);
+            if (c) counts_[i].fetch_add(c, std::memory_order_relaxed);
+        }
+
+        uint64_t total = other.getTotalCount();
+        if (total)
+        {
+            totalCount_.fetch_add(total, std::memory_order_relaxed);
+            sum_.fetch_add(other.sum_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            updateMin(min_, other.min_.load(std::memory_order_relaxed));
+            updateMax(max_, other.max_.load(std::memory_order_relaxed));
+        }
+    }
+    else
+        for (int32_t i = 0; i < other.countsLen_; ++i)
+        {
+            uint64_t c = other.counts_[i].load(std::memory_order_relaxed);
+            if (c) recordValues(other.valueFromIndex(i), c);
+        }
+}
+
+void
+Histogram::reset()
+{
+    for (int32_t i = 0; i < countsLen_; ++i)
+        counts_[i].store(0, std::memory_order_relaxed);
+    totalCount_ = 0;
+    sum_ = 0;
+    min_ = std::numeric_limits<int64_t>::max();
+    max_ = 0;
+}
+
+int64_t
+Histogram::getMin() const
+{
+    return (getTotalCount() ? min_.load(std::memory_order_relaxed) : 0);
+}
+
+int64_t
+Histogram::getMax() const
+{
+    return (getTotalCount() ? max_.load(std::memory_order_relaxed) : 0);
+}
+
+double
+Histogram::getMean() const
+{
+    uint64_t total = getTotalCount();
+    return (total ? (double)sum_.load(std::memory_order_relaxed)/(double)total : 0.);
+}
+
+int64_t
+Histogram::getValueAtPercentile(double percentile) const
+{
+    uint64_t total = getTotalCount();
+    if (!total) return 0;
+
+    if (percentile < 0.) percentile = 0.;
+    if (percentile > 100.) percentile = 100.;
+
+    uint64_t countAtPercentile = (uint64_t)((percentile/100.)*(double)total + 0.5);
+    if (countAtPercentile < 1) countAtPercentile = 1;
+
+    uint64_t cumulative = 0;
+    for (int32_t i = 0; i < countsLen_; ++i)
+    {
+        cumulative += counts_[i].load(std::memory_order_relaxed);
+        if (cumulative >= countAtPercentile)
+        {
+            int64_t v = highestEquivalentValue(valueFromIndex(i));
+            return std::min(v, getMax());
+        }
+    }
+
+    return getMax();
+}
+
+#pragma mark - private
+void
+Histogram::setup()
+{
+    int64_t largestValueWithSingleUnitResolution = 2*(int64_t)std::pow(10, significantDigits_);
+    int subBucketCountMagnitude = (int)std::ceil(std::log2((double)largestValueWithSingleUnitResolution));
+
+    subBucketHalfCountMagnitude_ = (subBucketCountMagnitude > 1 ? subBucketCountMagnitude : 1) - 1;
+    unitMagnitude_ = (int)std::floor(std::log2((double)lowest_));
+    subBucketCount_ = (int32_t)1 << (subBucketHalfCountMagnitude_ + 1);
+    subBucketHalfCount_ = subBucketCount_/2;
+    subBucketMask_ = ((int64_t)subBucketCount_ - 1) << unitMagnitude_;
+
+    int64_t smallestUntrackableValue = ((int64_t)subBucketCount_) << unitMagnitude_;
+    int32_t bucketsNeeded = 1;
+    while (smallestUntrackableValue <= highest_)
+    {
+        if (smallestUntrackableValue > std::numeric_limits<int64_t>::max()/2)
+        {
+            bucketsNeeded++;
+            break;
+        }
+        smallestUntrackableValue <<= 1;
+        bucketsNeeded++;
+    }
+
+    bucketCount_ = bucketsNeeded;
+    countsLen_ = (bucketCount_ + 1)*subBucketHalfCount_;
+    counts_.reset(new std::atomic<uint64_t>[countsLen_]);
+    reset();
+}
+
+void
+Histogram::copyCounts(const Histogram& histogram)
+{
+    for (int32_t i = 0; i < countsLen_; ++i)
+        counts_[i].store(histogram.counts_[i].load(std::memory_order_relaxed),
+                         std::memory_order_relaxed);
+    totalCount_ = histogram.totalCount_.load(std::memory_order_relaxed);
+    sum_ = histogram.sum_.load(std::memory_order_relaxed);
+    min_ = histogram.min_.load(std::memory_order_relaxed);
+    max_ = histogram.max_.load(std::memory_order_relaxed);
+}
+
+bool
+Histogram::isCompatible(const Histogram& histogram) const
+{
+    return lowest_ == histogram.lowest_ &&
+           highest_ == histogram.highest_ &&
+           significantDigits_ == histogram.significantDigits_;
+}
+
+int32_t
+Histogram::bucketIndexFor(int64_t value) const
+{
+    int32_t pow2Ceiling = 64 - leadingZeros(value | subBucketMask_);
+    return pow2Ceiling - unitMagnitude_ - (subBucketHalfCountMagnitude_ + 1);
+}
+
+int32_t
+Histogram::countsIndexFor(int64_t value) const
+{
+    int32_t bucketIdx = bucketIndexFor(value);
+    int32_t subBucketIdx = (int32_t)(value >> (bucketIdx + unitMagnitude_));
+    int32_t bucketBaseIdx = (bucketIdx + 1) << subBucketHalfCountMagnitude_;
+
+    return bucketBaseIdx + (subBucketIdx - subBucketHalfCount_);
+}
+
+int64_t
+Histogram::valueFromIndex(int32_t index) const
+{
+    int32_t bucketIdx = (index >> subBucketHalfCountMagnitude_) - 1;
+    int32_t subBucketIdx = (index & (subBucketHalfCount_ - 1)) + subBucketHalfCount_;
+
+    if (bucketIdx < 0)
+    {
+        subBucketIdx -= subBucketHalfCount_;
+        bucketIdx = 0;
+    }
+
+    return ((int64_t)subBucketIdx) << (bucketIdx + unitMagnitude_);
+}
+
+int64_t
+Histogram::highestEquivalentValue(int64_t value) const
+{
+    int32_t bucketIdx = bucketIndexFor(value);
+    int32_t subBucketIdx = (int32_t)(value >> (bucketIdx + unitMagnitude_));
+    int32_t adjustedBucket = (subBucketIdx >= subBucketCount_ ? bucketIdx + 1 : bucketIdx);
+    int64_t rangeSize = (int64_t)1 << (unitMagnitude_ + adjustedBucket);
+    int64_t lowestEquivalent = ((int64_t)subBucketIdx) << (bucketIdx + unitMagnitude_);
+
+    return lowestEquivalent + rangeSize - 1;
+}
@@ -11,6 +11,7 @@
 #include "frame-data.hpp"
 #include "name-components.hpp"
 #include "estimators.hpp"
+#include "clock.hpp"
 
 #define DEVIATION_ALPHA 1.
 #define MAX_PIPELINE_SIZE_MS 1000 // pipeline size shouldn't be more than this amount of milliseconds
@@ -65,11 +66,142 @@ int InterestControl::StrategyDefault::withhold(unsigned int currentLimit,
     return -(int)round((double)(currentLimit - lowerLimit) / 2.);
 }
 
+//******************************************************************************
+const unsigned int InterestControl::StrategyBbr::DeliveryWindowMs = 500;
+const unsigned int InterestControl::StrategyBbr::BandwidthWindowMs = 2000;
+const unsigned int InterestControl::StrategyBbr::MinDrdWindowMs = 10000;
+const unsigned int InterestControl::StrategyBbr::GradientIntervalMs = 100;
+const double InterestControl::StrategyBbr::CwndGain = 2.;
+const double InterestControl::StrategyBbr::ProbeGain = 1.25;
+const double InterestControl::StrategyBbr::GradientThreshold = 0.05;
+
+InterestControl::StrategyBbr::StrategyBbr()
+    : drdFiltered_(0), gradientDrd_(0), gradient_(0), gradientTimestamp_(0)
+{
+}
+
+void InterestControl::StrategyBbr::getLimits(double rate,
+                                             boost::shared_ptr<DrdEstimator> drdEstimator,
+                                             unsigned int &lowerLimit, unsigned int &upperLimit)
+{
+    double deliveryRate = getDeliveryRate();
+    double minDrd = getMinDrd();
+
+    if (deliveryRate == 0 || minDrd == 0)
+    {
+        StrategyDefault::getLimits(rate, drdEstimator, lowerLimit, upperLimit);
+        return;
+    }
+
+    // live stream can't be fetched slower than it is produced, hence
+    // producer's rate is the lowest bottleneck rate we can assume
+    double bdp = std::max(deliveryRate, rate) * minDrd / 1000.;
+    int maxDemandSize = calculateDemand(rate, MAX_PIPELINE_SIZE_MS, 0);
+    int interestDemand = (int)ceil(bdp);
+
+    if (interestDemand < (int)InterestControl::MinPipelineSize)
+        interestDemand = InterestControl::MinPipelineSize;
+    if (interestDemand > maxDemandSize)
+        interestDemand = maxDemandSize;
+
+    if (isQueueBuilding())
+    {
+        // drain the queue
+        lowerLimit = interestDemand;
+        upperLimit = interestDemand;
+    }
+    else
+    {
+        lowerLimit = (unsigned int)ceil(CwndGain * interestDemand);
+        upperLimit = (unsigned int)ceil(ProbeGain * lowerLimit);
+    }
+
+    lowerLimit = std::min(lowerLimit, (unsigned int)maxDemandSize);
+    upperLimit = std::min(upperLimit, (unsigned int)maxDemandSize);
+}
+
+int InterestControl::StrategyBbr::burst(unsigned int currentLimit,
+                                        unsigned int lowerLimit, unsigned int upperLimit)
+{
+    // more Interests will only add to the queue
+    if (isQueueBuilding())
+        return 0;
+    return std::max(1, (int)ceil((double)currentLimit / 4.));
+}
+
+int InterestControl::StrategyBbr::withhold(unsigned int currentLimit,
+                                           unsigned int lowerLimit, unsigned int upperLimit)
+{
+    if (currentLimit <= lowerLimit)
+        return 0;
+    return -(int)ceil((double)(currentLimit - lowerLimit) / 2.);
+}
+
+void InterestControl::StrategyBbr::sampleArrived(int64_t timestampMs)
+{
+    arrivals_.push_back(timestampMs);
+    while (arrivals_.front() < timestampMs - DeliveryWindowMs)
+        arrivals_.pop_front();
+
+    if (arrivals_.size() > 1 && arrivals_.back() > arrivals_.front())
+    {
+        double rate = (double)(arrivals_.size() - 1) * 1000. /
+                      (double)(arrivals_.back() - arrivals_.front());
+
+        // windowed max filter
+        while (maxRate_.size() && maxRate_.back().second <= rate)
+            maxRate_.pop_back();
+        maxRate_.push_back(TimedValue(timestampMs, rate));
+    }
+
+    while (maxRate_.size() && maxRate_.front().first < timestampMs - BandwidthWindowMs)
+        maxRate_.pop_front();
+}
+
+void InterestControl::StrategyBbr::drdUpdate(int64_t timestampMs, double drd)
+{
+    if (drd <= 0)
+        return;
+
+    // windowed min filter
+    while (minDrd_.size() && minDrd_.back().second >= drd)
+        minDrd_.pop_back();
+    minDrd_.push_back(TimedValue(timestampMs, drd));
+    while (minDrd_.front().first < timestampMs - MinDrdWindowMs)
+        minDrd_.pop_front();
+
+    drdFiltered_ = (drdFiltered_ == 0 ? drd : 0.8 * drdFiltered_ + 0.2 * drd);
+
+    if (gradientTimestamp_ == 0)
+    {
+        gradientTimestamp_ = timestampMs;
+        gradientDrd_ = drdFiltered_;
+    }
+    else if (timestampMs - gradientTimestamp_ >= GradientIntervalMs)
+    {
+        double g = (drdFiltered_ - gradientDrd_) / (double)(timestampMs - gradientTimestamp_);
+
+        gradient_ = 0.5 * gradient_ + 0.5 * g;
+        gradientTimestamp_ = timestampMs;
+        gradientDrd_ = drdFiltered_;
+    }
+}
+
+double InterestControl::StrategyBbr::getDeliveryRate() const
+{
+    return (maxRate_.size() ? maxRate_.front().second : 0);
+}
+
+double InterestControl::StrategyBbr::getMinDrd() const
+{
+    return (minDrd_.size() ? minDrd_.front().second : 0);
+}
+
 //******************************************************************************
 InterestControl::InterestControl(const boost::shared_ptr<DrdEstimator> &drdEstimator,
                                  const boost::shared_ptr<statistics::StatisticsStorage> &storage,
                                  boost::shared_ptr<IInterestControlStrategy> strategy)
-    : initialized_(false),
+    : initialized_(false), limitSet_(false),
       lowerLimit_(InterestControl::MinPipelineSize),
       limit_(InterestControl::MinPipelineSize),
       upperLimit_(10 * InterestControl::MinPipelineSize), pipeline_(0),
@@ -166,6 +298,9 @@ void InterestControl::markLowerLimit(unsigned int lowerLimit)
     LogDebugC << "marking lower limit " << lowerLimit << std::endl;
     limitSet_ = true;
     lowerLimit_ = lowerLimit;
+    // strict strategies may lower it later, but pipeline starts from here
+    if (limit_ < lowerLimit_)
+        changeLimitTo(lowerLimit_);
     setLimits();
 }
 
@@ -176,6 +311,9 @@ void InterestControl::onCachedDrdUpdate(double, double)
 
 void InterestControl::onOriginalDrdUpdate(double, double)
 {
+    strategy_->drdUpdate(clock::millisecondTimestamp(),
+                         drdEstimator_->getOriginalAverage().latestValue());
+
     if (initialized_)
         setLimits();
 }
@@ -193,6 +331,11 @@ void InterestControl::targetRateUpdate(double rate)
     setLimits();
 }
 
+void InterestControl::sampleArrived(const PacketNumber &)
+{
+    strategy_->sampleArrived(clock::millisecondTimestamp());
+}
+
 void InterestControl::setLimits()
 {
     unsigned int newLower = 0, newUpper = 0;
@@ -211,12 +354,16 @@ void InterestControl::setLimits()
     if (lowerLimit_ != newLower ||
         upperLimit_ != newUpper)
     {
-        if (!limitSet_ || newLower > lowerLimit_)
+        bool isStrict = strategy_->hasStrictLimits();
+
+        if (isStrict || !limitSet_ || newLower > lowerLimit_)
             lowerLimit_ = newLower;
         upperLimit_ = newUpper;
 
         if (limit_ < lowerLimit_)
             changeLimitTo(lowerLimit_);
+        if (isStrict && limit_ > upperLimit_)
+            changeLimitTo(upperLimit_);
 
         LogTraceC
             << "DRD orig: " << drdEstimator_->getOriginalEstimation()
@@ -228,25 +375,27 @@ void InterestControl::setLimits()
 
 void InterestControl::changeLimitTo(unsigned int newLimit)
 {
-    if (newLimit < lowerLimit_)
+    // lower limit wins if it has been marked above the upper limit
+    if (newLimit > upperLimit_)
     {
         LogWarnC << "can't set limit ("
                  << newLimit
-                 << ") lower than lower limit ("
-                 << lowerLimit_ << ")" << std::endl;
-
-        limit_ = lowerLimit_;
+                 << ") higher than upper limit ("
+                 << upperLimit_ << ")" << std::endl;
+        newLimit = upperLimit_;
     }
-    else if (newLimit > upperLimit_)
+
+    if (newLimit < lowerLimit_)
     {
         LogWarnC << "can't set limit ("
                  << newLimit
-                 << ") higher than upper limit ("
-                 << upperLimit_ << ")" << std::endl;
-        limit_ = upperLimit_;
+                 << ") lower than lower limit ("
+                 << lowerLimit_ << ")" << std::endl;
+
+        newLimit = lowerLimit_;
     }
-    else
-        limit_ = newLimit;
+
+    limit_ = newLimit;
 
     (*sstorage_)[Indicator::DW] = limit_;
 }
@@ -45,6 +45,26 @@ class IInterestControlStrategy
                       unsigned int lowerLimit, unsigned int upperLimit) = 0;
     virtual int withhold(unsigned int currentLimit,
                          unsigned int lowerLimit, unsigned int upperLimit) = 0;
+
+    /**
+     * Called when new sample has arrived. Strategies that estimate network
+     * state from arrivals may override this.
+     */
+    virtual void sampleArrived(int64_t timestampMs) {}
+
+    /**
+     * Called on every original DRD update with the latest DRD value.
+     */
+    virtual void drdUpdate(int64_t timestampMs, double drd) {}
+
+    /**
+     * If true, limits returned by getLimits() are followed as is: lower
+     * limit may go down below the marked one and current limit is clamped
+     * to the upper limit (i.e. to drain the queue). Otherwise, lower limit
+     * never goes below the marked one and current limit only grows up to
+     * the lower limit.
+     */
+    virtual bool hasStrictLimits() const { return false; }
 };
 
 class IInterestControl
@@ -97,6 +117,58 @@ class InterestControl : public NdnRtcComponent,
                      unsigned int lowerLimit, unsigned int upperLimit) override;
     };
 
+    /**
+     * Congestion-aware Interest pipeline adjustment strategy (BBR-style):
+     *  - estimates bottleneck delivery rate (samples/sec, windowed max) from
+     *      sample arrivals and min DRD (windowed min) from DRD updates
+     *  - sets lower limit to CwndGain times of the bandwidth-delay product
+     *      and upper limit to ProbeGain times of the lower limit
+     *  - tracks DRD gradient: while DRD grows (queue is building up), both
+     *      limits are clamped to the bandwidth-delay product and bursts are
+     *      suppressed, so that the queue drains
+     *  - bursts by one quarter of the current limit, withholds half-way down
+     *      to the lower limit
+     * Falls back to StrategyDefault until first estimations are available.
+     */
+    class StrategyBbr : public StrategyDefault
+    {
+      public:
+        static const unsigned int DeliveryWindowMs;
+        static const unsigned int BandwidthWindowMs;
+        static const unsigned int MinDrdWindowMs;
+        static const unsigned int GradientIntervalMs;
+        static const double CwndGain;
+        static const double ProbeGain;
+        static const double GradientThreshold;
+
+        StrategyBbr();
+
+        void getLimits(double rate, boost::shared_ptr<DrdEstimator> drdEstimator,
+                       unsigned int &lowerLimit, unsigned int &upperLimit) override;
+        int burst(unsigned int currentLimit,
+                  unsigned int lowerLimit, unsigned int upperLimit) override;
+        int withhold(unsigned int currentLimit,
+                     unsigned int lowerLimit, unsigned int upperLimit) override;
+        void sampleArrived(int64_t timestampMs) override;
+        void drdUpdate(int64_t timestampMs, double drd) override;
+        bool hasStrictLimits() const override { return true; }
+
+        // bottleneck delivery rate estimation, samples per second
+        double getDeliveryRate() const;
+        double getMinDrd() const;
+        // DRD change rate, milliseconds per millisecond
+        double getDrdGradient() const { return gradient_; }
+        bool isQueueBuilding() const { return gradient_ > GradientThreshold; }
+
+      private:
+        typedef std::pair<int64_t, double> TimedValue;
+
+        std::deque<int64_t> arrivals_;
+        std::deque<TimedValue> maxRate_, minDrd_;
+        double drdFiltered_, gradientDrd_, gradient_;
+        int64_t gradientTimestamp_;
+    };
+
     InterestControl(const boost::shared_ptr<DrdEstimator> &,
                     const boost::shared_ptr<statistics::StatisticsStorage> &storage,
                     boost::shared_ptr<IInterestControlStrategy> strategy = boost::make_shared<StrategyDefault>());
@@ -180,6 +252,12 @@ class InterestControl : public NdnRtcComponent,
 
     const boost::shared_ptr<const IInterestControlStrategy> getCurrentStrategy() const override { return strategy_; }
 
+    /**
+     * Replaces pipeline adjustment strategy. Should be called before
+     * initialize().
+     */
+    void setStrategy(const boost::shared_ptr<IInterestControlStrategy> &strategy) { strategy_ = strategy; }
+
     // IDrdEstimatorObserver
     void onDrdUpdate() override;
     void onCachedDrdUpdate(double, double) override;
@@ -187,7 +265,7 @@ class InterestControl : public NdnRtcComponent,
 
     // IBufferControlObserver
     void targetRateUpdate(double rate) override;
-    void sampleArrived(const PacketNumber &) override { }
+    void sampleArrived(const PacketNumber &) override;
 
   private:
     boost::shared_ptr<IInterestControlStrategy> strategy_;
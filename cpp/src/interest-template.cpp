@@ -0,0 +1,76 @@
+//
+// interest-template.cpp
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#include "interest-template.hpp"
+
+#include <boost/make_shared.hpp>
+
+#include "name-components.hpp"
+#include "object-pool.hpp"
+
+using namespace ndnrtc;
+using namespace ndn;
+
+const unsigned int InterestTemplate::PreEncodedSegmentsNum = 128;
+
+InterestTemplate::InterestTemplate(unsigned int lifetimeMs,
+                                   const boost::shared_ptr<ObjectPool> &pool)
+    : lifetimeMs_(lifetimeMs),
+      parityComponent_(NameComponents::NameComponentParity),
+      pool_(pool)
+{
+    template_.setMustBeFresh(false);
+    template_.setInterestLifetimeMilliseconds(lifetimeMs_);
+
+    segmentComponents_.reserve(PreEncodedSegmentsNum);
+    for (unsigned int segNo = 0; segNo < PreEncodedSegmentsNum; ++segNo)
+        segmentComponents_.push_back(Name::Component::fromSegment(segNo));
+}
+
+void InterestTemplate::setLifetime(unsigned int lifetimeMs)
+{
+    lifetimeMs_ = lifetimeMs;
+    template_.setInterestLifetimeMilliseconds(lifetimeMs_);
+}
+
+void InterestTemplate::makeInterests(const Name &samplePrefix, unsigned int nSegments,
+                                     bool parity,
+                                     std::vector<boost::shared_ptr<const Interest>> &interests) const
+{
+    Name prefix(samplePrefix);
+    if (parity)
+        prefix.append(parityComponent_);
+
+    interests.reserve(interests.size() + nSegments);
+    for (unsigned int segNo = 0; segNo < nSegments; ++segNo)
+    {
+        boost::shared_ptr<Interest> i = newInterest();
+        Name &name = i->getName();
+
+        name = prefix;
+        if (segNo < segmentComponents_.size())
+            name.append(segmentComponents_[segNo]);
+        else
+            name.appendSegment(segNo);
+
+        interests.push_back(i);
+    }
+}
+
+boost::shared_ptr<Interest> InterestTemplate::makeInterest(const Name &name) const
+{
+    boost::shared_ptr<Interest> i = newInterest();
+    i->setName(name);
+    return i;
+}
+
+boost::shared_ptr<Interest> InterestTemplate::newInterest() const
+{
+    if (pool_)
+        return pool_->make<Interest>(template_);
+    return boost::make_shared<Interest>(template_);
+}
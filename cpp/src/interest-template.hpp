@@ -0,0 +1,69 @@
+//
+// interest-template.hpp
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#ifndef __interest_template_h__
+#define __interest_template_h__
+
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include <ndn-cpp/interest.hpp>
+
+namespace ndnrtc
+{
+class ObjectPool;
+
+/**
+ * InterestTemplate produces segment Interests for samples. Interest
+ * selectors (lifetime, freshness) are set up once in a template Interest
+ * which is copied for every new Interest; name components for segment
+ * numbers and parity component are encoded once upon construction, so
+ * per-Interest work is limited to appending pre-encoded components to the
+ * sample prefix.
+ * Nonce is assigned by the Face when Interest is expressed.
+ * If object pool is provided, Interests are allocated from it.
+ */
+class InterestTemplate
+{
+  public:
+    // number of segment components encoded upon construction
+    static const unsigned int PreEncodedSegmentsNum;
+
+    InterestTemplate(unsigned int lifetimeMs,
+                     const boost::shared_ptr<ObjectPool> &pool = boost::shared_ptr<ObjectPool>());
+
+    void setLifetime(unsigned int lifetimeMs);
+    unsigned int getLifetime() const { return lifetimeMs_; }
+
+    /**
+     * Appends Interests for segments [0, nSegments) of a sample to the
+     * given vector.
+     * @param samplePrefix Sample prefix (including sequence number)
+     * @param nSegments Number of segments to request
+     * @param parity Whether Interests must be for parity segments
+     * @param interests Vector to append Interests to
+     */
+    void makeInterests(const ndn::Name &samplePrefix, unsigned int nSegments,
+                       bool parity,
+                       std::vector<boost::shared_ptr<const ndn::Interest>> &interests) const;
+
+    /**
+     * Creates Interest with given name using template's selectors.
+     */
+    boost::shared_ptr<ndn::Interest> makeInterest(const ndn::Name &name) const;
+
+  private:
+    unsigned int lifetimeMs_;
+    ndn::Interest template_;
+    ndn::Name::Component parityComponent_;
+    std::vector<ndn::Name::Component> segmentComponents_;
+    boost::shared_ptr<ObjectPool> pool_;
+
+    boost::shared_ptr<ndn::Interest> newInterest() const;
+};
+}
+
+#endif
@@ -19,6 +19,8 @@ using namespace ndnrtc::statistics;
 using namespace estimators;
 
 #define DEFAULT_TARGET_QUEUE_SIZE 150
+// lower limit for percentile strategy target queue size, in samples
+#define PERCENTILE_TARGET_MIN_SAMPLES 2
 
 #define STABILITY_ESTIMATOR_LOW_SENSITIVITY 0.3
 #define STABILITY_ESTIMATOR_MID_SENSITIVITY 0.18
@@ -249,6 +251,114 @@ LatencyControl::DefaultStrategy::getTargetPlayoutSize(const estimators::Average
     return (d > lowerLimit ? std::min((unsigned int)d, 4*lowerLimit) : lowerLimit);
 }
 
+//******************************************************************************
+const unsigned int LatencyControl::PercentileStrategy::BucketMs = 5;
+const unsigned int LatencyControl::PercentileStrategy::MaxDelayMs = 2000;
+const unsigned int LatencyControl::PercentileStrategy::ReferenceWindowMs = 2000;
+const unsigned int LatencyControl::PercentileStrategy::DecreaseRateMs = 20;
+// roughly 10 seconds of memory at 30 samples per second
+const double LatencyControl::PercentileStrategy::ForgetFactor = 0.997;
+
+LatencyControl::PercentileStrategy::DecayingHistogram::DecayingHistogram()
+    : buckets_(MaxDelayMs / BucketMs + 1, 0.), weight_(1.), total_(0.)
+{
+}
+
+void LatencyControl::PercentileStrategy::DecayingHistogram::newValue(double v)
+{
+    // instead of decaying all buckets, each new value gets larger weight.
+    // everything is rescaled once weights get too large
+    weight_ /= ForgetFactor;
+    if (weight_ > 1e100)
+    {
+        for (auto &b : buckets_)
+            b /= weight_;
+        total_ /= weight_;
+        weight_ = 1.;
+    }
+
+    size_t idx = std::min((size_t)(std::max(0., v) / BucketMs), buckets_.size() - 1);
+    buckets_[idx] += weight_;
+    total_ += weight_;
+}
+
+double LatencyControl::PercentileStrategy::DecayingHistogram::quantile(double q) const
+{
+    if (total_ == 0)
+        return 0;
+
+    double sum = 0, threshold = q * total_;
+    for (size_t i = 0; i < buckets_.size(); ++i)
+    {
+        sum += buckets_[i];
+        if (sum >= threshold)
+            return (double)((i + 1) * BucketMs);
+    }
+
+    return (double)MaxDelayMs;
+}
+
+LatencyControl::PercentileStrategy::PercentileStrategy(double percentile)
+    : percentile_(std::min(std::max(percentile, 1.), 100.)), samplePeriodMs_(0),
+      target_(0), minDrd_(0), lastArrivalMs_(0), targetTimestampMs_(0)
+{
+}
+
+unsigned int
+LatencyControl::PercentileStrategy::getTargetPlayoutSize(const estimators::Average &drd,
+                                                         const unsigned int &lowerLimit)
+{
+    if (lastArrivalMs_ == 0)
+        return lowerLimit;
+
+    double t = std::max(getArrivalDelay(), getDrdJitter()) + samplePeriodMs_;
+
+    if (t >= target_ || targetTimestampMs_ == 0)
+        target_ = t;
+    else
+        target_ = std::max(t, target_ - (double)DecreaseRateMs *
+                                            (double)(lastArrivalMs_ - targetTimestampMs_) / 1000.);
+    targetTimestampMs_ = lastArrivalMs_;
+
+    return std::min(std::max((unsigned int)ceil(target_), lowerLimit), MaxDelayMs);
+}
+
+void LatencyControl::PercentileStrategy::sampleArrived(int64_t timestampMs,
+                                                       PacketNumber playbackNo,
+                                                       double samplePeriodMs)
+{
+    if (samplePeriodMs <= 0)
+        return;
+
+    // arrival offset of a sample against its nominal schedule. the earliest
+    // arrival in the reference window has zero delay
+    double offset = (double)timestampMs - (double)playbackNo * samplePeriodMs;
+
+    while (minOffset_.size() && minOffset_.back().second >= offset)
+        minOffset_.pop_back();
+    minOffset_.push_back(std::make_pair(timestampMs, offset));
+    while (minOffset_.front().first < timestampMs - (int64_t)ReferenceWindowMs)
+        minOffset_.pop_front();
+
+    arrivalDelay_.newValue(offset - minOffset_.front().second);
+    samplePeriodMs_ = samplePeriodMs;
+    lastArrivalMs_ = timestampMs;
+}
+
+void LatencyControl::PercentileStrategy::drdUpdate(double drd)
+{
+    if (drd <= 0)
+        return;
+
+    // minimal DRD drifts up slowly, so that route changes are accepted eventually
+    if (minDrd_ == 0 || drd < minDrd_)
+        minDrd_ = drd;
+    else
+        minDrd_ += (drd - minDrd_) * 0.001;
+
+    drdJitter_.newValue(drd - minDrd_);
+}
+
 //******************************************************************************
 LatencyControl::LatencyControl(unsigned int timeoutWindowMs,
                                const boost::shared_ptr<const DrdEstimator> &drd,
@@ -265,6 +375,8 @@ LatencyControl::LatencyControl(unsigned int timeoutWindowMs,
     sstorage_(storage),
     interArrival_(Average(boost::make_shared<estimators::SampleWindow>(10))),
     targetRate_(30.),
+    jitterPercentile_(0),
+    achievedSize_(0),
     observer_(nullptr),
     currentCommand_(KeepPipeline)
 {
@@ -282,8 +394,18 @@ void LatencyControl::onDrdUpdate()
 
     if (playoutControl_.get())
     {
-        unsigned int targetSize = queueSizeStrategy_->getTargetPlayoutSize(drd_->getOriginalAverage(),
-                                                                           DEFAULT_TARGET_QUEUE_SIZE);
+        boost::shared_ptr<IQueueSizeStrategy> strategy;
+        unsigned int lowerLimit = DEFAULT_TARGET_QUEUE_SIZE;
+        {
+            boost::lock_guard<boost::mutex> scopedLock(mutex_);
+            strategy = queueSizeStrategy_;
+            if (jitterPercentile_ > 0)
+                lowerLimit = (unsigned int)ceil(PERCENTILE_TARGET_MIN_SAMPLES * 1000. / targetRate_);
+        }
+
+        playoutControl_->setMinimalThreshold(lowerLimit);
+        unsigned int targetSize = strategy->getTargetPlayoutSize(drd_->getOriginalAverage(),
+                                                                 lowerLimit);
 
         if (targetSize != playoutControl_->getThreshold())
         {
@@ -295,12 +417,29 @@ void LatencyControl::onDrdUpdate()
     }
 }
 
+void LatencyControl::onOriginalDrdUpdate(double drd, double)
+{
+    boost::shared_ptr<IQueueSizeStrategy> strategy;
+    {
+        boost::lock_guard<boost::mutex> scopedLock(mutex_);
+        strategy = queueSizeStrategy_;
+    }
+    strategy->drdUpdate(drd);
+}
+
 void LatencyControl::sampleArrived(const PacketNumber &playbackNo)
 {
     LogTraceC << "sample " << playbackNo << ". target rate " << targetRate_ << std::endl;
 
     PipelineAdjust command = KeepPipeline;
     int64_t now = clock::millisecondTimestamp();
+    boost::shared_ptr<IQueueSizeStrategy> strategy;
+
+    {
+        boost::lock_guard<boost::mutex> scopedLock(mutex_);
+        strategy = queueSizeStrategy_;
+    }
+    strategy->sampleArrived(now, playbackNo, (targetRate_ > 0 ? 1000. / targetRate_ : 0));
 
     if (timestamp_ == 0)
         timestamp_ = now;
@@ -361,6 +500,13 @@ void LatencyControl::sampleArrived(const PacketNumber &playbackNo)
     (*sstorage_)[Indicator::Darr] = stabilityEstimator_->getDarrAverage().latestValue();
     (*sstorage_)[Indicator::LatencyControlStable] = stabilityEstimator_->isStable();
     (*sstorage_)[Indicator::LatencyControlCommand] = command;
+
+    // achieved playback queue size, to be compared against the target
+    achievedSize_ += ((*sstorage_)[Indicator::BufferPlayableSize] - achievedSize_) * 0.05;
+    (*sstorage_)[Indicator::JitterAchievedSize] = achievedSize_;
+    boost::shared_ptr<PercentileStrategy> ps = boost::dynamic_pointer_cast<PercentileStrategy>(strategy);
+    if (ps)
+        (*sstorage_)[Indicator::JitterDelayPercentile] = ps->getArrivalDelay();
 }
 
 void LatencyControl::reset()
@@ -373,6 +519,28 @@ void LatencyControl::reset()
     interArrival_ = Average(boost::make_shared<estimators::SampleWindow>(10));
     targetRate_ = 30.;
     currentCommand_ = KeepPipeline;
+
+    // playback numbering may start over - arrival history is no longer valid
+    boost::lock_guard<boost::mutex> scopedLock(mutex_);
+    if (jitterPercentile_ > 0)
+        queueSizeStrategy_ = boost::make_shared<PercentileStrategy>(jitterPercentile_);
+}
+
+void LatencyControl::setJitterPercentile(double percentile)
+{
+    boost::lock_guard<boost::mutex> scopedLock(mutex_);
+
+    if (percentile > 0)
+        queueSizeStrategy_ = boost::make_shared<PercentileStrategy>(percentile);
+    else
+        queueSizeStrategy_ = boost::make_shared<DefaultStrategy>(2);
+    jitterPercentile_ = (percentile > 0 ? percentile : 0);
+
+    LogInfoC << "jitter target strategy: "
+             << (jitterPercentile_ > 0 ? "percentile" : "default");
+    if (jitterPercentile_ > 0)
+        LogInfoC << " (" << jitterPercentile_ << "th)";
+    LogInfoC << std::endl;
 }
 
 void LatencyControl::registerObserver(ILatencyControlObserver *o)
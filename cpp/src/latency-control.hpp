@@ -8,6 +8,8 @@
 #ifndef __latency_control_h__
 #define __latency_control_h__
 
+#include <deque>
+#include <vector>
 #include <boost/thread/mutex.hpp>
 
 #include "drd-estimator.hpp"
@@ -77,7 +79,7 @@ class LatencyControl : public NdnRtcComponent,
 
     void onDrdUpdate();
     void onCachedDrdUpdate(double, double) { /*ignored*/}
-    void onOriginalDrdUpdate(double, double) { /*ignored*/}
+    void onOriginalDrdUpdate(double drd, double);
 
     void targetRateUpdate(double rate) { targetRate_ = rate; }
     void sampleArrived(const PacketNumber &playbackNo);
@@ -95,11 +97,21 @@ class LatencyControl : public NdnRtcComponent,
 
     void setLogger(boost::shared_ptr<ndnlog::new_api::Logger> logger);
 
-  private:
     class IQueueSizeStrategy
     {
       public:
         virtual unsigned int getTargetPlayoutSize(const estimators::Average &drd, const unsigned int &lowerLimit) = 0;
+        /**
+         * Called when first segment of a sample has arrived.
+         * @param timestampMs Arrival timestamp
+         * @param playbackNo Playback number of the sample
+         * @param samplePeriodMs Nominal sample period
+         */
+        virtual void sampleArrived(int64_t timestampMs, PacketNumber playbackNo, double samplePeriodMs) {}
+        /**
+         * Called on each new DRD measurement.
+         */
+        virtual void drdUpdate(double drd) {}
     };
 
     class DefaultStrategy : public IQueueSizeStrategy
@@ -112,6 +124,65 @@ class LatencyControl : public NdnRtcComponent,
         double alpha_;
     };
 
+    /**
+     * Percentile strategy sets target playback queue size to the given
+     * percentile of sample arrival delay distribution (plus one sample period).
+     * Arrival delay of a sample is measured relative to the earliest sample
+     * arrival (adjusted by sample period) within ReferenceWindowMs. Arrival
+     * delays and DRD deviations from minimal DRD are collected into histograms
+     * which gradually forget older samples, target follows the larger of the
+     * two percentiles.
+     * Target grows immediately, but shrinks no faster than DecreaseRateMs per
+     * second, so the buffer is drained gradually once network gets calm.
+     */
+    class PercentileStrategy : public IQueueSizeStrategy
+    {
+      public:
+        static const unsigned int BucketMs;
+        static const unsigned int MaxDelayMs;
+        static const unsigned int ReferenceWindowMs;
+        static const unsigned int DecreaseRateMs;
+        static const double ForgetFactor;
+
+        PercentileStrategy(double percentile = 95.);
+
+        unsigned int getTargetPlayoutSize(const estimators::Average &drd, const unsigned int &lowerLimit) override;
+        void sampleArrived(int64_t timestampMs, PacketNumber playbackNo, double samplePeriodMs) override;
+        void drdUpdate(double drd) override;
+
+        double getPercentile() const { return percentile_; }
+        // current percentile of arrival delay distribution, ms
+        double getArrivalDelay() const { return arrivalDelay_.quantile(percentile_ / 100.); }
+        // current percentile of DRD deviation from minimal DRD, ms
+        double getDrdJitter() const { return drdJitter_.quantile(percentile_ / 100.); }
+
+      private:
+        // bucketed histogram with exponential forgetting
+        class DecayingHistogram
+        {
+          public:
+            DecayingHistogram();
+            void newValue(double v);
+            double quantile(double q) const;
+
+          private:
+            std::vector<double> buckets_;
+            double weight_, total_;
+        };
+
+        double percentile_, samplePeriodMs_, target_, minDrd_;
+        int64_t lastArrivalMs_, targetTimestampMs_;
+        std::deque<std::pair<int64_t, double>> minOffset_;
+        DecayingHistogram arrivalDelay_, drdJitter_;
+    };
+
+    /**
+     * Switches target playback queue size estimation to percentile strategy
+     * with given percentile. Passing 0 switches back to default strategy.
+     */
+    void setJitterPercentile(double percentile);
+
+  private:
     boost::mutex mutex_;
     boost::shared_ptr<StabilityEstimator> stabilityEstimator_;
     boost::shared_ptr<DrdChangeEstimator> drdChangeEstimator_;
@@ -122,7 +193,7 @@ class LatencyControl : public NdnRtcComponent,
     unsigned int timeoutWindowMs_;
     boost::shared_ptr<const DrdEstimator> drd_;
     estimators::Average interArrival_;
-    double targetRate_;
+    double targetRate_, jitterPercentile_, achievedSize_;
     ILatencyControlObserver *observer_;
     PipelineAdjust currentCommand_;
     boost::shared_ptr<statistics::StatisticsStorage> sstorage_;
@@ -174,6 +174,11 @@ int LocalVideoStream::incomingI420Frame(const unsigned int width,
 		strideV, yBuffer, uBuffer, vBuffer}));
 }
 
+int LocalVideoStream::incomingI420Frame(const PlanarFrame& frame, IFrameBufferOwner* owner)
+{
+	return pimpl_->incomingFrame(frame, owner);
+}
+
 int LocalVideoStream::incomingNV21Frame(const unsigned int width,
 			const unsigned int height,
 			const unsigned int strideY,
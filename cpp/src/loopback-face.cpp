@@ -0,0 +1,558 @@
+//
+// loopback-face.cpp
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#include "loopback-face.hpp"
+
+#include <algorithm>
+#include <boost/bind.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
+#include <boost/random/uniform_real_distribution.hpp>
+#include <boost/thread/lock_guard.hpp>
+#include <ndn-cpp/interest-filter.hpp>
+#include <ndn-cpp/network-nack.hpp>
+
+#if BOOST_ASIO_HAS_STD_CHRONO
+
+namespace lib_chrono=std::chrono;
+
+#else
+
+namespace lib_chrono=boost::chrono;
+
+#endif
+
+using namespace ndnrtc;
+using namespace ndn;
+
+typedef boost::asio::steady_timer::clock_type Clock;
+
+namespace
+{
+bool isSameInterest(const Interest &i1, const Interest &i2)
+{
+    return i1.getName().equals(i2.getName()) &&
+           i1.getChildSelector() == i2.getChildSelector() &&
+           i1.getMustBeFresh() == i2.getMustBeFresh() &&
+           i1.getMinSuffixComponents() == i2.getMinSuffixComponents() &&
+           i1.getMaxSuffixComponents() == i2.getMaxSuffixComponents();
+}
+
+unsigned int lifetimeMs(const Interest &interest)
+{
+    return (interest.getInterestLifetimeMilliseconds() < 0
+                ? LoopbackFace::DefaultInterestLifetimeMs
+                : (unsigned int)interest.getInterestLifetimeMilliseconds());
+}
+}
+
+//******************************************************************************
+LoopbackNetwork::LoopbackNetwork(boost::asio::io_service &io, uint32_t seed)
+    : io_(io), rng_(seed), lastId_(0), timer_(io)
+{
+}
+
+LoopbackNetwork::~LoopbackNetwork()
+{
+}
+
+boost::shared_ptr<LoopbackFace>
+LoopbackNetwork::createFace(const LinkSettings &link)
+{
+    boost::shared_ptr<LoopbackFace> face(new LoopbackFace(shared_from_this(), nextId(), link));
+    boost::lock_guard<boost::mutex> scopedLock(mutex_);
+
+    faces_[face->getFaceId()] = face;
+    return face;
+}
+
+LoopbackNetwork::Counters
+LoopbackNetwork::getCounters() const
+{
+    boost::lock_guard<boost::mutex> scopedLock(mutex_);
+    return counters_;
+}
+
+size_t LoopbackNetwork::getPitSize() const
+{
+    boost::lock_guard<boost::mutex> scopedLock(mutex_);
+    return pit_.size();
+}
+
+#pragma mark - private
+void LoopbackNetwork::removeFace(uint64_t faceId)
+{
+    boost::lock_guard<boost::mutex> scopedLock(mutex_);
+    faces_.erase(faceId);
+}
+
+void LoopbackNetwork::transmit(LoopbackFace &face, bool upstream, size_t size, Event onArrival)
+{
+    unsigned int delayUsec = 0;
+    {
+        boost::lock_guard<boost::mutex> scopedLock(mutex_);
+        const LinkSettings &link = face.link_;
+
+        if (link.lossRate_ > 0 &&
+            boost::random::uniform_real_distribution<double>(0, 1)(rng_) < link.lossRate_)
+        {
+            counters_.droppedNum_++;
+            return;
+        }
+
+        TimePoint now = Clock::now();
+        TimePoint departure = now;
+
+        // packet waits for previous ones to be sent out
+        if (link.bandwidthKbps_)
+        {
+            TimePoint &busyUntil = (upstream ? face.upBusyUntil_ : face.downBusyUntil_);
+            departure = std::max(now, busyUntil) +
+                        lib_chrono::microseconds((uint64_t)size * 8000 / link.bandwidthKbps_);
+            busyUntil = departure;
+        }
+
+        delayUsec = lib_chrono::duration_cast<lib_chrono::microseconds>(departure - now).count() +
+                    link.delayMs_ * 1000;
+        if (link.jitterMs_)
+            delayUsec += boost::random::uniform_int_distribution<unsigned int>(0, link.jitterMs_ * 1000)(rng_);
+    }
+
+    schedule(delayUsec, onArrival);
+}
+
+void LoopbackNetwork::schedule(unsigned int delayUsec, Event event)
+{
+    boost::lock_guard<boost::mutex> scopedLock(mutex_);
+    TimePoint t = Clock::now() + lib_chrono::microseconds(delayUsec);
+    bool isEarliest = (events_.size() == 0 || t < events_.begin()->first);
+
+    // events with the same time fire in the order they were scheduled
+    events_.insert(std::make_pair(t, event));
+
+    if (isEarliest)
+    {
+        timer_.expires_at(t);
+        timer_.async_wait(boost::bind(&LoopbackNetwork::fire, shared_from_this(),
+                                      boost::asio::placeholders::error));
+    }
+}
+
+void LoopbackNetwork::fire(const boost::system::error_code &e)
+{
+    if (e == boost::asio::error::operation_aborted)
+        return;
+
+    std::vector<Event> due;
+    {
+        boost::lock_guard<boost::mutex> scopedLock(mutex_);
+        TimePoint now = Clock::now();
+
+        while (events_.size() && events_.begin()->first <= now)
+        {
+            due.push_back(events_.begin()->second);
+            events_.erase(events_.begin());
+        }
+
+        if (events_.size())
+        {
+            timer_.expires_at(events_.begin()->first);
+            timer_.async_wait(boost::bind(&LoopbackNetwork::fire, shared_from_this(),
+                                          boost::asio::placeholders::error));
+        }
+    }
+
+    for (auto &event : due)
+        event();
+}
+
+void LoopbackNetwork::onInterest(uint64_t faceId, const boost::shared_ptr<const Interest> &interest)
+{
+    std::vector<boost::shared_ptr<LoopbackFace>> nextHops;
+    boost::shared_ptr<LoopbackFace> downstream;
+    {
+        boost::lock_guard<boost::mutex> scopedLock(mutex_);
+        TimePoint now = Clock::now();
+
+        counters_.interestsNum_++;
+        expirePit(now);
+
+        std::vector<PitEntry>::iterator entry =
+            std::find_if(pit_.begin(), pit_.end(), [interest](const PitEntry &e) {
+                return isSameInterest(*e.interest_, *interest);
+            });
+
+        if (entry != pit_.end())
+        {
+            entry->expiration_ = std::max(entry->expiration_,
+                                          now + lib_chrono::milliseconds(lifetimeMs(*interest)));
+
+            // retransmission from the same downstream is forwarded again
+            if (std::find(entry->downstreams_.begin(), entry->downstreams_.end(), faceId) ==
+                entry->downstreams_.end())
+            {
+                entry->downstreams_.push_back(faceId);
+                counters_.aggregatedNum_++;
+                return;
+            }
+        }
+
+        for (auto &it : faces_)
+        {
+            boost::shared_ptr<LoopbackFace> face = it.second.lock();
+            if (it.first != faceId && face && face->hasRoute(interest->getName()))
+                nextHops.push_back(face);
+        }
+
+        if (nextHops.size() == 0)
+        {
+            counters_.nacksNum_++;
+            if (faces_.find(faceId) != faces_.end())
+                downstream = faces_[faceId].lock();
+        }
+        else if (entry == pit_.end())
+            pit_.push_back(PitEntry({interest, std::vector<uint64_t>(1, faceId),
+                                     now + lib_chrono::milliseconds(lifetimeMs(*interest))}));
+    }
+
+    size_t size = interest->wireEncode().size();
+
+    if (downstream)
+    {
+        boost::shared_ptr<NetworkNack> nack = boost::make_shared<NetworkNack>();
+        nack->setReason(ndn_NetworkNackReason_NO_ROUTE);
+
+        boost::weak_ptr<LoopbackFace> face(downstream);
+        transmit(*downstream, false, size, [face, interest, nack]() {
+            if (boost::shared_ptr<LoopbackFace> f = face.lock())
+                f->nackReceived(interest, nack);
+        });
+    }
+
+    for (auto &nextHop : nextHops)
+    {
+        boost::weak_ptr<LoopbackFace> face(nextHop);
+        transmit(*nextHop, false, size, [face, interest]() {
+            if (boost::shared_ptr<LoopbackFace> f = face.lock())
+                f->interestReceived(interest);
+        });
+    }
+}
+
+void LoopbackNetwork::onData(uint64_t faceId, const boost::shared_ptr<const Data> &data)
+{
+    std::vector<boost::shared_ptr<LoopbackFace>> downstreams;
+    {
+        boost::lock_guard<boost::mutex> scopedLock(mutex_);
+        std::vector<uint64_t> faceIds;
+
+        counters_.dataNum_++;
+        expirePit(Clock::now());
+
+        for (std::vector<PitEntry>::iterator it = pit_.begin(); it != pit_.end();)
+        {
+            if (it->interest_->matchesName(data->getName()))
+            {
+                for (auto id : it->downstreams_)
+                    if (std::find(faceIds.begin(), faceIds.end(), id) == faceIds.end())
+                        faceIds.push_back(id);
+                it = pit_.erase(it);
+            }
+            else
+                ++it;
+        }
+
+        if (faceIds.size() == 0)
+            counters_.unsolicitedNum_++;
+
+        for (auto id : faceIds)
+        {
+            boost::shared_ptr<LoopbackFace> face;
+            if (faces_.find(id) != faces_.end() && (face = faces_[id].lock()))
+                downstreams.push_back(face);
+        }
+    }
+
+    size_t size = data->wireEncode().size();
+
+    for (auto &downstream : downstreams)
+    {
+        boost::weak_ptr<LoopbackFace> face(downstream);
+        transmit(*downstream, false, size, [face, data]() {
+            if (boost::shared_ptr<LoopbackFace> f = face.lock())
+                f->dataReceived(data);
+        });
+    }
+}
+
+void LoopbackNetwork::expirePit(const TimePoint &now)
+{
+    pit_.erase(std::remove_if(pit_.begin(), pit_.end(),
+                              [now](const PitEntry &e) { return e.expiration_ <= now; }),
+               pit_.end());
+}
+
+//******************************************************************************
+const unsigned int LoopbackFace::DefaultInterestLifetimeMs = 4000;
+
+LoopbackFace::LoopbackFace(const boost::shared_ptr<LoopbackNetwork> &network, uint64_t faceId,
+                           const LoopbackNetwork::LinkSettings &link)
+    : network_(network), faceId_(faceId), isShutdown_(false), link_(link)
+{
+}
+
+LoopbackFace::~LoopbackFace()
+{
+    network_->removeFace(faceId_);
+}
+
+void LoopbackFace::setLinkSettings(const LoopbackNetwork::LinkSettings &link)
+{
+    boost::lock_guard<boost::mutex> scopedLock(network_->mutex_);
+    link_ = link;
+}
+
+uint64_t
+LoopbackFace::expressInterest(const Interest &interest, const OnData &onData,
+                              const OnTimeout &onTimeout, const OnNetworkNack &onNetworkNack,
+                              WireFormat &wireFormat)
+{
+    uint64_t id = network_->nextId();
+    boost::shared_ptr<const Interest> i = boost::make_shared<Interest>(interest);
+
+    dispatch([id, i, onData, onTimeout, onNetworkNack](LoopbackFace &face) {
+        if (face.isShutdown_)
+            return;
+
+        face.pendingInterests_[id] = PendingInterest({i, onData, onTimeout, onNetworkNack});
+
+        boost::weak_ptr<LoopbackFace> me = face.shared_from_this();
+        face.network_->schedule(lifetimeMs(*i) * 1000, [me, id]() {
+            if (boost::shared_ptr<LoopbackFace> f = me.lock())
+                f->interestTimeout(id);
+        });
+
+        LoopbackNetwork *network = face.network_.get();
+        uint64_t faceId = face.faceId_;
+        network->transmit(face, true, i->wireEncode().size(), [network, faceId, i]() {
+            network->onInterest(faceId, i);
+        });
+    });
+
+    return id;
+}
+
+uint64_t
+LoopbackFace::expressInterest(const Name &name, const Interest *interestTemplate,
+                              const OnData &onData, const OnTimeout &onTimeout,
+                              const OnNetworkNack &onNetworkNack, WireFormat &wireFormat)
+{
+    Interest interest(name);
+
+    if (interestTemplate)
+    {
+        interest = *interestTemplate;
+        interest.setName(name);
+    }
+    else
+        interest.setInterestLifetimeMilliseconds(DefaultInterestLifetimeMs);
+
+    return expressInterest(interest, onData, onTimeout, onNetworkNack, wireFormat);
+}
+
+void LoopbackFace::removePendingInterest(uint64_t pendingInterestId)
+{
+    dispatch([pendingInterestId](LoopbackFace &face) {
+        face.pendingInterests_.erase(pendingInterestId);
+    });
+}
+
+uint64_t
+LoopbackFace::registerPrefix(const Name &prefix, const OnInterestCallback &onInterest,
+                             const OnRegisterFailed &onRegisterFailed,
+                             const OnRegisterSuccess &onRegisterSuccess,
+                             const ForwardingFlags &flags, WireFormat &wireFormat)
+{
+    uint64_t id = network_->nextId();
+    boost::shared_ptr<const Name> p = boost::make_shared<Name>(prefix);
+
+    dispatch([id, p, onInterest, onRegisterSuccess](LoopbackFace &face) {
+        face.addRoute(id, boost::make_shared<InterestFilter>(*p), onInterest);
+        if (onRegisterSuccess)
+            onRegisterSuccess(p, id);
+    });
+
+    return id;
+}
+
+void LoopbackFace::removeRegisteredPrefix(uint64_t registeredPrefixId)
+{
+    dispatch([registeredPrefixId](LoopbackFace &face) {
+        face.routes_.erase(registeredPrefixId);
+    });
+}
+
+uint64_t
+LoopbackFace::setInterestFilter(const InterestFilter &filter, const OnInterestCallback &onInterest)
+{
+    uint64_t id = network_->nextId();
+    boost::shared_ptr<const InterestFilter> f = boost::make_shared<InterestFilter>(filter);
+
+    dispatch([id, f, onInterest](LoopbackFace &face) {
+        face.addRoute(id, f, onInterest);
+    });
+
+    return id;
+}
+
+uint64_t
+LoopbackFace::setInterestFilter(const Name &prefix, const OnInterestCallback &onInterest)
+{
+    return setInterestFilter(InterestFilter(prefix), onInterest);
+}
+
+void LoopbackFace::unsetInterestFilter(uint64_t interestFilterId)
+{
+    dispatch([interestFilterId](LoopbackFace &face) {
+        face.routes_.erase(interestFilterId);
+    });
+}
+
+void LoopbackFace::putData(const Data &data, WireFormat &wireFormat)
+{
+    boost::shared_ptr<const Data> d = boost::make_shared<Data>(data);
+
+    dispatch([d](LoopbackFace &face) {
+        if (face.isShutdown_)
+            return;
+
+        LoopbackNetwork *network = face.network_.get();
+        uint64_t faceId = face.faceId_;
+        network->transmit(face, true, d->wireEncode().size(), [network, faceId, d]() {
+            network->onData(faceId, d);
+        });
+    });
+}
+
+void LoopbackFace::send(const uint8_t *encoding, size_t encodingLength)
+{
+    throw std::runtime_error("Sending raw packets is not supported by loopback face");
+}
+
+void LoopbackFace::shutdown()
+{
+    dispatch([](LoopbackFace &face) {
+        face.isShutdown_ = true;
+        face.pendingInterests_.clear();
+        face.routes_.clear();
+    });
+}
+
+void LoopbackFace::callLater(Milliseconds delayMilliseconds, const Callback &callback)
+{
+    unsigned int delayUsec = (unsigned int)(delayMilliseconds * 1000);
+    dispatch([delayUsec, callback](LoopbackFace &face) {
+        face.network_->schedule(delayUsec, callback);
+    });
+}
+
+#pragma mark - private
+void LoopbackFace::dispatch(boost::function<void(LoopbackFace &)> block)
+{
+    boost::weak_ptr<LoopbackFace> me = shared_from_this();
+    network_->getIo().dispatch([me, block]() {
+        if (boost::shared_ptr<LoopbackFace> face = me.lock())
+            block(*face);
+    });
+}
+
+void LoopbackFace::addRoute(uint64_t id, const boost::shared_ptr<const InterestFilter> &filter,
+                            const OnInterestCallback &onInterest)
+{
+    if (isShutdown_)
+        return;
+
+    routes_[id] = Route({boost::make_shared<Name>(filter->getPrefix()), filter, onInterest});
+}
+
+bool LoopbackFace::hasRoute(const Name &name) const
+{
+    for (auto &it : routes_)
+        if (it.second.filter_->doesMatch(name))
+            return true;
+    return false;
+}
+
+void LoopbackFace::interestTimeout(uint64_t id)
+{
+    std::map<uint64_t, PendingInterest>::iterator it = pendingInterests_.find(id);
+
+    if (it == pendingInterests_.end())
+        return;
+
+    PendingInterest pi = it->second;
+    pendingInterests_.erase(it);
+
+    if (pi.onTimeout_)
+        pi.onTimeout_(pi.interest_);
+}
+
+void LoopbackFace::interestReceived(const boost::shared_ptr<const Interest> &interest)
+{
+    std::vector<std::pair<uint64_t, Route>> routes;
+
+    for (auto &it : routes_)
+        if (it.second.onInterest_ && it.second.filter_->doesMatch(interest->getName()))
+            routes.push_back(it);
+
+    for (auto &r : routes)
+        r.second.onInterest_(r.second.prefix_, interest, *this, r.first, r.second.filter_);
+}
+
+void LoopbackFace::dataReceived(const boost::shared_ptr<const Data> &data)
+{
+    std::vector<PendingInterest> satisfied;
+
+    for (std::map<uint64_t, PendingInterest>::iterator it = pendingInterests_.begin();
+         it != pendingInterests_.end();)
+    {
+        if (it->second.interest_->matchesName(data->getName()))
+        {
+            satisfied.push_back(it->second);
+            it = pendingInterests_.erase(it);
+        }
+        else
+            ++it;
+    }
+
+    // each consumer gets its own copy of Data
+    for (auto &pi : satisfied)
+        if (pi.onData_)
+            pi.onData_(pi.interest_, boost::make_shared<Data>(*data));
+}
+
+void LoopbackFace::nackReceived(const boost::shared_ptr<const Interest> &interest,
+                                const boost::shared_ptr<NetworkNack> &nack)
+{
+    std::vector<PendingInterest> nacked;
+
+    for (std::map<uint64_t, PendingInterest>::iterator it = pendingInterests_.begin();
+         it != pendingInterests_.end();)
+    {
+        // Interests without Nack callback time out
+        if (it->second.onNetworkNack_ && isSameInterest(*it->second.interest_, *interest))
+        {
+            nacked.push_back(it->second);
+            it = pendingInterests_.erase(it);
+        }
+        else
+            ++it;
+    }
+
+    for (auto &pi : nacked)
+        pi.onNetworkNack_(pi.interest_, nack);
+}
@@ -0,0 +1,214 @@
+//
+// loopback-face.hpp
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#ifndef __loopback_face_h__
+#define __loopback_face_h__
+
+#include <map>
+#include <vector>
+#include <boost/asio.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/atomic.hpp>
+#include <boost/enable_shared_from_this.hpp>
+#include <boost/function.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/thread/mutex.hpp>
+#include <ndn-cpp/face.hpp>
+
+namespace ndnrtc
+{
+class LoopbackFace;
+
+/**
+ * In-process NDN network for tests and benchmarks - no NFD needed.
+ * Faces created by the network exchange packets in memory through a simple
+ * forwarder:
+ *  - Interests are forwarded to all other faces that have registered prefix
+ *    or Interest filter matching Interest name; Nack (NoRoute) is returned
+ *    if there are none;
+ *  - pending Interest table aggregates identical Interests from different
+ *    faces (retransmissions from the same face are forwarded again) and
+ *    routes Data back to all downstream faces.
+ * Every face is connected to the forwarder by a link, which emulates one-way
+ * delay, jitter, random loss and bandwidth (packets are serialized on a link
+ * in each direction and queue behind each other). Random generator is seeded
+ * explicitly, so loss and jitter patterns are reproducible.
+ * All packet processing and application callbacks run on network's
+ * io_service thread. Network must be created with make_shared.
+ */
+class LoopbackNetwork : public boost::enable_shared_from_this<LoopbackNetwork>
+{
+  public:
+    typedef struct _LinkSettings
+    {
+        _LinkSettings(unsigned int delayMs = 0, unsigned int jitterMs = 0,
+                      double lossRate = 0, unsigned int bandwidthKbps = 0)
+            : delayMs_(delayMs), jitterMs_(jitterMs),
+              lossRate_(lossRate), bandwidthKbps_(bandwidthKbps) {}
+
+        unsigned int delayMs_;       // one-way delay
+        unsigned int jitterMs_;      // extra delay, uniform in [0, jitterMs_]
+        double lossRate_;            // probability of packet loss, [0, 1]
+        unsigned int bandwidthKbps_; // 0 - unlimited
+    } LinkSettings;
+
+    typedef struct _Counters
+    {
+        _Counters() : interestsNum_(0), dataNum_(0), nacksNum_(0),
+                      aggregatedNum_(0), droppedNum_(0), unsolicitedNum_(0) {}
+
+        uint64_t interestsNum_;   // Interests received by forwarder
+        uint64_t dataNum_;        // Data received by forwarder
+        uint64_t nacksNum_;       // Nacks sent by forwarder (no route)
+        uint64_t aggregatedNum_;  // Interests aggregated in PIT
+        uint64_t droppedNum_;     // packets lost on links
+        uint64_t unsolicitedNum_; // Data that did not match any PIT entry
+    } Counters;
+
+    LoopbackNetwork(boost::asio::io_service &io, uint32_t seed = 0);
+    ~LoopbackNetwork();
+
+    boost::shared_ptr<LoopbackFace> createFace(const LinkSettings &link = LinkSettings());
+
+    boost::asio::io_service &getIo() const { return io_; }
+    Counters getCounters() const;
+    size_t getPitSize() const;
+
+  private:
+    friend class LoopbackFace;
+    typedef boost::asio::steady_timer::time_point TimePoint;
+    typedef boost::function<void(void)> Event;
+    typedef struct _PitEntry
+    {
+        boost::shared_ptr<const ndn::Interest> interest_;
+        std::vector<uint64_t> downstreams_;
+        TimePoint expiration_;
+    } PitEntry;
+
+    boost::asio::io_service &io_;
+    mutable boost::mutex mutex_;
+    boost::random::mt19937 rng_;
+    boost::atomic<uint64_t> lastId_;
+    std::map<uint64_t, boost::weak_ptr<LoopbackFace>> faces_;
+    std::vector<PitEntry> pit_;
+    Counters counters_;
+
+    boost::asio::steady_timer timer_;
+    std::multimap<TimePoint, Event> events_;
+
+    uint64_t nextId() { return ++lastId_; }
+    void removeFace(uint64_t faceId);
+
+    void transmit(LoopbackFace &face, bool upstream, size_t size, Event onArrival);
+    void schedule(unsigned int delayUsec, Event event);
+    void fire(const boost::system::error_code &e);
+
+    void onInterest(uint64_t faceId, const boost::shared_ptr<const ndn::Interest> &interest);
+    void onData(uint64_t faceId, const boost::shared_ptr<const ndn::Data> &data);
+    void expirePit(const TimePoint &now);
+};
+
+/**
+ * Face of the in-process network. May be used anywhere ndn::Face is used
+ * (remote streams, MemoryContentCache, RingContentCache). Registered
+ * prefixes and Interest filters both route Interests to the face.
+ * Thread-safe: calls are dispatched on network's io_service thread.
+ */
+class LoopbackFace : public ndn::Face,
+                     public boost::enable_shared_from_this<LoopbackFace>
+{
+  public:
+    static const unsigned int DefaultInterestLifetimeMs;
+
+    ~LoopbackFace();
+
+    uint64_t getFaceId() const { return faceId_; }
+    void setLinkSettings(const LoopbackNetwork::LinkSettings &link);
+
+    using ndn::Face::expressInterest;
+    using ndn::Face::registerPrefix;
+    using ndn::Face::setInterestFilter;
+    using ndn::Face::putData;
+
+    uint64_t
+    expressInterest(const ndn::Interest &interest, const ndn::OnData &onData,
+                    const ndn::OnTimeout &onTimeout, const ndn::OnNetworkNack &onNetworkNack,
+                    ndn::WireFormat &wireFormat = *ndn::WireFormat::getDefaultWireFormat()) override;
+    uint64_t
+    expressInterest(const ndn::Name &name, const ndn::Interest *interestTemplate,
+                    const ndn::OnData &onData, const ndn::OnTimeout &onTimeout,
+                    const ndn::OnNetworkNack &onNetworkNack,
+                    ndn::WireFormat &wireFormat = *ndn::WireFormat::getDefaultWireFormat()) override;
+    void removePendingInterest(uint64_t pendingInterestId) override;
+
+    uint64_t
+    registerPrefix(const ndn::Name &prefix, const ndn::OnInterestCallback &onInterest,
+                   const ndn::OnRegisterFailed &onRegisterFailed,
+                   const ndn::OnRegisterSuccess &onRegisterSuccess,
+                   const ndn::ForwardingFlags &flags = ndn::ForwardingFlags(),
+                   ndn::WireFormat &wireFormat = *ndn::WireFormat::getDefaultWireFormat()) override;
+    void removeRegisteredPrefix(uint64_t registeredPrefixId) override;
+    uint64_t setInterestFilter(const ndn::InterestFilter &filter,
+                               const ndn::OnInterestCallback &onInterest) override;
+    uint64_t setInterestFilter(const ndn::Name &prefix,
+                               const ndn::OnInterestCallback &onInterest) override;
+    void unsetInterestFilter(uint64_t interestFilterId) override;
+
+    void putData(const ndn::Data &data,
+                 ndn::WireFormat &wireFormat = *ndn::WireFormat::getDefaultWireFormat()) override;
+    void send(const uint8_t *encoding, size_t encodingLength) override;
+
+    // not virtual in ndn::Face - hide face's versions for callers using
+    // LoopbackFace directly
+    void processEvents() {}
+    bool isLocal() { return true; }
+    void shutdown() override;
+    void callLater(ndn::Milliseconds delayMilliseconds, const Callback &callback) override;
+
+  private:
+    friend class LoopbackNetwork;
+    typedef struct _PendingInterest
+    {
+        boost::shared_ptr<const ndn::Interest> interest_;
+        ndn::OnData onData_;
+        ndn::OnTimeout onTimeout_;
+        ndn::OnNetworkNack onNetworkNack_;
+    } PendingInterest;
+    typedef struct _Route
+    {
+        boost::shared_ptr<const ndn::Name> prefix_;
+        boost::shared_ptr<const ndn::InterestFilter> filter_;
+        ndn::OnInterestCallback onInterest_;
+    } Route;
+
+    boost::shared_ptr<LoopbackNetwork> network_;
+    uint64_t faceId_;
+    bool isShutdown_;
+    std::map<uint64_t, PendingInterest> pendingInterests_;
+    std::map<uint64_t, Route> routes_;
+
+    // guarded by network's mutex
+    LoopbackNetwork::LinkSettings link_;
+    boost::asio::steady_timer::time_point upBusyUntil_, downBusyUntil_;
+
+    LoopbackFace(const boost::shared_ptr<LoopbackNetwork> &network, uint64_t faceId,
+                 const LoopbackNetwork::LinkSettings &link);
+
+    void dispatch(boost::function<void(LoopbackFace &)> block);
+    void addRoute(uint64_t id, const boost::shared_ptr<const ndn::InterestFilter> &filter,
+                  const ndn::OnInterestCallback &onInterest);
+    bool hasRoute(const ndn::Name &name) const;
+
+    void interestTimeout(uint64_t id);
+    void interestReceived(const boost::shared_ptr<const ndn::Interest> &interest);
+    void dataReceived(const boost::shared_ptr<const ndn::Data> &data);
+    void nackReceived(const boost::shared_ptr<const ndn::Interest> &interest,
+                      const boost::shared_ptr<ndn::NetworkNack> &nack);
+};
+}
+
+#endif
@@ -8,7 +8,6 @@
 #include <boost/smart_ptr/shared_ptr.hpp>
 #include <boost/thread/lock_guard.hpp>
 #include <ndn-cpp/face.hpp>
-#include <ndn-cpp/util/memory-content-cache.hpp>
 
 #include "media-stream-base.hpp"
 #include "name-components.hpp"
@@ -16,6 +15,7 @@
 #include "clock.hpp"
 #include "statistics.hpp"
 #include "storage-engine.hpp"
+#include "ring-content-cache.hpp"
 
 #define META_CHECK_INTERVAL_MS 10
 
@@ -42,18 +42,16 @@ MediaStreamBase::MediaStreamBase(const std::string &basePrefix,
     streamPrefix_.append(Name(settings_.params_.streamName_));
     streamPrefix_.appendTimestamp(streamTimestamp_);
 
-    unsigned int minimumFreshness = min(settings_.params_.producerParams_.freshness_.metadataMs_, 
-                                        settings_.params_.producerParams_.freshness_.sampleMs_);
-    minimumFreshness = min(minimumFreshness, settings_.params_.producerParams_.freshness_.sampleKeyMs_);
-    // set cleanup interval for memory cache to 0
-    // this will make cache to cleanup every time there's an incoming interest 
-    // or data added (and prevent it from hanging for few ms when data rate is high)
-    cache_ = boost::make_shared<MemoryContentCache>(settings_.face_, 0);
+    // cache is bounded by the byte budget; segments are evicted once they
+    // expire, but are kept for at least a second to serve late interests
+    cache_ = boost::make_shared<RingContentCache>(settings_.face_,
+                                                  (size_t)settings_.params_.producerParams_.cacheBudgetMb_ * 1024 * 1024,
+                                                  statStorage_);
     cache_->setMinimumCacheLifetime(1000);
     // set filter for prefix without the timestamp, because stream _meta is served there
-    cache_->setInterestFilter(streamPrefix_.getPrefix(-1), cache_->getStorePendingInterest());
+    cache_->setInterestFilter(streamPrefix_.getPrefix(-1));
 
-    PublisherSettings ps;
+    StreamPublisherSettings ps;
     ps.sign_ = settings_.sign_; // it's ok to sign every packet as data publisher
                                 // is used for low-rate data (max 10fps) and manifests
     ps.keyChain_ = settings_.keyChain_;
@@ -69,7 +67,7 @@ MediaStreamBase::MediaStreamBase(const std::string &basePrefix,
         ps.onSegmentsCached_ = boost::bind(&MediaStreamBase::onSegmentsCached, this, _1);
     }
 
-    metadataPublisher_ = boost::make_shared<CommonPacketPublisher>(ps);
+    metadataPublisher_ = boost::make_shared<CommonStreamPublisher>(ps);
     metadataPublisher_->setDescription("metadata-publisher-" + settings_.params_.streamName_);
 }
 
@@ -101,6 +99,7 @@ void
 MediaStreamBase::setLogger(boost::shared_ptr<ndnlog::new_api::Logger> logger)
 {
     metadataPublisher_->setLogger(logger);
+    cache_->setLogger(logger);
 }
 
 void MediaStreamBase::publishMeta()
@@ -16,11 +16,6 @@
 #include "periodic.hpp"
 #include "statistics.hpp"
 
-namespace ndn
-{
-class MemoryContentCache;
-}
-
 namespace ndnrtc
 {
 namespace statistics
@@ -79,8 +74,8 @@ class MediaStreamBase : public NdnRtcComponent,
     MediaStreamSettings settings_;
     std::string basePrefix_;
     ndn::Name streamPrefix_;
-    boost::shared_ptr<ndn::MemoryContentCache> cache_;
-    boost::shared_ptr<CommonPacketPublisher> metadataPublisher_;
+    boost::shared_ptr<RingContentCache> cache_;
+    boost::shared_ptr<CommonStreamPublisher> metadataPublisher_;
     boost::shared_ptr<statistics::StatisticsStorage> statStorage_;
     boost::shared_ptr<StorageEngine> storage_;
     uint64_t streamTimestamp_;
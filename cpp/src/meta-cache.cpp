@@ -0,0 +1,92 @@
+//
+// meta-cache.cpp
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#include "meta-cache.hpp"
+
+#include <algorithm>
+#include <boost/thread/lock_guard.hpp>
+
+#include "clock.hpp"
+#include "network-data.hpp"
+
+using namespace ndnrtc;
+
+const unsigned int MetaCache::DefaultMaxAgeMs = 10 * 60 * 1000;
+
+//******************************************************************************
+MetaCache *MetaCache::getSharedInstance()
+{
+    static MetaCache cache;
+    return &cache;
+}
+
+void MetaCache::storeStreamMeta(const std::string &streamPrefix,
+                                const boost::shared_ptr<MediaStreamMeta> &meta)
+{
+    boost::lock_guard<boost::mutex> scopedLock(mutex_);
+    Entry &entry = entries_[streamPrefix];
+
+    if (entry.streamMeta_ &&
+        entry.streamMeta_->getStreamTimestamp() != meta->getStreamTimestamp())
+        entry.threadsMeta_.clear();
+
+    entry.streamMeta_ = meta;
+    entry.updatedMs_ = clock::millisecondTimestamp();
+}
+
+void MetaCache::storeThreadMeta(const std::string &streamPrefix, const std::string &thread,
+                                const boost::shared_ptr<NetworkData> &meta)
+{
+    boost::lock_guard<boost::mutex> scopedLock(mutex_);
+    auto it = entries_.find(streamPrefix);
+
+    if (it == entries_.end() || !it->second.streamMeta_)
+        return;
+
+    std::vector<std::string> threads = it->second.streamMeta_->getThreads();
+    if (std::find(threads.begin(), threads.end(), thread) == threads.end())
+        return;
+
+    it->second.threadsMeta_[thread] = meta;
+    it->second.updatedMs_ = clock::millisecondTimestamp();
+}
+
+bool MetaCache::get(const std::string &streamPrefix, Entry &entry,
+                    unsigned int maxAgeMs) const
+{
+    boost::lock_guard<boost::mutex> scopedLock(mutex_);
+    auto it = entries_.find(streamPrefix);
+
+    if (it == entries_.end() || !it->second.streamMeta_ ||
+        clock::millisecondTimestamp() - it->second.updatedMs_ > maxAgeMs)
+        return false;
+
+    for (auto &t : it->second.streamMeta_->getThreads())
+        if (it->second.threadsMeta_.find(t) == it->second.threadsMeta_.end())
+            return false;
+
+    entry = it->second;
+    return true;
+}
+
+void MetaCache::invalidate(const std::string &streamPrefix)
+{
+    boost::lock_guard<boost::mutex> scopedLock(mutex_);
+    entries_.erase(streamPrefix);
+}
+
+void MetaCache::clear()
+{
+    boost::lock_guard<boost::mutex> scopedLock(mutex_);
+    entries_.clear();
+}
+
+size_t MetaCache::size() const
+{
+    boost::lock_guard<boost::mutex> scopedLock(mutex_);
+    return entries_.size();
+}
@@ -0,0 +1,86 @@
+//
+// meta-cache.hpp
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#ifndef __meta_cache_h__
+#define __meta_cache_h__
+
+#include <map>
+#include <string>
+#include <stdint.h>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
+namespace ndnrtc
+{
+class MediaStreamMeta;
+
+// forward delcaration of typedef'ed template class
+struct Mutable;
+template <typename T>
+class NetworkDataT;
+typedef NetworkDataT<Mutable> NetworkDataAlias;
+
+/**
+ * Process-wide cache of remote streams' metadata.
+ * Stream and thread metadata fetched by remote streams is stored here, keyed
+ * by stream prefix (without stream timestamp), so that a remote stream
+ * re-created for the same producer (viewer switching back and forth between
+ * streams) can start fetching right away instead of waiting for two
+ * metadata round-trips. Cached metadata is only a hint - it must be
+ * refreshed by the consumer, producer might have restarted the stream since.
+ * Cache is thread-safe.
+ */
+class MetaCache
+{
+  public:
+    typedef std::map<std::string, boost::shared_ptr<NetworkDataAlias>> ThreadsMeta;
+    typedef struct _Entry
+    {
+        boost::shared_ptr<MediaStreamMeta> streamMeta_;
+        ThreadsMeta threadsMeta_;
+        int64_t updatedMs_;
+    } Entry;
+
+    static const unsigned int DefaultMaxAgeMs;
+
+    static MetaCache *getSharedInstance();
+
+    /**
+     * Stores stream metadata. If stream timestamp has changed, previously
+     * cached threads metadata is dropped.
+     */
+    void storeStreamMeta(const std::string &streamPrefix,
+                         const boost::shared_ptr<MediaStreamMeta> &meta);
+    /**
+     * Stores thread metadata. Ignored, if stream metadata for this prefix
+     * is not cached or if thread is not listed in it.
+     */
+    void storeThreadMeta(const std::string &streamPrefix, const std::string &thread,
+                         const boost::shared_ptr<NetworkDataAlias> &meta);
+    /**
+     * Retrieves metadata for the stream.
+     * @return True if cached metadata is complete (has metadata for all
+     *  stream threads) and is not older than maxAgeMs
+     */
+    bool get(const std::string &streamPrefix, Entry &entry,
+             unsigned int maxAgeMs = DefaultMaxAgeMs) const;
+
+    void invalidate(const std::string &streamPrefix);
+    void clear();
+    size_t size() const;
+
+  private:
+    MetaCache() {}
+    MetaCache(MetaCache const &) = delete;
+    void operator=(MetaCache const &) = delete;
+
+    mutable boost::mutex mutex_;
+    std::map<std::string, Entry> entries_;
+};
+}
+
+#endif
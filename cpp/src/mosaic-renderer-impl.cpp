@@ -0,0 +1,458 @@
+//
+// mosaic-renderer-impl.cpp
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#include "mosaic-renderer-impl.hpp"
+
+#include <assert.h>
+#include <algorithm>
+#include <stdexcept>
+#include <boost/make_shared.hpp>
+#include <boost/thread/lock_guard.hpp>
+#include <libyuv/convert_from.h>
+#include <libyuv/planar_functions.h>
+#include <libyuv/scale.h>
+
+#include "async.hpp"
+#include "clock.hpp"
+#include "periodic.hpp"
+#include "statistics.hpp"
+
+using namespace ndnrtc;
+using namespace ndnrtc::statistics;
+
+const unsigned int MosaicRendererImpl::DefaultSwapBuffersNum = 3;
+
+namespace
+{
+// black in limited range YUV
+const int BlackY = 16, BlackUV = 128;
+}
+
+//******************************************************************************
+void MosaicTile::renderFrame(const FrameInfo &frameInfo, const PlanarFrame &frame,
+                             IRenderBufferReleaser *releaser)
+{
+    boost::shared_ptr<HeldFrame> heldFrame = boost::make_shared<HeldFrame>(frame, releaser);
+    boost::shared_ptr<HeldFrame> previous;
+
+    {
+        boost::lock_guard<boost::mutex> scopedLock(mutex_);
+        previous = frame_;
+        frame_ = heldFrame;
+        generation_++;
+    }
+    // previous frame is released here, unless it is being scaled right now -
+    // then it is released by the worker
+}
+
+boost::shared_ptr<MosaicTile::HeldFrame> MosaicTile::getFrame(uint64_t &generation) const
+{
+    boost::lock_guard<boost::mutex> scopedLock(mutex_);
+    generation = generation_;
+    return frame_;
+}
+
+void MosaicTile::reset()
+{
+    boost::shared_ptr<HeldFrame> previous;
+    {
+        boost::lock_guard<boost::mutex> scopedLock(mutex_);
+        previous = frame_;
+        frame_.reset();
+    }
+}
+
+//******************************************************************************
+MosaicRendererImpl::MosaicRendererImpl(unsigned int width, unsigned int height,
+                                       unsigned int nWorkers)
+    : width_(width & ~1u), height_(height & ~1u)
+    , nWorkers_(nWorkers ? nWorkers : std::max(1u, boost::thread::hardware_concurrency()))
+    , isRunning_(false)
+    , sstorage_(StatisticsStorage::createConsumerStatistics())
+    , layoutVersion_(1)
+    , output_(nullptr), format_(IExternalPlanarRenderer::kI420)
+    , next_(0), composedNum_(0)
+    , workIoWork_(boost::make_shared<boost::asio::io_service::work>(workIo_))
+    , tickIoWork_(boost::make_shared<boost::asio::io_service::work>(tickIo_))
+    , tickTimer_(boost::make_shared<Periodic>(tickIo_))
+    , nPendingJobs_(0)
+{
+    description_ = "mosaic";
+
+    if (width_ == 0 || height_ == 0)
+        throw std::runtime_error("Bad mosaic resolution");
+
+    for (unsigned int i = 0; i < nWorkers_; ++i)
+        workers_.create_thread([this]() { workIo_.run(); });
+    tickThread_ = boost::thread([this]() { tickIo_.run(); });
+
+    allocateBuffers(DefaultSwapBuffersNum);
+}
+
+MosaicRendererImpl::~MosaicRendererImpl()
+{
+    stop();
+
+    tickTimer_.reset();
+    tickIoWork_.reset();
+    tickIo_.stop();
+    tickThread_.join();
+
+    workIoWork_.reset();
+    workIo_.stop();
+    workers_.join_all();
+
+    // release frames held by tiles
+    for (auto &t : tiles_)
+        t->reset();
+}
+
+IExternalPlanarRenderer *MosaicRendererImpl::addTile(const MosaicRenderer::Tile &tile)
+{
+    MosaicRenderer::Tile rect;
+
+    // chroma planes are subsampled - tiles must start and end on even pixels
+    rect.x_ = std::max(0, tile.x_) & ~1;
+    rect.y_ = std::max(0, tile.y_) & ~1;
+    rect.width_ = std::min(tile.width_, (int)width_ - rect.x_) & ~1;
+    rect.height_ = std::min(tile.height_, (int)height_ - rect.y_) & ~1;
+
+    if (rect.width_ <= 0 || rect.height_ <= 0)
+        throw std::runtime_error("Mosaic tile is outside of the output frame");
+
+    boost::shared_ptr<MosaicTile> mosaicTile = boost::make_shared<MosaicTile>(rect);
+    {
+        boost::lock_guard<boost::mutex> scopedLock(tilesMutex_);
+        tiles_.push_back(mosaicTile);
+        layoutVersion_++;
+    }
+
+    LogInfoC << "added tile " << rect.width_ << "x" << rect.height_
+             << " at (" << rect.x_ << "," << rect.y_ << ")" << std::endl;
+
+    return mosaicTile.get();
+}
+
+void MosaicRendererImpl::removeTile(IExternalPlanarRenderer *tileRenderer)
+{
+    boost::shared_ptr<MosaicTile> mosaicTile;
+    {
+        boost::lock_guard<boost::mutex> scopedLock(tilesMutex_);
+        auto it = std::find_if(tiles_.begin(), tiles_.end(),
+                               [tileRenderer](const boost::shared_ptr<MosaicTile> &t) {
+                                   return t.get() == tileRenderer;
+                               });
+        if (it == tiles_.end())
+            throw std::runtime_error("Trying to remove unknown mosaic tile");
+
+        mosaicTile = *it;
+        tiles_.erase(it);
+        layoutVersion_++;
+    }
+
+    mosaicTile->reset();
+    LogInfoC << "removed tile" << std::endl;
+}
+
+size_t MosaicRendererImpl::getTilesNum() const
+{
+    boost::lock_guard<boost::mutex> scopedLock(tilesMutex_);
+    return tiles_.size();
+}
+
+void MosaicRendererImpl::start(unsigned int fps, IExternalPlanarRenderer *output)
+{
+    if (isRunning_)
+        throw std::runtime_error("Mosaic renderer is already running");
+    if (fps == 0)
+        throw std::runtime_error("Bad mosaic frame rate");
+
+    assert(output);
+    unsigned int intervalMs = std::max(1u, 1000 / fps);
+    IExternalPlanarRenderer::PixelFormat format = output->getPixelFormat();
+    unsigned int nBuffers = output->getSwapBuffersNum();
+
+    // buffers are kept across restarts, so previous output may still
+    // release them; they can be re-allocated only once all are released
+    if (format != format_ || nBuffers != buffers_.size())
+    {
+        if (getHeldBuffersNum())
+            throw std::runtime_error("Previous mosaic output still holds swap buffers");
+
+        format_ = format;
+        allocateBuffers(nBuffers);
+    }
+
+    async::dispatchSync(tickIo_, [this, output, intervalMs]() {
+        output_ = output;
+        isRunning_ = true;
+
+        tickTimer_->setupInvocation(intervalMs, [this, intervalMs]() {
+            compose(output_);
+            return (isRunning_ ? intervalMs : 0);
+        });
+    });
+
+    LogInfoC << "started " << width_ << "x" << height_ << "@" << fps << "fps, "
+             << nWorkers_ << " workers" << std::endl;
+}
+
+void MosaicRendererImpl::stop()
+{
+    if (!isRunning_)
+        return;
+
+    // on tick thread, so that composing is not in progress
+    async::dispatchSync(tickIo_, [this]() {
+        tickTimer_->cancelInvocation();
+        isRunning_ = false;
+        output_ = nullptr;
+    });
+
+    LogInfoC << "stopped" << std::endl;
+}
+
+bool MosaicRendererImpl::compose(IExternalPlanarRenderer *output)
+{
+    int64_t composeStartUsec = clock::microsecondTimestamp();
+    int idx = acquireBuffer();
+
+    if (idx < 0)
+    {
+        LogTraceC << "output is busy (all " << buffers_.size()
+                  << " swap buffers are held)" << std::endl;
+        (*sstorage_)[Indicator::MosaicSkippedNum]++;
+        return false;
+    }
+
+    OutputBuffer &buffer = *buffers_[idx];
+    std::vector<boost::shared_ptr<MosaicTile>> tiles;
+    unsigned int layoutVersion;
+
+    {
+        boost::lock_guard<boost::mutex> scopedLock(tilesMutex_);
+        tiles = tiles_;
+        layoutVersion = layoutVersion_;
+    }
+
+    if (buffer.layoutVersion_ != layoutVersion)
+    {
+        clearRect(buffer, {0, 0, (int)width_, (int)height_});
+        buffer.generations_.clear();
+        buffer.layoutVersion_ = layoutVersion;
+    }
+
+    // only tiles with new frames since this buffer was composed are scaled
+    std::vector<boost::function<void(void)>> jobs;
+    OutputBuffer *b = &buffer;
+
+    for (auto &t : tiles)
+    {
+        uint64_t generation;
+        boost::shared_ptr<MosaicTile::HeldFrame> frame = t->getFrame(generation);
+
+        if (!frame || buffer.generations_[t.get()] == generation)
+            continue;
+
+        buffer.generations_[t.get()] = generation;
+        MosaicRenderer::Tile rect = t->getRect();
+        jobs.push_back([this, b, rect, frame]() {
+            drawTile(*b, rect, frame->frame_);
+        });
+    }
+
+    runJobs(jobs);
+
+    PlanarFrame planarFrame;
+    fillPlanarFrame(buffer, idx, planarFrame);
+    composedNum_++;
+
+    (*sstorage_)[Indicator::MosaicComposedNum]++;
+    (*sstorage_)[Indicator::MosaicTilesScaledNum] += jobs.size();
+    (*sstorage_)[Indicator::MosaicComposeTime] += (double)(clock::microsecondTimestamp() - composeStartUsec) / 1000.;
+
+    LogTraceC << "composed " << composedNum_ << " (" << jobs.size() << "/"
+              << tiles.size() << " tiles updated)" << std::endl;
+
+    if (output)
+    {
+        FrameInfo finfo({(uint64_t)clock::millisecondTimestamp(), composedNum_, "", false});
+        output->renderFrame(finfo, planarFrame, this);
+    }
+    else
+        buffer.busy_.store(false, boost::memory_order_release);
+
+    return true;
+}
+
+void MosaicRendererImpl::releaseFrame(const PlanarFrame &frame)
+{
+    if (frame.bufferIdx_ >= buffers_.size())
+        throw std::runtime_error("Trying to release unknown mosaic buffer");
+
+    buffers_[frame.bufferIdx_]->busy_.store(false, boost::memory_order_release);
+}
+
+StatisticsStorage MosaicRendererImpl::getStatistics() const
+{
+    return *sstorage_;
+}
+
+unsigned int MosaicRendererImpl::getHeldBuffersNum() const
+{
+    unsigned int nHeld = 0;
+    for (auto &b : buffers_)
+        if (b->busy_.load(boost::memory_order_acquire))
+            nHeld++;
+    return nHeld;
+}
+
+#pragma mark - private
+void MosaicRendererImpl::allocateBuffers(unsigned int nBuffers)
+{
+    if (nBuffers == 0)
+        throw std::runtime_error("Mosaic must have at least one swap buffer");
+
+    buffers_.clear();
+    for (unsigned int i = 0; i < nBuffers; ++i)
+    {
+        boost::shared_ptr<OutputBuffer> buffer = boost::make_shared<OutputBuffer>();
+        // buffer is cleared on first compose, as its' layout version is 0
+        buffer->i420_.resize(width_ * height_ * 3 / 2);
+        if (format_ == IExternalPlanarRenderer::kNV12)
+            buffer->nv12_.resize(width_ * height_ * 3 / 2);
+        buffers_.push_back(buffer);
+    }
+    next_ = 0;
+}
+
+int MosaicRendererImpl::acquireBuffer()
+{
+    unsigned int start = next_.load(boost::memory_order_relaxed);
+
+    for (unsigned int i = 0; i < buffers_.size(); ++i)
+    {
+        unsigned int idx = (start + i) % buffers_.size();
+        bool expected = false;
+
+        if (buffers_[idx]->busy_.compare_exchange_strong(expected, true,
+                                                          boost::memory_order_acquire))
+        {
+            next_.store(idx + 1, boost::memory_order_relaxed);
+            return idx;
+        }
+    }
+
+    return -1;
+}
+
+void MosaicRendererImpl::runJobs(const std::vector<boost::function<void(void)>> &jobs)
+{
+    if (jobs.size() == 0)
+        return;
+
+    {
+        boost::lock_guard<boost::mutex> scopedLock(jobsMutex_);
+        nPendingJobs_ = jobs.size();
+    }
+
+    for (auto &job : jobs)
+        workIo_.post([this, job]() {
+            job();
+
+            boost::lock_guard<boost::mutex> scopedLock(jobsMutex_);
+            if (--nPendingJobs_ == 0)
+                jobsDone_.notify_one();
+        });
+
+    boost::unique_lock<boost::mutex> lock(jobsMutex_);
+    jobsDone_.wait(lock, [this]() { return nPendingJobs_ == 0; });
+}
+
+void MosaicRendererImpl::clearRect(OutputBuffer &buffer, const MosaicRenderer::Tile &rect) const
+{
+    uint8_t *y = buffer.i420_.data();
+    uint8_t *u = y + width_ * height_;
+    uint8_t *v = u + (width_ / 2) * (height_ / 2);
+
+    libyuv::I420Rect(y, width_, u, width_ / 2, v, width_ / 2,
+                     rect.x_, rect.y_, rect.width_, rect.height_,
+                     BlackY, BlackUV, BlackUV);
+}
+
+void MosaicRendererImpl::drawTile(OutputBuffer &buffer, const MosaicRenderer::Tile &rect,
+                                  const PlanarFrame &frame) const
+{
+    if (frame.width_ <= 0 || frame.height_ <= 0)
+        return;
+
+    // fit frame into the tile, preserving aspect ratio
+    double scale = std::min((double)rect.width_ / frame.width_,
+                            (double)rect.height_ / frame.height_);
+    int w = std::max(2, (int)(frame.width_ * scale) & ~1);
+    int h = std::max(2, (int)(frame.height_ * scale) & ~1);
+    int x = rect.x_ + (((rect.width_ - w) / 2) & ~1);
+    int y = rect.y_ + (((rect.height_ - h) / 2) & ~1);
+
+    if (w != rect.width_ || h != rect.height_)
+        clearRect(buffer, rect);
+
+    uint8_t *dstY = buffer.i420_.data();
+    uint8_t *dstU = dstY + width_ * height_;
+    uint8_t *dstV = dstU + (width_ / 2) * (height_ / 2);
+    int strideUV = width_ / 2;
+
+    libyuv::I420Scale(frame.planes_[0], frame.strides_[0],
+                      frame.planes_[1], frame.strides_[1],
+                      frame.planes_[2], frame.strides_[2],
+                      frame.width_, frame.height_,
+                      dstY + y * width_ + x, width_,
+                      dstU + (y / 2) * strideUV + x / 2, strideUV,
+                      dstV + (y / 2) * strideUV + x / 2, strideUV,
+                      w, h, libyuv::kFilterBilinear);
+}
+
+void MosaicRendererImpl::fillPlanarFrame(OutputBuffer &buffer, unsigned int idx,
+                                         PlanarFrame &planarFrame)
+{
+    const uint8_t *y = buffer.i420_.data();
+    const uint8_t *u = y + width_ * height_;
+    const uint8_t *v = u + (width_ / 2) * (height_ / 2);
+
+    planarFrame.bufferIdx_ = idx;
+    planarFrame.width_ = width_;
+    planarFrame.height_ = height_;
+
+    if (format_ == IExternalPlanarRenderer::kI420)
+    {
+        planarFrame.nPlanes_ = 3;
+        planarFrame.planes_[0] = y;
+        planarFrame.planes_[1] = u;
+        planarFrame.planes_[2] = v;
+        planarFrame.strides_[0] = width_;
+        planarFrame.strides_[1] = width_ / 2;
+        planarFrame.strides_[2] = width_ / 2;
+    }
+    else
+    {
+        // one conversion of the composed frame instead of one per stream
+        uint8_t *nv12Y = buffer.nv12_.data();
+        uint8_t *nv12UV = nv12Y + width_ * height_;
+
+        libyuv::I420ToNV12(y, width_, u, width_ / 2, v, width_ / 2,
+                           nv12Y, width_, nv12UV, width_,
+                           width_, height_);
+
+        planarFrame.nPlanes_ = 2;
+        planarFrame.planes_[0] = nv12Y;
+        planarFrame.planes_[1] = nv12UV;
+        planarFrame.planes_[2] = nullptr;
+        planarFrame.strides_[0] = width_;
+        planarFrame.strides_[1] = width_;
+        planarFrame.strides_[2] = 0;
+    }
+}
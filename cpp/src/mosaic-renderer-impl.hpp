@@ -0,0 +1,167 @@
+//
+// mosaic-renderer-impl.hpp
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#ifndef __mosaic_renderer_impl_h__
+#define __mosaic_renderer_impl_h__
+
+#include <map>
+#include <vector>
+#include <boost/asio.hpp>
+#include <boost/atomic.hpp>
+#include <boost/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+#include "mosaic-renderer.hpp"
+#include "ndnrtc-object.hpp"
+
+namespace ndnrtc
+{
+class Periodic;
+
+/**
+ * Tile of the mosaic. Receives decoded frames from a remote stream's
+ * decoder (no copy - frame planes point to decoder's buffer) and keeps
+ * the latest one, until it is replaced by the next frame. Frame is released
+ * back to the stream once it is replaced and no worker is scaling it.
+ * Stream's swap buffers outlive the stream until released (see
+ * RenderBufferPool), so tile may hold a frame after the stream has stopped.
+ */
+class MosaicTile : public IExternalPlanarRenderer
+{
+  public:
+    class HeldFrame
+    {
+      public:
+        HeldFrame(const PlanarFrame &frame, IRenderBufferReleaser *releaser)
+            : frame_(frame), releaser_(releaser) {}
+        ~HeldFrame() { releaser_->releaseFrame(frame_); }
+
+        PlanarFrame frame_;
+
+      private:
+        IRenderBufferReleaser *releaser_;
+    };
+
+    MosaicTile(const MosaicRenderer::Tile &rect) : rect_(rect), generation_(0) {}
+
+    PixelFormat getPixelFormat() const override { return kI420; }
+    void renderFrame(const FrameInfo &frameInfo, const PlanarFrame &frame,
+                     IRenderBufferReleaser *releaser) override;
+
+    /**
+     * Returns latest frame (if any) and its' generation - number of frames
+     * received by the tile so far.
+     */
+    boost::shared_ptr<HeldFrame> getFrame(uint64_t &generation) const;
+    void reset();
+
+    const MosaicRenderer::Tile &getRect() const { return rect_; }
+
+  private:
+    MosaicRenderer::Tile rect_;
+    mutable boost::mutex mutex_;
+    boost::shared_ptr<HeldFrame> frame_;
+    uint64_t generation_;
+};
+
+/**
+ * Output frames are composed into a pool of swap buffers, which are held by
+ * output renderer until released. Swap buffers are kept across restarts
+ * (previous output may still release them) and are re-allocated only if
+ * output's pixel format or number of swap buffers changes, once all of
+ * them have been released. Each swap buffer remembers which frame of each
+ * tile it contains, so only tiles that received new frames since the
+ * buffer was composed last time are scaled again. Tiles are scaled in
+ * parallel by a pool of worker threads; output ticks run on a separate
+ * thread.
+ */
+class MosaicRendererImpl : public NdnRtcComponent,
+                           public IRenderBufferReleaser
+{
+  public:
+    static const unsigned int DefaultSwapBuffersNum;
+
+    MosaicRendererImpl(unsigned int width, unsigned int height, unsigned int nWorkers);
+    ~MosaicRendererImpl();
+
+    IExternalPlanarRenderer *addTile(const MosaicRenderer::Tile &tile);
+    void removeTile(IExternalPlanarRenderer *tileRenderer);
+    size_t getTilesNum() const;
+
+    void start(unsigned int fps, IExternalPlanarRenderer *output);
+    void stop();
+    bool isRunning() const { return isRunning_; }
+
+    /**
+     * Composes one output frame and passes it to the output renderer.
+     * Blocks until all tiles are scaled. Called on every output tick.
+     * @param output Output renderer or nullptr (frame is discarded)
+     * @return False if all swap buffers are held by the output renderer
+     */
+    bool compose(IExternalPlanarRenderer *output);
+
+    void releaseFrame(const PlanarFrame &frame) override;
+
+    /**
+     * Number of swap buffers held by the output renderer
+     */
+    unsigned int getHeldBuffersNum() const;
+
+    unsigned int getWidth() const { return width_; }
+    unsigned int getHeight() const { return height_; }
+    unsigned int getWorkersNum() const { return nWorkers_; }
+    statistics::StatisticsStorage getStatistics() const;
+
+  private:
+    typedef struct _OutputBuffer
+    {
+        _OutputBuffer() : busy_(false), layoutVersion_(0) {}
+
+        boost::atomic<bool> busy_;
+        std::vector<uint8_t> i420_, nv12_;
+        // generation of tiles' frames this buffer contains
+        std::map<const MosaicTile *, uint64_t> generations_;
+        unsigned int layoutVersion_;
+    } OutputBuffer;
+
+    unsigned int width_, height_, nWorkers_;
+    bool isRunning_;
+    boost::shared_ptr<statistics::StatisticsStorage> sstorage_;
+
+    mutable boost::mutex tilesMutex_;
+    std::vector<boost::shared_ptr<MosaicTile>> tiles_;
+    unsigned int layoutVersion_;
+
+    IExternalPlanarRenderer *output_;
+    IExternalPlanarRenderer::PixelFormat format_;
+    std::vector<boost::shared_ptr<OutputBuffer>> buffers_;
+    boost::atomic<unsigned int> next_;
+    int composedNum_;
+
+    boost::asio::io_service workIo_, tickIo_;
+    boost::shared_ptr<boost::asio::io_service::work> workIoWork_, tickIoWork_;
+    boost::thread_group workers_;
+    boost::thread tickThread_;
+    boost::shared_ptr<Periodic> tickTimer_;
+
+    boost::mutex jobsMutex_;
+    boost::condition_variable jobsDone_;
+    unsigned int nPendingJobs_;
+
+    void allocateBuffers(unsigned int nBuffers);
+    int acquireBuffer();
+    void runJobs(const std::vector<boost::function<void(void)>> &jobs);
+
+    void clearRect(OutputBuffer &buffer, const MosaicRenderer::Tile &rect) const;
+    void drawTile(OutputBuffer &buffer, const MosaicRenderer::Tile &rect,
+                  const PlanarFrame &frame) const;
+    void fillPlanarFrame(OutputBuffer &buffer, unsigned int idx, PlanarFrame &planarFrame);
+};
+}
+
+#endif
@@ -0,0 +1,86 @@
+//
+// mosaic-renderer.cpp
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#include "mosaic-renderer.hpp"
+#include <boost/make_shared.hpp>
+
+#include "mosaic-renderer-impl.hpp"
+
+using namespace ndnrtc;
+
+//******************************************************************************
+MosaicRenderer::MosaicRenderer(unsigned int width, unsigned int height,
+	unsigned int nWorkers):
+pimpl_(boost::make_shared<MosaicRendererImpl>(width, height, nWorkers))
+{
+}
+
+MosaicRenderer::~MosaicRenderer()
+{
+	pimpl_->stop();
+}
+
+IExternalPlanarRenderer*
+MosaicRenderer::addTile(const Tile& tile)
+{
+	return pimpl_->addTile(tile);
+}
+
+std::vector<IExternalPlanarRenderer*>
+MosaicRenderer::addGrid(unsigned int nColumns, unsigned int nRows)
+{
+	std::vector<IExternalPlanarRenderer*> renderers;
+
+	if (nColumns == 0 || nRows == 0)
+		return renderers;
+
+	int tileWidth = pimpl_->getWidth()/nColumns;
+	int tileHeight = pimpl_->getHeight()/nRows;
+
+	for (unsigned int row = 0; row < nRows; ++row)
+		for (unsigned int col = 0; col < nColumns; ++col)
+			renderers.push_back(pimpl_->addTile({(int)col*tileWidth, (int)row*tileHeight,
+				tileWidth, tileHeight}));
+
+	return renderers;
+}
+
+void
+MosaicRenderer::removeTile(IExternalPlanarRenderer* tileRenderer)
+{
+	pimpl_->removeTile(tileRenderer);
+}
+
+size_t
+MosaicRenderer::getTilesNum() const
+{
+	return pimpl_->getTilesNum();
+}
+
+void
+MosaicRenderer::start(unsigned int fps, IExternalPlanarRenderer* output)
+{
+	pimpl_->start(fps, output);
+}
+
+void
+MosaicRenderer::stop()
+{
+	pimpl_->stop();
+}
+
+statistics::StatisticsStorage
+MosaicRenderer::getStatistics() const
+{
+	return pimpl_->getStatistics();
+}
+
+void
+MosaicRenderer::setLogger(boost::shared_ptr<ndnlog::new_api::Logger> logger)
+{
+	pimpl_->setLogger(logger);
+}
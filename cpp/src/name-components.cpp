@@ -69,7 +69,7 @@ NamespaceInfo::getPrefix(int filter) const
         {
             if (filter&(Thread^ThreadNT) && threadName_ != "" &&
                 streamType_ == MediaStreamParams::MediaStreamType::MediaStreamTypeVideo)
-                    prefix.append((class_ == SampleClass::Delta ? NameComponents::NameComponentDelta : NameComponents::NameComponentKey));
+                    prefix.append((class_ == SampleClass::Delta ? NameComponents::deltaComponent(temporalLayer_) : NameComponents::NameComponentKey));
             if (filter&(Sample^Thread))
                 prefix.appendSequenceNumber(sampleNo_);
 
@@ -115,7 +115,7 @@ NamespaceInfo::getSuffix(int filter) const
         if (filter&(Thread^Sample) && threadName_ != "" &&
             streamType_ == MediaStreamParams::MediaStreamType::MediaStreamTypeVideo &&
             !isMeta_)
-            suffix.append((class_ == SampleClass::Delta ? NameComponents::NameComponentDelta : NameComponents::NameComponentKey));
+            suffix.append((class_ == SampleClass::Delta ? NameComponents::deltaComponent(temporalLayer_) : NameComponents::NameComponentKey));
         if (filter&(Sample^Segment))
         {
             if (isMeta_)
@@ -162,6 +162,12 @@ NameComponents::ndnrtcSuffix()
     return Name(NameComponentApp).appendVersion(nameApiVersion());
 }
 
+string
+NameComponents::deltaComponent(unsigned int temporalLayer)
+{
+    return (temporalLayer ? NameComponentDelta + to_string(temporalLayer) : NameComponentDelta);
+}
+
 Name
 NameComponents::streamPrefix(MediaStreamParams::MediaStreamType type, std::string basePrefix)
 {
@@ -203,6 +209,19 @@ bool extractMeta(const ndn::Name& name, NamespaceInfo& info)
     return false;
 }
 
+bool extractDeltaLayer(const ndn::Name::Component& c, unsigned int& layer)
+{
+    std::string str = c.toEscapedString();
+    const std::string& d = NameComponents::NameComponentDelta;
+
+    if (str.compare(0, d.size(), d) != 0 || str.size() > d.size() + 2 ||
+        str.find_first_not_of("0123456789", d.size()) != std::string::npos)
+        return false;
+
+    layer = (str.size() > d.size() ? (unsigned int)std::stoul(str.substr(d.size())) : 0);
+    return true;
+}
+
 bool extractVideoStreamInfo(const ndn::Name& name, NamespaceInfo& info)
 {
     if (name.size() == 1)
@@ -252,10 +271,10 @@ bool extractVideoStreamInfo(const ndn::Name& name, NamespaceInfo& info)
             return true;
         }
 
-        if (name[idx-1] == Name::Component(NameComponents::NameComponentDelta) || 
+        if (extractDeltaLayer(name[idx-1], info.temporalLayer_) || 
             name[idx-1] == Name::Component(NameComponents::NameComponentKey))
         {
-            info.isDelta_ = (name[idx-1] == Name::Component(NameComponents::NameComponentDelta));
+            info.isDelta_ = (name[idx-1] != Name::Component(NameComponents::NameComponentKey));
             info.class_ = (info.isDelta_ ? SampleClass::Delta : SampleClass::Key);
 
             try{
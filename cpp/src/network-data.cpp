@@ -7,37 +7,152 @@
 
 #include "network-data.hpp"
 
+#include <algorithm>
+#include <boost/make_shared.hpp>
+#include <boost/thread/lock_guard.hpp>
 #include <ndn-cpp/data.hpp>
 #include <ndn-cpp/interest.hpp>
 #include "fec.hpp"
+#include "digest-engine.hpp"
 
 using namespace ndnrtc;
 using namespace std;
 
+namespace {
+// walks blobs table of a data packet (see DataPacketT for wire format)
+// without copying; returns last blob (header) and beginning of the payload
+bool readBlobs(const uint8_t *begin, const uint8_t *end,
+               const uint8_t *&lastBlob, size_t &lastBlobSize,
+               const uint8_t *&payload)
+{
+    if (begin == end)
+        return false;
+
+    uint8_t nBlobs = *begin;
+    const uint8_t *p = begin + 1;
+
+    lastBlob = nullptr;
+    lastBlobSize = 0;
+    for (int i = 0; i < nBlobs; i++)
+    {
+        if (end - p < 2)
+            return false;
+
+        uint16_t blobSize = p[0] | ((uint16_t)p[1]) << 8;
+        p += 2;
+
+        if (end - p < blobSize)
+            return false;
+
+        lastBlob = p;
+        lastBlobSize = blobSize;
+        p += blobSize;
+    }
+
+    payload = p;
+    return true;
+}
+
+// reads V2 segment prefix and returns segment header, packet header (if 
+// present) and beginning of the payload; all offsets are fixed, so this is
+// just a bounds check
+bool readSegmentV2(const uint8_t *begin, const uint8_t *end,
+                   const uint8_t *&header, size_t &headerSize,
+                   const uint8_t *&packetHeader, size_t &packetHeaderSize,
+                   const uint8_t *&payload)
+{
+    if ((size_t)(end - begin) < sizeof(SegmentPrefixV2))
+        return false;
+
+    const SegmentPrefixV2 *prefix = (const SegmentPrefixV2 *)begin;
+    if (prefix->format_ != (uint8_t)WireFormat::V2)
+        return false;
+
+    bool hasPacketHeader = prefix->flags_ & SegmentFlagPacketHeader;
+    size_t headersSize = prefix->headerSize_ + (hasPacketHeader ? sizeof(CommonHeader) : 0);
+
+    if ((size_t)(end - begin) < sizeof(SegmentPrefixV2) + headersSize)
+        return false;
+
+    header = begin + sizeof(SegmentPrefixV2);
+    headerSize = prefix->headerSize_;
+    packetHeader = (hasPacketHeader ? header + headerSize : nullptr);
+    packetHeaderSize = (hasPacketHeader ? sizeof(CommonHeader) : 0);
+    payload = header + headersSize;
+
+    return true;
+}
+}
+
+WireFormat ndnrtc::wireFormat(unsigned int apiVersion)
+{
+    if (apiVersion == WireFormatV2ApiVersion)
+        return WireFormat::V2;
+    if (apiVersion == WireFormatV1ApiVersion)
+        return WireFormat::V1;
+    return WireFormat::Unknown;
+}
+
 //******************************************************************************
-Manifest::Manifest(const std::vector<boost::shared_ptr<const ndn::Data>> &dataObjects)
-    : DataPacket(std::vector<uint8_t>())
+namespace
+{
+// implicit digests (SHA-256 of wire encoding) of all data objects, in one
+// batch; data objects that have been encoded already (i.e. by the publisher)
+// are not re-encoded
+void implicitDigests(const std::vector<boost::shared_ptr<const ndn::Data>> &dataObjects,
+                     std::vector<DigestEngine::Digest> &digests)
 {
+    std::vector<ndn::SignedBlob> encodings;
+    std::vector<DigestEngine::Buffer> buffers;
+
+    encodings.reserve(dataObjects.size());
     for (auto &d : dataObjects)
     {
-        ndn::Blob digest = (*d->getFullName())[-1].getValue();
-        addBlob(digest.size(), digest.buf());
+        encodings.push_back(d->wireEncode());
+        buffers.push_back(DigestEngine::Buffer({encodings.back().buf(), encodings.back().size()}));
     }
+
+    DigestEngine::sha256(buffers, digests);
+}
+}
+
+Manifest::Manifest(const std::vector<boost::shared_ptr<const ndn::Data>> &dataObjects)
+    : DataPacket(std::vector<uint8_t>())
+{
+    std::vector<DigestEngine::Digest> digests;
+
+    implicitDigests(dataObjects, digests);
+    for (auto &digest : digests)
+        addBlob(digest.size(), digest.data());
 }
 
 Manifest::Manifest(NetworkData &&nd) : DataPacket(boost::move(nd)) {}
 
 bool Manifest::hasData(const ndn::Data &data) const
 {
-    ndn::Blob digest = (*data.getFullName())[-1].getValue();
+    return hasData(std::vector<boost::shared_ptr<const ndn::Data>>(
+        1, boost::shared_ptr<const ndn::Data>(&data, [](const ndn::Data *) {})));
+}
+
+bool Manifest::hasData(const std::vector<boost::shared_ptr<const ndn::Data>> &dataObjects) const
+{
+    std::vector<DigestEngine::Digest> digests, manifestDigests;
 
     for (int i = 0; i < getBlobsNum(); ++i)
-    {
-        ndn::Blob b(getBlob(i).data(), getBlob(i).size());
-        if (b.equals(digest))
-            return true;
-    }
-    return false;
+        if (getBlob(i).size() == DigestEngine::DigestSize)
+        {
+            manifestDigests.push_back(DigestEngine::Digest());
+            std::copy(getBlob(i).data(), getBlob(i).data() + DigestEngine::DigestSize,
+                      manifestDigests.back().begin());
+        }
+    std::sort(manifestDigests.begin(), manifestDigests.end());
+
+    implicitDigests(dataObjects, digests);
+    for (auto &digest : digests)
+        if (!std::binary_search(manifestDigests.begin(), manifestDigests.end(), digest))
+            return false;
+
+    return true;
 }
 
 //******************************************************************************
@@ -78,6 +193,8 @@ AudioThreadMeta::getCodec() const
 }
 
 //******************************************************************************
+const size_t VideoThreadMeta::LegacyMetaSize;
+
 VideoThreadMeta::VideoThreadMeta(double rate, PacketNumber deltaSeqNo, PacketNumber keySeqNo,
                                  unsigned char gopPos, const FrameSegmentsInfo &segInfo, const VideoCoderParams &coder)
     : DataPacket(std::vector<uint8_t>())
@@ -85,13 +202,16 @@ VideoThreadMeta::VideoThreadMeta(double rate, PacketNumber deltaSeqNo, PacketNum
     Meta m({rate, deltaSeqNo, keySeqNo, gopPos,
             coder.gop_, coder.startBitrate_, coder.encodeWidth_, coder.encodeHeight_,
             segInfo.deltaAvgSegNum_, segInfo.deltaAvgParitySegNum_,
-            segInfo.keyAvgSegNum_, segInfo.keyAvgParitySegNum_});
-    addBlob(sizeof(m), (uint8_t *)&m);
+            segInfo.keyAvgSegNum_, segInfo.keyAvgParitySegNum_,
+            (unsigned char)coder.temporalLayers_});
+    // temporal layers are published only if there is more than one
+    addBlob((m.temporalLayers_ > 1 ? sizeof(m) : LegacyMetaSize), (uint8_t *)&m);
 }
 
 VideoThreadMeta::VideoThreadMeta(NetworkData &&data) : DataPacket(boost::move(data))
 {
-    isValid_ = (blobs_.size() == 1 && blobs_[0].size() == sizeof(Meta));
+    isValid_ = (blobs_.size() == 1 &&
+                (blobs_[0].size() == sizeof(Meta) || blobs_[0].size() == LegacyMetaSize));
 }
 
 double VideoThreadMeta::getRate() const
@@ -127,6 +247,7 @@ VideoCoderParams VideoThreadMeta::getCoderParams() const
     c.startBitrate_ = m->bitrate_;
     c.encodeWidth_ = m->width_;
     c.encodeHeight_ = m->height_;
+    c.temporalLayers_ = (blobs_[0].size() == sizeof(Meta) ? m->temporalLayers_ : 1);
     return c;
 }
 
@@ -199,9 +320,10 @@ MediaStreamMeta::getStreamTimestamp() const
 WireSegment::WireSegment(const boost::shared_ptr<ndn::Data> &data,
                          const boost::shared_ptr<const ndn::Interest> &interest)
     : data_(data), interest_(interest),
-      isValid_(NameComponents::extractInfo(data->getName(), dataNameInfo_))
+      isValid_(NameComponents::extractInfo(data->getName(), dataNameInfo_)),
+      isParsed_(false)
 {
-    if (dataNameInfo_.apiVersion_ != NameComponents::nameApiVersion())
+    if (wireFormat(dataNameInfo_.apiVersion_) == WireFormat::Unknown)
     {
         std::stringstream ss;
         ss << "Attempt to create wired data object with "
@@ -215,9 +337,10 @@ WireSegment::WireSegment(const boost::shared_ptr<ndn::Data> &data,
 WireSegment::WireSegment(const NamespaceInfo &info,
                          const boost::shared_ptr<ndn::Data> &data,
                          const boost::shared_ptr<const ndn::Interest> &interest)
-    : dataNameInfo_(info), data_(data), interest_(interest), isValid_(true)
+    : dataNameInfo_(info), data_(data), interest_(interest), isValid_(true),
+      isParsed_(false)
 {
-    if (dataNameInfo_.apiVersion_ != NameComponents::nameApiVersion())
+    if (wireFormat(dataNameInfo_.apiVersion_) == WireFormat::Unknown)
     {
         std::stringstream ss;
         ss << "Attempt to create wired data object with "
@@ -227,35 +350,53 @@ WireSegment::WireSegment(const NamespaceInfo &info,
 }
 
 WireSegment::WireSegment(const WireSegment &data) : data_(data.data_),
-                                                    dataNameInfo_(data.dataNameInfo_), isValid_(data.isValid_) {}
+                                                    dataNameInfo_(data.dataNameInfo_), isValid_(data.isValid_),
+                                                    isParsed_(false) {}
 
 size_t WireSegment::getSlicesNum() const
 {
     return data_->getMetaInfo().getFinalBlockId().toSegment() + 1;
 }
 
-const DataSegmentHeader
+const DataSegmentHeader &
 WireSegment::header() const
 {
-    // this cast will be invalid for VideoFrameSegment packets,
-    // still casting to DataSegmentHeader is possible, because
-    // it's a parent class for VideoFrameSegmentHeader
-    ImmutableHeaderPacket<DataSegmentHeader> s(data_->getContent());
-    return s.getHeader();
+    // this cast is valid for VideoFrameSegment packets too,
+    // because DataSegmentHeader is a parent class for VideoFrameSegmentHeader
+    if (view().headerSize_ < sizeof(DataSegmentHeader))
+        throw std::runtime_error("Segment header is missing or malformed");
+
+    return *((const DataSegmentHeader *)view().header_);
 }
 
-const CommonHeader
+const CommonHeader &
 WireSegment::packetHeader() const
 {
     if (getSegNo())
         throw std::runtime_error("Accessing packet header in "
                                  "non-zero segment is not allowed");
 
-    ImmutableHeaderPacket<DataSegmentHeader> s0(data_->getContent());
-    boost::shared_ptr<std::vector<uint8_t>> data(boost::make_shared<std::vector<uint8_t>>(s0.getPayload().begin(),
-                                                                                          s0.getPayload().end()));
-    ImmutableHeaderPacket<CommonHeader> p0(data);
-    return p0.getHeader();
+    if (view().packetHeaderSize_ < sizeof(CommonHeader))
+        throw std::runtime_error("Packet header is missing or malformed");
+
+    return *((const CommonHeader *)view().packetHeader_);
+}
+
+const ImmutableDataPacket::Blob
+WireSegment::getPayload() const
+{
+    return ImmutableDataPacket::Blob(view().payloadBegin_, view().payloadEnd_);
+}
+
+WireFormat
+WireSegment::getWireFormat() const
+{
+    if (dataNameInfo_.isMeta_ ||
+        (dataNameInfo_.segmentClass_ != SegmentClass::Data &&
+         dataNameInfo_.segmentClass_ != SegmentClass::Parity))
+        return WireFormat::V1;
+
+    return wireFormat(dataNameInfo_.apiVersion_);
 }
 
 bool WireSegment::isOriginal() const
@@ -277,3 +418,69 @@ WireSegment::getSegmentWeight() const
 {
     return (dataNameInfo_.isParity_ ? fec::parityWeight() : 1);
 }
+
+const WireSegment::SegmentView &
+WireSegment::view() const
+{
+    if (!isParsed_.load(boost::memory_order_acquire))
+    {
+        boost::lock_guard<boost::mutex> scopedLock(parseMutex_);
+        if (!isParsed_.load(boost::memory_order_relaxed))
+        {
+            parse();
+            isParsed_.store(true, boost::memory_order_release);
+        }
+    }
+
+    return view_;
+}
+
+#pragma mark - private
+void WireSegment::parse() const
+{
+    view_.content_ = data_->getContent();
+    if (!view_.content_)
+        view_.content_ = boost::make_shared<std::vector<uint8_t>>();
+
+    const std::vector<uint8_t> &content = *view_.content_;
+    const uint8_t *begin = content.data(), *end = content.data() + content.size();
+    const uint8_t *payload = nullptr;
+    bool isValid = false;
+
+    view_.payloadBegin_ = view_.payloadEnd_ = content.end();
+
+    if (getWireFormat() == WireFormat::V2)
+        isValid = readSegmentV2(begin, end, view_.header_, view_.headerSize_,
+                                view_.packetHeader_, view_.packetHeaderSize_, payload);
+    else
+    {
+        isValid = readBlobs(begin, end, view_.header_, view_.headerSize_, payload);
+
+        // packet header is the last blob of the packet, which blobs table is
+        // at the beginning of segment 0 payload
+        if (isValid && isPacketHeaderSegment())
+        {
+            const uint8_t *packetPayload = nullptr;
+            if (!readBlobs(payload, end, view_.packetHeader_,
+                           view_.packetHeaderSize_, packetPayload))
+            {
+                view_.packetHeader_ = nullptr;
+                view_.packetHeaderSize_ = 0;
+            }
+        }
+    }
+
+    if (isValid)
+    {
+        view_.payloadBegin_ = content.begin() + (payload - begin);
+
+        if (view_.headerSize_ >= HeaderTraits<VideoFrameSegmentHeader>::minSize() &&
+            view_.headerSize_ < sizeof(VideoFrameSegmentHeader))
+            memcpy(&view_.extendedHeader_, view_.header_, view_.headerSize_);
+    }
+    else
+    {
+        view_.header_ = view_.packetHeader_ = nullptr;
+        view_.headerSize_ = view_.packetHeaderSize_ = 0;
+    }
+}
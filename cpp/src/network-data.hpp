@@ -7,9 +7,12 @@
 #ifndef __network_data_hpp__
 #define __network_data_hpp__
 
+#include <boost/atomic.hpp>
 #include <boost/crc.hpp>
+#include <boost/make_shared.hpp>
 #include <boost/move/move.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
 #include <boost/type_traits.hpp>
 #include <boost/utility/enable_if.hpp>
 #include <ndn-cpp/data.hpp>
@@ -25,6 +28,7 @@ class Data;
 
 namespace ndnrtc
 {
+class ObjectPool;
 
 struct Mutable
 {
@@ -409,6 +413,20 @@ typedef DataPacketT<Immutable> ImmutableDataPacket;
 typedef DataPacketT<> DataPacket;
 
 //******************************************************************************
+/**
+ * Headers may be extended with optional trailing fields. Such header is
+ * published without the extension if extension fields have default values,
+ * so consumers which don't know about the extension can still read it.
+ * Headers not shorter than minSize() are accepted, missing trailing fields
+ * keep their default values.
+ */
+template <typename Header>
+struct HeaderTraits
+{
+    static size_t minSize() { return sizeof(Header); }
+    static size_t wireSize(const Header &) { return sizeof(Header); }
+};
+
 /**
  * HeaderPacket extends DataPacket class by adding functionality for a header 
  * which is usually a structure.
@@ -425,8 +443,10 @@ class HeaderPacketT : public DataPacketT<T>
     HeaderPacketT(const boost::shared_ptr<const std::vector<uint8_t>> &data) : DataPacketT<T>(data)
     {
         isHeaderSet_ = this->isValid_ && (this->blobs_.size() >= 1) &&
-                       (this->blobs_.back().size() == sizeof(Header));
+                       isHeaderSizeValid(this->blobs_.back().size());
         this->isValid_ = isHeaderSet_;
+        if (isHeaderSet_)
+            extendHeader();
     }
 
     ENABLE_IF(T, Mutable)
@@ -450,8 +470,10 @@ class HeaderPacketT : public DataPacketT<T>
     {
         if (this->blobs_.size() > 0)
         {
-            this->isValid_ = (this->blobs_.back().size() == sizeof(Header));
+            this->isValid_ = isHeaderSizeValid(this->blobs_.back().size());
             isHeaderSet_ = true;
+            if (this->isValid_)
+                extendHeader();
         }
     }
 
@@ -460,9 +482,10 @@ class HeaderPacketT : public DataPacketT<T>
     {
         if (!isHeaderSet_)
         {
-            this->addBlob(sizeof(header), (uint8_t *)&header);
+            this->addBlob(HeaderTraits<Header>::wireSize(header), (uint8_t *)&header);
             this->isValid_ = true;
             isHeaderSet_ = true;
+            extendHeader();
         }
         else
             throw std::runtime_error("Sample header has been already "
@@ -471,6 +494,8 @@ class HeaderPacketT : public DataPacketT<T>
 
     const Header &getHeader() const
     {
+        if (extendedHeader_)
+            return *extendedHeader_;
         return *((Header *)this->blobs_.back().data());
     }
 
@@ -478,6 +503,7 @@ class HeaderPacketT : public DataPacketT<T>
     {
         DataPacketT<T>::swap((DataPacketT<T> &)packet);
         std::swap(isHeaderSet_, packet.isHeaderSet_);
+        extendedHeader_.swap(packet.extendedHeader_);
     }
 
   protected:
@@ -489,10 +515,30 @@ class HeaderPacketT : public DataPacketT<T>
         this->payloadBegin_ = this->_data().begin() + 1;
         this->blobs_.clear();
         isHeaderSet_ = false;
+        extendedHeader_.reset();
     }
 
   private:
     bool isHeaderSet_;
+    // copy of header published without optional trailing fields
+    boost::shared_ptr<Header> extendedHeader_;
+
+    static bool isHeaderSizeValid(size_t size)
+    {
+        return size >= HeaderTraits<Header>::minSize() && size <= sizeof(Header);
+    }
+
+    void extendHeader()
+    {
+        const DataPacket::Blob &b = this->blobs_.back();
+        if (b.size() < sizeof(Header))
+        {
+            extendedHeader_ = boost::make_shared<Header>();
+            memcpy(extendedHeader_.get(), b.data(), b.size());
+        }
+        else
+            extendedHeader_.reset();
+    }
 };
 
 template <typename Header>
@@ -535,11 +581,70 @@ typedef struct _VideoFrameSegmentHeader : public DataSegmentHeader // goes into
     PacketNumber playbackNo_;
     PacketNumber pairedSequenceNo_;
     int paritySegmentsNum_;
+    // optional extension, published only if thread has temporal layers
+    unsigned char temporalLayer_;     // temporal (SVC) layer of the frame
+    unsigned char temporalLayersNum_; // number of temporal layers in thread
 
     _VideoFrameSegmentHeader() : totalSegmentsNum_(0), playbackNo_(0),
-                                 pairedSequenceNo_(0), paritySegmentsNum_(0) {}
+                                 pairedSequenceNo_(0), paritySegmentsNum_(0),
+                                 temporalLayer_(0), temporalLayersNum_(1) {}
 } __attribute__((packed)) VideoFrameSegmentHeader;
 
+template <>
+struct HeaderTraits<VideoFrameSegmentHeader>
+{
+    static size_t minSize() { return sizeof(VideoFrameSegmentHeader) - 2 * sizeof(unsigned char); }
+    static size_t wireSize(const VideoFrameSegmentHeader &h)
+    {
+        return (h.temporalLayersNum_ > 1 ? sizeof(VideoFrameSegmentHeader) : minSize());
+    }
+};
+
+/*******************************************************************************
+ * Wire format of sample (data and parity) segments.
+ * V1: segment header is stored as the only blob of a data packet:
+ *
+ *      <1><header_size_byte0><header_size_byte1><header><payload>
+ *
+ * V2: segment header is stored at fixed offset after a fixed-size prefix.
+ * Segment 0 of a sample also carries a copy of the sample's CommonHeader
+ * right after segment header (SegmentFlagPacketHeader is set), so both 
+ * headers can be read in place after a single bounds check:
+ *
+ *      <SegmentPrefixV2><header>[<CommonHeader>]<payload>
+ *
+ * Prefix takes as many bytes as V1 blob overhead, so segment payload lengths
+ * are the same for both formats. Format is selected by the namespace API
+ * version of the segment name. Metadata and manifests are always V1.
+ */
+enum class WireFormat
+{
+    Unknown = 0,
+    V1 = 1,
+    V2 = 2
+};
+
+// namespace API versions which use corresponding wire format
+static const unsigned int WireFormatV1ApiVersion = 3;
+static const unsigned int WireFormatV2ApiVersion = 4;
+
+WireFormat wireFormat(unsigned int apiVersion = NameComponents::nameApiVersion());
+
+enum SegmentFlag
+{
+    SegmentFlagPacketHeader = 1 << 0
+};
+
+typedef struct _SegmentPrefixV2
+{
+    uint8_t format_;     // WireFormat::V2
+    uint8_t flags_;      // SegmentFlag bits
+    uint8_t headerSize_; // size of segment header
+} __attribute__((packed)) SegmentPrefixV2;
+
+static_assert(sizeof(SegmentPrefixV2) == 3,
+              "V2 segment prefix must be the same size as V1 header blob overhead");
+
 //******************************************************************************
 /**
  * This is a manifest data packet for (video) samples but can be used for an 
@@ -558,6 +663,13 @@ class Manifest : public DataPacket
           */
     bool hasData(const ndn::Data &data) const;
 
+    /**
+          * Checks whether all given data objects are part of this manifest.
+          * Digests of all objects are computed in one batch, which is faster
+          * than checking objects one by one
+          */
+    bool hasData(const std::vector<boost::shared_ptr<const ndn::Data>> &dataObjects) const;
+
     /**
           * Returns total number of data objects described by this manifest
           */
@@ -601,7 +713,11 @@ class VideoThreadMeta : public DataPacket
         unsigned int width_, height_; // pixels
         double deltaAvgSegNum_, deltaAvgParitySegNum_;
         double keyAvgSegNum_, keyAvgParitySegNum_;
+        unsigned char temporalLayers_; // optional extension
     } __attribute__((packed)) Meta;
+
+    // size of meta published without the extension
+    static const size_t LegacyMetaSize = sizeof(Meta) - sizeof(unsigned char);
 };
 
 class MediaStreamMeta : public DataPacket
@@ -671,20 +787,36 @@ class WireSegment
     const NamespaceInfo &getInfo() const { return dataNameInfo_; }
 
     /**
-     * Retrieves segment header from data
+     * Retrieves segment header from data.
+     * Segment content is parsed only once, on first access to header(),
+     * packetHeader() or getPayload(). Subsequent calls return references
+     * into the cached view and do not copy.
      * @return DataSegmentHeader
+     * @throws std::runtime_error if segment has no header
      */
-    const DataSegmentHeader header() const;
+    const DataSegmentHeader &header() const;
 
     /**
      * Retrieves packet header from data only if it's a segment 0 
      * (getSegNo() == 0) because only segment 0 contains packet header.
-     * Operation is expensive as it copies data into temporary storage.
-     * One may prefer to extract this information after the whole packet
-     * was assembled.
      * @return CommonHeader
+     * @throws std::runtime_error if segment is not segment 0 or packet 
+     *          header can not be found
      */
-    const CommonHeader packetHeader() const;
+    const CommonHeader &packetHeader() const;
+
+    /**
+     * Returns segment payload (content without blobs table and segment 
+     * header). Payload references segment's data and is valid as long as
+     * this segment exists.
+     */
+    const ImmutableDataPacket::Blob getPayload() const;
+
+    /**
+     * Returns wire format of this segment content.
+     * @see WireFormat
+     */
+    WireFormat getWireFormat() const;
 
     /**
      * Indicates, whether current packet was retrieved with the interest
@@ -695,12 +827,32 @@ class WireSegment
     bool isOriginal() const;
 
     // method implementation in frame-data.cpp
+    // if pool is provided, segment is allocated from it
     static boost::shared_ptr<WireSegment>
     createSegment(const NamespaceInfo &namespaceInfo,
                   const boost::shared_ptr<ndn::Data> &data,
-                  const boost::shared_ptr<const ndn::Interest> &interest);
+                  const boost::shared_ptr<const ndn::Interest> &interest,
+                  const boost::shared_ptr<ObjectPool> &pool = boost::shared_ptr<ObjectPool>());
 
   protected:
+    /**
+     * Parsed layout of the segment content. All pointers and iterators
+     * point into content_, which is shared with data_. Video segment header
+     * published without optional trailing fields is copied into
+     * extendedHeader_, so missing fields keep their default values.
+     */
+    typedef struct _SegmentView
+    {
+        boost::shared_ptr<const std::vector<uint8_t>> content_;
+        const uint8_t *header_, *packetHeader_;
+        size_t headerSize_, packetHeaderSize_;
+        std::vector<uint8_t>::const_iterator payloadBegin_, payloadEnd_;
+        VideoFrameSegmentHeader extendedHeader_;
+
+        _SegmentView() : header_(nullptr), packetHeader_(nullptr),
+                         headerSize_(0), packetHeaderSize_(0) {}
+    } SegmentView;
+
     NamespaceInfo dataNameInfo_;
     bool isValid_;
     boost::shared_ptr<ndn::Data> data_;
@@ -709,6 +861,16 @@ class WireSegment
     WireSegment(const NamespaceInfo &info,
                 const boost::shared_ptr<ndn::Data> &data,
                 const boost::shared_ptr<const ndn::Interest> &interest);
+
+    // parses segment content on first call
+    const SegmentView &view() const;
+
+  private:
+    mutable boost::atomic<bool> isParsed_;
+    mutable boost::mutex parseMutex_;
+    mutable SegmentView view_;
+
+    void parse() const;
 };
 
 template <typename SegmentHeader>
@@ -719,17 +881,46 @@ class WireData : public WireSegment
              const boost::shared_ptr<const ndn::Interest> &interest) : WireSegment(data, interest) {}
     WireData(const WireData<SegmentHeader> &data) : WireSegment(data) {}
 
+    /**
+     * Constructs header packet from segment content. This parses content 
+     * every time it's called and is valid for WireFormat::V1 segments only -
+     * prefer getHeader() and getPayload().
+     */
     const ImmutableHeaderPacket<SegmentHeader> segment() const
     {
         return ImmutableHeaderPacket<SegmentHeader>(data_->getContent());
     }
 
+    /**
+     * Returns segment header from the cached segment view. Header published
+     * without optional trailing fields is returned from the copy made when
+     * segment was parsed, missing fields keep their default values.
+     * @throws std::runtime_error if segment header is shorter than 
+     *          HeaderTraits<SegmentHeader>::minSize()
+     * @see HeaderTraits
+     */
+    const SegmentHeader &getHeader() const
+    {
+        const SegmentView &v = view();
+
+        if (v.headerSize_ >= sizeof(SegmentHeader))
+            return *((const SegmentHeader *)v.header_);
+        if (v.headerSize_ < HeaderTraits<SegmentHeader>::minSize())
+            throw std::runtime_error("Segment header is missing or malformed");
+
+        // only video segment headers have optional fields
+        static_assert(sizeof(SegmentHeader) <= sizeof(VideoFrameSegmentHeader),
+                      "Segment header does not fit segment view");
+        return *((const SegmentHeader *)&v.extendedHeader_);
+    }
+
     PacketNumber getPlaybackNo() const
     {
         return playbackNo();
     }
 
   private:
+    friend class ObjectPool;
     friend boost::shared_ptr<WireData<SegmentHeader>>
     boost::make_shared<WireData<SegmentHeader>>(const ndnrtc::NamespaceInfo &,
                                                 const boost::shared_ptr<ndn::Data> &,
@@ -748,7 +939,7 @@ class WireData : public WireSegment
     ENABLE_IF(SegmentHeader, _VideoFrameSegmentHeader)
     PacketNumber playbackNo(ENABLE_FOR(_VideoFrameSegmentHeader)) const
     {
-        return segment().getHeader().playbackNo_;
+        return getHeader().playbackNo_;
     }
 };
 
@@ -0,0 +1,70 @@
+//
+// object-pool.cpp
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#include "object-pool.hpp"
+
+#include <boost/thread/lock_guard.hpp>
+
+using namespace ndnrtc;
+
+const size_t ObjectPool::MaxFreeBlocks = 2048;
+
+ObjectPool::ObjectPool() : nHeapAllocations_(0)
+{
+}
+
+ObjectPool::~ObjectPool()
+{
+    for (auto &it : freeBlocks_)
+        for (auto &b : it.second)
+            ::operator delete(b);
+}
+
+void *ObjectPool::allocate(size_t size)
+{
+    {
+        boost::lock_guard<boost::mutex> scopedLock(mutex_);
+        std::vector<void *> &blocks = freeBlocks_[size];
+
+        if (blocks.size())
+        {
+            void *block = blocks.back();
+            blocks.pop_back();
+            return block;
+        }
+
+        nHeapAllocations_++;
+    }
+
+    return ::operator new(size);
+}
+
+void ObjectPool::deallocate(void *block, size_t size)
+{
+    {
+        boost::lock_guard<boost::mutex> scopedLock(mutex_);
+        std::vector<void *> &blocks = freeBlocks_[size];
+
+        if (blocks.size() < MaxFreeBlocks)
+        {
+            blocks.push_back(block);
+            return;
+        }
+    }
+
+    ::operator delete(block);
+}
+
+size_t ObjectPool::getFreeBlocksNum() const
+{
+    boost::lock_guard<boost::mutex> scopedLock(mutex_);
+    size_t n = 0;
+
+    for (auto &it : freeBlocks_)
+        n += it.second.size();
+    return n;
+}
@@ -0,0 +1,135 @@
+//
+// object-pool.hpp
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#ifndef __object_pool_h__
+#define __object_pool_h__
+
+#include <map>
+#include <new>
+#include <vector>
+#include <boost/enable_shared_from_this.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
+namespace ndnrtc
+{
+/**
+ * Per-stream pool of memory blocks for objects allocated on the consumer's
+ * fetching path for every segment (WireSegment, Interest) together with
+ * their shared_ptr control blocks. Released blocks are kept in free lists
+ * per block size (up to MaxFreeBlocks per size) and handed out again, so
+ * in steady state a stream does not go to the heap for these objects.
+ * Objects are released on any thread (playout, decode), so pool is
+ * thread-safe. Objects keep their pool alive and may outlive the stream.
+ * Pool must be created with make_shared.
+ */
+class ObjectPool : public boost::enable_shared_from_this<ObjectPool>
+{
+  public:
+    static const size_t MaxFreeBlocks;
+
+    /**
+     * Allocator over the pool, for shared_ptr control blocks and containers.
+     */
+    template <typename T>
+    class Allocator
+    {
+      public:
+        typedef T value_type;
+        typedef T *pointer;
+        typedef const T *const_pointer;
+        typedef T &reference;
+        typedef const T &const_reference;
+        typedef size_t size_type;
+        typedef ptrdiff_t difference_type;
+
+        template <typename U>
+        struct rebind
+        {
+            typedef Allocator<U> other;
+        };
+
+        Allocator(const boost::shared_ptr<ObjectPool> &pool) : pool_(pool) {}
+        template <typename U>
+        Allocator(const Allocator<U> &other) : pool_(other.pool_) {}
+
+        T *allocate(size_t n) { return (T *)pool_->allocate(n * sizeof(T)); }
+        void deallocate(T *p, size_t n) { pool_->deallocate(p, n * sizeof(T)); }
+
+        template <typename U>
+        bool operator==(const Allocator<U> &other) const { return pool_ == other.pool_; }
+        template <typename U>
+        bool operator!=(const Allocator<U> &other) const { return pool_ != other.pool_; }
+
+      private:
+        template <typename U>
+        friend class Allocator;
+
+        boost::shared_ptr<ObjectPool> pool_;
+    };
+
+    ObjectPool();
+    ~ObjectPool();
+
+    /**
+     * Constructs object in pool's memory. Both the object and its' shared_ptr
+     * control block are returned to the pool when last reference is gone.
+     * Classes with non-public constructors should befriend ObjectPool.
+     */
+    template <typename T, typename... Args>
+    boost::shared_ptr<T> make(Args &&... args)
+    {
+        boost::shared_ptr<ObjectPool> me = shared_from_this();
+        void *block = allocate(sizeof(T));
+        T *object = nullptr;
+
+        try
+        {
+            object = new (block) T(std::forward<Args>(args)...);
+        }
+        catch (...)
+        {
+            deallocate(block, sizeof(T));
+            throw;
+        }
+
+        return boost::shared_ptr<T>(object, Deleter<T>(me), Allocator<T>(me));
+    }
+
+    void *allocate(size_t size);
+    void deallocate(void *block, size_t size);
+
+    // number of blocks available for re-use
+    size_t getFreeBlocksNum() const;
+    // number of blocks allocated on the heap so far
+    size_t getHeapAllocationsNum() const { return nHeapAllocations_; }
+
+  private:
+    template <typename T>
+    class Deleter
+    {
+      public:
+        Deleter(const boost::shared_ptr<ObjectPool> &pool) : pool_(pool) {}
+        void operator()(T *object)
+        {
+            object->~T();
+            pool_->deallocate(object, sizeof(T));
+        }
+
+      private:
+        boost::shared_ptr<ObjectPool> pool_;
+    };
+
+    ObjectPool(const ObjectPool &) = delete;
+
+    mutable boost::mutex mutex_;
+    std::map<size_t, std::vector<void *>> freeBlocks_;
+    size_t nHeapAllocations_;
+};
+}
+
+#endif
@@ -20,6 +20,8 @@
 #include "frame-data.hpp"
 #include "ndnrtc-object.hpp"
 #include "statistics.hpp"
+#include "frame-trace.hpp"
+#include "ring-content-cache.hpp"
 
 #define ADD_CRC 0
 // this number defines iteration when publisher will
@@ -57,7 +59,7 @@ template <typename KeyChain, typename MemoryCache>
 struct _PublisherSettings
 {
     _PublisherSettings() : keyChain_(nullptr), memoryCache_(nullptr),
-                           statStorage_(nullptr) {}
+                           statStorage_(nullptr), wireFormat_(WireFormat::V1) {}
 
     KeyChain *keyChain_;
     MemoryCache *memoryCache_;
@@ -66,9 +68,12 @@ struct _PublisherSettings
     size_t segmentWireLength_;
     unsigned int freshnessPeriodMs_;
     bool sign_ = true;
+    WireFormat wireFormat_; // format of published segments
 };
 
 typedef _PublisherSettings<ndn::KeyChain, ndn::MemoryContentCache> PublisherSettings;
+// settings for local streams' publishers, which use bounded producer cache
+typedef _PublisherSettings<ndn::KeyChain, RingContentCache> StreamPublisherSettings;
 
 template <typename SegmentType, typename Settings>
 class PacketPublisher : public NdnRtcComponent
@@ -89,7 +94,7 @@ class PacketPublisher : public NdnRtcComponent
         // we don't care of bytes that will be saved in this memory, so allocate it
         // as shared_ptr so it's released automatically upon completion
         boost::shared_ptr<uint8_t[]> dummyHeader(new uint8_t[SegmentType::headerSize()]);
-        memset(dummyHeader.get(), SegmentType::headerSize(), 0);
+        memset(dummyHeader.get(), 0, SegmentType::headerSize());
         return publish(name, data, (_DataSegmentHeader &)*dummyHeader.get(),
                        freshnessMs, forcePitClean, banPitClean);
     }
@@ -99,7 +104,16 @@ class PacketPublisher : public NdnRtcComponent
                                    bool forcePitClean = false, bool banPitClean = false)
     {
         PublishedDataPtrVector ndnSegments;
-        std::vector<SegmentType> segments = SegmentType::slice(data, settings_.segmentWireLength_);
+
+        // sample packets carry CommonHeader, which goes into segment 0 in V2 format
+        const CommonSamplePacket *samplePacket = dynamic_cast<const CommonSamplePacket *>(&data);
+        const CommonHeader *packetHeader = (samplePacket && samplePacket->isValid() ? &samplePacket->getHeader() : nullptr);
+
+        // all segments reserve room for packet header, so that data and parity
+        // payloads have equal length of FEC symbol
+        std::vector<SegmentType> segments =
+            SegmentType::slice(data, settings_.segmentWireLength_,
+                               SegmentType::packetHeaderReserve(settings_.wireFormat_));
         LogTraceC << "sliced into " << segments.size() << " segments" << std::endl;
 
         commonHeader.interestNonce_ = 0;
@@ -120,22 +134,31 @@ class PacketPublisher : public NdnRtcComponent
             checkForPendingInterests(segmentName, commonHeader);
             segment.setHeader(commonHeader);
 
-            boost::shared_ptr<MutableNetworkData> segmentData = segment.getNetworkData();
+            boost::shared_ptr<MutableNetworkData> segmentData =
+                segment.getNetworkData(settings_.wireFormat_, (segIdx == 0 ? packetHeader : nullptr));
             boost::shared_ptr<ndn::Data> ndnSegment(boost::make_shared<ndn::Data>(segmentName));
             ndnSegment->getMetaInfo().setFreshnessPeriod(freshnessMs);
             ndnSegment->getMetaInfo().setFinalBlockId(ndn::Name::Component::fromSegment(segments.size() - 1));
-            ndnSegment->setContent(segmentData->getData(), segment.size());
-            sign(ndnSegment);
-            settings_.memoryCache_->add(*ndnSegment);
+            ndnSegment->setContent(segmentData->getData(), segmentData->getLength());
+            {
+                FrameTraceStep(Sign);
+                sign(ndnSegment);
+            }
+            // encode once, cached copy keeps the encoding
+            size_t wireSize = ndnSegment->wireEncode().size();
+            {
+                FrameTraceStep(Cache);
+                settings_.memoryCache_->add(*ndnSegment);
+            }
             ++segIdx;
             ndnSegments.push_back(ndnSegment);
 
             (*settings_.statStorage_)[statistics::Indicator::BytesPublished] += ndnSegment->getContent().size();
-            (*settings_.statStorage_)[statistics::Indicator::RawBytesPublished] += ndnSegment->getDefaultWireEncoding().size();
+            (*settings_.statStorage_)[statistics::Indicator::RawBytesPublished] += wireSize;
 
             LogTraceC << "cached " << segmentName << " ("
                       << ndnSegment->getContent().size() << "b payload, "
-                      << ndnSegment->getDefaultWireEncoding().size() << "b wire, "
+                      << wireSize << "b wire, "
                       << ndnSegment->getMetaInfo().getFreshnessPeriod() << "ms fp)"
                       << std::endl;
         }
@@ -165,6 +188,8 @@ class PacketPublisher : public NdnRtcComponent
             commonHeader.interestNonce_ = *(uint32_t *)(pendingInterests.back()->getInterest()->getNonce().buf());
             commonHeader.interestArrivalMs_ = pendingInterests.back()->getTimeoutPeriodStart();
             commonHeader.generationDelayMs_ = ndn_getNowMilliseconds() - pendingInterests.back()->getTimeoutPeriodStart();
+            FrameTraceInstantAt(InterestArrival, -1,
+                                (int64_t)(pendingInterests.back()->getTimeoutPeriodStart()*1000));
 
             (*settings_.statStorage_)[statistics::Indicator::InterestsReceivedNum] += pendingInterests.size();
 
@@ -272,6 +297,8 @@ class PacketPublisher : public NdnRtcComponent
 
 typedef PacketPublisher<VideoFrameSegment, PublisherSettings> VideoPacketPublisher;
 typedef PacketPublisher<CommonSegment, PublisherSettings> CommonPacketPublisher;
+typedef PacketPublisher<VideoFrameSegment, StreamPublisherSettings> VideoStreamPublisher;
+typedef PacketPublisher<CommonSegment, StreamPublisherSettings> CommonStreamPublisher;
 }
 
 #endif
@@ -209,7 +209,7 @@ FrameFetcherImpl::fetchGopKey(const boost::shared_ptr<const SlotSegment>& deltaS
     const shared_ptr<WireData<VideoFrameSegmentHeader>> videoFrameSegment = 
         dynamic_pointer_cast<WireData<VideoFrameSegmentHeader>>(deltaSegment->getData());
     
-    PacketNumber keyFrameNumber = videoFrameSegment->segment().getHeader().pairedSequenceNo_;
+    PacketNumber keyFrameNumber = videoFrameSegment->getHeader().pairedSequenceNo_;
     Name keyFrameName = frameNameInfo_.getPrefix(prefix_filter::ThreadNT)
                                       .append(NameComponents::NameComponentKey)
                                       .appendSequenceNumber(keyFrameNumber);
@@ -259,7 +259,7 @@ FrameFetcherImpl::fetchGopDelta(const boost::shared_ptr<const SlotSegment>& segm
 {
     const shared_ptr<WireData<VideoFrameSegmentHeader>> videoFrameSegment = 
         dynamic_pointer_cast<WireData<VideoFrameSegmentHeader>>(segment->getData());
-    PacketNumber firstGopDeltaNumber = videoFrameSegment->segment().getHeader().pairedSequenceNo_;
+    PacketNumber firstGopDeltaNumber = videoFrameSegment->getHeader().pairedSequenceNo_;
 
     // check, how many delta frames we need to fetch
     int deltasToFetch = frameNameInfo_.sampleNo_ - firstGopDeltaNumber;
@@ -109,6 +109,7 @@ class ReceivedMetadataProcessing
                                                            SampleClass::Key, SegmentClass::Parity);
 
             ctrl->interestControl_->initialize(metadata->getRate(), pipelineInitial);
+            ctrl->pipeliner_->setTemporalLayers(metadata->getCoderParams().temporalLayers_);
             ctrl->pipeliner_->setSequenceNumber(deltaToFetch, SampleClass::Delta);
             ctrl->pipeliner_->setSequenceNumber(keyToFetch, SampleClass::Key);
             ctrl->pipeliner_->setNeedSample(SampleClass::Key);
@@ -325,9 +326,9 @@ class BootstrappingT : public PipelineControlState,
 
         boost::shared_ptr<const WireData<VideoFrameSegmentHeader>> videoFrameSegment =
             boost::dynamic_pointer_cast<const WireData<VideoFrameSegmentHeader>>(seg);
-        ImmutableHeaderPacket<VideoFrameSegmentHeader> segmentPacket = videoFrameSegment->segment();
-        PacketNumber currentDeltaSeqNo = seg->isDelta() ? seg->getSampleNo() : segmentPacket.getHeader().pairedSequenceNo_ ;
-        PacketNumber currentKeySeqNo = seg->isDelta() ? segmentPacket.getHeader().pairedSequenceNo_ : seg->getSampleNo() ;
+        const VideoFrameSegmentHeader &segmentHeader = videoFrameSegment->getHeader();
+        PacketNumber currentDeltaSeqNo = seg->isDelta() ? seg->getSampleNo() : segmentHeader.pairedSequenceNo_ ;
+        PacketNumber currentKeySeqNo = seg->isDelta() ? segmentHeader.pairedSequenceNo_ : seg->getSampleNo() ;
 
         return (currentDeltaSeqNo >= startOffDeltaSeqNo) && (currentKeySeqNo >= startOffKeySeqNo);
     }
@@ -351,9 +352,9 @@ class BootstrappingT : public PipelineControlState,
     {
         boost::shared_ptr<const WireData<VideoFrameSegmentHeader>> videoFrameSegment =
             boost::dynamic_pointer_cast<const WireData<VideoFrameSegmentHeader>>(seg);
-        ImmutableHeaderPacket<VideoFrameSegmentHeader> segmentPacket = videoFrameSegment->segment();
+        const VideoFrameSegmentHeader &segmentHeader = videoFrameSegment->getHeader();
 
-        PacketNumber currentDeltaSeqNo = seg->isDelta() ? seg->getSampleNo() : segmentPacket.getHeader().pairedSequenceNo_;
+        PacketNumber currentDeltaSeqNo = seg->isDelta() ? seg->getSampleNo() : segmentHeader.pairedSequenceNo_;
 
         return (int)((double)(currentDeltaSeqNo -
             ReceivedMetadataProcessing<MetadataClass>::getBootstrapSequenceNumber().first) * metadata_->getRate());
@@ -405,7 +406,7 @@ class SeedBootstrapping : public PipelineControlState {
                 boost::dynamic_pointer_cast<const WireData<VideoFrameSegmentHeader>>(ev->getSegment());
 
             ctrl_->pipeliner_->setSequenceNumber(videoFrameSegment->getSampleNo()+1, SampleClass::Key);
-            ctrl_->pipeliner_->setSequenceNumber(videoFrameSegment->segment().getHeader().pairedSequenceNo_, SampleClass::Delta);
+            ctrl_->pipeliner_->setSequenceNumber(videoFrameSegment->getHeader().pairedSequenceNo_, SampleClass::Delta);
             //ctrl_->pipeliner_->setNeedSample(SampleClass::Delta);
             ctrl_->pipeliner_->fillUpPipeline(ctrl_->threadPrefix_);
             ctrl_->playoutControl_->allowPlayout(true, 0);
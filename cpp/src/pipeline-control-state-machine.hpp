@@ -164,7 +164,7 @@ class PipelineControlStateMachine : public NdnRtcComponent
     {
         _Struct(const ndn::Name threadPrefix) : threadPrefix_(threadPrefix) {}
 
-        const ndn::Name threadPrefix_;
+        ndn::Name threadPrefix_;
         boost::shared_ptr<DrdEstimator> drdEstimator_;
         boost::shared_ptr<IBuffer> buffer_;
         boost::shared_ptr<IPipeliner> pipeliner_;
@@ -179,6 +179,9 @@ class PipelineControlStateMachine : public NdnRtcComponent
 
     std::string getState() const;
     boost::shared_ptr<PipelineControlState> currentState() const { return currentState_; }
+    // not thread-safe! should be called on the same thread as dispatch(...)
+    void setThreadPrefix(const ndn::Name &threadPrefix) { ppCtrl_->threadPrefix_ = threadPrefix; }
+    ndn::Name getThreadPrefix() const { return ppCtrl_->threadPrefix_; }
     void dispatch(const boost::shared_ptr<const PipelineControlEvent> &ev);
 
     // not thread-safe! should be called on the same thread as dispatch(...)
@@ -150,6 +150,57 @@ void PipelineControl::segmentStarvation()
     machine_.dispatch(boost::make_shared<PipelineControlEvent>(PipelineControlEvent::Start));
 }
 
+void PipelineControl::switchThread(const ndn::Name &threadPrefix, const VideoThreadMeta &meta,
+                                   boost::function<void(const ndn::Name &)> onSwitched)
+{
+    if (machine_.currentState()->toInt() < PipelineControlState::Adjusting)
+    {
+        // not fetching frames yet - simply bootstrap from the new thread
+        LogInfoC << "switching to " << threadPrefix << " before bootstrapping completed" << std::endl;
+
+        stop();
+        machine_.setThreadPrefix(threadPrefix);
+        start();
+        onSwitched(threadPrefix);
+        return;
+    }
+
+    int gop = meta.getCoderParams().gop_;
+    int gopPos = meta.getGopPos();
+    PacketNumber keySeqNo = meta.getSeqNo().second + 1;
+    PacketNumber deltaSeqNo = meta.getSeqNo().first + gop - gopPos;
+
+    // estimate sequence number of the current thread's delta that precedes
+    // next key frame: everything requested above latest produced frame is
+    // still outstanding
+    PacketNumber nextDeltaSeqNo = pipeliner_->getSequenceNumber(SampleClass::Delta);
+    PacketNumber switchDeltaSeqNo = nextDeltaSeqNo - interestControl_->pipelineSize() + gop - gopPos - 1;
+
+    // current thread has been already requested past the boundary -
+    // switch at the next one
+    while (switchDeltaSeqNo < nextDeltaSeqNo)
+    {
+        switchDeltaSeqNo += gop - 1;
+        deltaSeqNo += gop - 1;
+        keySeqNo++;
+    }
+
+    LogInfoC << "switch to " << threadPrefix << " at key " << keySeqNo
+             << " (current thread delta " << switchDeltaSeqNo << ")" << std::endl;
+
+    // pipeliner may outlive pipeline control
+    boost::weak_ptr<PipelineControl> me = boost::dynamic_pointer_cast<PipelineControl>(shared_from_this());
+    pipeliner_->switchThread(threadPrefix, switchDeltaSeqNo, keySeqNo, deltaSeqNo,
+                             [me, onSwitched](const ndn::Name &prefix) {
+                                 boost::shared_ptr<PipelineControl> ppc = me.lock();
+                                 if (ppc)
+                                 {
+                                     ppc->machine_.setThreadPrefix(prefix);
+                                     onSwitched(prefix);
+                                 }
+                             });
+}
+
 bool PipelineControl::needPipelineAdjustment(const PipelineAdjust &cmd)
 {
     if (cmd == PipelineAdjust::IncreasePipeline ||
@@ -31,6 +31,7 @@ class IPlayoutControl;
 class IBuffer;
 class PipelineControlStateMachine;
 class SampleEstimator;
+class VideoThreadMeta;
 template <typename T>
 class NetworkDataT;
 typedef NetworkDataT<Mutable> NetworkDataAlias;
@@ -60,6 +61,19 @@ class PipelineControl : public NdnRtcComponent,
                      const boost::shared_ptr<const ndn::Interest> &);
     void segmentStarvation();
 
+    /**
+     * Switches fetching to another video thread at the next key frame
+     * boundary of the new thread that has not been requested yet. Frames of
+     * the current thread are fetched until this boundary, so playback is not
+     * interrupted.
+     * @param threadPrefix Prefix of the thread to switch to
+     * @param meta Latest metadata of the thread to switch to
+     * @param onSwitched Called once pipeline starts requesting new thread
+     */
+    void switchThread(const ndn::Name &threadPrefix, const VideoThreadMeta &meta,
+                      boost::function<void(const ndn::Name &)> onSwitched);
+    ndn::Name getThreadPrefix() const { return machine_.getThreadPrefix(); }
+
     bool needPipelineAdjustment(const PipelineAdjust &);
     void setLogger(boost::shared_ptr<ndnlog::new_api::Logger> logger);
 
@@ -9,6 +9,7 @@
 //
 
 #include "pipeliner.hpp"
+#include <algorithm>
 #include <ndn-cpp/exclude.hpp>
 
 #include "sample-estimator.hpp"
@@ -17,6 +18,7 @@
 #include "interest-queue.hpp"
 #include "segment-controller.hpp"
 #include "statistics.hpp"
+#include "clock.hpp"
 
 using namespace ndnrtc;
 using namespace ndnrtc::statistics;
@@ -32,10 +34,14 @@ interestQueue_(settings.interestQueue_),
 playbackQueue_(settings.playbackQueue_),
 segmentController_(settings.segmentController_),
 interestLifetime_(settings.interestLifetimeMs_),
+interestTemplate_(settings.interestLifetimeMs_, settings.objectPool_),
 sstorage_(settings.sstorage_),
 seqCounter_({0,0}),
-nextSamplePriority_(SampleClass::Delta)
+nextSamplePriority_(SampleClass::Delta),
+parityOnDemand_(false),
+maxTemporalLayer_(TemporalLayers::MaxLayers-1)
 {
+    threadSwitch_.pending_ = false;
     assert(sstorage_.get());
     
     description_ = "pipeliner";
@@ -59,13 +65,13 @@ Pipeliner::expressBootstrap(const ndn::Name& threadPrefix)
 void
 Pipeliner::express(const ndn::Name& threadPrefix, bool placeInBuffer)
 {
-    Name n = nameScheme_->samplePrefix(threadPrefix, nextSamplePriority_);
-    n.appendSequenceNumber((nextSamplePriority_ == SampleClass::Delta ? seqCounter_.delta_ : seqCounter_.key_));
+    PacketNumber seqNo = nextSequenceNumber(nextSamplePriority_);
+    Name n(getSamplePrefix(threadPrefix, nextSamplePriority_));
+    n.appendSequenceNumber(seqNo);
     
     const std::vector<boost::shared_ptr<const Interest>> batch = getBatch(n, nextSamplePriority_);
     
-    LogDebugC << "sample "
-        << (nextSamplePriority_ == SampleClass::Delta ? seqCounter_.delta_ : seqCounter_.key_) 
+    LogDebugC << "sample " << seqNo
         << " " << SAMPLE_SUFFIX(n) << " batch size " << batch.size() << std::endl;
     request(batch, DeadlinePriority::fromNow(0));
     if (placeInBuffer) buffer_->requested(batch);
@@ -89,11 +95,16 @@ Pipeliner::fillUpPipeline(const ndn::Name& threadPrefix)
             << " sample(s) will be requested"
             << std::endl;
     
+    Name prefix(threadPrefix);
+
     while (interestControl_->room() > 0)
     {
-        Name n = nameScheme_->samplePrefix(threadPrefix, nextSamplePriority_);
-        n.appendSequenceNumber((nextSamplePriority_ == SampleClass::Delta ?
-                                seqCounter_.delta_ : seqCounter_.key_));
+        if (threadSwitch_.pending_ && seqCounter_.delta_ >= threadSwitch_.switchDeltaSeqNo_)
+            commitThreadSwitch(prefix);
+
+        PacketNumber seqNo = nextSequenceNumber(nextSamplePriority_);
+        Name n(getSamplePrefix(prefix, nextSamplePriority_));
+        n.appendSequenceNumber(seqNo);
 
         const std::vector<boost::shared_ptr<const Interest>> batch = getBatch(n, nextSamplePriority_);
         int64_t deadline = playbackQueue_->size()+playbackQueue_->pendingSize();
@@ -102,8 +113,7 @@ Pipeliner::fillUpPipeline(const ndn::Name& threadPrefix)
         buffer_->requested(batch);
         interestControl_->increment();
 
-        LogDebugC << "requested "
-            << (nextSamplePriority_ == SampleClass::Delta ? seqCounter_.delta_ : seqCounter_.key_)
+        LogDebugC << "requested " << seqNo
             << " " << SAMPLE_SUFFIX(n) << " x" << batch.size() << std::endl;
         
         if (nextSamplePriority_ == SampleClass::Delta) seqCounter_.delta_++;
@@ -123,6 +133,86 @@ Pipeliner::reset()
     LogInfoC << "reset" << std::endl;
 
     nextSamplePriority_ = SampleClass::Delta;
+    parityRequested_.clear();
+
+    if (threadSwitch_.pending_)
+    {
+        // fetching will be re-bootstrapped anyway, so switch right away
+        threadSwitch_.pending_ = false;
+        if (threadSwitch_.onSwitched_)
+            threadSwitch_.onSwitched_(threadSwitch_.threadPrefix_);
+    }
+}
+
+void
+Pipeliner::switchThread(const ndn::Name& threadPrefix, PacketNumber switchDeltaSeqNo,
+    PacketNumber keySeqNo, PacketNumber deltaSeqNo,
+    boost::function<void(const ndn::Name&)> onSwitched)
+{
+    threadSwitch_.pending_ = true;
+    threadSwitch_.threadPrefix_ = threadPrefix;
+    threadSwitch_.switchDeltaSeqNo_ = switchDeltaSeqNo;
+    threadSwitch_.keySeqNo_ = keySeqNo;
+    threadSwitch_.deltaSeqNo_ = deltaSeqNo;
+    threadSwitch_.onSwitched_ = onSwitched;
+
+    LogInfoC << "scheduled switch to " << threadPrefix
+             << " after delta " << switchDeltaSeqNo - 1
+             << " (key " << keySeqNo << ", delta " << deltaSeqNo << ")" << std::endl;
+}
+
+void
+Pipeliner::setInterestLifetime(unsigned int lifetimeMs)
+{
+    interestLifetime_ = lifetimeMs;
+    interestTemplate_.setLifetime(lifetimeMs);
+}
+
+void
+Pipeliner::setParityOnDemand(bool onDemand)
+{
+    parityOnDemand_ = onDemand;
+    parityRequested_.clear();
+
+    LogInfoC << "parity " << (onDemand ? "on demand" : "always") << std::endl;
+}
+
+void
+Pipeliner::setTemporalLayers(unsigned int nLayers)
+{
+    layers_ = TemporalLayers(nLayers);
+    LogInfoC << "temporal layers " << layers_.getLayersNum() << std::endl;
+}
+
+void
+Pipeliner::setMaxTemporalLayer(unsigned int maxLayer)
+{
+    maxTemporalLayer_ = std::min(maxLayer, TemporalLayers::MaxLayers-1);
+    LogInfoC << "max temporal layer " << maxTemporalLayer_ << std::endl;
+}
+
+void
+Pipeliner::segmentRequestTimeout(const NamespaceInfo& info,
+                                 const boost::shared_ptr<const ndn::Interest>& interest)
+{
+    // fast path: don't wait for retransmission deadline, request parity
+    // right after first data segment timeout
+    if (parityOnDemand_)
+        requestParity(info);
+}
+
+void
+Pipeliner::onRetransmissionRequired(const std::vector<boost::shared_ptr<const ndn::Interest>>& interests)
+{
+    if (!parityOnDemand_)
+        return;
+
+    for (auto& i:interests)
+    {
+        NamespaceInfo info;
+        if (NameComponents::extractInfo(i->getName(), info))
+            requestParity(info);
+    }
 }
 
 void 
@@ -168,32 +258,131 @@ Pipeliner::getBatch(Name n, SampleClass cls, bool noParity) const
     std::vector<boost::shared_ptr<const Interest>> interests;
     unsigned int nData = sampleEstimator_->getSegmentNumberEstimation(cls, SegmentClass::Data);
 
-    for (int segNo = 0; segNo < nData; ++segNo)
+    interestTemplate_.makeInterests(n, nData, false, interests);
+    if (!noParity && !parityOnDemand_)
     {
-        Name iname(n);
-        iname.appendSegment(segNo);
-        
-        boost::shared_ptr<Interest> i = boost::make_shared<Interest>(iname, interestLifetime_);
-        i->setMustBeFresh(false);
-        interests.push_back(i);
+        const std::vector<boost::shared_ptr<const Interest>> parity = getParityBatch(n, cls);
+        interests.insert(interests.end(), parity.begin(), parity.end());
+    }
+
+    return interests;
+}
+
+std::vector<boost::shared_ptr<const Interest>>
+Pipeliner::getParityBatch(Name n, SampleClass cls) const
+{
+    std::vector<boost::shared_ptr<const Interest>> interests;
+    unsigned int nParity = sampleEstimator_->getSegmentNumberEstimation(cls, SegmentClass::Parity);
+
+    interestTemplate_.makeInterests(n, nParity, true, interests);
+    (*sstorage_)[Indicator::ParityRequestedNum] += interests.size();
+
+    return interests;
+}
+
+const Name&
+Pipeliner::getSamplePrefix(const Name& threadPrefix, SampleClass cls)
+{
+    if (samplePrefixes_.threadPrefix_.size() == 0 ||
+        !threadPrefix.equals(samplePrefixes_.threadPrefix_))
+    {
+        samplePrefixes_.threadPrefix_ = threadPrefix;
+        samplePrefixes_.delta_[0] = nameScheme_->samplePrefix(threadPrefix, SampleClass::Delta);
+        samplePrefixes_.key_ = nameScheme_->samplePrefix(threadPrefix, SampleClass::Key);
+
+        for (unsigned int l = 1; l < TemporalLayers::MaxLayers; ++l)
+            samplePrefixes_.delta_[l] = samplePrefixes_.delta_[0].getPrefix(-1)
+                .append(NameComponents::deltaComponent(l));
     }
 
-    if (!noParity)
+    if (cls == SampleClass::Delta)
+        return samplePrefixes_.delta_[layers_.getDeltaLayer(seqCounter_.delta_)];
+    return samplePrefixes_.key_;
+}
+
+PacketNumber
+Pipeliner::nextSequenceNumber(SampleClass cls)
+{
+    if (cls != SampleClass::Delta)
+        return seqCounter_.key_;
+
+    // skip delta frames of temporal layers which are not fetched
+    PacketNumber seqNo = layers_.nextDelta(seqCounter_.delta_, maxTemporalLayer_);
+
+    if (seqNo != seqCounter_.delta_)
+    {
+        LogTraceC << "skipping " << seqNo - seqCounter_.delta_
+            << " upper layer frame(s) from " << seqCounter_.delta_ << std::endl;
+        (*sstorage_)[Indicator::LayerSkippedNum] += (seqNo - seqCounter_.delta_);
+        seqCounter_.delta_ = seqNo;
+    }
+
+    return seqNo;
+}
+
+void
+Pipeliner::commitThreadSwitch(ndn::Name& threadPrefix)
+{
+    // current thread's key frame that was requested ahead belongs to the
+    // switching point or later - it won't be needed
+    if (seqCounter_.key_ > 0)
     {
-        n.append(NameComponents::NameComponentParity);
-        unsigned int nParity = sampleEstimator_->getSegmentNumberEstimation(cls, SegmentClass::Parity);
-        for (int segNo = 0; segNo < nParity; ++segNo)
+        Name keyPrefix = nameScheme_->samplePrefix(threadPrefix, SampleClass::Key);
+        keyPrefix.appendSequenceNumber(seqCounter_.key_ - 1);
+
+        bool noData = (buffer_->getSlotsNum(keyPrefix, BufferSlot::New) > 0);
+        if (buffer_->cancel(keyPrefix))
         {
-            Name iname(n);
-            iname.appendSegment(segNo);
-            
-            boost::shared_ptr<Interest> i = boost::make_shared<Interest>(iname, interestLifetime_);
-            i->setMustBeFresh(false);
-            interests.push_back(i);
+            LogDebugC << "cancelled pending key " << keyPrefix << std::endl;
+            if (noData) interestControl_->decrement();
         }
     }
 
-    return interests;
+    LogInfoC << "switching to " << threadSwitch_.threadPrefix_
+             << " (key " << threadSwitch_.keySeqNo_ << ")" << std::endl;
+
+    threadPrefix = threadSwitch_.threadPrefix_;
+    seqCounter_.key_ = threadSwitch_.keySeqNo_;
+    seqCounter_.delta_ = threadSwitch_.deltaSeqNo_;
+    nextSamplePriority_ = SampleClass::Key;
+    threadSwitch_.pending_ = false;
+
+    if (threadSwitch_.onSwitched_)
+        threadSwitch_.onSwitched_(threadPrefix);
+}
+
+void
+Pipeliner::requestParity(const NamespaceInfo& info)
+{
+    if (info.segmentClass_ != SegmentClass::Data ||
+        (info.class_ != SampleClass::Key && info.class_ != SampleClass::Delta))
+        return;
+
+    int64_t now = clock::millisecondTimestamp();
+    Name samplePrefix = info.getPrefix(prefix_filter::Sample);
+
+    // forget samples which can't be pending anymore
+    for (auto it = parityRequested_.begin(); it != parityRequested_.end(); /* no increment */)
+        if (now - it->second > 2*interestLifetime_) parityRequested_.erase(it++);
+        else ++it;
+
+    // parity requested already or sample has been assembled, played out or
+    // dropped already
+    if (parityRequested_.find(samplePrefix) != parityRequested_.end() ||
+        buffer_->getSlotsNum(samplePrefix, BufferSlot::New|BufferSlot::Assembling) == 0)
+        return;
+
+    const std::vector<boost::shared_ptr<const Interest>> batch = getParityBatch(samplePrefix, info.class_);
+    parityRequested_[samplePrefix] = now;
+
+    if (batch.size())
+    {
+        LogDebugC << "requesting " << batch.size() << " parity segments for "
+            << info.getSuffix(suffix_filter::Thread) << std::endl;
+
+        request(batch, DeadlinePriority::fromNow(0));
+        buffer_->requested(batch);
+    }
 }
 
 // IBufferObserver
@@ -204,14 +393,13 @@ void Pipeliner::onNewRequest(const boost::shared_ptr<BufferSlot>&)
 
 void Pipeliner::onNewData(const BufferReceipt& receipt)
 {
+    if (receipt.segment_->getInfo().segmentClass_ == SegmentClass::Parity)
+        (*sstorage_)[Indicator::ParityFetchedNum]++;
+
     // check for missing segments
     std::vector<boost::shared_ptr<const Interest>> interests;
     for (auto& n:receipt.slot_->getMissingSegments())
-    {
-        boost::shared_ptr<Interest> i = boost::make_shared<Interest>(n, interestLifetime_);
-        i->setMustBeFresh(false);
-        interests.push_back(i);
-    }
+        interests.push_back(interestTemplate_.makeInterest(n));
 
     if (interests.size())
     {
@@ -12,10 +12,15 @@
 #define __ndnrtc__pipeliner__
 
 #include <boost/thread/mutex.hpp>
+#include <boost/function.hpp>
 
 #include "ndnrtc-object.hpp"
 #include "name-components.hpp"
 #include "frame-buffer.hpp"
+#include "segment-controller.hpp"
+#include "rtx-controller.hpp"
+#include "interest-template.hpp"
+#include "temporal-layers.hpp"
 
 namespace ndnrtc {
     namespace statistics {
@@ -29,6 +34,7 @@ namespace ndnrtc {
     class IPlaybackQueue;
     class ISegmentController;
     class DeadlinePriority;
+    class ObjectPool;
 
     typedef struct _PipelinerSettings {
         unsigned int interestLifetimeMs_;
@@ -39,6 +45,8 @@ namespace ndnrtc {
         boost::shared_ptr<IPlaybackQueue> playbackQueue_;
         boost::shared_ptr<ISegmentController> segmentController_;
         boost::shared_ptr<statistics::StatisticsStorage> sstorage_;
+        // optional, Interests are allocated from it if set
+        boost::shared_ptr<ObjectPool> objectPool_;
     } PipelinerSettings;
 
     class IPipeliner {
@@ -54,6 +62,10 @@ namespace ndnrtc {
         virtual void setSequenceNumber(PacketNumber seqNo, SampleClass cls) = 0;
         virtual PacketNumber getSequenceNumber(SampleClass cls) = 0;
         virtual void setInterestLifetime(unsigned int lifetimeMs) = 0;
+        virtual void switchThread(const ndn::Name& threadPrefix, PacketNumber switchDeltaSeqNo,
+            PacketNumber keySeqNo, PacketNumber deltaSeqNo,
+            boost::function<void(const ndn::Name&)> onSwitched) = 0;
+        virtual void setTemporalLayers(unsigned int nLayers) = 0;
     };
 
     /**
@@ -61,9 +73,18 @@ namespace ndnrtc {
      * samples of specified media thread.
      * Pipeliner queries SampleEstimator in order to calculate size of Interest
      * batch to express.
+     * By default, parity segments are requested together with data segments.
+     * In on-demand parity mode, only data segments are requested and parity
+     * segments of a sample are requested once any of its data segments times
+     * out or sample misses retransmission deadline (for this, pipeliner must
+     * be attached to SegmentController and RetransmissionController).
+     * For threads encoded with temporal layers, pipeliner can be limited to
+     * fetch lower layers only - delta frames of upper layers are skipped
+     * and never requested.
      */
     class Pipeliner : public NdnRtcComponent, public IPipeliner,
-                    public IBufferObserver
+                    public IBufferObserver, public ISegmentControllerObserver,
+                    public IRtxObserver
     {
     public:
         class INameScheme;
@@ -144,7 +165,59 @@ namespace ndnrtc {
          */
         PacketNumber getSequenceNumber(SampleClass cls);
 
-        void setInterestLifetime(unsigned int lifetimeMs) {  interestLifetime_ = lifetimeMs; }
+        void setInterestLifetime(unsigned int lifetimeMs);
+
+        /**
+         * Enables or disables on-demand parity fetching. When enabled, parity
+         * segments are not requested with sample's batch, but only when
+         * data segments of the sample are lost.
+         */
+        void setParityOnDemand(bool onDemand);
+        bool isParityOnDemand() const { return parityOnDemand_; }
+
+        /**
+         * Sets number of temporal layers of the thread being fetched (as
+         * announced in thread metadata).
+         */
+        void setTemporalLayers(unsigned int nLayers);
+        /**
+         * Sets highest temporal layer to fetch. Delta frames of higher
+         * layers are not requested. By default, all layers are fetched.
+         */
+        void setMaxTemporalLayer(unsigned int maxLayer);
+        unsigned int getMaxTemporalLayer() const { return maxTemporalLayer_; }
+
+        // ISegmentControllerObserver
+        void segmentArrived(const boost::shared_ptr<WireSegment> &){}
+        void segmentRequestTimeout(const NamespaceInfo &,
+                                   const boost::shared_ptr<const ndn::Interest> &);
+        void segmentNack(const NamespaceInfo &, int,
+                         const boost::shared_ptr<const ndn::Interest> &){}
+        void segmentStarvation(){}
+
+        // IRtxObserver
+        void onRetransmissionRequired(const std::vector<boost::shared_ptr<const ndn::Interest>>&);
+
+        /**
+         * Schedules switching to another media thread at the key frame
+         * boundary. Pipeliner keeps requesting delta frames of the current
+         * thread until delta sequence number switchDeltaSeqNo is reached.
+         * After that, it requests key frame keySeqNo of the new thread and
+         * continues with new thread's delta frames starting from deltaSeqNo.
+         * Current thread's key frame, which is still pending at this moment,
+         * is cancelled.
+         * @param threadPrefix Prefix of the thread to switch to
+         * @param switchDeltaSeqNo First delta sequence number of the current
+         *          thread which will not be requested
+         * @param keySeqNo Sequence number of the new thread's key frame
+         * @param deltaSeqNo Sequence number of the new thread's delta frame
+         *          that follows key frame keySeqNo
+         * @param onSwitched Called once pipeliner starts requesting new thread
+         */
+        void switchThread(const ndn::Name& threadPrefix, PacketNumber switchDeltaSeqNo,
+            PacketNumber keySeqNo, PacketNumber deltaSeqNo,
+            boost::function<void(const ndn::Name&)> onSwitched);
+        bool isSwitchingThread() const { return threadSwitch_.pending_; }
 
         /**
          * This class
@@ -178,6 +251,7 @@ namespace ndnrtc {
 
     private:
         unsigned int interestLifetime_;
+        InterestTemplate interestTemplate_;
         boost::shared_ptr<INameScheme> nameScheme_;
         boost::shared_ptr<SampleEstimator> sampleEstimator_;
         boost::shared_ptr<IBuffer> buffer_;
@@ -188,6 +262,24 @@ namespace ndnrtc {
         boost::shared_ptr<statistics::StatisticsStorage> sstorage_;
         SequenceCounter seqCounter_;
         SampleClass nextSamplePriority_;
+        bool parityOnDemand_;
+        TemporalLayers layers_;
+        unsigned int maxTemporalLayer_;
+        // samples for which parity was requested on demand (sample prefix ->
+        // request timestamp)
+        std::map<ndn::Name, int64_t> parityRequested_;
+        // sample prefixes of the current thread, built by name scheme once
+        // (delta prefixes are per temporal layer)
+        struct {
+            ndn::Name threadPrefix_, key_;
+            ndn::Name delta_[TemporalLayers::MaxLayers];
+        } samplePrefixes_;
+        struct {
+            bool pending_;
+            ndn::Name threadPrefix_;
+            PacketNumber switchDeltaSeqNo_, keySeqNo_, deltaSeqNo_;
+            boost::function<void(const ndn::Name&)> onSwitched_;
+        } threadSwitch_;
 
         void request(const std::vector<boost::shared_ptr<const ndn::Interest>>& interests,
             const boost::shared_ptr<DeadlinePriority>& prioirty);
@@ -196,14 +288,19 @@ namespace ndnrtc {
         
         std::vector<boost::shared_ptr<const ndn::Interest>>
         getBatch(ndn::Name n, SampleClass cls, bool noParity = false) const;
+
+        std::vector<boost::shared_ptr<const ndn::Interest>>
+        getParityBatch(ndn::Name n, SampleClass cls) const;
+
+        const ndn::Name& getSamplePrefix(const ndn::Name& threadPrefix, SampleClass cls);
+        PacketNumber nextSequenceNumber(SampleClass cls);
+        void commitThreadSwitch(ndn::Name& threadPrefix);
+        void requestParity(const NamespaceInfo& info);
         
         // IBufferObserver
         void onNewRequest(const boost::shared_ptr<BufferSlot>&);
         void onNewData(const BufferReceipt& receipt);
-        void onReset(){}
-
-        // IRtxObserver
-        void onRetransmissionRequired(const std::vector<boost::shared_ptr<const ndn::Interest>>&);
+        void onReset(){ parityRequested_.clear(); }
     };
 }
 
@@ -23,18 +23,62 @@ using namespace estimators;
 // minimal default size of the playback queue
 unsigned int PlayoutControl::MinimalPlayableLevel = 150;
 
+const unsigned int CatchUpController::ToleranceSamples = 2;
+const unsigned int CatchUpController::CatchUpWindowMs = 2000;
+const double CatchUpController::MaxSpeedup = 0.25;
+const unsigned int CatchUpController::SkipThresholdMs = 1000;
+const unsigned int CatchUpController::SkipIntervalMs = 3000;
+
+CatchUpController::CatchUpController()
+{
+    reset();
+}
+
+CatchUpController::Action
+CatchUpController::update(int64_t nowMs, int64_t queueSizeMs, int64_t targetMs,
+                          double samplePeriodMs)
+{
+    Action action({1., false});
+    double excess = (double)(queueSizeMs - targetMs);
+    double tolerance = ToleranceSamples * samplePeriodMs;
+
+    if (excess > SkipThresholdMs && nowMs - lastSkipMs_ >= SkipIntervalMs)
+    {
+        action.skip_ = true;
+        lastSkipMs_ = nowMs;
+    }
+
+    // hysteresis: once accelerated, keep going until excess is mostly drained
+    if (excess > tolerance || (speed_ > 1. && excess > tolerance / 2.))
+        speed_ = 1. + fmin(MaxSpeedup, excess / (double)CatchUpWindowMs);
+    else
+        speed_ = 1.;
+
+    action.speed_ = speed_;
+    return action;
+}
+
+void CatchUpController::reset()
+{
+    speed_ = 1.;
+    lastSkipMs_ = 0;
+}
+
+//******************************************************************************
+
 PlayoutControl::PlayoutControl(const boost::shared_ptr<IPlayout> &playout,
                                const boost::shared_ptr<IPlaybackQueue> &queue,
                                const boost::shared_ptr<RetransmissionController> &rtxController,
                                unsigned int minimalPlayableLevel)
-    : playoutAllowed_(false),
+    : playoutAllowed_(false), catchUpEnabled_(false),
       ffwdMs_(0), queueCheckMs_(0),
       playbackQueueSize_(Average(boost::make_shared<TimeWindow>(QUEUE_CHECK_INTERVAL))),
       playout_(playout),
       queue_(queue),
       rtxController_(rtxController),
       userThresholdMs_(minimalPlayableLevel),
-      thresholdMs_(fmax(minimalPlayableLevel, PlayoutControl::MinimalPlayableLevel))
+      thresholdMs_(fmax(minimalPlayableLevel, PlayoutControl::MinimalPlayableLevel)),
+      minimalThresholdMs_(PlayoutControl::MinimalPlayableLevel)
 {
     description_ = "playout-control";
 }
@@ -65,11 +109,21 @@ void PlayoutControl::setThreshold(unsigned int t)
 {
     userThresholdMs_ = t;
     if (thresholdMs_ > userThresholdMs_)
-        thresholdMs_ = fmax(userThresholdMs_, PlayoutControl::MinimalPlayableLevel);
+        thresholdMs_ = fmax(userThresholdMs_, minimalThresholdMs_);
     else
         thresholdMs_ = userThresholdMs_;
 }
 
+void PlayoutControl::setCatchUpEnabled(bool enabled)
+{
+    catchUpEnabled_ = enabled;
+    if (!catchUpEnabled_)
+    {
+        catchUp_.reset();
+        playout_->setSpeed(1.);
+    }
+}
+
 void PlayoutControl::checkPlayout()
 {
     if (playout_->isRunning() ^ playoutAllowed_)
@@ -84,6 +138,7 @@ void PlayoutControl::checkPlayout()
                          << "). starting playout" << std::endl;
 
                 playout_->start(pqsize - thresholdMs_);
+                catchUp_.reset();
                 rtxController_->setEnabled(true);
 
                 // enable queue checking a bit later - give some time for
@@ -108,11 +163,16 @@ void PlayoutControl::checkPlaybackQueueSize()
     if (now - queueCheckMs_ >= QUEUE_CHECK_INTERVAL)
     {
         queueCheckMs_ = now;
-        double diffMs = (double)(thresholdMs_ - (double)queue_->size()); //playbackQueueSize_.value());
+        int64_t queueSize = queue_->size();
+        double diffMs = (double)(thresholdMs_ - (double)queueSize); //playbackQueueSize_.value());
         double framesDiff = fabs(diffMs / queue_->samplePeriod());
         int dir = (diffMs < 0 ? -1: 1);
 
-        if (framesDiff > QUEUE_DIFF_THRESHOLD)
+        // excess is handled by catch-up, if enabled
+        if (catchUpEnabled_)
+            checkCatchUp(now, queueSize);
+
+        if (framesDiff > QUEUE_DIFF_THRESHOLD && (dir > 0 || !catchUpEnabled_))
         {
             double maxAdjustment = QUEUE_DIFF_THRESHOLD*queue_->samplePeriod();
             int64_t adjustmentMs = dir * (int64_t)fmin(fabs(diffMs), maxAdjustment);
@@ -123,13 +183,38 @@ void PlayoutControl::checkPlaybackQueueSize()
     }
 }
 
+void PlayoutControl::checkCatchUp(int64_t now, int64_t queueSize)
+{
+    CatchUpController::Action action = catchUp_.update(now, queueSize, thresholdMs_,
+                                                       queue_->samplePeriod());
+
+    if (action.skip_)
+    {
+        int64_t skippedMs = queue_->skipToKey(thresholdMs_);
+        if (skippedMs > 0)
+        {
+            LogInfoC << "playback queue size " << queueSize << "ms exceeds target "
+                     << thresholdMs_ << "ms. skipped " << skippedMs << "ms" << std::endl;
+            // playout would otherwise wait for the gap in sample timestamps
+            playout_->addAdjustment(-skippedMs);
+        }
+    }
+
+    if (action.speed_ != playout_->getSpeed())
+    {
+        LogDebugC << "playback queue size " << queueSize << "ms (target " << thresholdMs_
+                  << "ms). playout speed " << action.speed_ << std::endl;
+        playout_->setSpeed(action.speed_);
+    }
+}
+
 void PlayoutControl::onOriginalDrdUpdate(double drd, double dev)
 {
     double target = drd + ALPHA*dev;
     double diff = fabs((double)thresholdMs_-target)/target;
 
     if (diff >= DRD_DIFF_THRESHOLD  &&
-        target >= PlayoutControl::MinimalPlayableLevel &&
+        target >= minimalThresholdMs_ &&
         thresholdMs_ != userThresholdMs_)
     {
         LogTraceC << "target playback queue size " << thresholdMs_
@@ -30,6 +30,45 @@ class IPlayoutControl : public IPlaybackQueueObserver,
     virtual void onQueueEmpty() = 0;
     virtual void setThreshold(unsigned int t) = 0;
     virtual unsigned int getThreshold() const = 0;
+    virtual void setMinimalThreshold(unsigned int t) = 0;
+};
+
+/**
+ * CatchUpController brings accumulated playback latency back to target once
+ * playback queue has grown beyond it (e.g. after network hiccup). Moderate
+ * excess is drained by playing faster (up to 1+MaxSpeedup times), excess
+ * larger than SkipThresholdMs is dropped at once by skipping to a key frame.
+ */
+class CatchUpController
+{
+  public:
+    typedef struct _Action
+    {
+        double speed_;
+        bool skip_;
+    } Action;
+
+    // excess (in samples) tolerated before speeding up
+    static const unsigned int ToleranceSamples;
+    // excess is drained within roughly this time
+    static const unsigned int CatchUpWindowMs;
+    static const double MaxSpeedup;
+    static const unsigned int SkipThresholdMs;
+    static const unsigned int SkipIntervalMs;
+
+    CatchUpController();
+
+    /**
+     * Decides on playout speed and skipping given current playback queue size
+     * and target size.
+     */
+    Action update(int64_t nowMs, int64_t queueSizeMs, int64_t targetMs, double samplePeriodMs);
+    void reset();
+    double getSpeed() const { return speed_; }
+
+  private:
+    double speed_;
+    int64_t lastSkipMs_;
 };
 
 /**
@@ -54,20 +93,30 @@ class PlayoutControl : public NdnRtcComponent,
     // void onSamplePlayed() { /*ignored*/ }
     void setThreshold(unsigned int t) override;
     unsigned int getThreshold() const override { return thresholdMs_; }
+    // lowest target size threshold may be set to (MinimalPlayableLevel by default)
+    void setMinimalThreshold(unsigned int t) override { minimalThresholdMs_ = t; }
+
+    /**
+     * Enables latency catch-up: playout is accelerated or skipped to the next
+     * key frame whenever playback queue exceeds target size.
+     * @see CatchUpController
+     */
+    void setCatchUpEnabled(bool enabled);
 
     const boost::shared_ptr<const IPlayout> getPlayoutMechanism() const { return playout_; }
     const boost::shared_ptr<const IPlaybackQueue> getPlaybackQueue() const { return queue_; }
 
     static unsigned int MinimalPlayableLevel;
   private:
-    bool playoutAllowed_;
+    bool playoutAllowed_, catchUpEnabled_;
     int ffwdMs_;
     int64_t queueCheckMs_;
     estimators::Average playbackQueueSize_;
     boost::shared_ptr<IPlayout> playout_;
     boost::shared_ptr<IPlaybackQueue> queue_;
     boost::shared_ptr<RetransmissionController> rtxController_;
-    unsigned int userThresholdMs_, thresholdMs_;
+    unsigned int userThresholdMs_, thresholdMs_, minimalThresholdMs_;
+    CatchUpController catchUp_;
 
     void onDrdUpdate() override {}
     void onCachedDrdUpdate(double, double) override{}
@@ -75,6 +124,7 @@ class PlayoutControl : public NdnRtcComponent,
 
     void checkPlayout();
     void checkPlaybackQueueSize();
+    void checkCatchUp(int64_t now, int64_t queueSize);
 };
 }
 
@@ -22,12 +22,14 @@ PlayoutImpl::PlayoutImpl(boost::asio::io_service& io,
     const boost::shared_ptr<IPlaybackQueue>& queue,
     const boost::shared_ptr<statistics::StatisticsStorage> statStorage):
 isRunning_(false),
+speed_(1.),
 jitterTiming_(io),
 pqueue_(queue),
 StatObject(statStorage),
 lastTimestamp_(-1),
 lastDelay_(-1),
-delayAdjustment_(0)
+delayAdjustment_(0),
+playDeadlineUsec_(0)
 {
     setDescription("playout");
 }
@@ -47,7 +49,9 @@ PlayoutImpl::start(unsigned int fastForwardMs)
     jitterTiming_.flush();
     lastTimestamp_ = -1;
     lastDelay_ = -1;
+    playDeadlineUsec_ = 0;
     delayAdjustment_ = -(int)fastForwardMs;
+    speed_ = 1.;
     isRunning_ = true;
     
     LogInfoC << "started (ffwd ‣‣" << fastForwardMs << "ms)" << std::endl;
@@ -65,6 +69,16 @@ PlayoutImpl::stop()
     }
 }
 
+void
+PlayoutImpl::setSpeed(double speed)
+{
+    if (speed <= 0)
+        throw std::runtime_error("Playout speed must be positive");
+
+    speed_ = speed;
+    (*statStorage_)[Indicator::PlayoutSpeed] = speed;
+}
+
 void
 PlayoutImpl::setLogger(boost::shared_ptr<ndnlog::new_api::Logger> logger)
 {
@@ -103,8 +117,8 @@ void PlayoutImpl::extractSample()
     
     stringstream debugStr;
     int64_t sampleDelay = (int64_t)round(pqueue_->samplePeriod());
-    bool validForPlayback = false;
-    jitterTiming_.startFramePlayout();
+    bool validForPlayback = false, hasPlayed = false;
+    int64_t tickUsec = jitterTiming_.startFramePlayout();
 
     if (pqueue_->size())
     {
@@ -115,8 +129,17 @@ void PlayoutImpl::extractSample()
             sampleDelay = playTimeMs;
             debugStr << slot->dump();
             (*statStorage_)[Indicator::LatencyEstimated] = (clock::unixTimestamp() - slot->getHeader().publishUnixTimestamp_);
+            statStorage_->recordValue(HistogramIndicator::CaptureToPlay,
+                (int64_t)((clock::unixTimestamp() - slot->getHeader().publishUnixTimestamp_)*1E6));
         });
 
+        // lateness is measured against the deadline set when previous 
+        // sample was played, thus empty queue stalls are accounted for
+        if (playDeadlineUsec_ > 0)
+            statStorage_->recordValue(HistogramIndicator::PlayoutLateness, 
+                                      std::max((int64_t)0, tickUsec - playDeadlineUsec_));
+        hasPlayed = true;
+
         LogTraceC << ". packet delay " << sampleDelay << " ts " << lastTimestamp_ << std::endl;
     }
     else
@@ -132,6 +155,13 @@ void PlayoutImpl::extractSample()
     lastDelay_ = sampleDelay;
     int64_t actualDelay = adjustDelay(sampleDelay);
 
+    // accelerated playout shortens intervals between samples
+    if (speed_ != 1.)
+        actualDelay = (int64_t)round((double)actualDelay / speed_);
+
+    if (hasPlayed)
+        playDeadlineUsec_ = tickUsec + actualDelay*1000;
+
     if (validForPlayback)
     {
         LogDebugC << "●-- play frame " << debugStr.str() << actualDelay << "ms" << std::endl;
@@ -37,14 +37,18 @@ namespace ndnrtc {
         void detach(IPlayoutObserver* observer);
 
         void addAdjustment(int64_t adjMs) { delayAdjustment_ += adjMs; }
+        void setSpeed(double speed);
+        double getSpeed() const { return speed_; }
     protected:
         PlayoutImpl(const PlayoutImpl&) = delete;
         
         mutable boost::recursive_mutex mutex_;
         std::atomic<bool> isRunning_;
+        std::atomic<double> speed_;
         boost::shared_ptr<IPlaybackQueue> pqueue_;
         JitterTiming jitterTiming_;
         int64_t lastTimestamp_, lastDelay_, delayAdjustment_;
+        int64_t playDeadlineUsec_;
         std::vector<IPlayoutObserver*> observers_;
         
         void extractSample();
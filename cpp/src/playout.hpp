@@ -35,6 +35,8 @@ namespace ndnrtc {
         virtual void stop() = 0;
         virtual bool isRunning() const = 0;
         virtual void addAdjustment(int64_t) = 0;
+        virtual void setSpeed(double) = 0;
+        virtual double getSpeed() const = 0;
     };
 
     /**
@@ -55,6 +57,12 @@ namespace ndnrtc {
         void start(unsigned int fastForwardMs = 0) override;
         void stop() override;
         void addAdjustment(int64_t adjMs) override;
+        /**
+         * Sets playout speed. Speed greater than 1 shortens intervals between
+         * samples, i.e. playout catches up with the latest samples.
+         */
+        void setSpeed(double speed) override;
+        double getSpeed() const override;
 
         void setLogger(boost::shared_ptr<ndnlog::new_api::Logger> logger);
         void setDescription(const std::string& desc);
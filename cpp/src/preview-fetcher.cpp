@@ -0,0 +1,315 @@
+//
+// preview-fetcher.cpp
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#include "preview-fetcher.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <boost/make_shared.hpp>
+#include <ndn-cpp/face.hpp>
+#include <ndn-cpp/network-nack.hpp>
+
+#include "frame-buffer.hpp"
+#include "frame-data.hpp"
+#include "periodic.hpp"
+#include "statistics.hpp"
+#include "video-playout-impl.hpp"
+
+using namespace ndnrtc;
+using namespace ndnrtc::statistics;
+using namespace ndn;
+
+const unsigned int PreviewFetcher::DefaultInterestLifetimeMs = 2000;
+
+namespace
+{
+// each missing segment is re-requested once, then frame is dropped
+const int MaxRtxNum = 1;
+// delay before requesting latest key frame again after network NACK
+const unsigned int RetryIntervalMs = 500;
+}
+
+//******************************************************************************
+PreviewFetcher::PreviewFetcher(boost::asio::io_service &io,
+                               const boost::shared_ptr<Face> &face,
+                               const Name &threadPrefix,
+                               const VideoThreadMeta &meta,
+                               unsigned int keyStep,
+                               const boost::shared_ptr<StatisticsStorage> &storage,
+                               const boost::shared_ptr<IBufferObserver> &validator)
+    : io_(io), face_(face), threadPrefix_(threadPrefix)
+    , keyStep_(std::max(1u, keyStep))
+    , keyIntervalMs_(1000)
+    , interestLifetimeMs_(DefaultInterestLifetimeMs)
+    , isRunning_(false), frameConsumer_(nullptr), seqNo_(-1)
+    , sstorage_(storage)
+    , validator_(validator)
+    , frameSlot_(boost::make_shared<VideoFrameSlot>())
+    , retryTimer_(boost::make_shared<Periodic>(io))
+{
+    description_ = "preview-fetcher";
+
+    if (meta.getRate() > 0)
+        keyIntervalMs_ = (unsigned int)std::ceil((double)meta.getCoderParams().gop_ / meta.getRate() * 1000.);
+}
+
+PreviewFetcher::~PreviewFetcher()
+{
+    retryTimer_->cancelInvocation();
+}
+
+void PreviewFetcher::start(IEncodedFrameConsumer *frameConsumer)
+{
+    if (isRunning_)
+        throw std::runtime_error("Preview fetcher is already running");
+
+    frameConsumer_ = frameConsumer;
+    isRunning_ = true;
+
+    LogInfoC << "preview " << threadPrefix_ << ": every " << keyStep_
+             << " key frame(s), ~" << getPreviewIntervalMs() << "ms" << std::endl;
+
+    requestLatest();
+}
+
+void PreviewFetcher::stop()
+{
+    if (!isRunning_)
+        return;
+
+    isRunning_ = false;
+    frameConsumer_ = nullptr;
+    slot_.reset();
+    retryTimer_->cancelInvocation();
+
+    LogInfoC << "stopped" << std::endl;
+}
+
+#pragma mark - private
+void PreviewFetcher::requestLatest()
+{
+    boost::shared_ptr<Interest> interest =
+        boost::make_shared<Interest>(Name(threadPrefix_).append(NameComponents::NameComponentKey),
+                                     interestLifetimeMs_);
+    interest->setChildSelector(1);
+    interest->setMustBeFresh(true);
+
+    LogDebugC << "requesting latest key frame" << std::endl;
+    express(interest, true);
+}
+
+void PreviewFetcher::requestKey(PacketNumber seqNo)
+{
+    // key frame is most likely not published yet - interest has to wait
+    // in producer's PIT until it is
+    boost::shared_ptr<Interest> interest =
+        boost::make_shared<Interest>(Name(threadPrefix_).append(NameComponents::NameComponentKey).appendSequenceNumber(seqNo).appendSegment(0),
+                                     getPreviewIntervalMs() + interestLifetimeMs_);
+
+    LogDebugC << "requesting key frame " << seqNo << "k" << std::endl;
+    express(interest, true);
+}
+
+void PreviewFetcher::requestSegments(const std::vector<Name> &names)
+{
+    std::vector<boost::shared_ptr<const Interest>> interests;
+
+    for (auto &n : names)
+    {
+        // parity is not fetched
+        if (n.size() > 1 && n[-2] == Name::Component(NameComponents::NameComponentParity))
+            continue;
+        interests.push_back(boost::make_shared<Interest>(n, interestLifetimeMs_));
+    }
+
+    slot_->segmentsRequested(interests);
+    for (auto &i : interests)
+        express(boost::const_pointer_cast<Interest>(i), false);
+}
+
+void PreviewFetcher::express(const boost::shared_ptr<Interest> &interest, bool isFirst)
+{
+    boost::shared_ptr<PreviewFetcher> me = boost::dynamic_pointer_cast<PreviewFetcher>(shared_from_this());
+
+    if (isFirst)
+        (*sstorage_)[Indicator::RequestedKeyNum]++;
+    (*sstorage_)[Indicator::InterestsSentNum]++;
+
+    face_->expressInterest(*interest,
+                           [me, isFirst](const boost::shared_ptr<const Interest> &i,
+                                         const boost::shared_ptr<Data> &d) {
+                               me->onData(i, d, isFirst);
+                           },
+                           [me, isFirst](const boost::shared_ptr<const Interest> &i) {
+                               me->onTimeout(i, isFirst);
+                           },
+                           [me](const boost::shared_ptr<const Interest> &i,
+                                const boost::shared_ptr<NetworkNack> &) {
+                               me->onNack(i);
+                           });
+}
+
+void PreviewFetcher::onData(const boost::shared_ptr<const Interest> &interest,
+                            const boost::shared_ptr<Data> &data, bool isFirst)
+{
+    if (!isRunning_)
+        return;
+
+    if (data->getMetaInfo().getType() == ndn_ContentType_NACK)
+    {
+        (*sstorage_)[Indicator::AppNackNum]++;
+        onNack(interest);
+        return;
+    }
+
+    NamespaceInfo info;
+    if (!NameComponents::extractInfo(data->getName(), info) ||
+        info.class_ != SampleClass::Key || !info.hasSeqNo_ ||
+        info.segmentClass_ != SegmentClass::Data)
+    {
+        LogWarnC << "unexpected data " << data->getName() << std::endl;
+        if (isFirst)
+            onNack(interest);
+        return;
+    }
+
+    (*sstorage_)[Indicator::SegmentsReceivedNum]++;
+    (*sstorage_)[Indicator::BytesReceived] += data->getContent().size();
+    (*sstorage_)[Indicator::RawBytesReceived] += data->getDefaultWireEncoding().size();
+
+    boost::shared_ptr<const Interest> segmentInterest = interest;
+    if (isFirst)
+    {
+        // interest might have been rightmost - slot needs one with segment name
+        seqNo_ = info.sampleNo_;
+        segmentInterest = boost::make_shared<Interest>(data->getName(), interestLifetimeMs_);
+        slot_ = boost::make_shared<BufferSlot>();
+        slot_->segmentsRequested({segmentInterest});
+        if (validator_)
+            validator_->onNewRequest(slot_);
+    }
+    else if (!slot_ || !slot_->getPrefix().isPrefixOf(data->getName()))
+        return; // late segment of dropped frame
+
+    boost::shared_ptr<WireSegment> segment = WireSegment::createSegment(info, data, segmentInterest);
+    if (!segment->isValid())
+    {
+        LogWarnC << "invalid data " << data->getName() << std::endl;
+        frameDropped();
+        return;
+    }
+
+    BufferReceipt receipt;
+    receipt.oldState_ = slot_->getState();
+    receipt.segment_ = slot_->segmentReceived(segment);
+    receipt.slot_ = slot_;
+    if (validator_)
+        validator_->onNewData(receipt);
+
+    if (slot_->getState() == BufferSlot::Ready)
+        frameAssembled();
+    else if (isFirst)
+        requestSegments(slot_->getMissingSegments());
+}
+
+void PreviewFetcher::onTimeout(const boost::shared_ptr<const Interest> &interest, bool isFirst)
+{
+    if (!isRunning_)
+        return;
+
+    (*sstorage_)[Indicator::TimeoutsNum]++;
+
+    if (isFirst)
+    {
+        LogDebugC << "timeout " << interest->getName() << ". requesting latest key frame" << std::endl;
+        requestLatest();
+        return;
+    }
+
+    if (!slot_ || !slot_->getPrefix().isPrefixOf(interest->getName()))
+        return;
+
+    if (slot_->getRtxNum(interest->getName()) < MaxRtxNum)
+    {
+        LogDebugC << "timeout " << interest->getName() << ". re-requesting" << std::endl;
+        (*sstorage_)[Indicator::RtxNum]++;
+        requestSegments({interest->getName()});
+    }
+    else
+        frameDropped();
+}
+
+void PreviewFetcher::onNack(const boost::shared_ptr<const Interest> &interest)
+{
+    if (!isRunning_)
+        return;
+
+    (*sstorage_)[Indicator::NacksNum]++;
+    LogDebugC << "nack " << interest->getName() << std::endl;
+
+    // start over with latest key frame a bit later
+    slot_.reset();
+    if (!retryTimer_->isPeriodicInvocationSet())
+    {
+        boost::shared_ptr<PreviewFetcher> me = boost::dynamic_pointer_cast<PreviewFetcher>(shared_from_this());
+        retryTimer_->setupInvocation(RetryIntervalMs, [me]() {
+            if (me->isRunning_ && !me->slot_)
+                me->requestLatest();
+            return 0;
+        });
+    }
+}
+
+void PreviewFetcher::frameAssembled()
+{
+    if (slot_->getVerificationStatus() == BufferSlot::Verification::Failed)
+    {
+        LogWarnC << "verification failed " << seqNo_ << "k" << std::endl;
+        frameDropped();
+        return;
+    }
+
+    bool recovered = false;
+    boost::shared_ptr<ImmutableVideoFramePacket> framePacket = frameSlot_->readPacket(*slot_, recovered);
+
+    if (framePacket.get() && framePacket->isValid())
+    {
+        VideoFrameSegmentHeader hdr = frameSlot_->readSegmentHeader(*slot_);
+        FrameInfo finfo({(uint64_t)(slot_->getHeader().publishUnixTimestamp_ * 1000),
+                         hdr.playbackNo_,
+                         slot_->getPrefix().toUri(),
+                         true});
+
+        LogDebugC << "assembled " << seqNo_ << "k/" << hdr.playbackNo_ << "p ("
+                  << slot_->getFetchedNum() << " segments)" << std::endl;
+
+        (*sstorage_)[Indicator::PlayedNum]++;
+        (*sstorage_)[Indicator::PlayedKeyNum]++;
+        (*sstorage_)[Indicator::LastPlayedNo] = hdr.playbackNo_;
+        (*sstorage_)[Indicator::LastPlayedKeyNo] = seqNo_;
+
+        if (frameConsumer_)
+            frameConsumer_->processFrame(finfo, framePacket->getFrame());
+
+        slot_.reset();
+        requestKey(seqNo_ + keyStep_);
+    }
+    else
+    {
+        LogWarnC << "failed to read frame " << seqNo_ << "k" << std::endl;
+        frameDropped();
+    }
+}
+
+void PreviewFetcher::frameDropped()
+{
+    LogDebugC << "dropped " << seqNo_ << "k" << std::endl;
+    (*sstorage_)[Indicator::SkippedNum]++;
+
+    slot_.reset();
+    requestKey(seqNo_ + keyStep_);
+}
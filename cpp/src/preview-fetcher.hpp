@@ -0,0 +1,118 @@
+//
+// preview-fetcher.hpp
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#ifndef __preview_fetcher_h__
+#define __preview_fetcher_h__
+
+#include <boost/asio.hpp>
+#include <ndn-cpp/name.hpp>
+
+#include "ndnrtc-object.hpp"
+#include "name-components.hpp"
+
+namespace ndn
+{
+class Face;
+class Interest;
+class Data;
+}
+
+namespace ndnrtc
+{
+namespace statistics
+{
+class StatisticsStorage;
+}
+
+class BufferSlot;
+class IBufferObserver;
+class VideoFrameSlot;
+class VideoThreadMeta;
+class IEncodedFrameConsumer;
+class Periodic;
+
+/**
+ * PreviewFetcher fetches key frames of a video thread only, for cheap
+ * stream previews (thumbnails on a monitoring wall, stream pickers, etc.).
+ * Unlike live fetching, there is no pipeline, buffer, latency or playout
+ * control - one key frame is fetched at a time:
+ *  - latest key frame is requested with a rightmost interest for the key
+ *    class prefix (<thread>/k);
+ *  - once its' first segment arrives, remaining data segments are requested
+ *    (parity is never fetched, incomplete frames are dropped);
+ *  - assembled frame is passed to the frame consumer and first segment of
+ *    the key frame keyStep frames ahead is requested, with interest lifetime
+ *    covering time until it is published, so producer answers it right away;
+ *  - if that interest times out (frame dropped by producer, stream
+ *    restarted, etc.), fetcher falls back to rightmost interest.
+ * Frames are verified by the stream's validator, the same way live frames
+ * are: validator is notified of new slots and received segments as if it
+ * was attached to the buffer. Frames known to have failed verification by
+ * the time they are assembled are dropped.
+ * Fetcher must be used on the face thread.
+ */
+class PreviewFetcher : public NdnRtcComponent
+{
+  public:
+    static const unsigned int DefaultInterestLifetimeMs;
+
+    /**
+     * @param threadPrefix Thread prefix, including stream timestamp
+     * @param meta Thread metadata, used for key frame interval estimation
+     * @param keyStep Fetch every keyStep-th key frame (1 - every key frame)
+     * @param validator Stream's validator (i.e. ManifestValidator), may be
+     *          null
+     */
+    PreviewFetcher(boost::asio::io_service &io,
+                   const boost::shared_ptr<ndn::Face> &face,
+                   const ndn::Name &threadPrefix,
+                   const VideoThreadMeta &meta,
+                   unsigned int keyStep,
+                   const boost::shared_ptr<statistics::StatisticsStorage> &storage,
+                   const boost::shared_ptr<IBufferObserver> &validator);
+    ~PreviewFetcher();
+
+    void start(IEncodedFrameConsumer *frameConsumer);
+    void stop();
+    bool isRunning() const { return isRunning_; }
+
+    void setInterestLifetime(unsigned int lifetimeMs) { interestLifetimeMs_ = lifetimeMs; }
+    unsigned int getKeyStep() const { return keyStep_; }
+    /**
+     * Expected interval between key frames fetched, in milliseconds
+     */
+    unsigned int getPreviewIntervalMs() const { return keyStep_ * keyIntervalMs_; }
+
+  private:
+    boost::asio::io_service &io_;
+    boost::shared_ptr<ndn::Face> face_;
+    ndn::Name threadPrefix_;
+    unsigned int keyStep_, keyIntervalMs_, interestLifetimeMs_;
+    bool isRunning_;
+    IEncodedFrameConsumer *frameConsumer_;
+    PacketNumber seqNo_; // key frame being fetched
+    boost::shared_ptr<statistics::StatisticsStorage> sstorage_;
+    boost::shared_ptr<IBufferObserver> validator_;
+    boost::shared_ptr<BufferSlot> slot_;
+    boost::shared_ptr<VideoFrameSlot> frameSlot_;
+    boost::shared_ptr<Periodic> retryTimer_;
+
+    void requestLatest();
+    void requestKey(PacketNumber seqNo);
+    void requestSegments(const std::vector<ndn::Name> &names);
+    void express(const boost::shared_ptr<ndn::Interest> &interest, bool isFirst);
+
+    void onData(const boost::shared_ptr<const ndn::Interest> &interest,
+                const boost::shared_ptr<ndn::Data> &data, bool isFirst);
+    void onTimeout(const boost::shared_ptr<const ndn::Interest> &interest, bool isFirst);
+    void onNack(const boost::shared_ptr<const ndn::Interest> &interest);
+    void frameAssembled();
+    void frameDropped();
+};
+}
+
+#endif
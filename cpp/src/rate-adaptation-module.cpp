@@ -0,0 +1,267 @@
+//
+// rate-adaptation-module.cpp
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#include "rate-adaptation-module.hpp"
+
+#include <algorithm>
+#include <sstream>
+
+#include "statistics.hpp"
+
+using namespace ndnrtc;
+using namespace ndnrtc::statistics;
+
+const unsigned int RateAdaptationModule::WindowMs = 2000;
+const unsigned int RateAdaptationModule::DownswitchHoldMs = 1000;
+const unsigned int RateAdaptationModule::UpswitchHoldMs = 5000;
+const unsigned int RateAdaptationModule::MaxUpswitchHoldMs = 60000;
+const double RateAdaptationModule::CongestionLossRatio = 0.05;
+const double RateAdaptationModule::CongestionDrdRatio = 2.;
+const double RateAdaptationModule::ThroughputHeadroom = 0.85;
+
+RateAdaptationModule::RateAdaptationModule(const boost::shared_ptr<DrdEstimator> &drdEstimator,
+                                           const boost::shared_ptr<StatisticsStorage> &storage)
+    : drdEstimator_(drdEstimator), sstorage_(storage), streamIdx_(0),
+      lastTimestampMs_(0), lastSwitchMs_(0), lastCongestionMs_(0),
+      upswitchHoldMs_(UpswitchHoldMs), windowData_(0), congested_(false), steppedUp_(false),
+      throughputKbps_(0), avgDataSize_(0), drd_(0), drdBaseline_(0)
+{
+    description_ = "rate-adaptation";
+    current_ = {0, 0, 0, 0, 0};
+
+    if (drdEstimator_)
+        drdEstimator_->attach(this);
+}
+
+RateAdaptationModule::~RateAdaptationModule()
+{
+    if (drdEstimator_)
+        drdEstimator_->detach(this);
+}
+
+int RateAdaptationModule::initialize(const CodecMode &codecMode,
+                                     uint32_t nStreams,
+                                     StreamEntry *streamArray)
+{
+    if (nStreams == 0 || !streamArray)
+        return -1;
+    if (codecMode != CodecModeNormal)
+        return -2;
+
+    streams_ = std::vector<StreamEntry>(streamArray, streamArray + nStreams);
+    std::sort(streams_.begin(), streams_.end(),
+              [](const StreamEntry &a, const StreamEntry &b) { return a.bitrate_ < b.bitrate_; });
+
+    streamIdx_ = 0;
+    periods_.clear();
+    current_ = {0, 0, 0, 0, 0};
+    lastTimestampMs_ = 0;
+    upswitchHoldMs_ = UpswitchHoldMs;
+    congested_ = steppedUp_ = false;
+
+    std::stringstream ss;
+    for (auto &s : streams_)
+        ss << s.id_ << ":" << s.bitrate_ << "kbps ";
+    LogInfoC << "initialized with " << nStreams << " streams: " << ss.str() << std::endl;
+
+    return 0;
+}
+
+void RateAdaptationModule::interestExpressed(const std::string &name,
+                                             unsigned int streamId)
+{
+    // nothing to do - loss ratio is calculated from answered and timed out
+    // Interests
+}
+
+void RateAdaptationModule::interestTimeout(const std::string &name,
+                                           unsigned int streamId)
+{
+    current_.nTimeouts_++;
+}
+
+void RateAdaptationModule::dataReceived(const std::string &name,
+                                        unsigned int streamId,
+                                        unsigned int dataSize,
+                                        double rttMs,
+                                        unsigned int nRtx)
+{
+    current_.bytes_ += dataSize;
+    current_.nData_++;
+    current_.nRtx_ += nRtx;
+    avgDataSize_ = (avgDataSize_ == 0 ? dataSize : 0.9 * avgDataSize_ + 0.1 * dataSize);
+}
+
+void RateAdaptationModule::getInterestRate(int64_t timestampMs,
+                                           double &interestRate,
+                                           unsigned int &streamId)
+{
+    interestRate = 0;
+    streamId = (streams_.size() ? streams_[streamIdx_].id_ : 0);
+
+    if (streams_.size() == 0)
+        return;
+
+    if (lastTimestampMs_ == 0)
+    {
+        lastTimestampMs_ = lastSwitchMs_ = lastCongestionMs_ = timestampMs;
+        return;
+    }
+
+    updateWindow(timestampMs);
+    congested_ = detectCongestion();
+
+    if (congested_)
+    {
+        // up-switch didn't work out - wait longer before the next attempt
+        if (steppedUp_ && timestampMs - lastSwitchMs_ < upswitchHoldMs_)
+            upswitchHoldMs_ = std::min(2 * upswitchHoldMs_, MaxUpswitchHoldMs);
+        steppedUp_ = false;
+        lastCongestionMs_ = timestampMs;
+
+        if (streamIdx_ > 0 && timestampMs - lastSwitchMs_ >= DownswitchHoldMs)
+        {
+            size_t idx = findStream(throughputKbps_ * ThroughputHeadroom);
+            if (idx >= streamIdx_)
+                idx = streamIdx_ - 1;
+
+            LogInfoC << "congestion detected (throughput " << throughputKbps_
+                     << "kbps, drd " << drd_ << "ms, baseline " << drdBaseline_
+                     << "ms). step down " << streams_[streamIdx_].id_ << " -> "
+                     << streams_[idx].id_ << std::endl;
+
+            streamIdx_ = idx;
+            lastSwitchMs_ = timestampMs;
+            periods_.clear();
+        }
+    }
+    else
+    {
+        if (steppedUp_ && timestampMs - lastSwitchMs_ >= 2 * upswitchHoldMs_)
+        {
+            // successful up-switch
+            upswitchHoldMs_ = UpswitchHoldMs;
+            steppedUp_ = false;
+        }
+
+        if (streamIdx_ + 1 < streams_.size() && windowData_ > 0 &&
+            timestampMs - lastCongestionMs_ >= upswitchHoldMs_ &&
+            timestampMs - lastSwitchMs_ >= upswitchHoldMs_)
+        {
+            LogInfoC << "no congestion for " << timestampMs - lastCongestionMs_
+                     << "ms (throughput " << throughputKbps_ << "kbps). step up "
+                     << streams_[streamIdx_].id_ << " -> " << streams_[streamIdx_ + 1].id_
+                     << std::endl;
+
+            streamIdx_++;
+            steppedUp_ = true;
+            lastSwitchMs_ = timestampMs;
+            periods_.clear();
+        }
+    }
+
+    if (avgDataSize_ > 0)
+        interestRate = throughputKbps_ * 1000. / 8. / avgDataSize_;
+    streamId = streams_[streamIdx_].id_;
+}
+
+void RateAdaptationModule::setCurrentStream(unsigned int streamId)
+{
+    size_t idx = findStreamIdx(streamId);
+
+    if (idx < streams_.size() && idx != streamIdx_)
+    {
+        streamIdx_ = idx;
+        periods_.clear();
+    }
+}
+
+unsigned int RateAdaptationModule::getCurrentStream() const
+{
+    return (streams_.size() ? streams_[streamIdx_].id_ : 0);
+}
+
+void RateAdaptationModule::onOriginalDrdUpdate(double drd, double)
+{
+    drd_ = drd;
+
+    // baseline tracks minimal DRD, slowly drifting up so that route
+    // changes are eventually accepted as a new norm
+    if (drdBaseline_ == 0 || drd < drdBaseline_)
+        drdBaseline_ = drd;
+    else
+        drdBaseline_ += (drd - drdBaseline_) * 0.0005;
+}
+
+#pragma mark - private
+void RateAdaptationModule::updateWindow(int64_t timestampMs)
+{
+    current_.durationMs_ = timestampMs - lastTimestampMs_;
+    periods_.push_back(current_);
+    current_ = {0, 0, 0, 0, 0};
+    lastTimestampMs_ = timestampMs;
+
+    int64_t windowDuration = 0;
+    for (auto &p : periods_)
+        windowDuration += p.durationMs_;
+
+    while (periods_.size() > 1 && windowDuration - periods_.front().durationMs_ >= WindowMs)
+    {
+        windowDuration -= periods_.front().durationMs_;
+        periods_.pop_front();
+    }
+
+    uint64_t bytes = 0;
+    windowData_ = 0;
+    for (auto &p : periods_)
+    {
+        bytes += p.bytes_;
+        windowData_ += p.nData_;
+    }
+
+    throughputKbps_ = (windowDuration > 0 ? (double)bytes * 8. / (double)windowDuration : 0);
+
+    if (sstorage_)
+        (*sstorage_)[Indicator::ThroughputEstimate] = throughputKbps_;
+}
+
+bool RateAdaptationModule::detectCongestion()
+{
+    unsigned int nData = 0, nTimeouts = 0;
+    for (auto &p : periods_)
+    {
+        nData += p.nData_;
+        nTimeouts += p.nTimeouts_;
+    }
+
+    double lossRatio = (nData + nTimeouts ? (double)nTimeouts / (double)(nData + nTimeouts) : 0);
+    bool drdGrowth = (drdBaseline_ > 0 && drd_ > drdBaseline_ * CongestionDrdRatio);
+
+    return lossRatio > CongestionLossRatio || drdGrowth;
+}
+
+size_t RateAdaptationModule::findStream(double throughputKbps) const
+{
+    size_t idx = 0;
+    for (size_t i = 0; i < streams_.size(); ++i)
+        if (streamLoadKbps(i) <= throughputKbps)
+            idx = i;
+    return idx;
+}
+
+size_t RateAdaptationModule::findStreamIdx(unsigned int streamId) const
+{
+    for (size_t i = 0; i < streams_.size(); ++i)
+        if (streams_[i].id_ == streamId)
+            return i;
+    return streams_.size();
+}
+
+double RateAdaptationModule::streamLoadKbps(size_t idx) const
+{
+    return streams_[idx].bitrate_ * (1. + streams_[idx].parityRatio_);
+}
@@ -12,7 +12,13 @@
 #define ndnrtc_rate_adaptation_module_h
 
 #include <string>
+#include <vector>
+#include <deque>
 #include <stdint.h>
+#include <boost/shared_ptr.hpp>
+
+#include "ndnrtc-object.hpp"
+#include "drd-estimator.hpp"
 
 namespace ndnrtc {
     
@@ -39,6 +45,8 @@ namespace ndnrtc {
      */
     class IRateAdaptationModule {
     public:
+        virtual ~IRateAdaptationModule() {}
+
         /**
          * Module intitialization
          * @param codecMode Codec mode used by producer
@@ -97,6 +105,95 @@ namespace ndnrtc {
                                      double& interestRate,
                                      unsigned int& streamId) = 0;
     };
+
+    namespace statistics {
+        class StatisticsStorage;
+    }
+
+    /**
+     * Default rate adaptation module. Detects congestion from Interest
+     * timeouts/NACKs and growth of original DRD over its baseline, measures
+     * received throughput over a sliding window and recommends a stream
+     * (simulcast thread) whose bitrate (with parity overhead) fits into
+     * measured throughput.
+     * Under congestion, module steps down immediately (but not more often
+     * than once per DownswitchHoldMs). Since throughput measurement is capped
+     * by the bitrate of the stream being fetched, module steps up one stream
+     * at a time after congestion-free UpswitchHoldMs interval; if congestion
+     * occurs shortly after stepping up, up-switch hold interval is doubled
+     * (up to MaxUpswitchHoldMs).
+     */
+    class RateAdaptationModule : public NdnRtcComponent,
+                                 public IRateAdaptationModule,
+                                 public IDrdEstimatorObserver
+    {
+    public:
+        static const unsigned int WindowMs;
+        static const unsigned int DownswitchHoldMs;
+        static const unsigned int UpswitchHoldMs;
+        static const unsigned int MaxUpswitchHoldMs;
+        static const double CongestionLossRatio;
+        static const double CongestionDrdRatio;
+        static const double ThroughputHeadroom;
+
+        RateAdaptationModule(const boost::shared_ptr<DrdEstimator>& drdEstimator,
+                             const boost::shared_ptr<statistics::StatisticsStorage>& storage);
+        ~RateAdaptationModule();
+
+        int initialize(const CodecMode& codecMode,
+                       uint32_t nStreams,
+                       StreamEntry* streamArray);
+        void interestExpressed(const std::string &name,
+                               unsigned int streamId);
+        void interestTimeout(const std::string &name,
+                             unsigned int streamId);
+        void dataReceived(const std::string &name,
+                          unsigned int streamId,
+                          unsigned int dataSize,
+                          double rttMs,
+                          unsigned int nRtx);
+        void getInterestRate(int64_t timestampMs,
+                             double& interestRate,
+                             unsigned int& streamId);
+
+        /**
+         * Sets stream which is currently being fetched (i.e. after thread
+         * switch has completed or if the user switched thread manually)
+         */
+        void setCurrentStream(unsigned int streamId);
+        unsigned int getCurrentStream() const;
+
+        double getThroughputKbps() const { return throughputKbps_; }
+        bool isCongested() const { return congested_; }
+
+        // IDrdEstimatorObserver
+        void onDrdUpdate() {}
+        void onCachedDrdUpdate(double, double) {}
+        void onOriginalDrdUpdate(double drd, double);
+
+    private:
+        typedef struct _Period {
+            int64_t durationMs_;
+            unsigned int bytes_, nData_, nTimeouts_, nRtx_;
+        } Period;
+
+        boost::shared_ptr<DrdEstimator> drdEstimator_;
+        boost::shared_ptr<statistics::StatisticsStorage> sstorage_;
+        std::vector<StreamEntry> streams_; // sorted by bitrate, ascending
+        std::deque<Period> periods_;
+        Period current_;
+        size_t streamIdx_;
+        int64_t lastTimestampMs_, lastSwitchMs_, lastCongestionMs_;
+        unsigned int upswitchHoldMs_, windowData_;
+        bool congested_, steppedUp_;
+        double throughputKbps_, avgDataSize_, drd_, drdBaseline_;
+
+        void updateWindow(int64_t timestampMs);
+        bool detectCongestion();
+        size_t findStream(double throughputKbps) const;
+        size_t findStreamIdx(unsigned int streamId) const;
+        double streamLoadKbps(size_t idx) const;
+    };
 }
 
 #endif
@@ -43,6 +43,7 @@ void RemoteAudioStreamImpl::construct()
     pps.playbackQueue_ = playbackQueue_;
     pps.segmentController_ = segmentController_;
     pps.sstorage_ = sstorage_;
+    pps.objectPool_ = objectPool_;
 
     pipeliner_ = boost::make_shared<Pipeliner>(pps,
                                                boost::make_shared<Pipeliner::AudioNameScheme>());
@@ -21,7 +21,9 @@
 #include "interest-control.hpp"
 #include "interest-queue.hpp"
 #include "latency-control.hpp"
+#include "meta-cache.hpp"
 #include "meta-fetcher.hpp"
+#include "object-pool.hpp"
 #include "pipeline-control-state-machine.hpp"
 #include "pipeline-control.hpp"
 #include "pipeliner.hpp"
@@ -45,9 +47,12 @@ RemoteStreamImpl::RemoteStreamImpl(asio::io_service &io,
     , keyChain_(keyChain)
     , streamPrefix_(streamPrefix)
     , needMeta_(true), isRunning_(false), cuedToRun_(false)
-    , metadataRequestedMs_(0)
+    , fastJoin_(false), isMetaCached_(false)
+    , pipelineStrategy_(RemoteStream::PipelineStrategyDefault)
+    , metadataRequestedMs_(0), startRequestedMs_(0)
     , metaFetcher_(make_shared<MetaFetcher>(face_, keyChain_))
     , sstorage_(StatisticsStorage::createConsumerStatistics())
+    , objectPool_(make_shared<ObjectPool>())
     , drdEstimator_(make_shared<DrdEstimator>())
 {
     assert(face.get());
@@ -60,7 +65,7 @@ void RemoteStreamImpl::construct()
 {
     description_ = "remote-stream";
 
-    segmentController_ = make_shared<SegmentController>(io_, 500, sstorage_);
+    segmentController_ = make_shared<SegmentController>(io_, 500, sstorage_, objectPool_);
     buffer_ = make_shared<Buffer>(sstorage_, make_shared<SlotPool>(500));
     playbackQueue_ = make_shared<PlaybackQueue>(Name(streamPrefix_),
                                                 dynamic_pointer_cast<Buffer>(buffer_));
@@ -106,6 +111,7 @@ void RemoteStreamImpl::start(const std::string &threadName)
 
     cuedToRun_ = true;
     threadName_ = threadName;
+    startRequestedMs_ = clock::millisecondTimestamp();
 
     if (!needMeta_)
         initiateFetching();
@@ -132,6 +138,43 @@ void RemoteStreamImpl::setInterestLifetime(unsigned int lifetimeMs)
         LogWarnC << "attempting to setInterestLifetime() but pipeliner_ is null" << std::endl;
 }
 
+void RemoteStreamImpl::setPipelineStrategy(RemoteStream::PipelineStrategy strategy)
+{
+    if (isRunning_)
+        throw std::runtime_error("Can't change pipeline strategy while fetching");
+
+    boost::shared_ptr<IInterestControlStrategy> s;
+    if (strategy == RemoteStream::PipelineStrategyBbr)
+        s = make_shared<InterestControl::StrategyBbr>();
+    else
+        s = make_shared<InterestControl::StrategyDefault>();
+
+    dynamic_pointer_cast<InterestControl>(interestControl_)->setStrategy(s);
+    pipelineStrategy_ = strategy;
+
+    LogInfoC << "set pipeline strategy "
+             << (strategy == RemoteStream::PipelineStrategyBbr ? "bbr" : "default") << std::endl;
+}
+
+void RemoteStreamImpl::setJitterPercentile(double percentile)
+{
+    dynamic_pointer_cast<LatencyControl>(latencyControl_)->setJitterPercentile(percentile);
+}
+
+void RemoteStreamImpl::setFastJoin(bool enabled)
+{
+    shared_ptr<RemoteStreamImpl> me = dynamic_pointer_cast<RemoteStreamImpl>(shared_from_this());
+    async::dispatchSync(io_, [me, enabled, this]() {
+        fastJoin_ = enabled;
+        LogInfoC << "fast join " << (enabled ? "enabled" : "disabled") << std::endl;
+
+        // metadata request is still in flight - try cached metadata instead,
+        // request's reply will confirm it
+        if (fastJoin_ && needMeta_ && !streamMeta_)
+            useCachedMeta();
+    });
+}
+
 void RemoteStreamImpl::setTargetBufferSize(unsigned int bufferSizeMs)
 {
     if (playoutControl_.get())
@@ -227,7 +270,32 @@ void RemoteStreamImpl::fetchMeta()
 
 void RemoteStreamImpl::streamMetaFetched(NetworkData &meta)
 {
-    streamMeta_ = make_shared<MediaStreamMeta>(move(meta));
+    shared_ptr<MediaStreamMeta> streamMeta = make_shared<MediaStreamMeta>(move(meta));
+    MetaCache::getSharedInstance()->storeStreamMeta(streamPrefix_.toUri(), streamMeta);
+
+    if (isMetaCached_)
+    {
+        isMetaCached_ = false;
+
+        if (streamMeta_->getStreamTimestamp() == streamMeta->getStreamTimestamp())
+        {
+            LogDebugC << "cached meta info confirmed" << std::endl;
+            streamMeta_ = streamMeta;
+            return;
+        }
+
+        // producer has restarted the stream - start over with fresh metadata
+        LogWarnC << "cached meta info is outdated (stream timestamp "
+                 << streamMeta_->getStreamTimestamp() << " -> "
+                 << streamMeta->getStreamTimestamp() << ")" << std::endl;
+
+        if (isRunning_)
+            stopFetching();
+        threadsMeta_.clear();
+        needMeta_ = true;
+    }
+
+    streamMeta_ = streamMeta;
 
     shared_ptr<RemoteStreamImpl> me = dynamic_pointer_cast<RemoteStreamImpl>(shared_from_this());
     std::stringstream ss;
@@ -243,6 +311,10 @@ void RemoteStreamImpl::streamMetaFetched(NetworkData &meta)
              << " timestamp " << streamMeta_->getStreamTimestamp() 
              << " (" << Name().append(Name::Component::fromTimestamp(streamMeta_->getStreamTimestamp())) << ")" 
              << std::endl;
+
+    // fetch latest key frame while thread meta is on its' way
+    if (fastJoin_)
+        prefetch();
 }
 
 void RemoteStreamImpl::fetchThreadMeta(const std::string &threadName, const int64_t& metadataRequestedMs)
@@ -272,6 +344,7 @@ void RemoteStreamImpl::fetchThreadMeta(const std::string &threadName, const int6
 void RemoteStreamImpl::threadMetaFetched(const std::string &thread, NetworkData &meta)
 {
     threadsMeta_[thread] = make_shared<NetworkData>(move(meta));
+    MetaCache::getSharedInstance()->storeThreadMeta(streamPrefix_.toUri(), thread, threadsMeta_[thread]);
     LogInfoC << "received thread meta info for: " << thread << std::endl;
 
     if (threadsMeta_.size() == streamMeta_->getThreads().size())
@@ -286,6 +359,29 @@ void RemoteStreamImpl::threadMetaFetched(const std::string &thread, NetworkData
     }
 }
 
+void RemoteStreamImpl::useCachedMeta()
+{
+    MetaCache::Entry entry;
+
+    if (!MetaCache::getSharedInstance()->get(streamPrefix_.toUri(), entry))
+        return;
+
+    streamMeta_ = entry.streamMeta_;
+    threadsMeta_ = entry.threadsMeta_;
+    isMetaCached_ = true;
+    needMeta_ = false;
+
+    LogInfoC << "using cached meta info. "
+             << streamMeta_->getThreads().size() << " thread(s), timestamp "
+             << streamMeta_->getStreamTimestamp() << std::endl;
+
+    prefetch();
+    notifyObservers(RemoteStream::Event::NewMeta);
+
+    if (cuedToRun_ && !isRunning_)
+        initiateFetching();
+}
+
 void RemoteStreamImpl::initiateFetching()
 {
     if (threadName_ == "")
@@ -38,6 +38,7 @@ class IPlayout;
 class IPlayoutControl;
 class MediaStreamMeta;
 class MetaFetcher;
+class ObjectPool;
 class RetransmissionController;
 
 // forward delcaration of typedef'ed template class
@@ -62,13 +63,16 @@ class RemoteStreamImpl : public NdnRtcComponent
 
     void fetchMeta();
     void start(const std::string &threadName);
-    void setThread(const std::string &threadName);
+    virtual void setThread(const std::string &threadName);
     std::string getThread() const { return threadName_; }
     void stop();
 
     void setInterestLifetime(unsigned int lifetimeMs);
     void setTargetBufferSize(unsigned int bufferSizeMs);
     void setPipelineSize(unsigned int pipelineSizeSamples);
+    void setPipelineStrategy(RemoteStream::PipelineStrategy strategy);
+    void setJitterPercentile(double percentile);
+    void setFastJoin(bool enabled);
     void setLogger(boost::shared_ptr<ndnlog::new_api::Logger> logger);
 
     bool isVerified() const;
@@ -84,12 +88,16 @@ class RemoteStreamImpl : public NdnRtcComponent
     MediaStreamParams::MediaStreamType type_;
     boost::asio::io_service &io_;
     bool needMeta_, isRunning_, cuedToRun_;
-    int64_t metadataRequestedMs_;
+    bool fastJoin_, isMetaCached_;
+    RemoteStream::PipelineStrategy pipelineStrategy_;
+    int64_t metadataRequestedMs_, startRequestedMs_;
     boost::shared_ptr<ndn::Face> face_;
     boost::shared_ptr<ndn::KeyChain> keyChain_;
     ndn::Name streamPrefix_;
     std::string threadName_;
     boost::shared_ptr<statistics::StatisticsStorage> sstorage_;
+    // per-stream pool for segments and Interests
+    boost::shared_ptr<ObjectPool> objectPool_;
 
     std::vector<IRemoteStreamObserver *> observers_;
     boost::shared_ptr<MetaFetcher> metaFetcher_;
@@ -118,6 +126,9 @@ class RemoteStreamImpl : public NdnRtcComponent
     void fetchThreadMeta(const std::string &threadName, const int64_t& metadataRequestedMs);
     void streamMetaFetched(NetworkDataAlias &);
     void threadMetaFetched(const std::string &thread, NetworkDataAlias &);
+    void useCachedMeta();
+    // called in fast-join mode, as soon as stream timestamp is known
+    virtual void prefetch() {}
     virtual void initiateFetching();
     virtual void stopFetching();
     void addValidationInfo(const std::vector<ValidationErrorInfo> &);
@@ -71,6 +71,24 @@ RemoteStream::setTargetBufferSize(unsigned int bufferSize)
 	pimpl_->setTargetBufferSize(bufferSize);
 }
 
+void
+RemoteStream::setPipelineStrategy(PipelineStrategy strategy)
+{
+	pimpl_->setPipelineStrategy(strategy);
+}
+
+void
+RemoteStream::setJitterPercentile(double percentile)
+{
+	pimpl_->setJitterPercentile(percentile);
+}
+
+void
+RemoteStream::setFastJoin(bool enabled)
+{
+	pimpl_->setFastJoin(enabled);
+}
+
 statistics::StatisticsStorage
 RemoteStream::getStatistics() const
 {
@@ -160,6 +178,12 @@ RemoteVideoStream::start(const std::string& threadName, IExternalRenderer* rende
 	boost::dynamic_pointer_cast<RemoteVideoStreamImpl>(pimpl_)->start(threadName, renderer);
 }
 
+void
+RemoteVideoStream::start(const std::string& threadName, IExternalPlanarRenderer* renderer)
+{
+	boost::dynamic_pointer_cast<RemoteVideoStreamImpl>(pimpl_)->start(threadName, renderer);
+}
+
 RemoteVideoStream::RemoteVideoStream(boost::asio::io_service& faceIo,
 			const boost::shared_ptr<ndn::Face>& face,
 			const boost::shared_ptr<ndn::KeyChain>& keyChain,
@@ -187,4 +211,48 @@ void
 RemoteVideoStream::start(const FetchingRuleSet& ruleset, IExternalRenderer* renderer)
 {
     boost::dynamic_pointer_cast<RemoteVideoStreamImpl>(pimpl_)->start(ruleset, renderer);
+}
+
+void
+RemoteVideoStream::start(const FetchingRuleSet& ruleset, IExternalPlanarRenderer* renderer)
+{
+    boost::dynamic_pointer_cast<RemoteVideoStreamImpl>(pimpl_)->start(ruleset, renderer);
+}
+
+void
+RemoteVideoStream::start(const std::string& threadName, const PreviewSettings& settings,
+                         IExternalRenderer* renderer)
+{
+    boost::dynamic_pointer_cast<RemoteVideoStreamImpl>(pimpl_)->start(threadName, settings, renderer);
+}
+
+void
+RemoteVideoStream::start(const std::string& threadName, const PreviewSettings& settings,
+                         IExternalPlanarRenderer* renderer)
+{
+    boost::dynamic_pointer_cast<RemoteVideoStreamImpl>(pimpl_)->start(threadName, settings, renderer);
+}
+
+void
+RemoteVideoStream::setRateAdaptation(bool enabled)
+{
+    boost::dynamic_pointer_cast<RemoteVideoStreamImpl>(pimpl_)->setRateAdaptation(enabled);
+}
+
+void
+RemoteVideoStream::setParityPolicy(ParityPolicy policy)
+{
+    boost::dynamic_pointer_cast<RemoteVideoStreamImpl>(pimpl_)->setParityPolicy(policy);
+}
+
+void
+RemoteVideoStream::setMaxTemporalLayer(unsigned int maxLayer)
+{
+    boost::dynamic_pointer_cast<RemoteVideoStreamImpl>(pimpl_)->setMaxTemporalLayer(maxLayer);
+}
+
+void
+RemoteVideoStream::setSharedFetching(bool enabled)
+{
+    boost::dynamic_pointer_cast<RemoteVideoStreamImpl>(pimpl_)->setSharedFetching(enabled);
 }
\ No newline at end of file
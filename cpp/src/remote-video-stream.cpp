@@ -7,6 +7,9 @@
 
 #include "remote-video-stream.hpp"
 #include <ndn-cpp/name.hpp>
+#include <ndn-cpp/face.hpp>
+#include <ndn-cpp/network-nack.hpp>
+#include <algorithm>
 #include <webrtc/common_video/libyuv/include/webrtc_libyuv.h>
 
 #include "interfaces.hpp"
@@ -20,7 +23,24 @@
 #include "sample-estimator.hpp"
 #include "sample-validator.hpp"
 #include "video-decoder.hpp"
+#include "decode-stage.hpp"
 #include "clock.hpp"
+#include "frame-trace.hpp"
+#include "render-buffer-pool.hpp"
+#include "rate-adaptation-module.hpp"
+#include "segment-controller.hpp"
+#include "buffer-control.hpp"
+#include "meta-cache.hpp"
+#include "meta-fetcher.hpp"
+#include "periodic.hpp"
+#include "preview-fetcher.hpp"
+#include "video-coder.hpp"
+#include "async.hpp"
+#include "stream-registry.hpp"
+#include "shared-fetch-observer.hpp"
+
+#define RATE_ADAPTATION_INTERVAL_MS 50
+#define KEY_PREFETCH_LIFETIME_MS 2000
 
 using namespace ndnrtc;
 using namespace ndn;
@@ -83,12 +103,70 @@ class PlaybackObserver : public IVideoPlayoutObserver {
         }
 };
 
+/**
+ * Feeds rate adaptation module with Interest/Data events of the stream
+ */
+class ndnrtc::RateAdaptationObserver : public IBufferObserver,
+                                       public ISegmentControllerObserver {
+    public:
+    RateAdaptationObserver(boost::shared_ptr<RateAdaptationModule> module,
+                           const std::vector<std::string>& streamThreads)
+                           : module_(module), streamThreads_(streamThreads) {}
+
+    // IBufferObserver
+    void onNewRequest(const boost::shared_ptr<BufferSlot>& slot)
+    {
+        module_->interestExpressed(slot->getPrefix().toUri(),
+                                   streamId(slot->getNameInfo().threadName_));
+    }
+    void onNewData(const BufferReceipt& receipt)
+    {
+        const boost::shared_ptr<const SlotSegment>& segment = receipt.segment_;
+        module_->dataReceived(segment->getData()->getData()->getName().toUri(),
+                              streamId(segment->getInfo().threadName_),
+                              segment->getData()->getData()->getContent().size(),
+                              (double)segment->getRoundTripDelayUsec() / 1000.,
+                              (segment->getRequestNum() ? segment->getRequestNum() - 1 : 0));
+    }
+    void onReset() {}
+
+    // ISegmentControllerObserver
+    void segmentArrived(const boost::shared_ptr<WireSegment> &) {}
+    void segmentRequestTimeout(const NamespaceInfo &info,
+                               const boost::shared_ptr<const ndn::Interest> &interest)
+    {
+        module_->interestTimeout(interest->getName().toUri(), streamId(info.threadName_));
+    }
+    void segmentNack(const NamespaceInfo &info, int,
+                     const boost::shared_ptr<const ndn::Interest> &interest)
+    {
+        module_->interestTimeout(interest->getName().toUri(), streamId(info.threadName_));
+    }
+    void segmentStarvation() {}
+
+    private:
+    boost::shared_ptr<RateAdaptationModule> module_;
+    std::vector<std::string> streamThreads_;
+
+    unsigned int streamId(const std::string& thread) const {
+        return std::find(streamThreads_.begin(), streamThreads_.end(), thread) - streamThreads_.begin();
+    }
+};
+
 RemoteVideoStreamImpl::RemoteVideoStreamImpl(boost::asio::io_service &io,
                                              const boost::shared_ptr<ndn::Face> &face,
                                              const boost::shared_ptr<ndn::KeyChain> &keyChain,
                                              const std::string &streamPrefix) 
     : RemoteStreamImpl(io, face, keyChain, streamPrefix)
     , isPlaybackDriven_(false)
+    , isRateAdaptationEnabled_(false)
+    , isPreview_(false)
+    , isFirstFrame_(false)
+    , isSharedFetching_(false)
+    , isFetchOwner_(false)
+    , renderer_(nullptr)
+    , planarRenderer_(nullptr)
+    , previewWidth_(0), previewHeight_(0)
 {
     construct();
 }
@@ -100,6 +178,14 @@ RemoteVideoStreamImpl::RemoteVideoStreamImpl(boost::asio::io_service &io,
                                              const std::string &threadName)
     : RemoteStreamImpl(io, face, keyChain, streamPrefix)
     , isPlaybackDriven_(true)
+    , isRateAdaptationEnabled_(false)
+    , isPreview_(false)
+    , isFirstFrame_(false)
+    , isSharedFetching_(false)
+    , isFetchOwner_(false)
+    , renderer_(nullptr)
+    , planarRenderer_(nullptr)
+    , previewWidth_(0), previewHeight_(0)
 {
     threadName_ = threadName;
 
@@ -119,10 +205,17 @@ void RemoteVideoStreamImpl::construct()
     pps.playbackQueue_ = playbackQueue_;
     pps.segmentController_ = segmentController_;
     pps.sstorage_ = sstorage_;
+    pps.objectPool_ = objectPool_;
 
-    pipeliner_ = make_shared<Pipeliner>(pps, boost::make_shared<Pipeliner::VideoNameScheme>());
+    boost::shared_ptr<Pipeliner> pipeliner = make_shared<Pipeliner>(pps, boost::make_shared<Pipeliner::VideoNameScheme>());
+    // needed for on-demand parity fetching
+    segmentController_->attach(pipeliner.get());
+    rtxController_->attach(pipeliner.get());
+    pipeliner_ = pipeliner;
     playout_ = boost::make_shared<VideoPlayout>(io_, playbackQueue_, sstorage_);
-    playoutControl_ = boost::make_shared<PlayoutControl>(playout_, playbackQueue_, rtxController_);
+    boost::shared_ptr<PlayoutControl> playoutControl = boost::make_shared<PlayoutControl>(playout_, playbackQueue_, rtxController_);
+    playoutControl->setCatchUpEnabled(true);
+    playoutControl_ = playoutControl;
     playbackQueue_->attach(playoutControl_.get());
     latencyControl_->setPlayoutControl(playoutControl_);
     drdEstimator_->attach(playoutControl_.get());
@@ -133,43 +226,77 @@ void RemoteVideoStreamImpl::construct()
 
 RemoteVideoStreamImpl::~RemoteVideoStreamImpl()
 {
+    releaseFetch();
     buffer_->detach(validator_.get());
+    segmentController_->detach(dynamic_pointer_cast<Pipeliner>(pipeliner_).get());
+    rtxController_->detach(dynamic_pointer_cast<Pipeliner>(pipeliner_).get());
 }
 
 void RemoteVideoStreamImpl::start(const std::string &threadName,
                                   IExternalRenderer *renderer)
 {
-    if (isPlaybackDriven_)
-        throw std::runtime_error("Can't bootstrap for live stream: stream created as playback-driven.");
-
     assert(renderer);
     renderer_ = renderer;
-    RemoteStreamImpl::start(threadName);
+    startLive(threadName);
 }
 
 void RemoteVideoStreamImpl::start(const RemoteVideoStream::FetchingRuleSet& ruleset, 
                                   IExternalRenderer *renderer)
 {
-    if (!isPlaybackDriven_)
-        throw std::runtime_error("Trying to initiate playback-driven fetch, but the stream is not "
-            "playback-driven.");
-
     assert(renderer);
     renderer_ = renderer;
-    ruleset_ = ruleset;
+    startPlaybackDriven(ruleset);
+}
 
-    sampleEstimator_->bootstrapSegmentNumber(3, SampleClass::Delta, SegmentClass::Data);
-    sampleEstimator_->bootstrapSegmentNumber(1, SampleClass::Delta, SegmentClass::Parity);
-    sampleEstimator_->bootstrapSegmentNumber(7, SampleClass::Key, SegmentClass::Data);
-    sampleEstimator_->bootstrapSegmentNumber(2, SampleClass::Key, SegmentClass::Parity);
+void RemoteVideoStreamImpl::start(const std::string &threadName,
+                                  IExternalPlanarRenderer *renderer)
+{
+    setupPlanarRenderer(renderer);
+    startLive(threadName);
+}
 
-    RemoteStreamImpl::start(threadName_);
+void RemoteVideoStreamImpl::start(const RemoteVideoStream::FetchingRuleSet& ruleset, 
+                                  IExternalPlanarRenderer *renderer)
+{
+    setupPlanarRenderer(renderer);
+    startPlaybackDriven(ruleset);
+}
+
+void RemoteVideoStreamImpl::start(const std::string &threadName,
+                                  const RemoteVideoStream::PreviewSettings &settings,
+                                  IExternalRenderer *renderer)
+{
+    assert(renderer);
+    renderer_ = renderer;
+    startPreview(threadName, settings);
+}
+
+void RemoteVideoStreamImpl::start(const std::string &threadName,
+                                  const RemoteVideoStream::PreviewSettings &settings,
+                                  IExternalPlanarRenderer *renderer)
+{
+    setupPlanarRenderer(renderer);
+    startPreview(threadName, settings);
 }
 
 void RemoteVideoStreamImpl::initiateFetching()
 {
     RemoteStreamImpl::initiateFetching();
 
+    if (isPreview_)
+    {
+        isFirstFrame_ = true;
+        setupDecoder();
+        setupPreview();
+        return;
+    }
+
+    if (isSharedFetching_ && !isPlaybackDriven_ && !acquireFetch())
+    {
+        startSubscribed();
+        return;
+    }
+
     if (isPlaybackDriven_)
     {
         playbackObserver_ = boost::make_shared<PlaybackObserver>(pipeliner_, 
@@ -181,24 +308,67 @@ void RemoteVideoStreamImpl::initiateFetching()
     {
         bufferObserver_ = boost::make_shared<BufferObserver>(pipeliner_, interestControl_);
         buffer_->attach(bufferObserver_.get());
+
+        // BBR strategy needs sample arrivals to estimate bottleneck rate
+        if (pipelineStrategy_ == RemoteStream::PipelineStrategyBbr)
+            bufferControl_->attach((InterestControl *)interestControl_.get());
     }
 
+    // size pipeline for the average sample of the thread, until
+    // sample estimator gets its' own statistics
+    if (!isPlaybackDriven_)
+        bootstrapSegmentNumbers(threadName_);
+
+    isFirstFrame_ = true;
     setupDecoder();
     setupPipelineControl();
     pipelineControl_->start();
+
+    if (isRateAdaptationEnabled_ && !isPlaybackDriven_)
+        setupRateAdaptation();
 }
 
 void RemoteVideoStreamImpl::stopFetching()
 {
+    if (isPreview_)
+    {
+        if (isRunning_)
+        {
+            releasePreview();
+            releaseDecoder();
+            segmentController_->setIsActive(false);
+            isRunning_ = false;
+            needMeta_ = false;
+        }
+        return;
+    }
+
+    if (fanOut_ && !isFetchOwner_)
+    {
+        if (isRunning_)
+        {
+            stopSubscribed();
+            releaseDecoder();
+            isRunning_ = false;
+            needMeta_ = false;
+        }
+        return;
+    }
+
     RemoteStreamImpl::stopFetching();
 
     if (isPlaybackDriven_)
         dynamic_pointer_cast<VideoPlayout>(playout_)->detach(playbackObserver_.get());
     else
+    {
         buffer_->detach(bufferObserver_.get());
+        bufferControl_->detach((InterestControl *)interestControl_.get());
+    }
 
+    releaseRateAdaptation();
     releasePipelineControl();
     releaseDecoder();
+    releaseFetch();
 }
 
 void RemoteVideoStreamImpl::setLogger(boost::shared_ptr<ndnlog::new_api::Logger> logger)
@@ -207,6 +377,86 @@ void RemoteVideoStreamImpl::setLogger(boost::shared_ptr<ndnlog::new_api::Logger>
     validator_->setLogger(logger);
     boost::dynamic_pointer_cast<NdnRtcComponent>(playoutControl_)->setLogger(logger);
     boost::dynamic_pointer_cast<Playout>(playout_)->setLogger(logger);
+    if (decodeStage_)
+        decodeStage_->setLogger(logger);
+    if (previewFetcher_)
+        previewFetcher_->setLogger(logger);
+}
+
+void RemoteVideoStreamImpl::setThread(const std::string &threadName)
+{
+    if (!isRunning_ || isPlaybackDriven_)
+    {
+        RemoteStreamImpl::setThread(threadName);
+        return;
+    }
+
+    if (threadsMeta_.find(threadName) == threadsMeta_.end())
+        throw std::runtime_error("Can't find requested thread to switch to");
+
+    boost::shared_ptr<RemoteVideoStreamImpl> me = boost::dynamic_pointer_cast<RemoteVideoStreamImpl>(shared_from_this());
+
+    // preview has no pipeline state to carry over - just restart it
+    if (isPreview_)
+    {
+        async::dispatchAsync(io_, [me, threadName, this]() {
+            if (!isRunning_ || threadName == threadName_)
+                return;
+
+            releasePreview();
+            threadName_ = threadName;
+            setupPreview();
+            (*sstorage_)[Indicator::ThreadSwitchesNum]++;
+            notifyObservers(RemoteStream::Event::ThreadSwitched);
+        });
+        return;
+    }
+
+    async::dispatchAsync(io_, [me, threadName]() {
+        me->switchThread(threadName);
+    });
+}
+
+void RemoteVideoStreamImpl::setRateAdaptation(bool enabled)
+{
+    boost::shared_ptr<RemoteVideoStreamImpl> me = boost::dynamic_pointer_cast<RemoteVideoStreamImpl>(shared_from_this());
+    async::dispatchAsync(io_, [me, enabled, this]() {
+        if (isRateAdaptationEnabled_ == enabled)
+            return;
+
+        isRateAdaptationEnabled_ = enabled;
+        if (isRunning_ && !isPlaybackDriven_ && !isPreview_)
+        {
+            if (enabled)
+                setupRateAdaptation();
+            else
+                releaseRateAdaptation();
+        }
+    });
+}
+
+void RemoteVideoStreamImpl::setParityPolicy(RemoteVideoStream::ParityPolicy policy)
+{
+    boost::shared_ptr<RemoteVideoStreamImpl> me = boost::dynamic_pointer_cast<RemoteVideoStreamImpl>(shared_from_this());
+    async::dispatchAsync(io_, [me, policy, this]() {
+        dynamic_pointer_cast<Pipeliner>(pipeliner_)->setParityOnDemand(policy == RemoteVideoStream::ParityPolicyOnDemand);
+    });
+}
+
+void RemoteVideoStreamImpl::setMaxTemporalLayer(unsigned int maxLayer)
+{
+    boost::shared_ptr<RemoteVideoStreamImpl> me = boost::dynamic_pointer_cast<RemoteVideoStreamImpl>(shared_from_this());
+    async::dispatchAsync(io_, [me, maxLayer, this]() {
+        dynamic_pointer_cast<Pipeliner>(pipeliner_)->setMaxTemporalLayer(maxLayer);
+    });
+}
+
+void RemoteVideoStreamImpl::setSharedFetching(bool enabled)
+{
+    if (isRunning_)
+        throw std::runtime_error("Can't change shared fetching while fetching");
+
+    isSharedFetching_ = enabled;
 }
 
 #pragma mark private
@@ -220,6 +470,7 @@ void RemoteVideoStreamImpl::feedFrame(const FrameInfo &frameInfo, const WebRtcVi
     if (rgbFrameBuffer)
     {
         LogTraceC << "passing frame " << frameInfo.playbackNo_ << "p to renderer" << std::endl;
+        FrameTraceScope(Render, frameInfo.playbackNo_);
 
         // @see frame-converter.cpp for explanation, why we flipping ARGB <-> BGRA data representations
         // webrtc::VideoType videoType = (bufferType == IExternalRenderer::kARGB ? webrtc::kARGB : webrtc::kBGRA);
@@ -233,26 +484,262 @@ void RemoteVideoStreamImpl::feedFrame(const FrameInfo &frameInfo, const WebRtcVi
         LogTraceC << "renderer is busy." << std::endl;
 }
 
+void RemoteVideoStreamImpl::feedPlanarFrame(const FrameInfo &frameInfo, const WebRtcVideoFrame &frame)
+{
+    PlanarFrame planarFrame;
+
+    if (renderBufferPool_->acquire(frame, planarFrame))
+    {
+        LogTraceC << "passing frame " << frameInfo.playbackNo_ << "p to renderer (swap buffer "
+                  << planarFrame.bufferIdx_ << ")" << std::endl;
+
+        FrameTraceScope(Render, frameInfo.playbackNo_);
+        planarRenderer_->renderFrame(frameInfo, planarFrame, renderBufferPool_.get());
+    }
+    else
+        LogTraceC << "renderer is busy (all " << renderBufferPool_->getSize() 
+                  << " swap buffers are held)." << std::endl;
+}
+
+void RemoteVideoStreamImpl::frameDecoded(const FrameInfo &frameInfo, const WebRtcVideoFrame &frame)
+{
+    if (isFirstFrame_.exchange(false))
+    {
+        (*sstorage_)[Indicator::TimeToFirstFrame] = clock::millisecondTimestamp() - startRequestedMs_;
+        LogInfoC << "first frame " << frameInfo.playbackNo_ << "p in "
+                 << (*sstorage_)[Indicator::TimeToFirstFrame] << "ms" << std::endl;
+    }
+
+    if (isPreview_ && previewSettings_.scale_ > 0 && previewSettings_.scale_ < 1)
+    {
+        const WebRtcVideoFrame scaled = scalePreview(frame);
+
+        if (planarRenderer_)
+            feedPlanarFrame(frameInfo, scaled);
+        else
+            feedFrame(frameInfo, scaled);
+        return;
+    }
+
+    if (planarRenderer_)
+        feedPlanarFrame(frameInfo, frame);
+    else
+        feedFrame(frameInfo, frame);
+}
+
+void RemoteVideoStreamImpl::startLive(const std::string &threadName)
+{
+    if (isPlaybackDriven_)
+        throw std::runtime_error("Can't bootstrap for live stream: stream created as playback-driven.");
+
+    isPreview_ = false;
+    RemoteStreamImpl::start(threadName);
+}
+
+void RemoteVideoStreamImpl::startPreview(const std::string &threadName,
+                                         const RemoteVideoStream::PreviewSettings &settings)
+{
+    if (isPlaybackDriven_)
+        throw std::runtime_error("Can't start preview: stream created as playback-driven.");
+
+    isPreview_ = true;
+    previewSettings_ = settings;
+    RemoteStreamImpl::start(threadName);
+}
+
+void RemoteVideoStreamImpl::startPlaybackDriven(const RemoteVideoStream::FetchingRuleSet& ruleset)
+{
+    if (!isPlaybackDriven_)
+        throw std::runtime_error("Trying to initiate playback-driven fetch, but the stream is not "
+            "playback-driven.");
+
+    ruleset_ = ruleset;
+
+    sampleEstimator_->bootstrapSegmentNumber(3, SampleClass::Delta, SegmentClass::Data);
+    sampleEstimator_->bootstrapSegmentNumber(1, SampleClass::Delta, SegmentClass::Parity);
+    sampleEstimator_->bootstrapSegmentNumber(7, SampleClass::Key, SegmentClass::Data);
+    sampleEstimator_->bootstrapSegmentNumber(2, SampleClass::Key, SegmentClass::Parity);
+
+    RemoteStreamImpl::start(threadName_);
+}
+
+bool RemoteVideoStreamImpl::acquireFetch()
+{
+    Name threadPrefix(getStreamPrefix());
+    threadPrefix.append(threadName_);
+
+    boost::weak_ptr<RemoteVideoStreamImpl> me = boost::dynamic_pointer_cast<RemoteVideoStreamImpl>(shared_from_this());
+    boost::shared_ptr<SharedFetchObserver> subscriber = boost::make_shared<SharedFetchObserver>(io_, buffer_, bufferControl_, sstorage_);
+
+    fanOutSubscriber_ = subscriber;
+    fanOut_ = StreamRegistry::getSharedInstance()->acquire(threadPrefix.toUri(), subscriber.get(),
+                                                           [me, subscriber, this]() {
+                                                               boost::shared_ptr<RemoteVideoStreamImpl> stream = me.lock();
+                                                               if (stream)
+                                                                   async::dispatchAsync(io_, [stream, subscriber]() {
+                                                                       stream->fetchOwnerLeft(subscriber);
+                                                                   });
+                                                           },
+                                                           isFetchOwner_,
+                                                           [subscriber](const Name &samplePrefix, BufferSlot::Verification status) {
+                                                               subscriber->onVerified(samplePrefix, status);
+                                                           });
+
+    if (isFetchOwner_)
+    {
+        boost::shared_ptr<FetchFanOut> fanOut = fanOut_;
+
+        fanOutSubscriber_.reset();
+        buffer_->attach(fanOut_.get());
+        validator_->setOnVerified([fanOut](const Name &samplePrefix, BufferSlot::Verification status) {
+            fanOut->onVerified(samplePrefix, status);
+        });
+        LogInfoC << "fetching " << threadPrefix << " for subscribers in this process" << std::endl;
+    }
+
+    return isFetchOwner_;
+}
+
+void RemoteVideoStreamImpl::releaseFetch()
+{
+    if (!fanOut_)
+        return;
+
+    if (isFetchOwner_)
+    {
+        buffer_->detach(fanOut_.get());
+        validator_->setOnVerified(ManifestValidator::OnVerified());
+        StreamRegistry::getSharedInstance()->release(fanOut_);
+    }
+    else
+        fanOut_->unsubscribe(fanOutSubscriber_.get());
+
+    fanOut_.reset();
+    fanOutSubscriber_.reset();
+    isFetchOwner_ = false;
+}
+
+void RemoteVideoStreamImpl::startSubscribed()
+{
+    LogInfoC << "subscribed to shared fetch of " << fanOut_->getThreadPrefix() << std::endl;
+
+    // this stream does not express Interests: segments come from the owner,
+    // once it has verified their samples
+    segmentController_->setIsActive(false);
+    validator_->setIsVerifiedUpstream(true);
+    buffer_->detach(rtxController_.get());
+
+    isFirstFrame_ = true;
+    setupDecoder();
+    playoutControl_->allowPlayout(true);
+}
+
+void RemoteVideoStreamImpl::stopSubscribed()
+{
+    releaseFetch();
+    buffer_->reset();
+    playoutControl_->allowPlayout(false);
+    validator_->setIsVerifiedUpstream(false);
+    buffer_->attach(rtxController_.get());
+}
+
+void RemoteVideoStreamImpl::fetchOwnerLeft(const boost::shared_ptr<IBufferObserver> &subscriber)
+{
+    if (!isRunning_ || fanOutSubscriber_ != subscriber)
+        return;
+
+    LogInfoC << "owner of shared fetch stopped fetching. restarting" << std::endl;
+
+    // one of the subscribers becomes the new owner
+    stopFetching();
+    initiateFetching();
+}
+
+void RemoteVideoStreamImpl::setupPlanarRenderer(IExternalPlanarRenderer *renderer)
+{
+    assert(renderer);
+    planarRenderer_ = renderer;
+    // previous pool stays alive until its' frames are released by the renderer
+    renderBufferPool_ = RenderBufferPool::create(renderer->getPixelFormat(),
+                                                 renderer->getSwapBuffersNum());
+}
+
 void RemoteVideoStreamImpl::setupDecoder()
 {
     boost::shared_ptr<RemoteVideoStreamImpl> me = boost::dynamic_pointer_cast<RemoteVideoStreamImpl>(shared_from_this());
     VideoThreadMeta meta(threadsMeta_[threadName_]->data());
+    // decoding runs on decode stage thread, decoded frames are presented
+    // on playout ticks; preview key frames are not paced by playout and
+    // are presented on decode thread as soon as they are decoded
+    boost::shared_ptr<DecodeStage> decodeStage =
+        boost::make_shared<DecodeStage>(sstorage_,
+                                        [this, me](const FrameInfo& finfo, const WebRtcVideoFrame &frame) 
+                                        {
+                                           frameDecoded(finfo, frame);
+                                        },
+                                        isPreview_);
+    // decoder is invoked only on decode thread, which is joined before the
+    // stage is destroyed
+    DecodeStage *stage = decodeStage.get();
     boost::shared_ptr<VideoDecoder> decoder =
         boost::make_shared<VideoDecoder>(meta.getCoderParams(),
-                                         [this, me](const FrameInfo& finfo, const WebRtcVideoFrame &frame) 
+                                         [stage](const FrameInfo& finfo, const WebRtcVideoFrame &frame)
                                          {
-                                            feedFrame(finfo, frame);
+                                            stage->frameDecoded(finfo, frame);
                                          });
-    boost::dynamic_pointer_cast<VideoPlayout>(playout_)->registerFrameConsumer(decoder.get());
+    decodeStage->setDecoder(decoder);
+    decodeStage->setLogger(logger_);
+    boost::dynamic_pointer_cast<VideoPlayout>(playout_)->registerFrameConsumer(decodeStage.get());
     decoder_ = decoder;
+    decodeStage_ = decodeStage;
 }
 
 void RemoteVideoStreamImpl::releaseDecoder()
 {
     dynamic_pointer_cast<VideoPlayout>(playout_)->deregisterFrameConsumer();
+    decodeStage_.reset();
     decoder_.reset();
 }
 
+void RemoteVideoStreamImpl::setupPreview()
+{
+    Name threadPrefix(getStreamPrefix());
+    threadPrefix.append(threadName_);
+
+    previewFetcher_ = boost::make_shared<PreviewFetcher>(io_, face_, threadPrefix,
+                                                         VideoThreadMeta(threadsMeta_[threadName_]->data()),
+                                                         previewSettings_.keyStep_, sstorage_,
+                                                         validator_);
+    previewFetcher_->setLogger(logger_);
+    previewFetcher_->start(decodeStage_.get());
+}
+
+void RemoteVideoStreamImpl::releasePreview()
+{
+    if (!previewFetcher_)
+        return;
+
+    previewFetcher_->stop();
+    previewFetcher_.reset();
+}
+
+const WebRtcVideoFrame
+RemoteVideoStreamImpl::scalePreview(const WebRtcVideoFrame &frame)
+{
+    // dimensions are kept even for chroma subsampling
+    unsigned int width = std::max(2u, (unsigned int)(frame.width() * previewSettings_.scale_) & ~1u);
+    unsigned int height = std::max(2u, (unsigned int)(frame.height() * previewSettings_.scale_) & ~1u);
+
+    if (!previewScaler_ || width != previewWidth_ || height != previewHeight_)
+    {
+        previewScaler_ = boost::make_shared<FrameScaler>(width, height);
+        previewWidth_ = width;
+        previewHeight_ = height;
+    }
+
+    return (*previewScaler_)(frame);
+}
+
 void RemoteVideoStreamImpl::setupPipelineControl()
 {
     Name threadPrefix(getStreamPrefix());
@@ -294,3 +781,257 @@ void RemoteVideoStreamImpl::releasePipelineControl()
 
     pipelineControl_.reset();
 }
+
+void RemoteVideoStreamImpl::switchThread(const std::string &threadName)
+{
+    if (!isRunning_ || threadName == threadName_)
+        return;
+
+    // subscriber has no pipeline to switch: subscribe to (or fetch) the new
+    // thread instead. owner switches as usual and hands fan-out over once
+    // switched (see threadSwitched())
+    if (fanOut_ && !isFetchOwner_)
+    {
+        LogInfoC << "switching thread " << threadName_ << " -> " << threadName
+                 << " (re-subscribing)" << std::endl;
+        stopFetching();
+        threadName_ = threadName;
+        initiateFetching();
+        (*sstorage_)[Indicator::ThreadSwitchesNum]++;
+        notifyObservers(RemoteStream::Event::ThreadSwitched);
+        return;
+    }
+
+    if (pendingThread_ != "")
+    {
+        LogWarnC << "can't switch to " << threadName << ": switch to "
+                 << pendingThread_ << " is in progress" << std::endl;
+        return;
+    }
+
+    LogInfoC << "switching thread " << threadName_ << " -> " << threadName << std::endl;
+    pendingThread_ = threadName;
+
+    // fresh thread metadata is needed to find out sequence numbers of the
+    // upcoming key frame of the new thread
+    Name metaPrefix(getStreamPrefix());
+    metaPrefix.append(threadName).append(NameComponents::NameComponentMeta);
+
+    boost::shared_ptr<RemoteVideoStreamImpl> me = boost::dynamic_pointer_cast<RemoteVideoStreamImpl>(shared_from_this());
+    metaFetcher_->fetch(metaPrefix,
+                        [me, threadName, this](NetworkData &meta,
+                                               const std::vector<ValidationErrorInfo> &validationInfo,
+                                               const std::vector<boost::shared_ptr<Data>>&) {
+                            me->addValidationInfo(validationInfo);
+                            threadsMeta_[threadName] = boost::make_shared<NetworkData>(boost::move(meta));
+                            MetaCache::getSharedInstance()->storeThreadMeta(streamPrefix_.toUri(), threadName,
+                                                                            threadsMeta_[threadName]);
+
+                            if (!isRunning_ || !pipelineControl_)
+                            {
+                                pendingThread_ = "";
+                                return;
+                            }
+
+                            Name threadPrefix(getStreamPrefix());
+                            threadPrefix.append(threadName);
+                            VideoThreadMeta threadMeta(threadsMeta_[threadName]->data());
+                            pipelineControl_->switchThread(threadPrefix, threadMeta,
+                                                           [me, threadName](const Name &) {
+                                                               me->threadSwitched(threadName);
+                                                           });
+                        },
+                        [me, threadName, this](const std::string &msg) {
+                            LogWarnC << "error fetching thread meta for " << threadName
+                                     << ", thread switch cancelled: " << msg << std::endl;
+                            pendingThread_ = "";
+                        });
+}
+
+void RemoteVideoStreamImpl::threadSwitched(const std::string &threadName)
+{
+    LogInfoC << "switched thread " << threadName_ << " -> " << threadName << std::endl;
+
+    bootstrapSegmentNumbers(threadName);
+    threadName_ = threadName;
+    pendingThread_ = "";
+    (*sstorage_)[Indicator::ThreadSwitchesNum]++;
+
+    // fan-out is per-thread: subscribers of the old thread take it over,
+    // while this stream fetches the new one for its' subscribers, unless
+    // other stream fetches it already
+    if (isFetchOwner_)
+    {
+        releaseFetch();
+        if (!acquireFetch())
+        {
+            LogInfoC << "thread " << threadName << " is fetched by other stream. subscribing" << std::endl;
+
+            releaseFetch();
+            boost::shared_ptr<RemoteVideoStreamImpl> me = boost::dynamic_pointer_cast<RemoteVideoStreamImpl>(shared_from_this());
+            async::dispatchAsync(io_, [me, threadName, this]() {
+                if (!isRunning_ || threadName != threadName_)
+                    return;
+
+                stopFetching();
+                initiateFetching();
+            });
+        }
+    }
+
+    if (rateAdaptation_)
+    {
+        std::vector<std::string>::iterator it = std::find(streamThreads_.begin(),
+                                                          streamThreads_.end(), threadName);
+        rateAdaptation_->setCurrentStream(it - streamThreads_.begin());
+    }
+
+    notifyObservers(RemoteStream::Event::ThreadSwitched);
+}
+
+void RemoteVideoStreamImpl::bootstrapSegmentNumbers(const std::string &threadName)
+{
+    VideoThreadMeta meta(threadsMeta_[threadName]->data());
+    sampleEstimator_->bootstrapSegmentNumber(meta.getSegInfo().deltaAvgSegNum_,
+                                             SampleClass::Delta, SegmentClass::Data);
+    sampleEstimator_->bootstrapSegmentNumber(meta.getSegInfo().deltaAvgParitySegNum_,
+                                             SampleClass::Delta, SegmentClass::Parity);
+    sampleEstimator_->bootstrapSegmentNumber(meta.getSegInfo().keyAvgSegNum_,
+                                             SampleClass::Key, SegmentClass::Data);
+    sampleEstimator_->bootstrapSegmentNumber(meta.getSegInfo().keyAvgParitySegNum_,
+                                             SampleClass::Key, SegmentClass::Parity);
+}
+
+void RemoteVideoStreamImpl::prefetch()
+{
+    if (isPlaybackDriven_ || isRunning_ || !streamMeta_ || streamMeta_->getThreads().size() == 0)
+        return;
+
+    // rightmost interest for the key class prefix brings first segment of
+    // the latest key frame; the rest is requested once it arrives. Replies
+    // are discarded - the point is to have key frame in forwarder's cache by
+    // the time pipeline asks for it
+    std::string thread = (threadName_ != "" ? threadName_ : streamMeta_->getThreads().front());
+    Name keyPrefix(getStreamPrefix());
+    keyPrefix.append(thread).append(NameComponents::NameComponentKey);
+
+    Interest interest(keyPrefix, KEY_PREFETCH_LIFETIME_MS);
+    interest.setChildSelector(1);
+    interest.setMustBeFresh(true);
+
+    LogDebugC << "prefetching latest key frame " << keyPrefix << std::endl;
+
+    boost::shared_ptr<RemoteVideoStreamImpl> me = boost::dynamic_pointer_cast<RemoteVideoStreamImpl>(shared_from_this());
+    face_->expressInterest(interest,
+                           [me](const boost::shared_ptr<const Interest> &,
+                                const boost::shared_ptr<Data> &data) {
+                               me->keyPrefetched(data);
+                           },
+                           [me, this](const boost::shared_ptr<const Interest> &i) {
+                               LogDebugC << "key frame prefetch timeout " << i->getName() << std::endl;
+                           },
+                           [me, this](const boost::shared_ptr<const Interest> &i,
+                                      const boost::shared_ptr<NetworkNack> &) {
+                               LogDebugC << "key frame prefetch nack " << i->getName() << std::endl;
+                           });
+}
+
+void RemoteVideoStreamImpl::keyPrefetched(const boost::shared_ptr<Data> &data)
+{
+    NamespaceInfo info;
+
+    if (!NameComponents::extractInfo(data->getName(), info) || !info.hasSegNo_ ||
+        data->getMetaInfo().getFinalBlockId().getValue().size() == 0)
+        return;
+
+    Name samplePrefix = info.getPrefix(prefix_filter::Sample);
+    uint64_t lastSegNo = data->getMetaInfo().getFinalBlockId().toSegment();
+
+    LogDebugC << "prefetched key frame " << samplePrefix
+              << " (" << lastSegNo + 1 << " segments)" << std::endl;
+
+    for (uint64_t segNo = 0; segNo <= lastSegNo; ++segNo)
+    {
+        if (segNo == info.segNo_)
+            continue;
+
+        Interest interest(Name(samplePrefix).appendSegment(segNo), KEY_PREFETCH_LIFETIME_MS);
+        face_->expressInterest(interest,
+                               [](const boost::shared_ptr<const Interest> &, const boost::shared_ptr<Data> &) {},
+                               [](const boost::shared_ptr<const Interest> &) {});
+    }
+}
+
+void RemoteVideoStreamImpl::setupRateAdaptation()
+{
+    std::vector<StreamEntry> streams;
+
+    streamThreads_.clear();
+    for (auto &it : threadsMeta_)
+    {
+        VideoThreadMeta meta(it.second->data());
+        FrameSegmentsInfo segInfo = meta.getSegInfo();
+        StreamEntry entry;
+
+        entry.id_ = streamThreads_.size();
+        entry.bitrate_ = meta.getCoderParams().startBitrate_;
+        entry.parityRatio_ = (segInfo.deltaAvgSegNum_ > 0 ? segInfo.deltaAvgParitySegNum_ / segInfo.deltaAvgSegNum_ : 0);
+
+        streams.push_back(entry);
+        streamThreads_.push_back(it.first);
+    }
+
+    rateAdaptation_ = boost::make_shared<RateAdaptationModule>(drdEstimator_, sstorage_);
+    rateAdaptation_->setLogger(logger_);
+    if (rateAdaptation_->initialize(CodecModeNormal, streams.size(), streams.data()) < 0)
+    {
+        LogWarnC << "failed to initialize rate adaptation" << std::endl;
+        rateAdaptation_.reset();
+        return;
+    }
+
+    rateAdaptation_->setCurrentStream(std::find(streamThreads_.begin(), streamThreads_.end(), threadName_) -
+                                      streamThreads_.begin());
+
+    rateObserver_ = boost::make_shared<RateAdaptationObserver>(rateAdaptation_, streamThreads_);
+    buffer_->attach(rateObserver_.get());
+    segmentController_->attach(rateObserver_.get());
+
+    boost::shared_ptr<RemoteVideoStreamImpl> me = boost::dynamic_pointer_cast<RemoteVideoStreamImpl>(shared_from_this());
+    rateAdaptationTimer_ = boost::make_shared<Periodic>(io_);
+    rateAdaptationTimer_->setupInvocation(RATE_ADAPTATION_INTERVAL_MS,
+                                          [me]() { return me->checkRateAdaptation(); });
+
+    LogInfoC << "rate adaptation enabled" << std::endl;
+}
+
+void RemoteVideoStreamImpl::releaseRateAdaptation()
+{
+    if (!rateAdaptation_)
+        return;
+
+    rateAdaptationTimer_->cancelInvocation();
+    rateAdaptationTimer_.reset();
+    buffer_->detach(rateObserver_.get());
+    segmentController_->detach(rateObserver_.get());
+    rateObserver_.reset();
+    rateAdaptation_.reset();
+
+    LogInfoC << "rate adaptation disabled" << std::endl;
+}
+
+unsigned int RemoteVideoStreamImpl::checkRateAdaptation()
+{
+    if (!rateAdaptation_)
+        return 0;
+
+    double interestRate;
+    unsigned int streamId;
+    rateAdaptation_->getInterestRate(clock::millisecondTimestamp(), interestRate, streamId);
+
+    if (pendingThread_ == "" && streamId < streamThreads_.size() &&
+        streamThreads_[streamId] != threadName_)
+        switchThread(streamThreads_[streamId]);
+
+    return RATE_ADAPTATION_INTERVAL_MS;
+}
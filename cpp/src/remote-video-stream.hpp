@@ -8,6 +8,8 @@
 #ifndef __remote_video_stream_h__
 #define __remote_video_stream_h__
 
+#include <boost/atomic.hpp>
+
 #include "remote-stream-impl.hpp"
 #include "sample-validator.hpp"
 #include "webrtc.hpp"
@@ -21,8 +23,17 @@ class PipelineControl;
 class ManifestValidator;
 class VideoDecoder;
 class IExternalRenderer;
+class IExternalPlanarRenderer;
+class RenderBufferPool;
+class DecodeStage;
 class IVideoPlayoutObserver;
 class IBufferObserver;
+class RateAdaptationModule;
+class RateAdaptationObserver;
+class Periodic;
+class PreviewFetcher;
+class FrameScaler;
+class FetchFanOut;
 
 class RemoteVideoStreamImpl : public RemoteStreamImpl
 {
@@ -46,26 +57,77 @@ class RemoteVideoStreamImpl : public RemoteStreamImpl
 
     void start(const std::string &threadName, IExternalRenderer *render);
     void start(const RemoteVideoStream::FetchingRuleSet& ruleset, IExternalRenderer *render);
+    void start(const std::string &threadName, IExternalPlanarRenderer *render);
+    void start(const RemoteVideoStream::FetchingRuleSet& ruleset, IExternalPlanarRenderer *render);
+    void start(const std::string &threadName, const RemoteVideoStream::PreviewSettings &settings,
+               IExternalRenderer *render);
+    void start(const std::string &threadName, const RemoteVideoStream::PreviewSettings &settings,
+               IExternalPlanarRenderer *render);
     void initiateFetching();
     void stopFetching();
     void setLogger(boost::shared_ptr<ndnlog::new_api::Logger> logger);
 
+    void setThread(const std::string &threadName) override;
+    void setRateAdaptation(bool enabled);
+    void setParityPolicy(RemoteVideoStream::ParityPolicy policy);
+    void setMaxTemporalLayer(unsigned int maxLayer);
+    void setSharedFetching(bool enabled);
+
   private:
-    bool isPlaybackDriven_;
+    bool isPlaybackDriven_, isRateAdaptationEnabled_, isPreview_;
+    // set on io thread, cleared on decode thread
+    boost::atomic<bool> isFirstFrame_;
+    bool isSharedFetching_, isFetchOwner_;
+    std::string pendingThread_;
     boost::shared_ptr<IVideoPlayoutObserver> playbackObserver_;
     boost::shared_ptr<IBufferObserver> bufferObserver_;
     RemoteVideoStream::FetchingRuleSet ruleset_;
+    RemoteVideoStream::PreviewSettings previewSettings_;
+    boost::shared_ptr<PreviewFetcher> previewFetcher_;
+    boost::shared_ptr<FrameScaler> previewScaler_;
+    unsigned int previewWidth_, previewHeight_;
+    boost::shared_ptr<FetchFanOut> fanOut_;
+    boost::shared_ptr<IBufferObserver> fanOutSubscriber_;
 
     boost::shared_ptr<ManifestValidator> validator_;
     IExternalRenderer *renderer_;
+    IExternalPlanarRenderer *planarRenderer_;
+    boost::shared_ptr<RenderBufferPool> renderBufferPool_;
     boost::shared_ptr<VideoDecoder> decoder_;
+    boost::shared_ptr<DecodeStage> decodeStage_;
+    boost::shared_ptr<RateAdaptationModule> rateAdaptation_;
+    boost::shared_ptr<RateAdaptationObserver> rateObserver_;
+    boost::shared_ptr<Periodic> rateAdaptationTimer_;
+    std::vector<std::string> streamThreads_; // rate adaptation stream id -> thread name
 
     void construct();
+    void startLive(const std::string &threadName);
+    void startPlaybackDriven(const RemoteVideoStream::FetchingRuleSet& ruleset);
+    void startPreview(const std::string &threadName, const RemoteVideoStream::PreviewSettings &settings);
+    bool acquireFetch();
+    void releaseFetch();
+    void startSubscribed();
+    void stopSubscribed();
+    void fetchOwnerLeft(const boost::shared_ptr<IBufferObserver> &subscriber);
+    void setupPreview();
+    void releasePreview();
+    const WebRtcVideoFrame scalePreview(const WebRtcVideoFrame &frame);
+    void setupPlanarRenderer(IExternalPlanarRenderer *renderer);
     void feedFrame(const FrameInfo&, const WebRtcVideoFrame &);
+    void feedPlanarFrame(const FrameInfo&, const WebRtcVideoFrame &);
     void setupDecoder();
     void releaseDecoder();
     void setupPipelineControl();
     void releasePipelineControl();
+    void switchThread(const std::string &threadName);
+    void threadSwitched(const std::string &threadName);
+    void bootstrapSegmentNumbers(const std::string &threadName);
+    void prefetch() override;
+    void keyPrefetched(const boost::shared_ptr<ndn::Data> &data);
+    void frameDecoded(const FrameInfo &, const WebRtcVideoFrame &);
+    void setupRateAdaptation();
+    void releaseRateAdaptation();
+    unsigned int checkRateAdaptation();
 };
 }
 
@@ -0,0 +1,145 @@
+//
+// render-buffer-pool.cpp
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#include "render-buffer-pool.hpp"
+
+#include <string.h>
+#include <stdexcept>
+#include <boost/make_shared.hpp>
+
+using namespace ndnrtc;
+
+RenderBufferPool::RenderBufferPool(IExternalPlanarRenderer::PixelFormat format,
+                                   unsigned int nBuffers)
+    : format_(format), next_(0)
+{
+    if (nBuffers == 0)
+        throw std::runtime_error("Render buffer pool must have at least one buffer");
+
+    for (unsigned int i = 0; i < nBuffers; ++i)
+        buffers_.push_back(boost::make_shared<SwapBuffer>());
+}
+
+boost::shared_ptr<RenderBufferPool>
+RenderBufferPool::create(IExternalPlanarRenderer::PixelFormat format, unsigned int nBuffers)
+{
+    boost::shared_ptr<RenderBufferPool> pool = boost::make_shared<RenderBufferPool>(format, nBuffers);
+    pool->self_ = pool;
+    return pool;
+}
+
+bool RenderBufferPool::acquire(const WebRtcVideoFrame &frame, PlanarFrame &planarFrame)
+{
+    // start search from the buffer following the last acquired one, so
+    // buffers are used in round-robin fashion
+    unsigned int start = next_.load(boost::memory_order_relaxed);
+
+    for (unsigned int i = 0; i < buffers_.size(); ++i)
+    {
+        unsigned int idx = (start + i) % buffers_.size();
+        bool expected = false;
+
+        if (buffers_[idx]->busy_.compare_exchange_strong(expected, true,
+                                                          boost::memory_order_acquire))
+        {
+            next_.store(idx + 1, boost::memory_order_relaxed);
+            buffers_[idx]->pool_ = self_.lock();
+            planarFrame.bufferIdx_ = idx;
+            planarFrame.width_ = frame.width();
+            planarFrame.height_ = frame.height();
+
+            if (format_ == IExternalPlanarRenderer::kI420)
+                fillI420(*buffers_[idx], frame, planarFrame);
+            else
+                fillNV12(*buffers_[idx], frame, planarFrame);
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void RenderBufferPool::releaseFrame(const PlanarFrame &frame)
+{
+    if (frame.bufferIdx_ >= buffers_.size())
+        throw std::runtime_error("Trying to release unknown render buffer");
+
+    SwapBuffer &buffer = *buffers_[frame.bufferIdx_];
+    // if this is the last reference, pool is destroyed on return
+    boost::shared_ptr<RenderBufferPool> pool;
+
+    pool.swap(buffer.pool_);
+    buffer.frameBuffer_ = nullptr;
+    buffer.busy_.store(false, boost::memory_order_release);
+}
+
+unsigned int RenderBufferPool::getFreeNum() const
+{
+    unsigned int nFree = 0;
+    for (auto &b : buffers_)
+        if (!b->busy_.load(boost::memory_order_relaxed))
+            nFree++;
+    return nFree;
+}
+
+#pragma mark - private
+void RenderBufferPool::fillI420(SwapBuffer &buffer, const WebRtcVideoFrame &frame,
+                                PlanarFrame &planarFrame)
+{
+    // holding a reference prevents decoder from reusing this buffer until
+    // renderer releases it
+    buffer.frameBuffer_ = frame.video_frame_buffer();
+
+    planarFrame.nPlanes_ = 3;
+    planarFrame.planes_[0] = buffer.frameBuffer_->DataY();
+    planarFrame.planes_[1] = buffer.frameBuffer_->DataU();
+    planarFrame.planes_[2] = buffer.frameBuffer_->DataV();
+    planarFrame.strides_[0] = buffer.frameBuffer_->StrideY();
+    planarFrame.strides_[1] = buffer.frameBuffer_->StrideU();
+    planarFrame.strides_[2] = buffer.frameBuffer_->StrideV();
+}
+
+void RenderBufferPool::fillNV12(SwapBuffer &buffer, const WebRtcVideoFrame &frame,
+                                PlanarFrame &planarFrame)
+{
+    const rtc::scoped_refptr<webrtc::VideoFrameBuffer> &src = frame.video_frame_buffer();
+    int width = frame.width(), height = frame.height();
+    int chromaWidth = (width + 1) / 2, chromaHeight = (height + 1) / 2;
+    int strideY = width, strideUV = 2 * chromaWidth;
+    size_t ySize = strideY * height, uvSize = strideUV * chromaHeight;
+
+    if (buffer.data_.size() < ySize + uvSize)
+        buffer.data_.resize(ySize + uvSize);
+
+    uint8_t *dstY = buffer.data_.data();
+    uint8_t *dstUV = dstY + ySize;
+
+    for (int row = 0; row < height; ++row)
+        memcpy(dstY + row * strideY, src->DataY() + row * src->StrideY(), width);
+
+    for (int row = 0; row < chromaHeight; ++row)
+    {
+        const uint8_t *srcU = src->DataU() + row * src->StrideU();
+        const uint8_t *srcV = src->DataV() + row * src->StrideV();
+        uint8_t *dst = dstUV + row * strideUV;
+
+        for (int col = 0; col < chromaWidth; ++col)
+        {
+            dst[2 * col] = srcU[col];
+            dst[2 * col + 1] = srcV[col];
+        }
+    }
+
+    planarFrame.nPlanes_ = 2;
+    planarFrame.planes_[0] = dstY;
+    planarFrame.planes_[1] = dstUV;
+    planarFrame.planes_[2] = nullptr;
+    planarFrame.strides_[0] = strideY;
+    planarFrame.strides_[1] = strideUV;
+    planarFrame.strides_[2] = 0;
+}
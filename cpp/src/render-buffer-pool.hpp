@@ -0,0 +1,77 @@
+//
+// render-buffer-pool.hpp
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#ifndef __render_buffer_pool_h__
+#define __render_buffer_pool_h__
+
+#include <vector>
+#include <boost/atomic.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/weak_ptr.hpp>
+
+#include "webrtc.hpp"
+#include "interfaces.hpp"
+
+namespace ndnrtc
+{
+/**
+ * Fixed-size pool of swap buffers for IExternalPlanarRenderer.
+ * Acquiring and releasing buffers is lock-free, so the decoding thread
+ * never waits for the renderer. For I420 output, swap buffer keeps a
+ * reference to the decoder's frame buffer (no copy); for NV12 output,
+ * chroma planes are interleaved into the swap buffer's own memory, which
+ * is reallocated only when frame resolution grows.
+ * Pool created with create() keeps itself alive while any of its' buffers
+ * is held by the renderer, so renderer may release frames after the stream
+ * has replaced or destroyed the pool.
+ */
+class RenderBufferPool : public IRenderBufferReleaser
+{
+  public:
+    RenderBufferPool(IExternalPlanarRenderer::PixelFormat format,
+                     unsigned int nBuffers);
+    ~RenderBufferPool() {}
+
+    static boost::shared_ptr<RenderBufferPool> create(IExternalPlanarRenderer::PixelFormat format,
+                                                      unsigned int nBuffers);
+
+    /**
+     * Places frame into a free swap buffer.
+     * @param frame Decoded frame
+     * @param planarFrame Frame descriptor to fill
+     * @return true if free buffer was found, false if all buffers are held
+     *          by the renderer
+     */
+    bool acquire(const WebRtcVideoFrame &frame, PlanarFrame &planarFrame);
+    void releaseFrame(const PlanarFrame &frame) override;
+
+    IExternalPlanarRenderer::PixelFormat getFormat() const { return format_; }
+    unsigned int getSize() const { return buffers_.size(); }
+    unsigned int getFreeNum() const;
+
+  private:
+    typedef struct _SwapBuffer {
+        _SwapBuffer() : busy_(false) {}
+
+        boost::atomic<bool> busy_;
+        rtc::scoped_refptr<webrtc::VideoFrameBuffer> frameBuffer_;
+        std::vector<uint8_t> data_;
+        // keeps pool alive while buffer is held by the renderer
+        boost::shared_ptr<RenderBufferPool> pool_;
+    } SwapBuffer;
+
+    boost::weak_ptr<RenderBufferPool> self_;
+    IExternalPlanarRenderer::PixelFormat format_;
+    std::vector<boost::shared_ptr<SwapBuffer>> buffers_;
+    boost::atomic<unsigned int> next_;
+
+    void fillI420(SwapBuffer &buffer, const WebRtcVideoFrame &frame, PlanarFrame &planarFrame);
+    void fillNV12(SwapBuffer &buffer, const WebRtcVideoFrame &frame, PlanarFrame &planarFrame);
+};
+}
+
+#endif
@@ -0,0 +1,357 @@
+//
+// ring-content-cache.cpp
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#include "ring-content-cache.hpp"
+
+#include <algorithm>
+#include <boost/bind.hpp>
+#include <boost/make_shared.hpp>
+#include <ndn-cpp/c/common.h>
+#include <ndn-cpp/face.hpp>
+
+#include "statistics.hpp"
+#include "clock.hpp"
+
+using namespace ndnrtc;
+using namespace ndnrtc::statistics;
+using namespace ndn;
+
+const unsigned int RingContentCache::DefaultRingSize = 512;
+
+//******************************************************************************
+RingContentCache::RingContentCache(Face *face, size_t byteBudget,
+                                   const boost::shared_ptr<StatisticsStorage> &storage,
+                                   unsigned int ringSize)
+    : face_(face), byteBudget_(byteBudget), bytes_(0),
+      ringSize_(std::max(1u, ringSize)), minLifetimeMs_(0), lastId_(0),
+      sstorage_(storage)
+{
+    description_ = "ring-cache";
+}
+
+RingContentCache::~RingContentCache()
+{
+    for (auto id : filterIds_)
+        face_->unsetInterestFilter(id);
+}
+
+void RingContentCache::setInterestFilter(const Name &prefix)
+{
+    filterIds_.push_back(face_->setInterestFilter(prefix,
+                                                  boost::bind(&RingContentCache::onInterest,
+                                                              this, _1, _2, _3, _4, _5)));
+    LogDebugC << "interest filter " << prefix << std::endl;
+}
+
+void RingContentCache::add(const Data &data)
+{
+    int64_t now = clock::millisecondTimestamp();
+    NamespaceInfo info;
+    Entry e;
+
+    e.data_ = boost::make_shared<Data>(data);
+    e.id_ = ++lastId_;
+    // encodes unsigned or never encoded data once, the encoding is kept
+    // by the cached copy and reused when it is sent out
+    e.bytes_ = e.data_->wireEncode().size();
+    e.freshUntilMs_ = now + (int64_t)data.getMetaInfo().getFreshnessPeriod();
+    e.expiresMs_ = std::max(e.freshUntilMs_, now + (int64_t)minLifetimeMs_);
+
+    Locator l({e.id_, e.expiresMs_, nullptr, SegmentClass::Unknown, 0, Name()});
+    Slot *slot = (NameComponents::extractInfo(data.getName(), info) ? getSlot(info, true) : nullptr);
+
+    if (slot)
+    {
+        if (slot->seqNo_ != info.sampleNo_)
+        {
+            // ring has wrapped since this sample was published
+            LogWarnC << "sample is too old for the ring " << data.getName() << std::endl;
+            return;
+        }
+
+        std::vector<Entry> &segments = (info.segmentClass_ == SegmentClass::Parity ? slot->parity_ :
+                                        (info.segmentClass_ == SegmentClass::Manifest ? slot->manifest_ : slot->data_));
+        unsigned int idx = (info.segmentClass_ == SegmentClass::Manifest ? segments.size() : info.segNo_);
+
+        if (segments.size() <= idx)
+            segments.resize(idx + 1, Entry({boost::shared_ptr<const Data>(), 0, 0, 0, 0}));
+        release(segments[idx], false);
+        segments[idx] = e;
+
+        l.slot_ = slot;
+        l.segmentClass_ = info.segmentClass_;
+        l.idx_ = idx;
+    }
+    else
+    {
+        auto it = other_.find(data.getName());
+        if (it != other_.end())
+            release(it->second, false);
+        other_[data.getName()] = e;
+        l.name_ = data.getName();
+    }
+
+    bytes_ += e.bytes_;
+    fifo_.push_back(l);
+
+    satisfyPendingInterests(*e.data_, now);
+    evict(now);
+}
+
+void RingContentCache::getPendingInterestsForName(const Name &name,
+                                                  PendingInterests &pendingInterests)
+{
+    MillisecondsSince1970 now = ndn_getNowMilliseconds();
+    pendingInterests.clear();
+
+    for (auto &pi : pit_)
+        if (!pi->isTimedOut(now) && pi->getInterest()->matchesName(name))
+            pendingInterests.push_back(pi);
+}
+
+void RingContentCache::getPendingInterestsWithPrefix(const Name &prefix,
+                                                     PendingInterests &pendingInterests)
+{
+    MillisecondsSince1970 now = ndn_getNowMilliseconds();
+    pendingInterests.clear();
+
+    for (auto &pi : pit_)
+        if (!pi->isTimedOut(now) && prefix.isPrefixOf(pi->getInterest()->getName()))
+            pendingInterests.push_back(pi);
+}
+
+boost::shared_ptr<const Data>
+RingContentCache::find(const Interest &interest)
+{
+    int64_t now = clock::millisecondTimestamp();
+    NamespaceInfo info;
+    bool isSample = NameComponents::extractInfo(interest.getName(), info) && !info.isMeta_ &&
+                    (info.class_ == SampleClass::Key || info.class_ == SampleClass::Delta);
+    bool rightmost = (interest.getChildSelector() == 1);
+
+    if (isSample && info.hasSeqNo_)
+    {
+        Slot *slot = getSlot(info, false);
+
+        if (!slot || slot->seqNo_ != info.sampleNo_)
+            return boost::shared_ptr<const Data>();
+
+        // fast path - segment name
+        if (info.hasSegNo_ &&
+            (info.segmentClass_ == SegmentClass::Data || info.segmentClass_ == SegmentClass::Parity))
+        {
+            std::vector<Entry> &segments = (info.segmentClass_ == SegmentClass::Parity ? slot->parity_ : slot->data_);
+
+            if (info.segNo_ < segments.size() && segments[info.segNo_].data_ &&
+                matches(interest, segments[info.segNo_], now))
+                return segments[info.segNo_].data_;
+        }
+
+        // sample or manifest prefix
+        for (auto segments : {&slot->data_, &slot->parity_, &slot->manifest_})
+            for (auto &e : *segments)
+                if (e.data_ && matches(interest, e, now))
+                    return e.data_;
+
+        return boost::shared_ptr<const Data>();
+    }
+
+    // rightmost interest for sample class prefix (e.g. <thread>/k) - latest
+    // cached sample of that class
+    if (isSample && rightmost)
+        return findLatest(interest, info, now);
+
+    // names sharing a prefix are adjacent in canonical order
+    boost::shared_ptr<const Data> data;
+
+    for (auto it = other_.lower_bound(interest.getName());
+         it != other_.end() && interest.getName().isPrefixOf(it->first); ++it)
+        if (matches(interest, it->second, now))
+        {
+            data = it->second.data_;
+            if (!rightmost)
+                break;
+        }
+
+    return data;
+}
+
+void RingContentCache::onInterest(const boost::shared_ptr<const Name> &prefix,
+                                  const boost::shared_ptr<const Interest> &interest,
+                                  Face &face, uint64_t interestFilterId,
+                                  const boost::shared_ptr<const InterestFilter> &filter)
+{
+    evict(clock::millisecondTimestamp());
+
+    boost::shared_ptr<const Data> data = find(*interest);
+
+    if (data)
+    {
+        face.putData(*data);
+        (*sstorage_)[Indicator::CacheHitNum]++;
+        LogTraceC << "hit " << interest->getName() << std::endl;
+    }
+    else
+    {
+        pit_.push_back(boost::make_shared<PendingInterest>(interest, face));
+        (*sstorage_)[Indicator::CacheMissNum]++;
+        LogTraceC << "miss " << interest->getName() << std::endl;
+    }
+}
+
+#pragma mark - private
+boost::shared_ptr<const Data>
+RingContentCache::findLatest(const Interest &interest, const NamespaceInfo &info, int64_t now)
+{
+    auto it = threads_.find(info.threadName_);
+
+    if (it == threads_.end())
+        return boost::shared_ptr<const Data>();
+
+    std::vector<Slot> &ring = (info.class_ == SampleClass::Key ? it->second.key_ : it->second.delta_);
+    boost::shared_ptr<const Data> data;
+    PacketNumber latest = -1;
+
+    for (auto &slot : ring)
+        if (slot.seqNo_ > latest)
+            for (auto &e : slot.data_)
+                if (e.data_ && matches(interest, e, now))
+                {
+                    data = e.data_;
+                    latest = slot.seqNo_;
+                    break;
+                }
+
+    return data;
+}
+
+RingContentCache::Slot *
+RingContentCache::getSlot(const NamespaceInfo &info, bool create)
+{
+    if (info.isMeta_ || !info.hasSeqNo_ || info.sampleNo_ < 0 ||
+        (info.class_ != SampleClass::Key && info.class_ != SampleClass::Delta))
+        return nullptr;
+
+    auto it = threads_.find(info.threadName_);
+
+    if (it == threads_.end())
+    {
+        if (!create)
+            return nullptr;
+
+        // slots are allocated once, so locators can keep pointers to them
+        ThreadRings rings;
+        rings.delta_.resize(ringSize_, Slot({-1}));
+        rings.key_.resize(ringSize_, Slot({-1}));
+        it = threads_.insert(std::make_pair(info.threadName_, rings)).first;
+
+        LogDebugC << "new thread " << info.threadName_ << " (" << ringSize_ << " slots)" << std::endl;
+    }
+
+    std::vector<Slot> &ring = (info.class_ == SampleClass::Key ? it->second.key_ : it->second.delta_);
+    Slot &slot = ring[info.sampleNo_ % ringSize_];
+
+    if (create && slot.seqNo_ < info.sampleNo_)
+        resetSlot(slot, info.sampleNo_);
+
+    return &slot;
+}
+
+RingContentCache::Entry *
+RingContentCache::locate(const Locator &l)
+{
+    Entry *e = nullptr;
+
+    if (l.slot_)
+    {
+        std::vector<Entry> &segments = (l.segmentClass_ == SegmentClass::Parity ? l.slot_->parity_ :
+                                        (l.segmentClass_ == SegmentClass::Manifest ? l.slot_->manifest_ : l.slot_->data_));
+        if (l.idx_ < segments.size())
+            e = &segments[l.idx_];
+    }
+    else
+    {
+        auto it = other_.find(l.name_);
+        if (it != other_.end())
+            e = &it->second;
+    }
+
+    return (e && e->data_ && e->id_ == l.id_ ? e : nullptr);
+}
+
+void RingContentCache::release(Entry &e, bool evicted)
+{
+    if (!e.data_)
+        return;
+
+    bytes_ -= e.bytes_;
+    e.data_.reset();
+    if (evicted)
+        (*sstorage_)[Indicator::CacheEvictedNum]++;
+}
+
+void RingContentCache::resetSlot(Slot &slot, PacketNumber seqNo)
+{
+    // segments of the previous sample are dropped regardless of freshness
+    for (auto segments : {&slot.data_, &slot.parity_, &slot.manifest_})
+    {
+        for (auto &e : *segments)
+            release(e, true);
+        segments->clear();
+    }
+
+    slot.seqNo_ = seqNo;
+}
+
+void RingContentCache::evict(int64_t now)
+{
+    // locators of segments that were replaced or dropped with their slot
+    // are simply discarded
+    while (fifo_.size())
+    {
+        const Locator &l = fifo_.front();
+        Entry *e = locate(l);
+
+        if (e && l.expiresMs_ > now && bytes_ <= byteBudget_)
+            break;
+
+        if (e)
+        {
+            release(*e, (l.expiresMs_ > now));
+            if (!l.slot_)
+                other_.erase(l.name_);
+        }
+        fifo_.pop_front();
+    }
+
+    (*sstorage_)[Indicator::CacheBytes] = bytes_;
+}
+
+void RingContentCache::satisfyPendingInterests(const Data &data, int64_t now)
+{
+    MillisecondsSince1970 pitNow = ndn_getNowMilliseconds();
+
+    for (auto it = pit_.begin(); it != pit_.end(); /* no increment */)
+    {
+        if ((*it)->isTimedOut(pitNow))
+            it = pit_.erase(it);
+        else if ((*it)->getInterest()->matchesName(data.getName()))
+        {
+            (*it)->getFace().putData(data);
+            it = pit_.erase(it);
+        }
+        else
+            ++it;
+    }
+}
+
+bool RingContentCache::matches(const Interest &interest, const Entry &e, int64_t now) const
+{
+    return (now < e.expiresMs_) &&
+           (!interest.getMustBeFresh() || now < e.freshUntilMs_) &&
+           interest.matchesName(e.data_->getName());
+}
@@ -0,0 +1,151 @@
+//
+// ring-content-cache.hpp
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#ifndef __ring_content_cache_h__
+#define __ring_content_cache_h__
+
+#include <deque>
+#include <map>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include <ndn-cpp/name.hpp>
+#include <ndn-cpp/data.hpp>
+#include <ndn-cpp/interest.hpp>
+#include <ndn-cpp/util/memory-content-cache.hpp>
+
+#include "ndnrtc-object.hpp"
+#include "name-components.hpp"
+
+namespace ndn
+{
+class Face;
+class InterestFilter;
+}
+
+namespace ndnrtc
+{
+namespace statistics
+{
+class StatisticsStorage;
+}
+
+/**
+ * Producer content store, optimized for live streams.
+ * Samples' segments (data, parity and manifests) are kept in per-thread
+ * rings of slots, one ring per sample class, indexed by sample sequence
+ * number. Insertion and lookup of a segment are O(1): slot is found by
+ * sequence number, segment - by its' number. Segments that don't belong to
+ * samples (stream and thread metadata) are kept in a separate name-ordered
+ * store.
+ * Segments are evicted in insertion order once they expire (freshness
+ * period, but not earlier than minimum cache lifetime), or when total size
+ * of cached segments exceeds byte budget, or when ring slot is taken by a
+ * newer sample.
+ * Cache answers incoming interests through face's interest filter. Unanswered
+ * interests are kept as pending and can be queried by the publisher
+ * (interface is the same as ndn::MemoryContentCache's, so it can be used
+ * with PacketPublisher).
+ * Cache is not thread-safe and must be used on the face thread.
+ */
+class RingContentCache : public NdnRtcComponent
+{
+  public:
+    typedef ndn::MemoryContentCache::PendingInterest PendingInterest;
+    typedef std::vector<boost::shared_ptr<const PendingInterest>> PendingInterests;
+
+    static const unsigned int DefaultRingSize;
+
+    /**
+     * @param face Face to answer interests on
+     * @param byteBudget Maximum size (wire encoding) of all cached segments
+     * @param storage Producer statistics storage
+     * @param ringSize Number of samples of one class (key or delta) per thread
+     */
+    RingContentCache(ndn::Face *face, size_t byteBudget,
+                     const boost::shared_ptr<statistics::StatisticsStorage> &storage,
+                     unsigned int ringSize = DefaultRingSize);
+    ~RingContentCache();
+
+    void setInterestFilter(const ndn::Name &prefix);
+    void setMinimumCacheLifetime(unsigned int lifetimeMs) { minLifetimeMs_ = lifetimeMs; }
+
+    void add(const ndn::Data &data);
+    void getPendingInterestsForName(const ndn::Name &name, PendingInterests &pendingInterests);
+    void getPendingInterestsWithPrefix(const ndn::Name &prefix, PendingInterests &pendingInterests);
+
+    /**
+     * Looks up cached data for the interest.
+     * Rightmost interest for sample class prefix (<thread>/k or <thread>/d)
+     * is answered with a segment of the latest cached sample of that class.
+     * @return Matching data or null pointer
+     */
+    boost::shared_ptr<const ndn::Data> find(const ndn::Interest &interest);
+
+    size_t getBytes() const { return bytes_; }
+    size_t getByteBudget() const { return byteBudget_; }
+    size_t getPendingInterestsNum() const { return pit_.size(); }
+
+    void onInterest(const boost::shared_ptr<const ndn::Name> &prefix,
+                    const boost::shared_ptr<const ndn::Interest> &interest,
+                    ndn::Face &face, uint64_t interestFilterId,
+                    const boost::shared_ptr<const ndn::InterestFilter> &filter);
+
+  private:
+    typedef struct _Entry
+    {
+        boost::shared_ptr<const ndn::Data> data_;
+        uint64_t id_;
+        size_t bytes_;
+        int64_t freshUntilMs_, expiresMs_;
+    } Entry;
+
+    typedef struct _Slot
+    {
+        PacketNumber seqNo_;
+        std::vector<Entry> data_, parity_, manifest_;
+    } Slot;
+
+    typedef struct _ThreadRings
+    {
+        std::vector<Slot> delta_, key_;
+    } ThreadRings;
+
+    // position of a cached segment, in insertion order
+    typedef struct _Locator
+    {
+        uint64_t id_;
+        int64_t expiresMs_;
+        Slot *slot_;               // null for non-sample segments
+        SegmentClass segmentClass_;
+        unsigned int idx_;
+        ndn::Name name_;           // for non-sample segments only
+    } Locator;
+
+    ndn::Face *face_;
+    size_t byteBudget_, bytes_;
+    unsigned int ringSize_, minLifetimeMs_;
+    uint64_t lastId_;
+    boost::shared_ptr<statistics::StatisticsStorage> sstorage_;
+    std::vector<uint64_t> filterIds_;
+    std::map<std::string, ThreadRings> threads_;
+    std::map<ndn::Name, Entry> other_;
+    std::deque<Locator> fifo_;
+    std::vector<boost::shared_ptr<const PendingInterest>> pit_;
+
+    boost::shared_ptr<const ndn::Data> findLatest(const ndn::Interest &interest,
+                                                  const NamespaceInfo &info, int64_t now);
+    Slot *getSlot(const NamespaceInfo &info, bool create);
+    Entry *locate(const Locator &l);
+    void release(Entry &e, bool evicted);
+    void resetSlot(Slot &slot, PacketNumber seqNo);
+    void evict(int64_t now);
+    void satisfyPendingInterests(const ndn::Data &data, int64_t now);
+    bool matches(const ndn::Interest &interest, const Entry &e, int64_t now) const;
+};
+}
+
+#endif
@@ -13,6 +13,7 @@
 #include "frame-data.hpp"
 #include "name-components.hpp"
 #include "meta-fetcher.hpp"
+#include "frame-trace.hpp"
 
 static const unsigned int META_FETCHER_POOL_SIZE = 100;
 
@@ -57,13 +58,16 @@ ManifestValidator::ManifestValidator(boost::shared_ptr<ndn::Face> face,
                                      boost::shared_ptr<ndn::KeyChain> keyChain,
                                      const boost::shared_ptr<StatisticsStorage> &statStorage) 
     : StatObject(statStorage), face_(face), keyChain_(keyChain),
-    metaFetcherPool_(META_FETCHER_POOL_SIZE)
+    metaFetcherPool_(META_FETCHER_POOL_SIZE), isVerifiedUpstream_(false)
 {
     description_ = "sample-validator";
 }
 
 void ManifestValidator::onNewRequest(const boost::shared_ptr<BufferSlot> &slot)
 {
+    if (isVerifiedUpstream_)
+        return;
+
     if (slot->getState() == BufferSlot::State::New)
     {
         // initiate manifest fetching
@@ -72,10 +76,11 @@ void ManifestValidator::onNewRequest(const boost::shared_ptr<BufferSlot> &slot)
 
         boost::shared_ptr<ManifestValidator> me = boost::dynamic_pointer_cast<ManifestValidator>(shared_from_this());
         boost::shared_ptr<MetaFetcher> mfetcher = metaFetcherPool_.pop();
-        Name manifestName = slot->getNameInfo().getPrefix(prefix_filter::Sample).append(NameComponents::NameComponentManifest);
+        Name samplePrefix = slot->getNameInfo().getPrefix(prefix_filter::Sample);
+        Name manifestName = Name(samplePrefix).append(NameComponents::NameComponentManifest);
         mfetcher->fetch(face_, keyChain_,
                         manifestName,
-                        [mfetcher, slot, me, this](NetworkData &nd, 
+                        [mfetcher, slot, samplePrefix, me, this](NetworkData &nd, 
                                                    const std::vector<ValidationErrorInfo> info, 
                                                    const std::vector<boost::shared_ptr<Data>>&) {
                             if (info.size())
@@ -88,6 +93,8 @@ void ManifestValidator::onNewRequest(const boost::shared_ptr<BufferSlot> &slot)
                                              << i.getReason() << std::endl;
                                 slot->verified_ = BufferSlot::Verification::Failed;
                                 (*me->statStorage_)[Indicator::VerifyFailure]++;
+                                if (onVerified_)
+                                    onVerified_(samplePrefix, BufferSlot::Verification::Failed);
                             }
                             else
                             {
@@ -106,13 +113,15 @@ void ManifestValidator::onNewRequest(const boost::shared_ptr<BufferSlot> &slot)
                             }
                             metaFetcherPool_.push(mfetcher);
                         },
-                        [mfetcher, slot, me, this](const std::string &) {
+                        [mfetcher, slot, samplePrefix, me, this](const std::string &) {
                             LogErrorC << "couldn't fetch manifest for "
                                       << slot->getNameInfo().getSuffix(suffix_filter::Thread)
                                       << std::endl;
 
                             metaFetcherPool_.push(mfetcher);
                             (*me->statStorage_)[Indicator::VerifyFailure]++;
+                            if (onVerified_)
+                                onVerified_(samplePrefix, BufferSlot::Verification::Unknown);
                         });
 
         LogTraceC << "fetch " << manifestName << std::endl;
@@ -121,6 +130,17 @@ void ManifestValidator::onNewRequest(const boost::shared_ptr<BufferSlot> &slot)
 
 void ManifestValidator::onNewData(const BufferReceipt &receipt)
 {
+    if (isVerifiedUpstream_)
+    {
+        if (receipt.slot_->getVerificationStatus() == BufferSlot::Verification::Unknown &&
+            receipt.slot_->getState() >= BufferSlot::State::Ready)
+        {
+            receipt.slot_->verified_ = BufferSlot::Verification::Verified;
+            (*statStorage_)[Indicator::VerifySuccess]++;
+        }
+        return;
+    }
+
     if (receipt.slot_->getVerificationStatus() == BufferSlot::Verification::Unknown)
         if ((receipt.slot_->getState() & BufferSlot::State::Ready ||
              receipt.slot_->getState() & BufferSlot::State::Locked) &&
@@ -131,10 +151,13 @@ void ManifestValidator::onNewData(const BufferReceipt &receipt)
 void ManifestValidator::verifySlot(const boost::shared_ptr<const BufferSlot> slot)
 {
     assert(slot->getState() >= BufferSlot::State::Ready);
+    FrameTraceScope(Verified, slot->fetched_.begin()->second->getPlaybackNo());
 
-    bool verified = true;
+    std::vector<boost::shared_ptr<const ndn::Data>> segments;
     for (auto &it : slot->fetched_)
-        verified &= slot->manifest_->hasData(*(it.second->getData()->getData()));
+        segments.push_back(it.second->getData()->getData());
+
+    bool verified = slot->manifest_->hasData(segments);
     slot->verified_ = (verified ? BufferSlot::Verification::Verified : BufferSlot::Verification::Failed);
 
     if (slot->getVerificationStatus() == BufferSlot::Verification::Failed)
@@ -148,4 +171,7 @@ void ManifestValidator::verifySlot(const boost::shared_ptr<const BufferSlot> slo
         LogDebugC << "verified " << slot->dump() << std::endl;
         (*statStorage_)[Indicator::VerifySuccess]++;
     }
+
+    if (onVerified_)
+        onVerified_(slot->getNameInfo().getPrefix(prefix_filter::Sample), slot->getVerificationStatus());
 }
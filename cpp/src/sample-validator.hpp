@@ -8,6 +8,8 @@
 #ifndef __sample_validator_h__
 #define __sample_validator_h__
 
+#include <boost/function.hpp>
+
 #include "ndnrtc-object.hpp"
 #include "frame-buffer.hpp"
 #include "statistics.hpp"
@@ -51,10 +53,24 @@ class SampleValidator : public NdnRtcComponent, public IBufferObserver, statisti
 class ManifestValidator : public NdnRtcComponent, public IBufferObserver, statistics::StatObject
 {
   public:
+    typedef boost::function<void(const ndn::Name &, BufferSlot::Verification)> OnVerified;
+
     ManifestValidator(boost::shared_ptr<ndn::Face> face,
                       boost::shared_ptr<ndn::KeyChain> keyChain,
                       const boost::shared_ptr<statistics::StatisticsStorage> &statStorage);
 
+    /**
+     * Sets callback, called with sample prefix once verification of the
+     * sample is over (status is Unknown if manifest couldn't be fetched).
+     */
+    void setOnVerified(OnVerified onVerified) { onVerified_ = onVerified; }
+    /**
+     * When set, manifests are not fetched: buffer receives only samples
+     * verified elsewhere (by the owner of shared fetch, see FetchFanOut)
+     * and slots are marked as verified once assembled.
+     */
+    void setIsVerifiedUpstream(bool verifiedUpstream) { isVerifiedUpstream_ = verifiedUpstream; }
+
   private:
     template <typename T>
     class Pool
@@ -103,6 +119,8 @@ class ManifestValidator : public NdnRtcComponent, public IBufferObserver, statis
     boost::shared_ptr<ndn::Face> face_;
     boost::shared_ptr<ndn::KeyChain> keyChain_;
     Pool<MetaFetcher> metaFetcherPool_;
+    OnVerified onVerified_;
+    bool isVerifiedUpstream_;
 
     void onNewRequest(const boost::shared_ptr<BufferSlot> &);
     void onNewData(const BufferReceipt &receipt);
@@ -0,0 +1,126 @@
+//
+// scaling-pyramid.cpp
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#include "scaling-pyramid.hpp"
+
+#include <algorithm>
+#include <boost/make_shared.hpp>
+#include <webrtc/common_video/include/i420_buffer_pool.h>
+
+#include "statistics.hpp"
+#include "clock.hpp"
+#include "frame-trace.hpp"
+
+using namespace ndnrtc;
+using namespace ndnrtc::statistics;
+
+//******************************************************************************
+ScalingPyramid::_Level::_Level(unsigned int width, unsigned int height)
+    : width_(width), height_(height), nUsers_(1),
+      pool_(boost::make_shared<webrtc::I420BufferPool>())
+{
+}
+
+//******************************************************************************
+ScalingPyramid::ScalingPyramid(const boost::shared_ptr<StatisticsStorage> &storage)
+    : sstorage_(storage)
+{
+}
+
+ScalingPyramid::~ScalingPyramid()
+{
+}
+
+void ScalingPyramid::addLevel(unsigned int width, unsigned int height)
+{
+    for (auto &l : levels_)
+        if (l.width_ == width && l.height_ == height)
+        {
+            l.nUsers_++;
+            return;
+        }
+
+    Level level(width, height);
+    levels_.insert(std::upper_bound(levels_.begin(), levels_.end(), level,
+                                    [](const Level &a, const Level &b) {
+                                        return a.width_ * a.height_ > b.width_ * b.height_;
+                                    }),
+                   level);
+}
+
+void ScalingPyramid::removeLevel(unsigned int width, unsigned int height)
+{
+    for (auto it = levels_.begin(); it != levels_.end(); ++it)
+        if (it->width_ == width && it->height_ == height)
+        {
+            if (--it->nUsers_ == 0)
+                levels_.erase(it);
+            return;
+        }
+}
+
+void ScalingPyramid::scale(const WebRtcVideoFrame &frame, OnLevelReady onLevelReady)
+{
+    std::vector<WebRtcVideoFrame> scaled;
+    scaled.reserve(levels_.size());
+
+    for (auto &level : levels_)
+    {
+        if (level.width_ == (unsigned int)frame.width() &&
+            level.height_ == (unsigned int)frame.height())
+        {
+            scaled.push_back(frame);
+            (*sstorage_)[Indicator::ScaleSkippedNum]++;
+        }
+        else
+        {
+            const WebRtcVideoFrame &source = getSource(frame, scaled, level);
+            WebRtcSmartPtr<WebRtcVideoFrameBuffer> buffer = level.pool_->CreateBuffer(level.width_, level.height_);
+            int64_t scaleStartUsec = clock::microsecondTimestamp();
+
+            {
+                FrameTraceStep(Scale);
+                buffer->ScaleFrom(*(source.video_frame_buffer()));
+            }
+
+            scaled.push_back(WebRtcVideoFrame(buffer, frame.rotation(), frame.timestamp_us()));
+            (*sstorage_)[Indicator::ScaledNum]++;
+            (*sstorage_)[Indicator::ScaleTime] += (double)(clock::microsecondTimestamp() - scaleStartUsec) / 1000.;
+        }
+
+        onLevelReady(level.width_, level.height_, scaled.back());
+    }
+}
+
+#pragma mark - private
+const WebRtcVideoFrame &
+ScalingPyramid::getSource(const WebRtcVideoFrame &frame,
+                          const std::vector<WebRtcVideoFrame> &scaled,
+                          const Level &level) const
+{
+    // smallest level computed so far, which is not smaller than the target,
+    // not larger (not upscaled) than the input frame and has the same aspect
+    // ratio as the target - otherwise, it has been cropped differently and
+    // scaling from it would crop twice
+    for (auto it = scaled.rbegin(); it != scaled.rend(); ++it)
+        if ((unsigned int)it->width() >= level.width_ &&
+            (unsigned int)it->height() >= level.height_ &&
+            it->width() <= frame.width() && it->height() <= frame.height() &&
+            isSameAspectRatio(it->width(), it->height(), level.width_, level.height_))
+            return *it;
+
+    return frame;
+}
+
+bool ScalingPyramid::isSameAspectRatio(unsigned int w1, unsigned int h1,
+                                       unsigned int w2, unsigned int h2)
+{
+    // allow for rounding of dimensions: (w1, h1) scaled to width w2 must
+    // have height h2 within one pixel
+    int64_t d = (int64_t)h1 * w2 - (int64_t)h2 * w1;
+    return (d < 0 ? -d : d) <= (int64_t)w1;
+}
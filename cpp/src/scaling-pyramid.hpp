@@ -0,0 +1,87 @@
+//
+// scaling-pyramid.hpp
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#ifndef __scaling_pyramid_h__
+#define __scaling_pyramid_h__
+
+#include <vector>
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "webrtc.hpp"
+
+namespace webrtc
+{
+class I420BufferPool;
+}
+
+namespace ndnrtc
+{
+namespace statistics
+{
+class StatisticsStorage;
+}
+
+/**
+ * ScalingPyramid produces captured frame in all resolutions required by
+ * simulcast threads. Levels are processed from the largest to the smallest
+ * and each level is scaled only once, from the nearest larger level of the
+ * same aspect ratio which has been computed already (or from the input
+ * frame), so full resolution frame is not scaled for every thread. Level that matches input frame
+ * resolution is passed as is. Scaled frames are allocated from per-level
+ * buffer pools - buffers are re-used once encoders release them.
+ * Like FrameScaler, pyramid must always be used on the same thread.
+ */
+class ScalingPyramid
+{
+  public:
+    typedef boost::function<void(unsigned int width, unsigned int height,
+                                 const WebRtcVideoFrame &frame)>
+        OnLevelReady;
+
+    ScalingPyramid(const boost::shared_ptr<statistics::StatisticsStorage> &storage);
+    ~ScalingPyramid();
+
+    /**
+     * Adds resolution level. Levels are reference-counted, so several
+     * threads of the same resolution share one level.
+     */
+    void addLevel(unsigned int width, unsigned int height);
+    void removeLevel(unsigned int width, unsigned int height);
+    size_t getLevelsNum() const { return levels_.size(); }
+
+    /**
+     * Scales frame to all levels, starting from the largest one.
+     * onLevelReady is called as soon as level is ready, before lower levels
+     * are computed, so encoding can proceed in parallel with scaling.
+     */
+    void scale(const WebRtcVideoFrame &frame, OnLevelReady onLevelReady);
+
+  private:
+    ScalingPyramid(const ScalingPyramid &) = delete;
+
+    typedef struct _Level
+    {
+        _Level(unsigned int width, unsigned int height);
+
+        unsigned int width_, height_;
+        unsigned int nUsers_;
+        boost::shared_ptr<webrtc::I420BufferPool> pool_;
+    } Level;
+
+    boost::shared_ptr<statistics::StatisticsStorage> sstorage_;
+    std::vector<Level> levels_; // sorted by area, largest first
+
+    const WebRtcVideoFrame &getSource(const WebRtcVideoFrame &frame,
+                                      const std::vector<WebRtcVideoFrame> &scaled,
+                                      const Level &level) const;
+    static bool isSameAspectRatio(unsigned int w1, unsigned int h1,
+                                  unsigned int w2, unsigned int h2);
+};
+}
+
+#endif
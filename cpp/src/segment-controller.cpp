@@ -24,7 +24,8 @@ class SegmentControllerImpl : public NdnRtcComponent,
 {
   public:
     SegmentControllerImpl(boost::asio::io_service &faceIo, unsigned int maxIdleTimeMs,
-                          const boost::shared_ptr<StatisticsStorage> &storage);
+                          const boost::shared_ptr<StatisticsStorage> &storage,
+                          const boost::shared_ptr<ObjectPool> &pool);
     ~SegmentControllerImpl();
 
     unsigned int getCurrentIdleTime() const;
@@ -47,6 +48,7 @@ class SegmentControllerImpl : public NdnRtcComponent,
     int64_t lastDataTimestampMs_;
     bool starvationFired_;
     boost::shared_ptr<StatisticsStorage> sstorage_;
+    boost::shared_ptr<ObjectPool> pool_;
 
     unsigned int periodicInvocation();
 
@@ -60,7 +62,9 @@ class SegmentControllerImpl : public NdnRtcComponent,
 
 #pragma mark - public
 SegmentController::SegmentController(boost::asio::io_service &faceIo,
-                                     unsigned int maxIdleTimeMs, StatStoragePtr storage) : pimpl_(boost::make_shared<SegmentControllerImpl>(faceIo, maxIdleTimeMs, storage))
+                                     unsigned int maxIdleTimeMs, StatStoragePtr storage,
+                                     const boost::shared_ptr<ObjectPool> &pool)
+    : pimpl_(boost::make_shared<SegmentControllerImpl>(faceIo, maxIdleTimeMs, storage, pool))
 {
 }
 
@@ -117,13 +121,15 @@ void SegmentController::setLogger(boost::shared_ptr<ndnlog::new_api::Logger> log
 #pragma mark - pimpl
 SegmentControllerImpl::SegmentControllerImpl(boost::asio::io_service &faceIo,
                                              unsigned int maxIdleTimeMs,
-                                             const boost::shared_ptr<StatisticsStorage> &storage) 
+                                             const boost::shared_ptr<StatisticsStorage> &storage,
+                                             const boost::shared_ptr<ObjectPool> &pool)
     : Periodic(faceIo),
     maxIdleTimeMs_(maxIdleTimeMs),
     lastDataTimestampMs_(0),
     starvationFired_(false),
     active_(false),
-    sstorage_(storage)
+    sstorage_(storage),
+    pool_(pool)
 {
     assert(sstorage_.get());
     description_ = "segment-controller";
@@ -235,7 +241,7 @@ void SegmentControllerImpl::onData(const boost::shared_ptr<const Interest> &inte
 
     if (NameComponents::extractInfo(data->getName(), info))
     {
-        boost::shared_ptr<WireSegment> segment = WireSegment::createSegment(info, data, interest);
+        boost::shared_ptr<WireSegment> segment = WireSegment::createSegment(info, data, interest, pool_);
 
         if (segment->isValid())
         {
@@ -31,6 +31,7 @@ class StatisticsStorage;
 }
 
 class WireSegment;
+class ObjectPool;
 class ISegmentControllerObserver;
 class SegmentControllerImpl;
 
@@ -64,7 +65,9 @@ class SegmentController : public ISegmentController
     SegmentController(boost::asio::io_service &faceIo,
                       unsigned int maxIdleTimeMs,
                       StatStoragePtr storage =
-                          StatStoragePtr(StatStorage::createConsumerStatistics()));
+                          StatStoragePtr(StatStorage::createConsumerStatistics()),
+                      const boost::shared_ptr<ObjectPool> &pool =
+                          boost::shared_ptr<ObjectPool>());
 
     unsigned int getCurrentIdleTime() const;
     unsigned int getMaxIdleTime() const;
@@ -0,0 +1,108 @@
+//
+// shared-fetch-observer.cpp
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#include "shared-fetch-observer.hpp"
+
+#include <algorithm>
+
+#include "async.hpp"
+#include "name-components.hpp"
+#include "segment-controller.hpp"
+#include "statistics.hpp"
+
+using namespace ndnrtc;
+using namespace ndnrtc::statistics;
+using namespace ndn;
+
+const size_t SharedFetchObserver::MaxPendingSamples = 64;
+
+SharedFetchObserver::SharedFetchObserver(boost::asio::io_service &io,
+                                         const boost::shared_ptr<IBuffer> &buffer,
+                                         const boost::shared_ptr<ISegmentControllerObserver> &bufferControl,
+                                         const boost::shared_ptr<StatisticsStorage> &sstorage)
+    : io_(io), buffer_(buffer), bufferControl_(bufferControl), sstorage_(sstorage)
+{
+}
+
+void SharedFetchObserver::onNewData(const BufferReceipt &receipt)
+{
+    // late segments of samples owner has already assembled are not needed
+    if (!receipt.segment_ || receipt.oldState_ == BufferSlot::State::Ready)
+        return;
+
+    // owner's buffer re-uses slot segments - take data and Interest now
+    Name samplePrefix = receipt.slot_->getNameInfo().getPrefix(prefix_filter::Sample);
+    Sample &sample = pendingSample(samplePrefix);
+    sample.data_.push_back(receipt.segment_->getData());
+    sample.interests_.push_back(receipt.segment_->getInterest());
+
+    // sample may have been verified (or failed verification) already
+    if (receipt.slot_->getVerificationStatus() != BufferSlot::Verification::Unknown)
+        onVerified(samplePrefix, receipt.slot_->getVerificationStatus());
+}
+
+void SharedFetchObserver::onReset()
+{
+    pending_.clear();
+
+    boost::shared_ptr<IBuffer> buffer = buffer_;
+    async::dispatchAsync(io_, [buffer]() { buffer->reset(); });
+}
+
+void SharedFetchObserver::onVerified(const Name &samplePrefix, BufferSlot::Verification status)
+{
+    std::vector<Sample>::iterator it = std::find_if(pending_.begin(), pending_.end(),
+                                                    [&samplePrefix](const Sample &s) { return s.prefix_ == samplePrefix; });
+    if (it == pending_.end())
+        return;
+
+    Sample sample = *it;
+    pending_.erase(it);
+
+    if (status == BufferSlot::Verification::Verified)
+        forward(sample);
+}
+
+#pragma mark - private
+SharedFetchObserver::Sample &
+SharedFetchObserver::pendingSample(const Name &samplePrefix)
+{
+    for (auto &s : pending_)
+        if (s.prefix_ == samplePrefix)
+            return s;
+
+    if (pending_.size() >= MaxPendingSamples)
+        pending_.erase(pending_.begin());
+    pending_.push_back(Sample({samplePrefix}));
+    return pending_.back();
+}
+
+void SharedFetchObserver::forward(const Sample &sample)
+{
+    boost::shared_ptr<IBuffer> buffer = buffer_;
+    boost::shared_ptr<ISegmentControllerObserver> bufferControl = bufferControl_;
+    boost::shared_ptr<StatisticsStorage> sstorage = sstorage_;
+
+    async::dispatchAsync(io_, [sample, buffer, bufferControl, sstorage]() {
+        try
+        {
+            if (!buffer->requested(sample.interests_))
+                return;
+
+            for (auto &d : sample.data_)
+                if (buffer->isRequested(d))
+                {
+                    bufferControl->segmentArrived(d);
+                    (*sstorage)[Indicator::SharedSegmentsNum]++;
+                }
+        }
+        catch (std::exception &e)
+        {
+            // sample has been played out or skipped already
+        }
+    });
+}
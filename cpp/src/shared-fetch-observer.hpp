@@ -0,0 +1,80 @@
+//
+// shared-fetch-observer.hpp
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#ifndef __shared_fetch_observer_h__
+#define __shared_fetch_observer_h__
+
+#include <vector>
+#include <boost/asio.hpp>
+#include <boost/shared_ptr.hpp>
+#include <ndn-cpp/name.hpp>
+
+#include "frame-buffer.hpp"
+
+namespace ndnrtc
+{
+namespace statistics
+{
+class StatisticsStorage;
+}
+
+class ISegmentControllerObserver;
+
+/**
+ * Subscriber of other stream's fetch engine: segments fetched by the owner
+ * are held back until the owner verifies their sample, then re-assembled in
+ * this stream's buffer through buffer control (as if this stream fetched
+ * them), on this stream's thread. Segments of samples that failed
+ * verification or can't be verified are dropped.
+ * Fan-out events are delivered on owner's thread, one at a time.
+ * @see FetchFanOut
+ */
+class SharedFetchObserver : public IBufferObserver
+{
+  public:
+    // samples owner never finished verifying (i.e. skipped before
+    // manifest arrival) are evicted, oldest first
+    static const size_t MaxPendingSamples;
+
+    SharedFetchObserver(boost::asio::io_service &io,
+                        const boost::shared_ptr<IBuffer> &buffer,
+                        const boost::shared_ptr<ISegmentControllerObserver> &bufferControl,
+                        const boost::shared_ptr<statistics::StatisticsStorage> &sstorage);
+    ~SharedFetchObserver() {}
+
+    void onNewRequest(const boost::shared_ptr<BufferSlot> &) override {}
+    void onNewData(const BufferReceipt &receipt) override;
+    void onReset() override;
+
+    /**
+     * Called once owner verified the sample. Verified sample is forwarded
+     * to this stream's buffer, others are dropped.
+     */
+    void onVerified(const ndn::Name &samplePrefix, BufferSlot::Verification status);
+
+    size_t getPendingSamplesNum() const { return pending_.size(); }
+
+  private:
+    typedef struct _Sample
+    {
+        ndn::Name prefix_;
+        std::vector<boost::shared_ptr<WireSegment>> data_;
+        std::vector<boost::shared_ptr<const ndn::Interest>> interests_;
+    } Sample;
+
+    boost::asio::io_service &io_;
+    boost::shared_ptr<IBuffer> buffer_;
+    boost::shared_ptr<ISegmentControllerObserver> bufferControl_;
+    boost::shared_ptr<statistics::StatisticsStorage> sstorage_;
+    std::vector<Sample> pending_;
+
+    Sample &pendingSample(const ndn::Name &samplePrefix);
+    void forward(const Sample &sample);
+};
+}
+
+#endif
@@ -12,6 +12,7 @@
 
 #include <algorithm>
 #include <boost/assign.hpp>
+#include <boost/make_shared.hpp>
 
 using namespace ndnrtc;
 using namespace ndnrtc::statistics;
@@ -37,6 +38,13 @@ map_list_of
 ( Indicator::BufferTargetSize, "Jitter target size" ) 
 ( Indicator::BufferPlayableSize, "Jitter playable size" ) 
 ( Indicator::BufferReservedSize, "Jitter reserved size" )
+( Indicator::JitterDelayPercentile, "Jitter arrival delay percentile" )
+( Indicator::JitterAchievedSize, "Jitter achieved size" )
+( Indicator::CatchUpSkippedNum, "Samples skipped on catch-up" )
+( Indicator::PlayoutSpeed, "Playout speed" )
+( Indicator::DecodeQueueSize, "Decoded frames queue size" )
+( Indicator::DecodePendingNum, "Frames pending decoding" )
+( Indicator::DecodeDroppedNum, "Frames dropped by decode stage" )
 ( Indicator::CurrentProducerFramerate, "Producer rate" )
 ( Indicator::VerifySuccess, "Verified samples" )
 ( Indicator::VerifyFailure, "Verify failure samples" )
@@ -53,6 +61,27 @@ map_list_of
 ( Indicator::PlayedKeyNum, "Played key frames" ) 
 ( Indicator::SkippedNum, "Skipped" )
 ( Indicator::LatencyEstimated, "Latency (est.)" )
+// latency distributions
+( Indicator::LatencyP50, "Latency 50th percentile" )
+( Indicator::LatencyP95, "Latency 95th percentile" )
+( Indicator::LatencyP99, "Latency 99th percentile" )
+( Indicator::LatencyMax, "Latency max" )
+( Indicator::DrdP50, "Segment DRD 50th percentile" )
+( Indicator::DrdP95, "Segment DRD 95th percentile" )
+( Indicator::DrdP99, "Segment DRD 99th percentile" )
+( Indicator::DrdMax, "Segment DRD max" )
+( Indicator::AssemblyP50, "Frame assembly time 50th percentile" )
+( Indicator::AssemblyP95, "Frame assembly time 95th percentile" )
+( Indicator::AssemblyP99, "Frame assembly time 99th percentile" )
+( Indicator::AssemblyMax, "Frame assembly time max" )
+( Indicator::DecodeP50, "Decode time 50th percentile" )
+( Indicator::DecodeP95, "Decode time 95th percentile" )
+( Indicator::DecodeP99, "Decode time 99th percentile" )
+( Indicator::DecodeMax, "Decode time max" )
+( Indicator::LatenessP50, "Playout lateness 50th percentile" )
+( Indicator::LatenessP95, "Playout lateness 95th percentile" )
+( Indicator::LatenessP99, "Playout lateness 99th percentile" )
+( Indicator::LatenessMax, "Playout lateness max" )
 // pipeliner
 ( Indicator::SegmentsDeltaAvgNum, "Delta segments average" ) 
 ( Indicator::SegmentsKeyAvgNum, "Key segments average" ) 
@@ -62,6 +91,10 @@ map_list_of
 ( Indicator::RebufferingsNum, "Rebufferings" ) 
 ( Indicator::RequestedNum, "Requested" ) 
 ( Indicator::RequestedKeyNum, "Requested key" ) 
+( Indicator::ParityRequestedNum, "Parity segments requested" ) 
+( Indicator::ParityFetchedNum, "Parity segments fetched" ) 
+( Indicator::LayerSkippedNum, "Skipped (temporal layer)" ) 
+( Indicator::ParityUsedNum, "Parity segments used for recovery" ) 
 ( Indicator::DW, "Lambda D" )
 ( Indicator::W, "Lambda" )
 ( Indicator::SegmentsReceivedNum, "Segments received" )
@@ -74,6 +107,9 @@ map_list_of
 ( Indicator::State, "Consumer state" )
 ( Indicator::DoubleRtFrames, "Number of frames with additional round trips for assembling" )
 ( Indicator::DoubleRtFramesKey, "Number of key frames with additional round trips for assemnbling" )
+( Indicator::ThroughputEstimate, "Throughput estimation (kbps)" )
+( Indicator::ThreadSwitchesNum, "Number of thread switches" )
+( Indicator::TimeToFirstFrame, "Time to first frame (ms)" )
 // DRD estimator
 ( Indicator::DrdOriginalEstimation, "DRD estimation (orig)" )
 ( Indicator::DrdCachedEstimation, "DRD estimation (cach)" )
@@ -94,6 +130,26 @@ map_list_of
 // encoder
 ( Indicator::EncodedNum, "Encoded frames" )
 
+// scaler
+( Indicator::ScaledNum, "Scaled frames" )
+( Indicator::ScaleSkippedNum, "Frames passed without scaling" )
+( Indicator::ScaleTime, "Total scaling time (ms)" )
+
+// content cache
+( Indicator::CacheHitNum, "Cache hits" )
+( Indicator::CacheMissNum, "Cache misses" )
+( Indicator::CacheEvictedNum, "Cache evicted segments" )
+( Indicator::CacheBytes, "Cache size (bytes)" )
+
+// mosaic
+( Indicator::MosaicComposedNum, "Mosaic frames composed" )
+( Indicator::MosaicSkippedNum, "Mosaic frames skipped (output busy)" )
+( Indicator::MosaicTilesScaledNum, "Mosaic tiles scaled" )
+( Indicator::MosaicComposeTime, "Total mosaic composing time (ms)" )
+
+// shared fetching
+( Indicator::SharedSegmentsNum, "Segments received from shared fetch" )
+
 // capturer
 ( Indicator::CapturedNum, "Captured frames" );
 
@@ -118,6 +174,13 @@ map_list_of
 ( Indicator::BufferTargetSize, 0. )
 ( Indicator::BufferPlayableSize, 0. )
 ( Indicator::BufferReservedSize, 0. )
+( Indicator::JitterDelayPercentile, 0. )
+( Indicator::JitterAchievedSize, 0. )
+( Indicator::CatchUpSkippedNum, 0. )
+( Indicator::PlayoutSpeed, 1. )
+( Indicator::DecodeQueueSize, 0. )
+( Indicator::DecodePendingNum, 0. )
+( Indicator::DecodeDroppedNum, 0. )
 ( Indicator::CurrentProducerFramerate, 0. )
 ( Indicator::VerifySuccess, 0. )
 ( Indicator::VerifyFailure, 0. )
@@ -133,6 +196,27 @@ map_list_of
 ( Indicator::PlayedKeyNum, 0. )
 ( Indicator::SkippedNum, 0. )
 ( Indicator::LatencyEstimated, 0. )
+// latency distributions
+( Indicator::LatencyP50, 0. )
+( Indicator::LatencyP95, 0. )
+( Indicator::LatencyP99, 0. )
+( Indicator::LatencyMax, 0. )
+( Indicator::DrdP50, 0. )
+( Indicator::DrdP95, 0. )
+( Indicator::DrdP99, 0. )
+( Indicator::DrdMax, 0. )
+( Indicator::AssemblyP50, 0. )
+( Indicator::AssemblyP95, 0. )
+( Indicator::AssemblyP99, 0. )
+( Indicator::AssemblyMax, 0. )
+( Indicator::DecodeP50, 0. )
+( Indicator::DecodeP95, 0. )
+( Indicator::DecodeP99, 0. )
+( Indicator::DecodeMax, 0. )
+( Indicator::LatenessP50, 0. )
+( Indicator::LatenessP95, 0. )
+( Indicator::LatenessP99, 0. )
+( Indicator::LatenessMax, 0. )
 // pipeliner
 ( Indicator::SegmentsDeltaAvgNum, 0. )
 ( Indicator::SegmentsKeyAvgNum, 0. )
@@ -142,6 +226,10 @@ map_list_of
 ( Indicator::RebufferingsNum, 0. )
 ( Indicator::RequestedNum, 0. )
 ( Indicator::RequestedKeyNum, 0. )
+( Indicator::ParityRequestedNum, 0. )
+( Indicator::ParityFetchedNum, 0. )
+( Indicator::LayerSkippedNum, 0. )
+( Indicator::ParityUsedNum, 0. )
 ( Indicator::DW, 0. )
 ( Indicator::W, 0. )
 ( Indicator::SegmentsReceivedNum, 0. )
@@ -154,6 +242,14 @@ map_list_of
 ( Indicator::State, 0. )
 ( Indicator::DoubleRtFrames, 0. )
 ( Indicator::DoubleRtFramesKey, 0. )
+( Indicator::ThroughputEstimate, 0. )
+( Indicator::ThreadSwitchesNum, 0. )
+( Indicator::TimeToFirstFrame, 0. )
+( Indicator::MosaicComposedNum, 0. )
+( Indicator::MosaicSkippedNum, 0. )
+( Indicator::MosaicTilesScaledNum, 0. )
+( Indicator::MosaicComposeTime, 0. )
+( Indicator::SharedSegmentsNum, 0. )
 // DRD estimator
 ( Indicator::DrdCachedEstimation, 0. )
 ( Indicator::DrdOriginalEstimation, 0. )
@@ -177,6 +273,15 @@ map_list_of ( Indicator::Timestamp, 0. )
 // encoder
 ( Indicator::DroppedNum, 0. )
 ( Indicator::EncodedNum, 0. )
+// scaler
+( Indicator::ScaledNum, 0. )
+( Indicator::ScaleSkippedNum, 0. )
+( Indicator::ScaleTime, 0. )
+// content cache
+( Indicator::CacheHitNum, 0. )
+( Indicator::CacheMissNum, 0. )
+( Indicator::CacheEvictedNum, 0. )
+( Indicator::CacheBytes, 0. )
 // capturer
 ( Indicator::CapturedNum, 0. );
 
@@ -202,6 +307,13 @@ boost::assign::map_list_of
 (Indicator::BufferTargetSize, "jitterTar")
 (Indicator::BufferPlayableSize, "jitterPlay")
 (Indicator::BufferReservedSize, "jitterRsrv")
+(Indicator::JitterDelayPercentile, "jitterDelayPct")
+(Indicator::JitterAchievedSize, "jitterAch")
+(Indicator::CatchUpSkippedNum, "catchUpSkip")
+(Indicator::PlayoutSpeed, "playSpeed")
+(Indicator::DecodeQueueSize, "decQueue")
+(Indicator::DecodePendingNum, "decPending")
+(Indicator::DecodeDroppedNum, "decDropped")
 (Indicator::CurrentProducerFramerate, "prodRate")
 (Indicator::VerifySuccess, "verifySuccess")
 (Indicator::VerifyFailure, "verifyFailure")
@@ -217,6 +329,27 @@ boost::assign::map_list_of
 (Indicator::PlayedKeyNum, "framesPlayedKey")
 (Indicator::SkippedNum, "skipNoKey")
 (Indicator::LatencyEstimated, "latEst")
+// latency distributions
+(Indicator::LatencyP50, "latP50")
+(Indicator::LatencyP95, "latP95")
+(Indicator::LatencyP99, "latP99")
+(Indicator::LatencyMax, "latMax")
+(Indicator::DrdP50, "drdP50")
+(Indicator::DrdP95, "drdP95")
+(Indicator::DrdP99, "drdP99")
+(Indicator::DrdMax, "drdMax")
+(Indicator::AssemblyP50, "asmP50")
+(Indicator::AssemblyP95, "asmP95")
+(Indicator::AssemblyP99, "asmP99")
+(Indicator::AssemblyMax, "asmMax")
+(Indicator::DecodeP50, "decP50")
+(Indicator::DecodeP95, "decP95")
+(Indicator::DecodeP99, "decP99")
+(Indicator::DecodeMax, "decMax")
+(Indicator::LatenessP50, "lateP50")
+(Indicator::LatenessP95, "lateP95")
+(Indicator::LatenessP99, "lateP99")
+(Indicator::LatenessMax, "lateMax")
 // pipeliner
 (Indicator::SegmentsDeltaAvgNum, "segAvgDelta")
 (Indicator::SegmentsKeyAvgNum, "segAvgKey")
@@ -226,6 +359,10 @@ boost::assign::map_list_of
 (Indicator::RebufferingsNum, "rebuf")
 (Indicator::RequestedNum, "framesReq")
 (Indicator::RequestedKeyNum, "framesReqKey")
+(Indicator::ParityRequestedNum, "parityReq")
+(Indicator::ParityFetchedNum, "parityFetched")
+(Indicator::LayerSkippedNum, "layerSkipped")
+(Indicator::ParityUsedNum, "parityUsed")
 (Indicator::DW, "lambdaD")
 (Indicator::W, "lambda")
 (Indicator::SegmentsReceivedNum, "segNumRcvd")
@@ -238,6 +375,9 @@ boost::assign::map_list_of
 (Indicator::State, "state" )
 ( Indicator::DoubleRtFrames, "doubleRt" )
 ( Indicator::DoubleRtFramesKey, "doubleRtKey" )
+( Indicator::ThroughputEstimate, "thruput" )
+( Indicator::ThreadSwitchesNum, "switches" )
+( Indicator::TimeToFirstFrame, "ttff" )
 // DRD estimator
 (Indicator::DrdOriginalEstimation, "drdEst")
 (Indicator::DrdCachedEstimation, "drdPrime")
@@ -255,15 +395,122 @@ boost::assign::map_list_of
 (Indicator::SignNum, "signNum")
 // encoder
 (Indicator::EncodedNum, "framesEncoded")
+// scaler
+(Indicator::ScaledNum, "framesScaled")
+(Indicator::ScaleSkippedNum, "scaleSkipped")
+(Indicator::ScaleTime, "scaleMs")
+// content cache
+(Indicator::CacheHitNum, "cacheHit")
+(Indicator::CacheMissNum, "cacheMiss")
+(Indicator::CacheEvictedNum, "cacheEvict")
+(Indicator::CacheBytes, "cacheBytes")
+// mosaic
+(Indicator::MosaicComposedNum, "mosaicComposed")
+(Indicator::MosaicSkippedNum, "mosaicSkipped")
+(Indicator::MosaicTilesScaledNum, "mosaicTiles")
+(Indicator::MosaicComposeTime, "mosaicMs")
+// shared fetching
+(Indicator::SharedSegmentsNum, "sharedSegs")
 // capturer
 (Indicator::CapturedNum, "framesCaptured");
 
+// histogram names
+const std::map<HistogramIndicator, std::string> StatisticsStorage::HistogramKeywords =
+boost::assign::map_list_of
+(HistogramIndicator::CaptureToPlay, "latency")
+(HistogramIndicator::SegmentDrd, "drd")
+(HistogramIndicator::SlotAssembly, "assembly")
+(HistogramIndicator::Decode, "decode")
+(HistogramIndicator::PlayoutLateness, "lateness");
+
+const std::vector<HistogramIndicator> StatisticsStorage::ConsumerHistograms =
+boost::assign::list_of
+(HistogramIndicator::CaptureToPlay)
+(HistogramIndicator::SegmentDrd)
+(HistogramIndicator::SlotAssembly)
+(HistogramIndicator::Decode)
+(HistogramIndicator::PlayoutLateness);
+
+namespace {
+    typedef struct _PercentileIndicator {
+        HistogramIndicator histogram_;
+        double percentile_;
+    } PercentileIndicator;
+
+    // percentile 100 corresponds to max value
+    const std::map<Indicator, PercentileIndicator> PercentileIndicators =
+    boost::assign::map_list_of
+    (Indicator::LatencyP50, PercentileIndicator({HistogramIndicator::CaptureToPlay, 50}))
+    (Indicator::LatencyP95, PercentileIndicator({HistogramIndicator::CaptureToPlay, 95}))
+    (Indicator::LatencyP99, PercentileIndicator({HistogramIndicator::CaptureToPlay, 99}))
+    (Indicator::LatencyMax, PercentileIndicator({HistogramIndicator::CaptureToPlay, 100}))
+    (Indicator::DrdP50, PercentileIndicator({HistogramIndicator::SegmentDrd, 50}))
+    (Indicator::DrdP95, PercentileIndicator({HistogramIndicator::SegmentDrd, 95}))
+    (Indicator::DrdP99, PercentileIndicator({HistogramIndicator::SegmentDrd, 99}))
+    (Indicator::DrdMax, PercentileIndicator({HistogramIndicator::SegmentDrd, 100}))
+    (Indicator::AssemblyP50, PercentileIndicator({HistogramIndicator::SlotAssembly, 50}))
+    (Indicator::AssemblyP95, PercentileIndicator({HistogramIndicator::SlotAssembly, 95}))
+    (Indicator::AssemblyP99, PercentileIndicator({HistogramIndicator::SlotAssembly, 99}))
+    (Indicator::AssemblyMax, PercentileIndicator({HistogramIndicator::SlotAssembly, 100}))
+    (Indicator::DecodeP50, PercentileIndicator({HistogramIndicator::Decode, 50}))
+    (Indicator::DecodeP95, PercentileIndicator({HistogramIndicator::Decode, 95}))
+    (Indicator::DecodeP99, PercentileIndicator({HistogramIndicator::Decode, 99}))
+    (Indicator::DecodeMax, PercentileIndicator({HistogramIndicator::Decode, 100}))
+    (Indicator::LatenessP50, PercentileIndicator({HistogramIndicator::PlayoutLateness, 50}))
+    (Indicator::LatenessP95, PercentileIndicator({HistogramIndicator::PlayoutLateness, 95}))
+    (Indicator::LatenessP99, PercentileIndicator({HistogramIndicator::PlayoutLateness, 99}))
+    (Indicator::LatenessMax, PercentileIndicator({HistogramIndicator::PlayoutLateness, 100}));
+}
+
+StatisticsStorage::StatisticsStorage(const StatRepo& indicators,
+                                     const std::vector<HistogramIndicator>& histograms):
+indicators_(indicators)
+{
+    for (auto h:histograms)
+        histograms_[h] = boost::make_shared<Histogram>();
+}
+
 StatisticsStorage::StatRepo
 StatisticsStorage::getIndicators() const
 {
     StatRepo copy;
     for (StatRepo::const_iterator it = indicators_.begin(); it != indicators_.end(); ++it)
         copy[it->first] = it->second;
+
+    for (auto& it:PercentileIndicators)
+    {
+        HistogramRepo::const_iterator h = histograms_.find(it.second.histogram_);
+        if (h != histograms_.end() && copy.find(it.first) != copy.end())
+            copy[it.first] = (double)h->second->getValueAtPercentile(it.second.percentile_)/1000.;
+    }
+
+    return copy;
+}
+
+void
+StatisticsStorage::recordValue(const statistics::HistogramIndicator& histogram,
+                               int64_t valueUsec)
+{
+    HistogramRepo::iterator it = histograms_.find(histogram);
+    if (it != histograms_.end())
+        it->second->recordValue(valueUsec);
+}
+
+boost::shared_ptr<const Histogram>
+StatisticsStorage::getHistogram(const statistics::HistogramIndicator& histogram) const
+{
+    HistogramRepo::const_iterator it = histograms_.find(histogram);
+    if (it != histograms_.end())
+        return it->second;
+    return boost::shared_ptr<const Histogram>();
+}
+
+StatisticsStorage::HistogramRepo
+StatisticsStorage::copyHistograms() const
+{
+    HistogramRepo copy;
+    for (auto& it:histograms_)
+        copy[it.first] = boost::make_shared<Histogram>(*it.second);
     return copy;
 }
 
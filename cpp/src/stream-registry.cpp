@@ -0,0 +1,144 @@
+//
+// stream-registry.cpp
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#include "stream-registry.hpp"
+
+#include <algorithm>
+#include <boost/make_shared.hpp>
+#include <boost/thread/lock_guard.hpp>
+
+using namespace ndnrtc;
+
+//******************************************************************************
+FetchFanOut::FetchFanOut(const std::string &threadPrefix)
+    : threadPrefix_(threadPrefix)
+{
+}
+
+size_t FetchFanOut::getSubscribersNum() const
+{
+    boost::lock_guard<boost::recursive_mutex> scopedLock(mutex_);
+    return subscribers_.size();
+}
+
+void FetchFanOut::unsubscribe(IBufferObserver *subscriber)
+{
+    boost::lock_guard<boost::recursive_mutex> scopedLock(mutex_);
+    subscribers_.erase(std::remove_if(subscribers_.begin(), subscribers_.end(),
+                                      [subscriber](const Subscriber &s) {
+                                          return s.observer_ == subscriber;
+                                      }),
+                       subscribers_.end());
+}
+
+void FetchFanOut::onNewRequest(const boost::shared_ptr<BufferSlot> &slot)
+{
+    boost::lock_guard<boost::recursive_mutex> scopedLock(mutex_);
+    for (auto &s : subscribers_)
+        s.observer_->onNewRequest(slot);
+}
+
+void FetchFanOut::onNewData(const BufferReceipt &receipt)
+{
+    boost::lock_guard<boost::recursive_mutex> scopedLock(mutex_);
+    for (auto &s : subscribers_)
+        s.observer_->onNewData(receipt);
+}
+
+void FetchFanOut::onReset()
+{
+    boost::lock_guard<boost::recursive_mutex> scopedLock(mutex_);
+    for (auto &s : subscribers_)
+        s.observer_->onReset();
+}
+
+void FetchFanOut::onVerified(const ndn::Name &samplePrefix, BufferSlot::Verification status)
+{
+    boost::lock_guard<boost::recursive_mutex> scopedLock(mutex_);
+    for (auto &s : subscribers_)
+        if (s.onVerified_)
+            s.onVerified_(samplePrefix, status);
+}
+
+#pragma mark - private
+void FetchFanOut::subscribe(IBufferObserver *subscriber, OnClosed onClosed,
+                            OnVerified onVerified)
+{
+    boost::lock_guard<boost::recursive_mutex> scopedLock(mutex_);
+    subscribers_.push_back(Subscriber({subscriber, onClosed, onVerified}));
+}
+
+void FetchFanOut::close()
+{
+    std::vector<Subscriber> subscribers;
+    {
+        boost::lock_guard<boost::recursive_mutex> scopedLock(mutex_);
+        subscribers.swap(subscribers_);
+    }
+
+    for (auto &s : subscribers)
+        if (s.onClosed_)
+            s.onClosed_();
+}
+
+//******************************************************************************
+StreamRegistry *StreamRegistry::getSharedInstance()
+{
+    static StreamRegistry registry;
+    return &registry;
+}
+
+boost::shared_ptr<FetchFanOut>
+StreamRegistry::acquire(const std::string &threadPrefix,
+                        IBufferObserver *subscriber,
+                        FetchFanOut::OnClosed onClosed,
+                        bool &isOwner,
+                        FetchFanOut::OnVerified onVerified)
+{
+    boost::lock_guard<boost::mutex> scopedLock(mutex_);
+    std::map<std::string, boost::shared_ptr<FetchFanOut>>::iterator it = fanOuts_.find(threadPrefix);
+
+    isOwner = (it == fanOuts_.end());
+    if (isOwner)
+    {
+        boost::shared_ptr<FetchFanOut> fanOut = boost::make_shared<FetchFanOut>(threadPrefix);
+        fanOuts_[threadPrefix] = fanOut;
+        return fanOut;
+    }
+
+    it->second->subscribe(subscriber, onClosed, onVerified);
+    return it->second;
+}
+
+void StreamRegistry::release(const boost::shared_ptr<FetchFanOut> &fanOut)
+{
+    {
+        boost::lock_guard<boost::mutex> scopedLock(mutex_);
+        std::map<std::string, boost::shared_ptr<FetchFanOut>>::iterator it =
+            fanOuts_.find(fanOut->getThreadPrefix());
+
+        if (it == fanOuts_.end() || it->second != fanOut)
+            return;
+
+        fanOuts_.erase(it);
+    }
+
+    // subscribers may acquire thread prefix again from their callbacks
+    fanOut->close();
+}
+
+bool StreamRegistry::isFetched(const std::string &threadPrefix) const
+{
+    boost::lock_guard<boost::mutex> scopedLock(mutex_);
+    return fanOuts_.find(threadPrefix) != fanOuts_.end();
+}
+
+size_t StreamRegistry::size() const
+{
+    boost::lock_guard<boost::mutex> scopedLock(mutex_);
+    return fanOuts_.size();
+}
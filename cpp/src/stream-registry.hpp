@@ -0,0 +1,128 @@
+//
+// stream-registry.hpp
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#ifndef __stream_registry_h__
+#define __stream_registry_h__
+
+#include <map>
+#include <string>
+#include <vector>
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/recursive_mutex.hpp>
+
+#include "frame-buffer.hpp"
+
+namespace ndnrtc
+{
+/**
+ * Fan-out of a fetch engine. Attached to the buffer of the remote stream that
+ * fetches a thread (owner), it forwards buffer events to all subscribers.
+ * Owner also reports verification results of its' samples (see onVerified()),
+ * so subscribers can hold segments back until the sample is verified.
+ * Events are delivered on owner's thread, while owner's buffer is locked,
+ * hence subscribers should only hand them over to their own threads.
+ * After unsubscribe() returns, subscriber receives no more events.
+ */
+class FetchFanOut : public IBufferObserver
+{
+  public:
+    typedef boost::function<void(void)> OnClosed;
+    typedef boost::function<void(const ndn::Name &, BufferSlot::Verification)> OnVerified;
+
+    FetchFanOut(const std::string &threadPrefix);
+
+    const std::string &getThreadPrefix() const { return threadPrefix_; }
+    size_t getSubscribersNum() const;
+    void unsubscribe(IBufferObserver *subscriber);
+
+    void onNewRequest(const boost::shared_ptr<BufferSlot> &slot) override;
+    void onNewData(const BufferReceipt &receipt) override;
+    void onReset() override;
+    /**
+     * Called by owner once verification of a sample is over.
+     * @param samplePrefix Sample prefix
+     * @param status Verified, Failed or Unknown if sample can't be verified
+     *  (i.e. manifest couldn't be fetched)
+     */
+    void onVerified(const ndn::Name &samplePrefix, BufferSlot::Verification status);
+
+  private:
+    friend class StreamRegistry;
+    typedef struct _Subscriber
+    {
+        IBufferObserver *observer_;
+        OnClosed onClosed_;
+        OnVerified onVerified_;
+    } Subscriber;
+
+    std::string threadPrefix_;
+    mutable boost::recursive_mutex mutex_;
+    std::vector<Subscriber> subscribers_;
+
+    void subscribe(IBufferObserver *subscriber, OnClosed onClosed,
+                   OnVerified onVerified);
+    void close();
+};
+
+/**
+ * Process-wide registry of remote streams' threads being fetched, keyed by
+ * thread prefix (stream prefix with thread name). Several remote streams
+ * consuming the same thread in one process (playout, storage, preview of the
+ * same producer) use one fetch engine: the first stream to acquire thread
+ * prefix becomes its owner and fetches and verifies data as usual; the others
+ * subscribe to owner's fan-out and assemble received segments in their own
+ * buffers, each with its own playback. Network and verification cost stay
+ * flat as subscribers are added.
+ * When owner releases its' fan-out, subscribers are notified with OnClosed
+ * callback and should acquire thread prefix again (one of them becomes the
+ * new owner). Registry is thread-safe.
+ */
+class StreamRegistry
+{
+  public:
+    static StreamRegistry *getSharedInstance();
+
+    /**
+     * Acquires fan-out for the thread.
+     * @param threadPrefix Thread prefix
+     * @param subscriber Observer that will receive owner's buffer events,
+     *  unless caller becomes the owner
+     * @param onClosed Called (on owner's thread) when owner releases fan-out
+     * @param isOwner Set to true if no stream fetched this thread before -
+     *  caller must attach returned fan-out to its' buffer, report
+     *  verification results to it, fetch the thread and release fan-out
+     *  when fetching stops
+     * @param onVerified Called (on owner's thread) once verification of a
+     *  sample is over
+     */
+    boost::shared_ptr<FetchFanOut> acquire(const std::string &threadPrefix,
+                                           IBufferObserver *subscriber,
+                                           FetchFanOut::OnClosed onClosed,
+                                           bool &isOwner,
+                                           FetchFanOut::OnVerified onVerified = FetchFanOut::OnVerified());
+    /**
+     * Releases fan-out acquired by owner. Thread prefix can be acquired by
+     * another stream after this call.
+     */
+    void release(const boost::shared_ptr<FetchFanOut> &fanOut);
+
+    bool isFetched(const std::string &threadPrefix) const;
+    size_t size() const;
+
+  private:
+    StreamRegistry() {}
+    StreamRegistry(StreamRegistry const &) = delete;
+    void operator=(StreamRegistry const &) = delete;
+
+    mutable boost::mutex mutex_;
+    std::map<std::string, boost::shared_ptr<FetchFanOut>> fanOuts_;
+};
+}
+
+#endif
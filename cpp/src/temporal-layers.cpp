@@ -0,0 +1,53 @@
+//
+// temporal-layers.cpp
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#include "temporal-layers.hpp"
+
+#include <algorithm>
+
+using namespace ndnrtc;
+
+namespace {
+    const unsigned int Patterns[TemporalLayers::MaxLayers][4] = {
+        {0, 0, 0, 0},
+        {0, 1, 0, 1},
+        {0, 2, 1, 2}
+    };
+}
+
+const unsigned int TemporalLayers::MaxLayers;
+
+TemporalLayers::TemporalLayers(unsigned int nLayers)
+    : nLayers_(std::min(std::max(nLayers, 1u), MaxLayers)),
+      period_(1 << (nLayers_ - 1))
+{
+}
+
+unsigned int TemporalLayers::getLayer(unsigned int gopPos) const
+{
+    return Patterns[nLayers_ - 1][gopPos % period_];
+}
+
+unsigned int TemporalLayers::getDeltaLayer(PacketNumber deltaSeqNo) const
+{
+    // first delta frame (seq 0) follows key frame, GOPs are aligned
+    // to pattern period
+    return getLayer((unsigned int)(deltaSeqNo < 0 ? 0 : deltaSeqNo) + 1);
+}
+
+PacketNumber TemporalLayers::nextDelta(PacketNumber deltaSeqNo, unsigned int maxLayer) const
+{
+    // base layer appears once per period, so search is bounded
+    while (getDeltaLayer(deltaSeqNo) > maxLayer)
+        deltaSeqNo++;
+    return deltaSeqNo;
+}
+
+unsigned int TemporalLayers::getReferenceDistance(unsigned int layer) const
+{
+    return (layer >= nLayers_ ? 1 : 1 << (nLayers_ - 1 - layer));
+}
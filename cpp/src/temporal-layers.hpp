@@ -0,0 +1,54 @@
+//
+// temporal-layers.hpp
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#ifndef __temporal_layers_h__
+#define __temporal_layers_h__
+
+#include "ndnrtc-common.hpp"
+
+namespace ndnrtc
+{
+/**
+ * Describes temporal layer structure of a video thread encoded in SVC mode.
+ * Layers follow fixed dyadic pattern, repeating every getPeriod() frames,
+ * starting from a key frame:
+ *      1 layer:  0
+ *      2 layers: 0 1
+ *      3 layers: 0 2 1 2
+ * Frame of layer L references only frames of lower layers (or previous
+ * base layer frame), hence any number of upper layers can be dropped.
+ * Producer starts every GOP at a pattern boundary, so temporal layer of
+ * a delta frame can be derived from its sequence number alone.
+ */
+class TemporalLayers
+{
+  public:
+    static const unsigned int MaxLayers = 3;
+
+    TemporalLayers(unsigned int nLayers = 1);
+
+    unsigned int getLayersNum() const { return nLayers_; }
+    unsigned int getPeriod() const { return period_; }
+
+    // temporal layer of a frame at given GOP position (key frame is 0)
+    unsigned int getLayer(unsigned int gopPos) const;
+    // temporal layer of a delta frame with given sequence number
+    unsigned int getDeltaLayer(PacketNumber deltaSeqNo) const;
+    // first delta sequence number, starting from deltaSeqNo, of a frame
+    // which belongs to one of the layers up to maxLayer
+    PacketNumber nextDelta(PacketNumber deltaSeqNo, unsigned int maxLayer) const;
+    // distance (in frames) to the frame referenced by a frame of given layer
+    unsigned int getReferenceDistance(unsigned int layer) const;
+    // whether GOP can start after given number of delta frames
+    bool isAligned(unsigned int nDeltas) const { return nDeltas % period_ == 0; }
+
+  private:
+    unsigned int nLayers_, period_;
+};
+}
+
+#endif
@@ -22,11 +22,15 @@ void ThreadingCapability::startMyThread()
     });
 }
 
-void ThreadingCapability::stopMyThread()
+void ThreadingCapability::stopMyThread(bool waitForCompletion)
 {
     threadWork_.reset();
     ioService_.stop();
-    thread_.try_join_for(chrono::milliseconds(500));
+
+    if (waitForCompletion)
+        thread_.join();
+    else
+        thread_.try_join_for(chrono::milliseconds(500));
 }
 
 void ThreadingCapability::dispatchOnMyThread(boost::function<void(void)> dispatchBlock)
@@ -22,7 +22,8 @@ namespace ndnrtc {
         ~ThreadingCapability(){}
         
         void startMyThread();
-        void stopMyThread();
+            // if waitForCompletion is false, gives up joining after 500ms
+        void stopMyThread(bool waitForCompletion = false);
             // asynchronous
         void dispatchOnMyThread(boost::function<void(void)> dispatchBlock);
             // synchronous
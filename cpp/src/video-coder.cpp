@@ -12,6 +12,7 @@
 // #define USE_VP9
 
 #include <boost/thread.hpp>
+#include <boost/chrono.hpp>
 #include <webrtc/modules/video_coding/codecs/vp8/include/vp8.h>
 #include <webrtc/modules/video_coding/codecs/vp9/include/vp9.h>
 #include <webrtc/modules/video_coding/include/video_coding.h>
@@ -20,6 +21,7 @@
 
 #include "video-coder.hpp"
 #include "threading-capability.hpp"
+#include "frame-trace.hpp"
 
 using namespace std;
 using namespace ndnlog;
@@ -90,10 +92,12 @@ webrtc::VideoCodec VideoCoder::codecFromSettings(const VideoCoderParams &setting
     codec.VP9()->resilience = 1;
     codec.VP9()->frameDroppingOn = settings.dropFramesOn_;
     codec.VP9()->keyFrameInterval = settings.gop_;
+    codec.VP9()->numberOfTemporalLayers = TemporalLayers(settings.temporalLayers_).getLayersNum();
 #else
     codec.VP8()->resilience = kResilientStream;
     codec.VP8()->frameDroppingOn = settings.dropFramesOn_;
     codec.VP8()->keyFrameInterval = settings.gop_;
+    codec.VP8()->numberOfTemporalLayers = TemporalLayers(settings.temporalLayers_).getLayersNum();
 #endif
 
     // customize parameteres if possible
@@ -124,6 +128,7 @@ FrameScaler::operator()(const WebRtcVideoFrame &frame)
     //     scaledFrameBuffer_->ScaleFrom(frame);
     // });
 
+    FrameTraceStep(Scale);
     scaledFrameBuffer_->ScaleFrom(*(frame.video_frame_buffer()));
 
     return WebRtcVideoFrame(scaledFrameBuffer_, frame.rotation(), frame.timestamp_us());
@@ -157,6 +162,15 @@ VideoCoder::VideoCoder(const VideoCoderParams &coderParams, IEncoderDelegate *de
       codec_(VideoCoder::codecFromSettings(coderParams_)),
       codecSpecificInfo_(nullptr),
       keyEnforcement_(keyEnforcement),
+      nCores_(0),
+      nCoresAllocated_(0),
+      nCoresPending_(0),
+      encodeTimeUsec_(0),
+      nEncodeCalls_(0),
+      layers_(coderParams.temporalLayers_),
+      nDeltas_(0),
+      temporalLayer_(0),
+      keyPending_(false),
 #ifdef USE_VP9
       encoder_(VP9Encoder::Create())
 #else
@@ -171,14 +185,23 @@ VideoCoder::VideoCoder(const VideoCoderParams &coderParams, IEncoderDelegate *de
         throw std::runtime_error("Error creating encoder");
 
     encoder_->RegisterEncodeCompleteCallback(this);
-    int maxPayload = 1440;
+    nCoresAllocated_ = EncoderResourceManager::getSharedInstance()->addEncoder(this, coderParams_);
 
-    if (encoder_->InitEncode(&codec_, boost::thread::hardware_concurrency(), maxPayload) != WEBRTC_VIDEO_CODEC_OK)
-        throw std::runtime_error("Can't initialize encoder");
+    try
+    {
+        initEncoder();
+    }
+    catch (...)
+    {
+        EncoderResourceManager::getSharedInstance()->removeEncoder(this);
+        throw;
+    }
+}
 
-    LogInfoC
-        << "initialized. max payload " << maxPayload
-        << " parameters: " << plotCodec(codec_) << endl;
+VideoCoder::~VideoCoder()
+{
+    EncoderResourceManager::getSharedInstance()->removeEncoder(this);
+    encoder_->Release();
 }
 
 //********************************************************************************
@@ -196,13 +219,44 @@ void VideoCoder::onRawFrame(const WebRtcVideoFrame &frame)
         throw std::runtime_error(ss.str());
     }
 
+    // new GOP can start only at temporal pattern boundary
+    bool canStartGop = layers_.isAligned(nDeltas_);
+    // key frame is due by GOP anyway
+    bool isGopStart = (keyFrameTrigger_ % coderParams_.gop_ == 0) ||
+                      (keyEnforcement_ == KeyEnforcement::EncoderDefined &&
+                       gopPos_ + 1 >= (int)coderParams_.gop_);
+
+    if (isGopStart && canStartGop)
+    {
+        // encoder has to be re-initialized to use new number of cores, which
+        // means a key frame. to avoid extra key frames, new number of cores
+        // is applied at natural GOP start only, and only if it has not
+        // changed since the previous GOP start
+        unsigned int nCores = nCoresAllocated_;
+
+        if (nCores != nCores_ && nCores == nCoresPending_)
+        {
+            encoder_->Release();
+            initEncoder();
+            keyFrameTrigger_ = 0;
+        }
+        nCoresPending_ = nCores;
+    }
+
+    bool encodeKey = (keyFrameTrigger_ % coderParams_.gop_ == 0) || keyPending_;
+    keyPending_ = (encodeKey && !canStartGop);
+    encodeKey &= canStartGop;
+
     encodeComplete_ = false;
     delegate_->onEncodingStarted();
 
     int err;
-    if (keyFrameTrigger_ % coderParams_.gop_ == 0)
+    boost::chrono::steady_clock::time_point encodeStart = boost::chrono::steady_clock::now();
+    if (encodeKey)
     {
         gopPos_ = 0;
+        if (keyEnforcement_ == KeyEnforcement::Gop)
+            keyFrameTrigger_ = 0; // GOP counts from this key frame, even if it was postponed
 
         LogTraceC << "⤹ encoding ○ (K) " << gopPos_ << endl;
         err = encoder_->Encode(frame, codecSpecificInfo_, &keyFrameType_);
@@ -217,6 +271,9 @@ void VideoCoder::onRawFrame(const WebRtcVideoFrame &frame)
         err = encoder_->Encode(frame, codecSpecificInfo_, NULL);
     }
 
+    encodeTimeUsec_ += boost::chrono::duration_cast<boost::chrono::microseconds>(boost::chrono::steady_clock::now() - encodeStart).count();
+    nEncodeCalls_++;
+
     if (!encodeComplete_)
     {
         LogTraceC << " dropped ✕ " << gopPos_ << endl;
@@ -232,6 +289,20 @@ void VideoCoder::onRawFrame(const WebRtcVideoFrame &frame)
         LogErrorC << "can't encode frame due to error " << err << std::endl;
 }
 
+//********************************************************************************
+#pragma mark - interfaces realization - IEncoderResourceClient
+void VideoCoder::onCoresAllocated(unsigned int nCores)
+{
+    // may be called from any thread, encoder picks it up on the next frame
+    nCoresAllocated_ = nCores;
+}
+
+double VideoCoder::getEncodeTimeMs() const
+{
+    uint64_t nCalls = nEncodeCalls_;
+    return (nCalls ? (double)encodeTimeUsec_ / (double)nCalls / 1000. : 0);
+}
+
 //********************************************************************************
 #pragma mark - interfaces realization - EncodedImageCallback
 webrtc::EncodedImageCallback::Result
@@ -241,8 +312,32 @@ VideoCoder::OnEncodedImage(const EncodedImage &encodedImage,
 {
     encodeComplete_ = true;
 
-    if (encodedImage._frameType == webrtc::kVideoFrameKey)
+    bool isKey = (encodedImage._frameType == webrtc::kVideoFrameKey);
+    bool isAligned = layers_.isAligned(nDeltas_);
+    unsigned int expectedLayer = (isKey ? 0 : layers_.getDeltaLayer(nDeltas_));
+    uint8_t temporalIdx = webrtc::kNoTemporalIdx;
+
+    if (isKey)
         gopPos_ = 0;
+    else
+        nDeltas_++;
+
+    if (codecSpecificInfo)
+#ifdef USE_VP9
+        temporalIdx = codecSpecificInfo->codecSpecific.VP9.temporal_idx;
+#else
+        temporalIdx = codecSpecificInfo->codecSpecific.VP8.temporalIdx;
+#endif
+    temporalLayer_ = (temporalIdx == webrtc::kNoTemporalIdx ? 0 : temporalIdx);
+
+    if (temporalLayer_ != expectedLayer || (isKey && !isAligned))
+    {
+        // encoder went out of sync with temporal pattern (i.e. encoder 
+        // inserted key frame itself) - resync on the next pattern boundary
+        LogWarnC << "temporal layer " << temporalLayer_
+                 << " expected " << expectedLayer << ", forcing key frame" << std::endl;
+        keyPending_ = true;
+    }
 
     LogTraceC << "⤷ encoded  ● "
               << (encodedImage._frameType == webrtc::kVideoFrameKey ? "K " : "D ")
@@ -270,3 +365,19 @@ VideoCoder::OnEncodedImage(const EncodedImage &encodedImage,
     delegate_->onEncodedFrame(encodedImage);
     return Result(Result::OK);
 }
+
+//********************************************************************************
+#pragma mark - private
+void VideoCoder::initEncoder()
+{
+    int maxPayload = 1440;
+
+    nCores_ = nCoresPending_ = nCoresAllocated_;
+    if (encoder_->InitEncode(&codec_, nCores_, maxPayload) != WEBRTC_VIDEO_CODEC_OK)
+        throw std::runtime_error("Can't initialize encoder");
+
+    LogInfoC
+        << "initialized. max payload " << maxPayload
+        << " cores " << nCores_
+        << " parameters: " << plotCodec(codec_) << endl;
+}
@@ -12,12 +12,15 @@
 #ifndef __ndnrtc__video_coder__
 #define __ndnrtc__video_coder__
 
+#include <boost/atomic.hpp>
 #include <webrtc/modules/video_coding/include/video_codec_interface.h>
 
 #include "webrtc.hpp"
 #include "ndnrtc-common.hpp"
 #include "statistics.hpp"
 #include "ndnrtc-object.hpp"
+#include "encoder-resource-manager.hpp"
+#include "temporal-layers.hpp"
 
 #define USE_VP9
 
@@ -74,9 +77,17 @@ class FrameScaler
      * This class is a main wrapper for VP8 WebRTC encoder. It consumes raw
      * frames, encodes them using VP8 encoder, configured for specified
      * parameters and passes encoded frames to its' frame consumer class.
+     * Number of cores encoder uses is assigned by EncoderResourceManager.
+     * New number of cores is applied at the start of a GOP, once it has
+     * stayed the same for a whole GOP.
+     * If more than one temporal layer is configured, encoder works in SVC
+     * mode and produces one stream with temporal layers (see TemporalLayers).
+     * In this mode, key frames are inserted at temporal pattern boundaries
+     * only, so GOP may be slightly longer than requested.
      */
 class VideoCoder : public NdnRtcComponent,
                    public IRawFrameConsumer,
+                   public IEncoderResourceClient,
                    public webrtc::EncodedImageCallback
 {
   public:
@@ -89,9 +100,18 @@ class VideoCoder : public NdnRtcComponent,
 
     VideoCoder(const VideoCoderParams &coderParams, IEncoderDelegate *delegate,
                KeyEnforcement = KeyEnforcement::EncoderDefined);
+    ~VideoCoder();
 
     void onRawFrame(const WebRtcVideoFrame &frame);
     int getGopCounter() const { return gopPos_; }
+    unsigned int getCoresNum() const { return nCores_; }
+    // temporal layer of the last encoded frame
+    unsigned int getTemporalLayer() const { return temporalLayer_; }
+    const TemporalLayers &getTemporalLayers() const { return layers_; }
+
+    // interface IEncoderResourceClient
+    void onCoresAllocated(unsigned int nCores);
+    double getEncodeTimeMs() const;
 
     static webrtc::VideoCodec codecFromSettings(const VideoCoderParams &settings);
 
@@ -109,6 +129,15 @@ class VideoCoder : public NdnRtcComponent,
 
     int keyFrameTrigger_, gopPos_;
     KeyEnforcement keyEnforcement_;
+    unsigned int nCores_;
+    boost::atomic<unsigned int> nCoresAllocated_;
+    unsigned int nCoresPending_; // allocation seen at the last GOP start
+    boost::atomic<uint64_t> encodeTimeUsec_, nEncodeCalls_;
+    TemporalLayers layers_;
+    unsigned int nDeltas_, temporalLayer_;
+    bool keyPending_;
+
+    void initEncoder();
 
     // interface webrtc::EncodedImageCallback
     webrtc::EncodedImageCallback::Result OnEncodedImage(const webrtc::EncodedImage &encoded_image,
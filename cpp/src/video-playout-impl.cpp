@@ -9,6 +9,9 @@
 #include "frame-data.hpp"
 #include "frame-buffer.hpp"
 #include "statistics.hpp"
+#include "clock.hpp"
+#include "frame-trace.hpp"
+#include "temporal-layers.hpp"
 
 using namespace std;
 using namespace ndnrtc;
@@ -55,6 +58,10 @@ void VideoPlayoutImpl::stop()
     PlayoutImpl::stop();
     currentPlayNo_ = -1;
     gopCount_ = 0;
+
+    boost::lock_guard<boost::recursive_mutex> scopedLock(mutex_);
+    if (frameConsumer_)
+        frameConsumer_->flush();
 }
 
 //******************************************************************************
@@ -82,6 +89,10 @@ bool VideoPlayoutImpl::processSample(const boost::shared_ptr<const BufferSlot>&
             (*statStorage_)[Indicator::RecoveredNum]++;
             if (slot->getNameInfo().class_ == SampleClass::Key)
                 (*statStorage_)[Indicator::RecoveredKeyNum]++;
+
+            for (auto& s:slot->getFetchedSegments())
+                if (s->getInfo().segmentClass_ == SegmentClass::Parity)
+                    (*statStorage_)[Indicator::ParityUsedNum]++;
         }
 
         if (!slot->getNameInfo().isDelta_)
@@ -93,8 +104,14 @@ bool VideoPlayoutImpl::processSample(const boost::shared_ptr<const BufferSlot>&
         }
         else
         {
+            // frames of upper temporal layers may be skipped on purpose,
+            // delta frame can be decoded as long as frame it references
+            // has been played
+            PacketNumber maxGap = TemporalLayers(hdr.temporalLayersNum_).getReferenceDistance(hdr.temporalLayer_);
+
             if (currentPlayNo_ >= 0 &&
-                (hdr.playbackNo_ != currentPlayNo_ + 1 || !gopIsValid_))
+                (hdr.playbackNo_ <= currentPlayNo_ || 
+                 hdr.playbackNo_ - currentPlayNo_ > maxGap || !gopIsValid_))
             {
                 if (!gopIsValid_)
                     LogWarnC << "skip " << frameStr << ". invalid GOP" << std::endl;
@@ -129,6 +146,7 @@ bool VideoPlayoutImpl::processSample(const boost::shared_ptr<const BufferSlot>&
                                           currentPlayNo_, 
                                           slot->getPrefix().toUri(),
                                           !slot->getNameInfo().isDelta_});
+                        // decode time is measured by DecodeStage
                         frameConsumer_->processFrame(finfo, framePacket->getFrame());
                     }
                     else
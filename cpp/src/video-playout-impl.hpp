@@ -58,6 +58,8 @@ namespace ndnrtc {
     {
     public:
         virtual void processFrame(const FrameInfo&, const webrtc::EncodedImage&) = 0;
+        // called when playout stops, frames passed earlier won't be played
+        virtual void flush() {}
     };
 
     class IVideoPlayoutObserver : public IPlayoutObserver 
@@ -19,6 +19,7 @@
 #include "frame-data.hpp"
 #include "video-thread.hpp"
 #include "video-coder.hpp"
+#include "scaling-pyramid.hpp"
 #include "packet-publisher.hpp"
 #include "name-components.hpp"
 #include "simple-log.hpp"
@@ -26,6 +27,7 @@
 #include "clock.hpp"
 #include "async.hpp"
 #include "params.hpp"
+#include "frame-trace.hpp"
 
 #define PARITY_RATIO 0.2
 
@@ -50,16 +52,18 @@ VideoStreamImpl::VideoStreamImpl(const std::string &streamPrefix,
         throw runtime_error("Wrong media stream parameters type supplied (audio instead of video)");
 
     description_ = "vstream-" + settings_.params_.streamName_;
+    pyramid_ = boost::make_shared<ScalingPyramid>(statStorage_);
 
     for (int i = 0; i < settings_.params_.getThreadNum(); ++i)
         if (settings_.params_.getVideoThread(i))
             add(settings_.params_.getVideoThread(i));
 
-    PublisherSettings ps;
+    StreamPublisherSettings ps;
     ps.sign_ = false; // stream samples are not signed - we use manifests for verification
     ps.keyChain_ = settings_.keyChain_;
     ps.memoryCache_ = cache_.get();
     ps.segmentWireLength_ = settings_.params_.producerParams_.segmentSize_;
+    ps.wireFormat_ = wireFormat(NameComponents::nameApiVersion());
     ps.freshnessPeriodMs_ = settings_.params_.producerParams_.freshness_.sampleMs_;
     ps.statStorage_ = statStorage_.get();
 
@@ -68,7 +72,7 @@ VideoStreamImpl::VideoStreamImpl(const std::string &streamPrefix,
         ps.onSegmentsCached_ = boost::bind(&MediaStreamBase::onSegmentsCached, this, _1);
     }
 
-    framePublisher_ = boost::make_shared<VideoPacketPublisher>(ps);
+    framePublisher_ = boost::make_shared<VideoStreamPublisher>(ps);
     framePublisher_->setDescription("seg-publisher-" + settings_.params_.streamName_);
 }
 
@@ -91,6 +95,7 @@ vector<string> VideoStreamImpl::getThreads() const
 int VideoStreamImpl::incomingFrame(const ArgbRawFrameWrapper &w)
 {
     LogDebugC << "⤹ incoming ARGB frame " << w.width_ << "x" << w.height_ << std::endl;
+    FrameTraceFlow(playbackCounter_);
     if (feedFrame(conv_ << w))
         return (playbackCounter_ - 1);
     return -1;
@@ -99,14 +104,40 @@ int VideoStreamImpl::incomingFrame(const ArgbRawFrameWrapper &w)
 int VideoStreamImpl::incomingFrame(const I420RawFrameWrapper &w)
 {
     LogDebugC << "⤹ incoming I420 frame " << w.width_ << "x" << w.height_ << std::endl;
+    FrameTraceFlow(playbackCounter_);
     if (feedFrame(conv_ << w))
         return (playbackCounter_ - 1);
     return -1;
 }
 
+int VideoStreamImpl::incomingFrame(const PlanarFrame &f, IFrameBufferOwner *owner)
+{
+    LogDebugC << "⤹ incoming I420 frame (no copy) " << f.width_ << "x" << f.height_ << std::endl;
+
+    if (f.nPlanes_ != 3)
+    {
+        LogErrorC << "only I420 frames can be published without copying" << std::endl;
+        owner->releaseFrame(f);
+        return -1;
+    }
+
+    FrameTraceFlow(playbackCounter_);
+    // owner is notified when the last encoder releases the frame (or right
+    // away, if frame is dropped)
+    WebRtcVideoFrame frame = conv_.wrap(I420RawFrameWrapper({(unsigned int)f.width_, (unsigned int)f.height_,
+                                                             (unsigned int)f.strides_[0], (unsigned int)f.strides_[1],
+                                                             (unsigned int)f.strides_[2],
+                                                             f.planes_[0], f.planes_[1], f.planes_[2]}),
+                                        [f, owner]() { owner->releaseFrame(f); });
+    if (feedFrame(frame))
+        return (playbackCounter_ - 1);
+    return -1;
+}
+
 int VideoStreamImpl::incomingFrame(const YUV_NV21FrameWrapper &w)
 {
     LogDebugC << "⤹ incoming NV21 frame " << w.width_ << "x" << w.height_ << std::endl;
+    FrameTraceFlow(playbackCounter_);
     if (feedFrame(conv_ << w))
         return (playbackCounter_ - 1);
     return -1;
@@ -140,8 +171,9 @@ void VideoStreamImpl::add(const MediaThreadParams *mp)
         boost::lock_guard<boost::mutex> scopedLock(internalMutex_);
 
         threads_[params->threadName_] = boost::make_shared<VideoThread>(params->coderParams_);
-        scalers_[params->threadName_] = boost::make_shared<FrameScaler>(params->coderParams_.encodeWidth_,
-                                                                        params->coderParams_.encodeHeight_);
+        resolutions_[params->threadName_] = std::make_pair(params->coderParams_.encodeWidth_,
+                                                           params->coderParams_.encodeHeight_);
+        pyramid_->addLevel(params->coderParams_.encodeWidth_, params->coderParams_.encodeHeight_);
         seqCounters_[params->threadName_].first = -1;
         seqCounters_[params->threadName_].second = -1;
         metaKeepers_[params->threadName_] = boost::make_shared<MetaKeeper>(params);
@@ -159,7 +191,8 @@ void VideoStreamImpl::remove(const string &threadName)
         boost::lock_guard<boost::mutex> scopedLock(internalMutex_);
 
         threads_.erase(threadName);
-        scalers_.erase(threadName);
+        pyramid_->removeLevel(resolutions_[threadName].first, resolutions_[threadName].second);
+        resolutions_.erase(threadName);
         seqCounters_.erase(threadName);
         metaKeepers_.erase(threadName);
 
@@ -183,14 +216,29 @@ bool VideoStreamImpl::feedFrame(const WebRtcVideoFrame &frame)
         LogDebugC << "↓ feeding " << playbackCounter_ << "p into encoders..." << std::endl;
 
         map<string, FutureFramePtr> futureFrames;
-        for (auto it : threads_)
-        {
-            FutureFramePtr ff =
-                boost::make_shared<FutureFrame>(boost::move(boost::async(boost::launch::async,
-                                                                         boost::bind(&VideoThread::encode, it.second.get(),
-                                                                         (*scalers_[it.first])(frame)))));
-            futureFrames[it.first] = ff;
-        }
+        // encoding happens on a different thread, so frame number has to
+        // be passed explicitly for tracing
+        PacketNumber playbackNo = playbackCounter_;
+
+        // threads start encoding as soon as their resolution level is ready,
+        // while lower levels are still being scaled
+        pyramid_->scale(frame, [this, playbackNo, &futureFrames](unsigned int width, unsigned int height,
+                                                                 const WebRtcVideoFrame &scaledFrame) {
+            for (auto &it : resolutions_)
+            {
+                if (it.second.first != width || it.second.second != height)
+                    continue;
+
+                boost::shared_ptr<VideoThread> thread = threads_[it.first];
+                FutureFramePtr ff =
+                    boost::make_shared<FutureFrame>(boost::move(boost::async(boost::launch::async,
+                                                                             [thread, scaledFrame, playbackNo]() {
+                                                                                 FrameTraceFlow(playbackNo);
+                                                                                 return thread->encode(scaledFrame);
+                                                                             })));
+                futureFrames[it.first] = ff;
+            }
+        });
 
         map<string, FramePacketPtr> frames;
         for (auto it : futureFrames)
@@ -261,24 +309,37 @@ void VideoStreamImpl::publish(map<string, FramePacketPtr> &frames)
 
 std::string VideoStreamImpl::publish(const string &thread, FramePacketPtr &fp)
 {
-    boost::shared_ptr<NetworkData> parityData = fp->getParityData(
-        VideoFrameSegment::payloadLength(settings_.params_.producerParams_.segmentSize_),
-        PARITY_RATIO);
+    // data segments payload length is the FEC symbol length
+    size_t headerReserve = VideoFrameSegment::packetHeaderReserve(wireFormat(NameComponents::nameApiVersion()));
+    boost::shared_ptr<NetworkData> parityData;
+    {
+        FrameTraceStep(Fec);
+        parityData = fp->getParityData(
+            VideoFrameSegment::slicePayloadLength(settings_.params_.producerParams_.segmentSize_, headerReserve),
+            PARITY_RATIO);
+    }
 
     bool isKey = (fp->getFrame()._frameType == webrtc::kVideoFrameKey);
     PacketNumber seqNo = (isKey ? seqCounters_[thread].first : seqCounters_[thread].second);
     PacketNumber pairedSeq = (isKey ? seqCounters_[thread].second + 1 : seqCounters_[thread].first);
     PacketNumber playbackNo = playbackCounter_;
     unsigned char gopPos = (char)threads_[thread]->getCoder().getGopCounter();
+    const TemporalLayers &layers = threads_[thread]->getCoder().getTemporalLayers();
+    unsigned char temporalLayer = (unsigned char)threads_[thread]->getCoder().getTemporalLayer();
+    unsigned char temporalLayersNum = (unsigned char)layers.getLayersNum();
+    // delta name carries temporal layer expected for this sequence number,
+    // so consumers can skip upper layers without fetching them
     Name dataName(streamPrefix_);
     dataName.append(thread)
-        .append((isKey ? NameComponents::NameComponentKey : NameComponents::NameComponentDelta))
+        .append((isKey ? NameComponents::NameComponentKey : NameComponents::deltaComponent(layers.getDeltaLayer(seqNo))))
         .appendSequenceNumber(seqNo);
 
     size_t nDataSeg = VideoFrameSegment::numSlices(*fp,
-                                                   settings_.params_.producerParams_.segmentSize_);
+                                                   settings_.params_.producerParams_.segmentSize_,
+                                                   headerReserve);
     size_t nParitySeg = fecEnabled_ && VideoFrameSegment::numSlices(*parityData,
-                                                     settings_.params_.producerParams_.segmentSize_);
+                                                     settings_.params_.producerParams_.segmentSize_,
+                                                     headerReserve);
     boost::shared_ptr<VideoStreamImpl> me = boost::static_pointer_cast<VideoStreamImpl>(shared_from_this());
     boost::shared_ptr<MetaKeeper> keeper = metaKeepers_[thread];
 
@@ -290,12 +351,16 @@ std::string VideoStreamImpl::publish(const string &thread, FramePacketPtr &fp)
 
     busyPublishing_++;
     async::dispatchAsync(settings_.faceIo_, [me, nParitySeg, nDataSeg, seqNo, pairedSeq, keeper, isKey,
-                                             thread, fp, parityData, dataName, playbackNo, gopPos, this] {
+                                             thread, fp, parityData, dataName, playbackNo, gopPos,
+                                             temporalLayer, temporalLayersNum, this] {
+        FrameTraceFlow(playbackNo);
         VideoFrameSegmentHeader segmentHdr;
         segmentHdr.totalSegmentsNum_ = nDataSeg;
         segmentHdr.paritySegmentsNum_ = nParitySeg;
         segmentHdr.playbackNo_ = playbackNo;
         segmentHdr.pairedSequenceNo_ = pairedSeq;
+        segmentHdr.temporalLayer_ = temporalLayer;
+        segmentHdr.temporalLayersNum_ = temporalLayersNum;
 
         PublishedDataPtrVector segments =
             me->framePublisher_->publish(dataName, *fp, segmentHdr,
@@ -36,7 +36,7 @@ class Logger;
 namespace ndnrtc
 {
 class VideoThread;
-class FrameScaler;
+class ScalingPyramid;
 class VideoThreadParams;
 struct Mutable;
 template <typename T>
@@ -54,6 +54,7 @@ class VideoStreamImpl : public MediaStreamBase
 
     int incomingFrame(const ArgbRawFrameWrapper &);
     int incomingFrame(const I420RawFrameWrapper &);
+    int incomingFrame(const PlanarFrame &, IFrameBufferOwner *);
     int incomingFrame(const YUV_NV21FrameWrapper &);
     
     const std::map<std::string, FrameInfo>& getLastPublished() { return lastPublished_; }
@@ -94,11 +95,12 @@ class VideoStreamImpl : public MediaStreamBase
     boost::atomic<int> busyPublishing_;
     RawFrameConverter conv_;
     std::map<std::string, boost::shared_ptr<VideoThread>> threads_;
-    std::map<std::string, boost::shared_ptr<FrameScaler>> scalers_;
+    boost::shared_ptr<ScalingPyramid> pyramid_;
+    std::map<std::string, std::pair<unsigned int, unsigned int>> resolutions_;
     std::map<std::string, boost::shared_ptr<MetaKeeper>> metaKeepers_;
     std::map<std::string, std::pair<uint64_t, uint64_t>> seqCounters_;
     uint64_t playbackCounter_;
-    boost::shared_ptr<VideoPacketPublisher> framePublisher_;
+    boost::shared_ptr<VideoStreamPublisher> framePublisher_;
     std::map<std::string, FrameInfo> lastPublished_;
 
     void add(const MediaThreadParams *params) override;
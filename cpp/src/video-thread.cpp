@@ -13,6 +13,7 @@
 
 #include "video-thread.hpp"
 #include "frame-data.hpp"
+#include "frame-trace.hpp"
 
 using namespace std;
 using namespace ndnlog;
@@ -36,6 +37,7 @@ VideoThread::~VideoThread()
 boost::shared_ptr<VideoFramePacket>
 VideoThread::encode(const WebRtcVideoFrame &frame)
 {
+    FrameTraceStep(Encode);
     coder_.onRawFrame(frame);
     // result should be delivered using onEncodedFrame or onDroppedFrame
     // callbacks which prepare videoFramePacket_ accordingly
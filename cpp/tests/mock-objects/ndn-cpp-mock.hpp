@@ -10,6 +10,7 @@
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include <ndn-cpp/face.hpp>
 #include <ndn-cpp/security/key-chain.hpp>
 #include <ndn-cpp/util/memory-content-cache.hpp>
 
@@ -53,4 +54,14 @@ public:
 	}
 };
 
+class MockNdnFace : public ndn::Face
+{
+public:
+	MockNdnFace():ndn::Face("aleph.ndn.ucla.edu"){}
+
+	using ndn::Face::expressInterest;
+	MOCK_METHOD5(expressInterest, uint64_t(const ndn::Interest&, const ndn::OnData&,
+		const ndn::OnTimeout&, const ndn::OnNetworkNack&, ndn::WireFormat&));
+};
+
 #endif
@@ -23,6 +23,9 @@ public:
     MOCK_METHOD2(setSequenceNumber, void(PacketNumber seqNo, ndnrtc::SampleClass cls));
     MOCK_METHOD1(getSequenceNumber, PacketNumber(ndnrtc::SampleClass));
     MOCK_METHOD1(setInterestLifetime, void(unsigned int));
+    MOCK_METHOD5(switchThread, void(const ndn::Name&, PacketNumber, PacketNumber, PacketNumber,
+                                    boost::function<void(const ndn::Name&)>));
+    MOCK_METHOD1(setTemporalLayers, void(unsigned int));
 };
 
 #endif
\ No newline at end of file
@@ -17,6 +17,9 @@ public:
 	MOCK_METHOD1(start, void(unsigned int));
 	MOCK_METHOD0(stop, void());
 	MOCK_CONST_METHOD0(isRunning, bool());
+	MOCK_METHOD1(addAdjustment, void(int64_t));
+	MOCK_METHOD1(setSpeed, void(double));
+	MOCK_CONST_METHOD0(getSpeed, double());
 };
 
 #endif
\ No newline at end of file
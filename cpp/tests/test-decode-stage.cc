@@ -0,0 +1,297 @@
+//
+// test-decode-stage.cc
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#include <stdlib.h>
+
+#include <boost/thread.hpp>
+#include <boost/chrono.hpp>
+#include <boost/atomic.hpp>
+
+#include "gtest/gtest.h"
+#include "src/decode-stage.hpp"
+#include "statistics.hpp"
+#include "histogram.hpp"
+
+using namespace ndnrtc;
+using namespace ndnrtc::statistics;
+
+namespace {
+	WebRtcVideoFrame makeFrame(int w, int h)
+	{
+		rtc::scoped_refptr<WebRtcVideoFrameBuffer> buffer = WebRtcVideoFrameBuffer::Create(w, h);
+		return WebRtcVideoFrame(buffer, webrtc::kVideoRotation_0, 0);
+	}
+
+	// "decodes" frames by sleeping for given time
+	class FakeDecoder : public IEncodedFrameConsumer
+	{
+	public:
+		FakeDecoder(int decodeMs):decodeMs_(decodeMs), nOutputs_(1), stage_(nullptr),
+			nDecoded_(0), frame_(makeFrame(64, 48)){}
+
+		void processFrame(const FrameInfo& finfo, const webrtc::EncodedImage& image)
+		{
+			// encoded data must be a copy owned by decode stage
+			EXPECT_EQ(finfo.playbackNo_, image._buffer[0]);
+			EXPECT_EQ(1, image._length);
+
+			boost::this_thread::sleep_for(boost::chrono::milliseconds(decodeMs_));
+			nDecoded_++;
+			// each extra output is numbered 100 above the previous one
+			for (int i = 0; i < nOutputs_; ++i)
+			{
+				FrameInfo out(finfo);
+				out.playbackNo_ += 100*i;
+				stage_->frameDecoded(out, frame_);
+			}
+		}
+
+		int decodeMs_, nOutputs_;
+		DecodeStage *stage_;
+		boost::atomic<int> nDecoded_;
+		WebRtcVideoFrame frame_;
+	};
+
+	// frames are presented on playout ticks (or decode thread)
+	class Presented {
+	public:
+		OnDecodedImage callback()
+		{
+			return [this](const FrameInfo& finfo, const WebRtcVideoFrame&){
+				boost::lock_guard<boost::mutex> scopedLock(m_);
+				frames_.push_back(finfo.playbackNo_);
+			};
+		}
+		std::vector<int> get()
+		{
+			boost::lock_guard<boost::mutex> scopedLock(m_);
+			return frames_;
+		}
+
+	private:
+		boost::mutex m_;
+		std::vector<int> frames_;
+	};
+
+	void passFrame(DecodeStage& stage, int playbackNo, bool isKey)
+	{
+		uint8_t data[32];
+		webrtc::EncodedImage image(data, 1, sizeof(data));
+		FrameInfo finfo({0, playbackNo, "/frame", isKey});
+
+		data[0] = (uint8_t)playbackNo;
+		stage.processFrame(finfo, image);
+		// playout releases frame data right after it was passed
+		data[0] = 0xff;
+	}
+}
+
+TEST(TestDecodeStage, TestPresentOnTick)
+{
+	boost::shared_ptr<StatisticsStorage> storage(StatisticsStorage::createConsumerStatistics());
+	Presented presented;
+	boost::shared_ptr<DecodeStage> stage = boost::make_shared<DecodeStage>(storage, presented.callback());
+	boost::shared_ptr<FakeDecoder> decoder = boost::make_shared<FakeDecoder>(5);
+
+	decoder->stage_ = stage.get();
+	stage->setDecoder(decoder);
+
+	// each frame is presented on the playout tick following its' decoding
+	for (int i = 0; i < 10; ++i)
+	{
+		passFrame(*stage, i, i == 0);
+		ASSERT_EQ(i, presented.get().size());
+		if (i)
+			EXPECT_EQ(i-1, presented.get().back());
+		boost::this_thread::sleep_for(boost::chrono::milliseconds(30));
+		EXPECT_EQ(i, presented.get().size());
+	}
+
+	EXPECT_EQ(10, decoder->nDecoded_);
+	EXPECT_EQ(0, stage->getPendingNum());
+	EXPECT_EQ(1, stage->getQueueSize());
+	EXPECT_EQ(0, (*storage)[Indicator::DecodeDroppedNum]);
+	EXPECT_EQ(1, (*storage)[Indicator::DecodeQueueSize]);
+	EXPECT_EQ(10, storage->getHistogram(HistogramIndicator::Decode)->getTotalCount());
+	EXPECT_LE(5000, storage->getHistogram(HistogramIndicator::Decode)->getMin());
+}
+
+TEST(TestDecodeStage, TestPresentOnDecode)
+{
+	boost::shared_ptr<StatisticsStorage> storage(StatisticsStorage::createConsumerStatistics());
+	Presented presented;
+	boost::shared_ptr<DecodeStage> stage = boost::make_shared<DecodeStage>(storage, presented.callback(), true);
+	boost::shared_ptr<FakeDecoder> decoder = boost::make_shared<FakeDecoder>(5);
+
+	decoder->stage_ = stage.get();
+	stage->setDecoder(decoder);
+
+	// frames not paced by playout are presented as soon as they are decoded
+	for (int i = 0; i < 3; ++i)
+	{
+		passFrame(*stage, i, true);
+		boost::this_thread::sleep_for(boost::chrono::milliseconds(30));
+		ASSERT_EQ(i+1, presented.get().size());
+		EXPECT_EQ(i, presented.get().back());
+	}
+	EXPECT_EQ(0, stage->getQueueSize());
+}
+
+TEST(TestDecodeStage, TestSlowDecoder)
+{
+	boost::shared_ptr<StatisticsStorage> storage(StatisticsStorage::createConsumerStatistics());
+	Presented presented;
+	boost::shared_ptr<DecodeStage> stage = boost::make_shared<DecodeStage>(storage, presented.callback());
+	boost::shared_ptr<FakeDecoder> decoder = boost::make_shared<FakeDecoder>(50);
+	int gop = 20;
+
+	decoder->stage_ = stage.get();
+	stage->setDecoder(decoder);
+
+	// playout timing is not affected by decoding time and at most one frame
+	// is presented per playout tick
+	boost::chrono::steady_clock::time_point start = boost::chrono::steady_clock::now();
+	for (int i = 0; i < 2*gop; ++i)
+	{
+		size_t nPresented = presented.get().size();
+		passFrame(*stage, i, i%gop == 0);
+		nPresented++;
+		EXPECT_GE(nPresented, presented.get().size());
+		boost::this_thread::sleep_for(boost::chrono::milliseconds(10));
+		EXPECT_GE(nPresented, presented.get().size());
+	}
+	int elapsedMs = boost::chrono::duration_cast<boost::chrono::milliseconds>(boost::chrono::steady_clock::now()-start).count();
+	EXPECT_GT(2*gop*10+100, elapsedMs);
+
+	// decoder fell behind - frames were dropped until the next key frame
+	EXPECT_LT(0, (*storage)[Indicator::DecodeDroppedNum]);
+	EXPECT_GE(DecodeStage::MaxPendingFrames, stage->getPendingNum());
+	EXPECT_GE(DecodeStage::QueueCapacity, stage->getQueueSize());
+
+	std::vector<int> frames = presented.get();
+	for (int i = 1; i < frames.size(); ++i)
+		EXPECT_LT(frames[i-1], frames[i]);
+
+	stage->flush();
+	EXPECT_EQ(0, stage->getPendingNum());
+	EXPECT_EQ(0, stage->getQueueSize());
+}
+
+TEST(TestDecodeStage, TestBurstIsPaced)
+{
+	boost::shared_ptr<StatisticsStorage> storage(StatisticsStorage::createConsumerStatistics());
+	Presented presented;
+	boost::shared_ptr<DecodeStage> stage = boost::make_shared<DecodeStage>(storage, presented.callback());
+	boost::shared_ptr<FakeDecoder> decoder = boost::make_shared<FakeDecoder>(60);
+
+	decoder->stage_ = stage.get();
+	stage->setDecoder(decoder);
+
+	// slow key frame, quick deltas: deltas are decoded in a burst right
+	// after the key frame, nothing is presented until the next tick
+	passFrame(*stage, 0, true);
+	boost::this_thread::sleep_for(boost::chrono::milliseconds(5));
+	decoder->decodeMs_ = 1;
+	for (int i = 1; i < 3; ++i)
+	{
+		passFrame(*stage, i, false);
+		boost::this_thread::sleep_for(boost::chrono::milliseconds(5));
+	}
+	boost::this_thread::sleep_for(boost::chrono::milliseconds(100));
+	EXPECT_EQ(0, presented.get().size());
+	EXPECT_EQ(3, stage->getQueueSize());
+
+	// next tick presents the newest frame only, following tick has nothing
+	// new to present
+	decoder->decodeMs_ = 100;
+	passFrame(*stage, 3, false);
+	EXPECT_EQ(std::vector<int>({2}), presented.get());
+	EXPECT_EQ(2, (*storage)[Indicator::DecodeDroppedNum]);
+	passFrame(*stage, 4, false);
+	EXPECT_EQ(std::vector<int>({2}), presented.get());
+}
+
+TEST(TestDecodeStage, TestFlush)
+{
+	boost::shared_ptr<StatisticsStorage> storage(StatisticsStorage::createConsumerStatistics());
+	Presented presented;
+	boost::shared_ptr<DecodeStage> stage = boost::make_shared<DecodeStage>(storage, presented.callback());
+	boost::shared_ptr<FakeDecoder> decoder = boost::make_shared<FakeDecoder>(1);
+
+	decoder->stage_ = stage.get();
+	stage->setDecoder(decoder);
+
+	// decoding starts from a key frame only
+	passFrame(*stage, 1, false);
+	EXPECT_EQ(1, (*storage)[Indicator::DecodeDroppedNum]);
+
+	passFrame(*stage, 2, true);
+	boost::this_thread::sleep_for(boost::chrono::milliseconds(20));
+	passFrame(*stage, 3, false);
+	boost::this_thread::sleep_for(boost::chrono::milliseconds(20));
+	EXPECT_EQ(2, decoder->nDecoded_);
+
+	// decoded frames are not presented after flush
+	stage->flush();
+	passFrame(*stage, 4, false);
+	passFrame(*stage, 5, true);
+	boost::this_thread::sleep_for(boost::chrono::milliseconds(20));
+	passFrame(*stage, 6, false);
+	boost::this_thread::sleep_for(boost::chrono::milliseconds(20));
+	passFrame(*stage, 7, false);
+
+	EXPECT_EQ(std::vector<int>({2, 5, 6}), presented.get());
+	EXPECT_EQ(2, (*storage)[Indicator::DecodeDroppedNum]);
+}
+
+TEST(TestDecodeStage, TestPresentNewest)
+{
+	boost::shared_ptr<StatisticsStorage> storage(StatisticsStorage::createConsumerStatistics());
+	Presented presented;
+	boost::shared_ptr<DecodeStage> stage = boost::make_shared<DecodeStage>(storage, presented.callback());
+	boost::shared_ptr<FakeDecoder> decoder = boost::make_shared<FakeDecoder>(1);
+
+	decoder->stage_ = stage.get();
+	decoder->nOutputs_ = 3;
+	stage->setDecoder(decoder);
+
+	passFrame(*stage, 1, true);
+	boost::this_thread::sleep_for(boost::chrono::milliseconds(20));
+	EXPECT_EQ(3, stage->getQueueSize());
+
+	// older due frames are superseded by the newest due one (101), frame
+	// that is not due yet (201) stays in the queue
+	decoder->decodeMs_ = 100;
+	passFrame(*stage, 150, false);
+	EXPECT_EQ(std::vector<int>({101}), presented.get());
+	EXPECT_EQ(1, (*storage)[Indicator::DecodeDroppedNum]);
+	EXPECT_EQ(1, stage->getQueueSize());
+}
+
+TEST(TestDecodeStage, TestDestroyWhileDecoding)
+{
+	boost::shared_ptr<StatisticsStorage> storage(StatisticsStorage::createConsumerStatistics());
+	Presented presented;
+	boost::shared_ptr<FakeDecoder> decoder = boost::make_shared<FakeDecoder>(600);
+	{
+		boost::shared_ptr<DecodeStage> stage = boost::make_shared<DecodeStage>(storage, presented.callback(), true);
+
+		decoder->stage_ = stage.get();
+		stage->setDecoder(decoder);
+		passFrame(*stage, 1, true);
+		boost::this_thread::sleep_for(boost::chrono::milliseconds(10));
+	}
+
+	// stage waited for decoder to return
+	EXPECT_EQ(1, decoder->nDecoded_);
+	EXPECT_EQ(1, presented.get().size());
+}
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,105 @@
+//
+// test-digest-engine.cc
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "gtest/gtest.h"
+#include "src/digest-engine.hpp"
+
+using namespace ndnrtc;
+
+namespace {
+	std::string toHex(const DigestEngine::Digest& d)
+	{
+		static const char *hex = "0123456789abcdef";
+		std::string s;
+		for (auto b:d) { s += hex[b >> 4]; s += hex[b & 0xf]; }
+		return s;
+	}
+
+	const DigestEngine::Implementation All[] = {
+		DigestEngine::Implementation::Scalar,
+		DigestEngine::Implementation::MultiBuffer,
+		DigestEngine::Implementation::ShaExtensions
+	};
+}
+
+TEST(TestDigestEngine, TestKnownDigests)
+{
+	std::string abc = "abc";
+	std::string twoBlocks = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+	std::vector<DigestEngine::Buffer> buffers;
+
+	buffers.push_back(DigestEngine::Buffer({(const uint8_t*)abc.data(), abc.size()}));
+	buffers.push_back(DigestEngine::Buffer({(const uint8_t*)"", 0}));
+	buffers.push_back(DigestEngine::Buffer({(const uint8_t*)twoBlocks.data(), twoBlocks.size()}));
+
+	for (auto impl:All)
+	{
+		std::vector<DigestEngine::Digest> digests;
+		DigestEngine::sha256(buffers, digests, impl);
+
+		ASSERT_EQ(3, digests.size());
+		EXPECT_EQ("ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad", toHex(digests[0]));
+		EXPECT_EQ("e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855", toHex(digests[1]));
+		EXPECT_EQ("248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1", toHex(digests[2]));
+	}
+
+	EXPECT_EQ("ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad",
+		toHex(DigestEngine::sha256((const uint8_t*)abc.data(), abc.size())));
+}
+
+TEST(TestDigestEngine, TestImplementationsMatch)
+{
+	// lengths around padding boundaries and typical segment sizes, mixed
+	// in one batch so that multi-buffer lanes finish at different blocks
+	size_t lengths[] = {0, 1, 55, 56, 63, 64, 65, 119, 120, 128, 1000, 8000, 8800, 3, 200, 4096, 7999};
+	std::vector<std::vector<uint8_t>> data;
+	std::vector<DigestEngine::Buffer> buffers;
+
+	for (auto l:lengths)
+	{
+		std::vector<uint8_t> d(l);
+		for (auto &b:d) b = (uint8_t)rand();
+		data.push_back(d);
+	}
+	for (auto &d:data)
+		buffers.push_back(DigestEngine::Buffer({d.data(), d.size()}));
+
+	std::vector<DigestEngine::Digest> reference;
+	DigestEngine::sha256(buffers, reference, DigestEngine::Implementation::Scalar);
+
+	for (auto impl:All)
+	{
+		std::vector<DigestEngine::Digest> digests;
+		DigestEngine::sha256(buffers, digests, impl);
+
+		ASSERT_EQ(reference.size(), digests.size());
+		for (size_t i = 0; i < digests.size(); ++i)
+			EXPECT_EQ(toHex(reference[i]), toHex(digests[i])) << "length " << lengths[i];
+
+		// batch of any size gives the same result
+		for (size_t n = 1; n <= DigestEngine::MultiBufferLanes+1; ++n)
+		{
+			std::vector<DigestEngine::Buffer> batch(buffers.begin(), buffers.begin()+n);
+			DigestEngine::sha256(batch, digests, impl);
+			ASSERT_EQ(n, digests.size());
+			for (size_t i = 0; i < n; ++i)
+				EXPECT_EQ(toHex(reference[i]), toHex(digests[i]));
+		}
+	}
+
+	std::vector<DigestEngine::Digest> digests;
+	DigestEngine::sha256(std::vector<DigestEngine::Buffer>(), digests);
+	EXPECT_EQ(0, digests.size());
+}
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,140 @@
+//
+// test-encoder-resource-manager.cc
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#include <stdlib.h>
+#include <numeric>
+
+#include "gtest/gtest.h"
+#include "src/encoder-resource-manager.hpp"
+
+using namespace ndnrtc;
+
+namespace {
+	class FakeEncoder : public IEncoderResourceClient
+	{
+	public:
+		FakeEncoder():nCores_(0), nCalls_(0){}
+
+		void onCoresAllocated(unsigned int nCores) { nCores_ = nCores; nCalls_++; }
+		double getEncodeTimeMs() const { return 5; }
+
+		unsigned int nCores_, nCalls_;
+	};
+
+	VideoCoderParams makeParams(unsigned int w, unsigned int h, unsigned int bitrate)
+	{
+		VideoCoderParams p;
+		p.encodeWidth_ = w;
+		p.encodeHeight_ = h;
+		p.startBitrate_ = bitrate;
+		p.maxBitrate_ = bitrate;
+		return p;
+	}
+}
+
+TEST(TestEncoderResourceManager, TestAllocate)
+{
+	{ // proportional split
+		std::vector<unsigned int> cores = EncoderResourceManager::allocate(8, {3, 1});
+		EXPECT_EQ(6, cores[0]);
+		EXPECT_EQ(2, cores[1]);
+	}
+	{ // budget is never exceeded, rounding leftovers are not lost
+		std::vector<unsigned int> cores = EncoderResourceManager::allocate(8, {10, 5, 1});
+		EXPECT_EQ(8, std::accumulate(cores.begin(), cores.end(), 0u));
+		EXPECT_GE(cores[0], cores[1]);
+		EXPECT_GE(cores[1], cores[2]);
+		EXPECT_LE(1, cores[2]);
+	}
+	{ // at least one core per encoder
+		std::vector<unsigned int> cores = EncoderResourceManager::allocate(2, {10, 5, 1});
+		for (auto c:cores) EXPECT_EQ(1, c);
+	}
+	{ // zero weights are split equally
+		std::vector<unsigned int> cores = EncoderResourceManager::allocate(4, {0, 0});
+		EXPECT_EQ(2, cores[0]);
+		EXPECT_EQ(2, cores[1]);
+	}
+	EXPECT_EQ(0, EncoderResourceManager::allocate(4, {}).size());
+}
+
+TEST(TestEncoderResourceManager, TestWeight)
+{
+	EXPECT_LT(EncoderResourceManager::getWeight(makeParams(320, 180, 100)),
+		EncoderResourceManager::getWeight(makeParams(640, 360, 300)));
+	EXPECT_LT(EncoderResourceManager::getWeight(makeParams(640, 360, 300)),
+		EncoderResourceManager::getWeight(makeParams(1280, 720, 1200)));
+	EXPECT_LT(EncoderResourceManager::getWeight(makeParams(640, 360, 300)),
+		EncoderResourceManager::getWeight(makeParams(640, 360, 1000)));
+
+	// pixel rate and bitrate are normalized, so both contribute equally
+	VideoCoderParams reference = makeParams(1280, 720, 2000);
+	reference.codecFrameRate_ = 30;
+	EXPECT_DOUBLE_EQ(2., EncoderResourceManager::getWeight(reference));
+
+	VideoCoderParams doublePixels = reference;
+	doublePixels.codecFrameRate_ = 60;
+	VideoCoderParams doubleBitrate = makeParams(1280, 720, 4000);
+	doubleBitrate.codecFrameRate_ = 30;
+	EXPECT_DOUBLE_EQ(3., EncoderResourceManager::getWeight(doublePixels));
+	EXPECT_DOUBLE_EQ(EncoderResourceManager::getWeight(doublePixels),
+		EncoderResourceManager::getWeight(doubleBitrate));
+}
+
+TEST(TestEncoderResourceManager, TestRebalance)
+{
+	EncoderResourceManager *manager = EncoderResourceManager::getSharedInstance();
+	FakeEncoder hi, mid, low;
+
+	manager->setCoreBudget(8);
+	EXPECT_EQ(8, manager->addEncoder(&hi, makeParams(1280, 720, 1200)));
+	EXPECT_EQ(8, hi.nCores_);
+
+	// adding encoders takes cores from existing ones
+	unsigned int midCores = manager->addEncoder(&mid, makeParams(640, 360, 300));
+	unsigned int lowCores = manager->addEncoder(&low, makeParams(320, 180, 100));
+	EXPECT_EQ(midCores, mid.nCores_);
+	EXPECT_EQ(lowCores, low.nCores_);
+	EXPECT_EQ(8, hi.nCores_ + mid.nCores_ + low.nCores_);
+	EXPECT_GT(hi.nCores_, mid.nCores_);
+	EXPECT_GE(mid.nCores_, low.nCores_);
+	EXPECT_EQ(hi.nCores_, manager->getCores(&hi));
+
+	std::vector<EncoderResourceManager::EncoderInfo> encoders = manager->getEncoders();
+	ASSERT_EQ(3, encoders.size());
+	for (auto &e:encoders)
+	{
+		EXPECT_EQ(5, e.encodeTimeMs_);
+		EXPECT_FALSE(e.description_.empty());
+	}
+
+	// removing encoder gives cores back
+	manager->removeEncoder(&hi);
+	EXPECT_EQ(0, manager->getCores(&hi));
+	EXPECT_EQ(8, mid.nCores_ + low.nCores_);
+
+	// budget change is propagated
+	unsigned int nCalls = low.nCalls_;
+	manager->setCoreBudget(2);
+	EXPECT_EQ(1, mid.nCores_);
+	EXPECT_EQ(1, low.nCores_);
+	EXPECT_LT(nCalls, low.nCalls_);
+
+	// clients are not notified when allocation does not change
+	nCalls = low.nCalls_;
+	manager->setCoreBudget(2);
+	EXPECT_EQ(nCalls, low.nCalls_);
+
+	manager->removeEncoder(&mid);
+	manager->removeEncoder(&low);
+	EXPECT_EQ(0, manager->getEncoders().size());
+}
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -8,6 +8,7 @@
 #include <stdlib.h>
 #include <algorithm>
 #include <ctime>
+#include <set>
 
 #include <ndn-cpp/interest.hpp>
 #include <ndn-cpp/name.hpp>
@@ -511,6 +512,54 @@ TEST(TestBufferSlot, TestReuseSlot)
 	}
 }
 
+TEST(TestBufferSlot, TestRecycleSegments)
+{
+	BufferSlot slot;
+	std::string frameName = "/ndn/edu/ucla/remap/peter/ndncon/instance1/ndnrtc/%FD%03/audio/mic/%FC%00%00%01c_%27%DE%D6/hd/%FE%07";
+	VideoFramePacket vp = getVideoFramePacket();
+	std::vector<VideoFrameSegment> segments = sliceFrame(vp);
+	std::vector<boost::shared_ptr<ndn::Data>> dataObjects = dataFromSegments(frameName, segments);
+	std::vector<boost::shared_ptr<Interest>> interests = getInterests(frameName, 0, dataObjects.size());
+	std::set<const SlotSegment*> allocated;
+	boost::shared_ptr<const SlotSegment> held;
+
+	ASSERT_LT(1, dataObjects.size());
+
+	for (int i = 0; i < 2; ++i)
+	{
+		slot.segmentsRequested(makeInterestsConst(interests));
+		for (int idx = 0; idx < dataObjects.size(); ++idx)
+			slot.segmentReceived(boost::make_shared<WireSegment>(dataObjects[idx], interests[idx]));
+
+		ASSERT_EQ(BufferSlot::Ready, slot.getState());
+		ASSERT_EQ(dataObjects.size(), slot.getFetchedSegments().size());
+
+		if (i == 0)
+		{
+			for (auto& s:slot.getFetchedSegments())
+				allocated.insert(s.get());
+			// segment referenced outside of the slot must not be re-used
+			held = slot.getFetchedSegments().front();
+		}
+		else
+		{
+			int nReused = 0;
+			for (auto& s:slot.getFetchedSegments())
+			{
+				EXPECT_NE(held.get(), s.get());
+				if (allocated.find(s.get()) != allocated.end())
+					nReused++;
+			}
+			EXPECT_EQ(dataObjects.size()-1, nReused);
+		}
+
+		slot.clear();
+	}
+
+	EXPECT_TRUE(held->isFetched());
+	EXPECT_EQ(interests[0]->getName(), held->getInterest()->getName());
+}
+
 TEST(TestVideoFrameSlot, TestAsembleVideoFrame)
 {
 	std::string frameName = "/ndn/edu/ucla/remap/peter/ndncon/instance1/ndnrtc/%FD%03/video/camera/%FC%00%00%01c_%27%DE%D6/hi/d/%FE%07";
@@ -692,6 +741,104 @@ TEST(TestVideoFrameSlot, TestAssembleVideoFrameRecover2)
 	EXPECT_TRUE(videoPacket.get());
 }
 
+TEST(TestVideoFrameSlot, TestAssembleVideoFrameV2)
+{
+	std::string frameName = "/ndn/edu/ucla/remap/peter/ndncon/instance1/ndnrtc/%FD%04/video/camera/%FC%00%00%01c_%27%DE%D6/hi/d/%FE%07";
+	VideoFramePacket vp = getVideoFramePacket(10000);
+	size_t reserve = VideoFrameSegment::packetHeaderReserve(WireFormat::V2);
+	size_t symbolSize = VideoFrameSegment::slicePayloadLength(1000, reserve);
+
+	boost::shared_ptr<NetworkData> parity = vp.getParityData(symbolSize, 0.2);
+	std::vector<VideoFrameSegment> segments = VideoFrameSegment::slice(vp, 1000, reserve);
+	std::vector<VideoFrameSegment> paritySegments = VideoFrameSegment::slice(*parity, 1000, reserve);
+
+	ASSERT_LT(2, segments.size());
+	ASSERT_LT(1, paritySegments.size());
+	for (auto &s:paritySegments)
+		EXPECT_EQ(symbolSize, s.getPayload().size());
+
+	VideoFrameSegmentHeader header;
+	header.totalSegmentsNum_ = segments.size();
+	header.paritySegmentsNum_ = paritySegments.size();
+	header.playbackNo_ = 734;
+	header.pairedSequenceNo_ = 1249;
+
+	std::vector<boost::shared_ptr<ndn::Data>> dataObjects, parityObjects;
+	for (int idx = 0; idx < segments.size(); ++idx)
+	{
+		// only segment 0 carries packet header, but all have equal payload
+		if (idx < segments.size()-1)
+			EXPECT_EQ(symbolSize, segments[idx].getPayload().size());
+
+		segments[idx].setHeader(header);
+		boost::shared_ptr<NetworkData> nd = segments[idx].getNetworkData(WireFormat::V2, (idx == 0 ? &vp.getHeader() : nullptr));
+		EXPECT_GE(1000, nd->getLength());
+
+		ndn::Name n(frameName);
+		n.appendSegment(idx);
+		boost::shared_ptr<ndn::Data> ds(boost::make_shared<ndn::Data>(n));
+		ds->getMetaInfo().setFinalBlockId(ndn::Name::Component::fromSegment(segments.size() - 1));
+		ds->setContent(nd->getData(), nd->getLength());
+		dataObjects.push_back(ds);
+	}
+
+	for (int idx = 0; idx < paritySegments.size(); ++idx)
+	{
+		paritySegments[idx].setHeader(header);
+		boost::shared_ptr<NetworkData> nd = paritySegments[idx].getNetworkData(WireFormat::V2);
+
+		ndn::Name n(frameName);
+		n.append(NameComponents::NameComponentParity).appendSegment(idx);
+		boost::shared_ptr<ndn::Data> ds(boost::make_shared<ndn::Data>(n));
+		ds->getMetaInfo().setFinalBlockId(ndn::Name::Component::fromSegment(paritySegments.size() - 1));
+		ds->setContent(nd->getData(), nd->getLength());
+		parityObjects.push_back(ds);
+	}
+
+	// all segments arrive; then a segment in the middle and the last one
+	// are lost and recovered from parity
+	for (auto lost : {std::vector<int>(), std::vector<int>({1, (int)segments.size()-1})})
+	{
+		std::vector<boost::shared_ptr<Interest>> interests = getInterests(frameName, 0, dataObjects.size(), 0, parityObjects.size());
+		std::vector<boost::shared_ptr<Interest>> parityInterests(interests.end()-parityObjects.size(), interests.end());
+		BufferSlot slot;
+
+		slot.segmentsRequested(makeInterestsConst(interests));
+
+		for (int idx = 0; idx < dataObjects.size(); ++idx)
+		{
+			if (std::find(lost.begin(), lost.end(), idx) != lost.end())
+				continue;
+
+			boost::shared_ptr<WireData<VideoFrameSegmentHeader>> wd(
+				boost::make_shared<WireData<VideoFrameSegmentHeader>>(dataObjects[idx], interests[idx]));
+			ASSERT_TRUE(wd->isValid());
+			ASSERT_EQ(WireFormat::V2, wd->getWireFormat());
+			ASSERT_NO_THROW(slot.segmentReceived(wd));
+		}
+
+		if (lost.size())
+			for (int idx = 0; idx < parityObjects.size(); ++idx)
+			{
+				boost::shared_ptr<WireData<VideoFrameSegmentHeader>> wd(
+					boost::make_shared<WireData<VideoFrameSegmentHeader>>(parityObjects[idx], parityInterests[idx]));
+				ASSERT_TRUE(wd->isValid());
+				ASSERT_NO_THROW(slot.segmentReceived(wd));
+			}
+
+		VideoFrameSlot videoSlot;
+		bool recovered = false;
+		boost::shared_ptr<ImmutableVideoFramePacket> videoPacket = videoSlot.readPacket(slot, recovered);
+
+		ASSERT_TRUE(videoPacket.get());
+		EXPECT_EQ(lost.size() > 0, recovered);
+		ASSERT_LE(vp.getLength(), videoPacket->getLength());
+		EXPECT_TRUE(std::equal(vp.getData(), vp.getData() + vp.getLength(), videoPacket->getData()));
+		EXPECT_TRUE(checkVideoFrame(videoPacket->getFrame()));
+		EXPECT_EQ(vp.getHeader().publishTimestampMs_, videoPacket->getHeader().publishTimestampMs_);
+	}
+}
+
 TEST(TestAudioBundleSlot, TestAssembleAudioBundle)
 {
     int data_len = 247;
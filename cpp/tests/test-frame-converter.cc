@@ -6,6 +6,8 @@
 //
 
 #include <stdlib.h>
+#include <string.h>
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "frame-converter.hpp"
@@ -42,6 +44,84 @@ TEST(TestFrameConverter, TestI420Frame)
 	EXPECT_EQ(h, frame.height());
 }
 
+TEST(TestFrameConverter, TestI420Strides)
+{
+	// source planes are padded, converted frame has tight strides
+	unsigned int w = 16, h = 8, strideY = 32, strideUV = 16;
+	std::vector<uint8_t> ybuf(strideY*h, 0xff), ubuf(strideUV*h/2, 0xff), vbuf(strideUV*h/2, 0xff);
+
+	for (unsigned int row = 0; row < h; ++row) memset(ybuf.data() + row*strideY, 0x10, w);
+	for (unsigned int row = 0; row < h/2; ++row)
+	{
+		memset(ubuf.data() + row*strideUV, 0x20, w/2);
+		memset(vbuf.data() + row*strideUV, 0x30, w/2);
+	}
+
+	RawFrameConverter conv;
+	WebRtcVideoFrame frame = conv << I420RawFrameWrapper({w, h, strideY, strideUV, strideUV,
+		ybuf.data(), ubuf.data(), vbuf.data()});
+	rtc::scoped_refptr<webrtc::VideoFrameBuffer> b = frame.video_frame_buffer();
+
+	for (unsigned int row = 0; row < h; ++row)
+		for (unsigned int col = 0; col < w; ++col)
+			ASSERT_EQ(0x10, b->DataY()[row*b->StrideY()+col]);
+	for (unsigned int row = 0; row < h/2; ++row)
+		for (unsigned int col = 0; col < w/2; ++col)
+		{
+			ASSERT_EQ(0x20, b->DataU()[row*b->StrideU()+col]);
+			ASSERT_EQ(0x30, b->DataV()[row*b->StrideV()+col]);
+		}
+}
+
+TEST(TestFrameConverter, TestBufferReuse)
+{
+	unsigned int w = 640, h = 480, size = w*h*4;
+	std::vector<uint8_t> data(size);
+	const webrtc::VideoFrameBuffer *released = nullptr, *reused = nullptr, *fresh = nullptr;
+	RawFrameConverter conv;
+
+	{
+		WebRtcVideoFrame frame = conv << ArgbRawFrameWrapper({w,h,data.data(),size});
+		released = frame.video_frame_buffer().get();
+	}
+	// buffer from the previous frame is still held by the converter
+	WebRtcVideoFrame held = conv << ArgbRawFrameWrapper({w,h,data.data(),size});
+	fresh = held.video_frame_buffer().get();
+	EXPECT_NE(released, fresh);
+
+	{
+		WebRtcVideoFrame frame = conv << ArgbRawFrameWrapper({w,h,data.data(),size});
+		reused = frame.video_frame_buffer().get();
+	}
+	EXPECT_EQ(released, reused);
+}
+
+TEST(TestFrameConverter, TestWrapI420)
+{
+	unsigned int w = 16, h = 8, strideY = 16, strideUV = 8;
+	std::vector<uint8_t> ybuf(strideY*h), ubuf(strideUV*h/2), vbuf(strideUV*h/2);
+	int nReleased = 0;
+	RawFrameConverter conv;
+
+	{
+		WebRtcVideoFrame frame = conv.wrap(I420RawFrameWrapper({w, h, strideY, strideUV, strideUV,
+			ybuf.data(), ubuf.data(), vbuf.data()}), [&nReleased](){ nReleased++; });
+
+		// planes are not copied
+		EXPECT_EQ(w, frame.width());
+		EXPECT_EQ(h, frame.height());
+		EXPECT_EQ(ybuf.data(), frame.video_frame_buffer()->DataY());
+		EXPECT_EQ(ubuf.data(), frame.video_frame_buffer()->DataU());
+		EXPECT_EQ(vbuf.data(), frame.video_frame_buffer()->DataV());
+
+		// copies of the frame share the buffer
+		WebRtcVideoFrame copy = frame;
+		EXPECT_EQ(0, nReleased);
+	}
+
+	EXPECT_EQ(1, nReleased);
+}
+
 int main(int argc, char **argv) {
 	::testing::InitGoogleTest(&argc, argv);
 	return RUN_ALL_TESTS();
@@ -10,6 +10,7 @@
 #include "tests/tests-helpers.hpp"
 #include "gtest/gtest.h"
 #include "client/src/frame-io.hpp"
+#include "client/src/shm-ring.h"
 
 #ifdef HAVE_NANOMSG
 #include "client/src/ipc-shim.h"
@@ -229,6 +230,191 @@ TEST(TestPipeSink, TestWriteAndRead)
 	remove(fname.c_str());
 }
 
+TEST(TestSharedMemorySink, TestWriteAndRead)
+{
+	std::string name = "test-shm-sink.640x480";
+	SharedMemorySink sink(name);
+	ArgbFrame frame(640, 480);
+	uint8_t *b = frame.getBuffer().get();
+
+	for (int i = 0; i < frame.getFrameSizeInBytes(); ++i)
+		b[i] = (i%256);
+	frame.setFrameInfo({1234, 7, "/test/frame", true});
+	sink.setWriteFrameInfo(true);
+
+	// ring does not exist until first frame
+	EXPECT_EQ(nullptr, shmr_open(name.c_str()));
+
+	EXPECT_NO_THROW(sink << frame);
+	EXPECT_TRUE(sink.isLastWriteSuccessful());
+
+	shmr_ring *ring = shmr_open(name.c_str());
+	ASSERT_NE(nullptr, ring);
+	EXPECT_EQ(1, shmr_writeCount(ring));
+
+	uint64_t next = 0;
+	shmr_frame f;
+	ASSERT_EQ(SHMR_OK, shmr_nextFrame(ring, &next, 0, &f));
+	EXPECT_EQ(1, next);
+	EXPECT_EQ(640, f.info_->width_);
+	EXPECT_EQ(480, f.info_->height_);
+	EXPECT_EQ(7, f.info_->playbackNo_);
+	EXPECT_EQ(1234, f.info_->timestamp_);
+	EXPECT_EQ(std::string("/test/frame"), std::string(f.info_->ndnName_));
+	EXPECT_EQ(frame.getFrameSizeInBytes(), f.info_->dataSize_);
+	EXPECT_EQ(0, memcmp(b, f.data_, frame.getFrameSizeInBytes()));
+	EXPECT_EQ(SHMR_OK, shmr_releaseFrame(ring, &f));
+
+	EXPECT_EQ(SHMR_TIMEOUT, shmr_nextFrame(ring, &next, 10, &f));
+	shmr_close(ring);
+}
+
+TEST(TestSharedMemorySink, TestOverwrite)
+{
+	std::string name = "test-shm-overwrite";
+	shmr_ring *writer = shmr_create(name.c_str(), 4, 16);
+	ASSERT_NE(nullptr, writer);
+
+	shmr_ring *reader = shmr_open(name.c_str());
+	ASSERT_NE(nullptr, reader);
+
+	shmr_slot_header info;
+	memset(&info, 0, sizeof(info));
+	uint8_t data[16];
+
+	info.playbackNo_ = 0;
+	ASSERT_EQ(SHMR_OK, shmr_write(writer, &info, data, sizeof(data)));
+
+	uint64_t next = 0;
+	shmr_frame f;
+	ASSERT_EQ(SHMR_OK, shmr_nextFrame(reader, &next, 0, &f));
+	EXPECT_EQ(0, f.info_->playbackNo_);
+
+	// writer wraps around while reader holds the frame
+	for (int i = 1; i <= 10; ++i)
+	{
+		info.playbackNo_ = i;
+		ASSERT_EQ(SHMR_OK, shmr_write(writer, &info, data, sizeof(data)));
+	}
+	EXPECT_EQ(SHMR_OVERWRITTEN, shmr_releaseFrame(reader, &f));
+	EXPECT_EQ(SHMR_OVERWRITTEN, shmr_acquireFrame(reader, 1, &f));
+
+	// lagging reader skips to the latest frame
+	ASSERT_EQ(SHMR_OK, shmr_nextFrame(reader, &next, 0, &f));
+	EXPECT_EQ(10, f.info_->playbackNo_);
+	EXPECT_EQ(11, next);
+
+	// too big frame
+	uint8_t bigData[32];
+	EXPECT_EQ(SHMR_ERROR, shmr_write(writer, &info, bigData, sizeof(bigData)));
+
+	shmr_close(reader);
+	shmr_destroy(writer);
+	EXPECT_EQ(nullptr, shmr_open(name.c_str()));
+}
+
+TEST(TestSharedMemorySink, TestSource)
+{
+	std::string name = "test-shm-source.320x240";
+	SharedMemorySink sink(name);
+	ArgbFrame frame(320, 240);
+	uint8_t *b = frame.getBuffer().get();
+
+	for (int i = 0; i < frame.getFrameSizeInBytes(); ++i)
+		b[i] = (i%256);
+
+	sink << frame;
+	SharedMemoryFrameSource source(name, 100);
+	int nFrames = 30;
+
+	boost::thread t([&sink, &frame, nFrames]{
+		for (int i = 1; i <= nFrames; ++i)
+		{
+			frame.setFrameInfo({0, i, "", false});
+			sink << frame;
+			boost::this_thread::sleep_for(boost::chrono::milliseconds(5));
+		}
+	});
+
+	ArgbFrame readFrame(320, 240);
+	int lastPlaybackNo = -1;
+	do {
+		source >> readFrame;
+		ASSERT_FALSE(source.isError());
+		EXPECT_LT(lastPlaybackNo, readFrame.getFrameInfo().playbackNo_);
+		lastPlaybackNo = readFrame.getFrameInfo().playbackNo_;
+	} while (lastPlaybackNo < nFrames);
+
+	EXPECT_EQ(0, memcmp(b, readFrame.getBuffer().get(), readFrame.getFrameSizeInBytes()));
+	t.join();
+}
+
+TEST(TestSharedMemorySink, TestRecreate)
+{
+	std::string name = "test-shm-recreate";
+	SharedMemorySink sink(name);
+	ArgbFrame small(320, 240), big(640, 480);
+
+	small.setFrameInfo({0, 1, "", false});
+	sink << small;
+
+	shmr_ring *ring = shmr_open(name.c_str());
+	ASSERT_NE(nullptr, ring);
+	EXPECT_EQ(1, shmr_generation(ring));
+
+	// bigger frame re-creates the ring, reader of the old ring is notified
+	// after it has read all frames from it
+	big.setFrameInfo({0, 2, "", false});
+	sink << big;
+	EXPECT_TRUE(sink.isLastWriteSuccessful());
+
+	uint64_t next = 0;
+	shmr_frame f;
+	ASSERT_EQ(SHMR_OK, shmr_nextFrame(ring, &next, 0, &f));
+	EXPECT_EQ(1, f.info_->playbackNo_);
+	EXPECT_EQ(SHMR_CLOSED, shmr_nextFrame(ring, &next, 100, &f));
+	shmr_close(ring);
+
+	ring = shmr_open(name.c_str());
+	ASSERT_NE(nullptr, ring);
+	EXPECT_EQ(2, shmr_generation(ring));
+	next = 0;
+	ASSERT_EQ(SHMR_OK, shmr_nextFrame(ring, &next, 0, &f));
+	EXPECT_EQ(2, f.info_->playbackNo_);
+	EXPECT_EQ(big.getFrameSizeInBytes(), f.info_->dataSize_);
+	shmr_close(ring);
+}
+
+TEST(TestSharedMemorySink, TestSourceFrameSize)
+{
+	std::string name = "test-shm-source-size";
+	SharedMemorySink sink(name);
+	ArgbFrame small(320, 240), big(640, 480);
+	ArgbFrame readFrame(320, 240);
+	SharedMemoryFrameSource source(name, 100);
+
+	small.setFrameInfo({0, 1, "", false});
+	sink << small;
+	source >> readFrame;
+	ASSERT_FALSE(source.isError());
+	EXPECT_EQ(1, readFrame.getFrameInfo().playbackNo_);
+
+	// source follows the sink to the new ring, but frame that does not fit
+	// is rejected
+	big.setFrameInfo({0, 2, "", false});
+	sink << big;
+	source >> readFrame;
+	EXPECT_TRUE(source.isError());
+	EXPECT_NE(std::string::npos, source.getErrorMsg().find("does not fit"));
+	EXPECT_EQ(1, readFrame.getFrameInfo().playbackNo_);
+
+	small.setFrameInfo({0, 3, "", false});
+	sink << small;
+	source >> readFrame;
+	ASSERT_FALSE(source.isError());
+	EXPECT_EQ(3, readFrame.getFrameInfo().playbackNo_);
+}
+
 #ifdef HAVE_NANOMSG
 // TEST(TestNanoSink, TestWriteAndRead)
 // {
@@ -0,0 +1,187 @@
+//
+// test-frame-trace.cc
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#include <stdlib.h>
+#include <sstream>
+
+#include <boost/thread.hpp>
+
+#include "gtest/gtest.h"
+#include "include/frame-trace.hpp"
+
+using namespace ndnrtc::trace;
+
+namespace {
+	size_t countOccurrences(const std::string& str, const std::string& sub)
+	{
+		size_t n = 0;
+		for (size_t pos = str.find(sub); pos != std::string::npos; pos = str.find(sub, pos+sub.size()))
+			++n;
+		return n;
+	}
+}
+
+TEST(TestFrameTrace, TestDisabled)
+{
+	FrameTracer& tracer = FrameTracer::getSharedInstance();
+	tracer.disable();
+	tracer.clear();
+
+	{
+		FrameTraceScope(Encode, 1);
+		FrameTraceInstant(Assembled, 1);
+	}
+
+	std::stringstream ss;
+	tracer.writeChromeTrace(ss);
+
+	EXPECT_EQ(0, countOccurrences(ss.str(), "\"ph\""));
+}
+
+TEST(TestFrameTrace, TestEvents)
+{
+	FrameTracer& tracer = FrameTracer::getSharedInstance();
+	tracer.enable();
+	tracer.clear();
+
+	{
+		FrameTraceScope(Encode, 7);
+		boost::this_thread::sleep_for(boost::chrono::milliseconds(2));
+	}
+	FrameTraceInstant(SegmentReceived, 7);
+
+	std::stringstream ss;
+	tracer.writeChromeTrace(ss);
+	std::string trace = ss.str();
+
+	EXPECT_EQ(1, countOccurrences(trace, "\"name\":\"encode\""));
+	EXPECT_EQ(1, countOccurrences(trace, "\"name\":\"segment\""));
+	EXPECT_EQ(1, countOccurrences(trace, "\"ph\":\"X\""));
+	EXPECT_EQ(1, countOccurrences(trace, "\"ph\":\"i\""));
+	// flow start and finish
+	EXPECT_EQ(1, countOccurrences(trace, "\"ph\":\"s\""));
+	EXPECT_EQ(1, countOccurrences(trace, "\"ph\":\"f\""));
+	EXPECT_EQ(2, countOccurrences(trace, "\"id\":7"));
+
+	tracer.disable();
+}
+
+TEST(TestFrameTrace, TestCurrentFlow)
+{
+	FrameTracer& tracer = FrameTracer::getSharedInstance();
+	tracer.enable();
+	tracer.clear();
+
+	EXPECT_EQ(-1, tracer.getCurrentFlow());
+	{
+		FrameTraceFlow(42);
+		EXPECT_EQ(42, tracer.getCurrentFlow());
+		{
+			FrameTraceFlow(43);
+			EXPECT_EQ(43, tracer.getCurrentFlow());
+			FrameTraceStep(Sign);
+		}
+		EXPECT_EQ(42, tracer.getCurrentFlow());
+		FrameTraceStep(Cache);
+	}
+	EXPECT_EQ(-1, tracer.getCurrentFlow());
+
+	std::stringstream ss;
+	tracer.writeChromeTrace(ss);
+	std::string trace = ss.str();
+
+	EXPECT_EQ(1, countOccurrences(trace, "\"args\":{\"frame\":42}"));
+	EXPECT_EQ(1, countOccurrences(trace, "\"args\":{\"frame\":43}"));
+
+	tracer.disable();
+}
+
+TEST(TestFrameTrace, TestMultipleThreads)
+{
+	FrameTracer& tracer = FrameTracer::getSharedInstance();
+	tracer.enable();
+	tracer.clear();
+
+	int nThreads = 4, nFrames = 100;
+	std::vector<boost::shared_ptr<boost::thread>> threads;
+
+	for (int t = 0; t < nThreads; ++t)
+		threads.push_back(boost::make_shared<boost::thread>([nFrames, t](){
+			for (int i = 0; i < nFrames; ++i)
+			{
+				FrameTraceScope(Decode, t*nFrames+i);
+			}
+		}));
+
+	for (auto& t:threads) t->join();
+
+	std::stringstream ss;
+	tracer.writeChromeTrace(ss);
+
+	EXPECT_EQ(nThreads*nFrames, countOccurrences(ss.str(), "\"name\":\"decode\""));
+
+	tracer.disable();
+}
+
+TEST(TestFrameTrace, TestRingOverwrite)
+{
+	TraceRing ring(10, 0);
+
+	for (int i = 0; i < 25; ++i)
+		ring.push(TraceEvent({i, -1, i, Stage::Capture}));
+
+	std::vector<TraceEvent> events = ring.snapshot();
+
+	ASSERT_EQ(10, events.size());
+	EXPECT_EQ(15, events.front().flowId_);
+	EXPECT_EQ(24, events.back().flowId_);
+
+	ring.clear();
+	EXPECT_EQ(0, ring.snapshot().size());
+
+	ring.push(TraceEvent({25, -1, 25, Stage::Capture}));
+	events = ring.snapshot();
+	ASSERT_EQ(1, events.size());
+	EXPECT_EQ(25, events.front().flowId_);
+}
+
+TEST(TestFrameTrace, TestConcurrentSnapshot)
+{
+	TraceRing ring(64, 0);
+	boost::atomic<bool> done(false);
+
+	// every event carries its sequence number twice, torn reads would
+	// show up as mismatch or out-of-order sequence
+	boost::thread writer([&ring, &done](){
+		for (int64_t i = 0; i < 2000000; ++i)
+			ring.push(TraceEvent({i, i, i, Stage::Capture}));
+		done = true;
+	});
+
+	int nSnapshots = 0;
+	while (!done)
+	{
+		std::vector<TraceEvent> events = ring.snapshot();
+		for (size_t i = 0; i < events.size(); ++i)
+		{
+			EXPECT_EQ(events[i].timestampUsec_, events[i].flowId_);
+			EXPECT_EQ(events[i].durationUsec_, events[i].flowId_);
+			if (i) EXPECT_EQ(events[i-1].flowId_+1, events[i].flowId_);
+		}
+		if (++nSnapshots % 10 == 0) ring.clear();
+	}
+
+	writer.join();
+	EXPECT_LT(0, nSnapshots);
+}
+
+//******************************************************************************
+int main(int argc, char **argv)
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,161 @@
+// 
+// test-histogram.cc
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#include <stdlib.h>
+
+#include <boost/thread.hpp>
+#include <boost/make_shared.hpp>
+
+#include "gtest/gtest.h"
+#include "include/histogram.hpp"
+#include "include/statistics.hpp"
+
+using namespace ndnrtc::statistics;
+
+TEST(TestHistogram, TestEmpty)
+{
+	Histogram h;
+
+	EXPECT_EQ(0, h.getTotalCount());
+	EXPECT_EQ(0, h.getMin());
+	EXPECT_EQ(0, h.getMax());
+	EXPECT_EQ(0, h.getMean());
+	EXPECT_EQ(0, h.getValueAtPercentile(99));
+}
+
+TEST(TestHistogram, TestPercentiles)
+{
+	Histogram h(1, 3600000, 3);
+
+	for (int i = 1; i <= 100000; ++i)
+		h.recordValue(i);
+
+	EXPECT_EQ(100000, h.getTotalCount());
+	EXPECT_EQ(1, h.getMin());
+	EXPECT_EQ(100000, h.getMax());
+	EXPECT_DOUBLE_EQ(50000.5, h.getMean());
+
+	// precision is 3 significant digits
+	EXPECT_NEAR(50000, h.getValueAtPercentile(50), 50);
+	EXPECT_NEAR(95000, h.getValueAtPercentile(95), 95);
+	EXPECT_NEAR(99000, h.getValueAtPercentile(99), 99);
+	EXPECT_EQ(100000, h.getValueAtPercentile(100));
+}
+
+TEST(TestHistogram, TestClamp)
+{
+	Histogram h(1, 1000, 2);
+
+	h.recordValue(-10);
+	h.recordValue(1000000);
+
+	EXPECT_EQ(2, h.getTotalCount());
+	EXPECT_EQ(0, h.getMin());
+	EXPECT_EQ(1000, h.getMax());
+}
+
+TEST(TestHistogram, TestTail)
+{
+	Histogram h;
+
+	for (int i = 0; i < 990; ++i)
+		h.recordValue(10000);
+	for (int i = 0; i < 10; ++i)
+		h.recordValue(500000);
+
+	EXPECT_NEAR(10000, h.getValueAtPercentile(50), 100);
+	EXPECT_NEAR(10000, h.getValueAtPercentile(99), 100);
+	EXPECT_NEAR(500000, h.getValueAtPercentile(99.5), 5000);
+	EXPECT_EQ(500000, h.getMax());
+}
+
+TEST(TestHistogram, TestMerge)
+{
+	Histogram h1, h2, h3(1, 100000, 3);
+
+	for (int i = 1; i <= 1000; ++i)
+	{
+		h1.recordValue(i);
+		h2.recordValue(i+1000);
+		h3.recordValue(i+2000);
+	}
+
+	h1.add(h2);
+	EXPECT_EQ(2000, h1.getTotalCount());
+	EXPECT_EQ(1, h1.getMin());
+	EXPECT_EQ(2000, h1.getMax());
+	EXPECT_NEAR(1000, h1.getValueAtPercentile(50), 10);
+
+	// different configuration
+	h1.add(h3);
+	EXPECT_EQ(3000, h1.getTotalCount());
+	EXPECT_NEAR(3000, h1.getMax(), 30);
+	EXPECT_NEAR(1500, h1.getValueAtPercentile(50), 15);
+}
+
+TEST(TestHistogram, TestCopy)
+{
+	Histogram h;
+	for (int i = 1; i <= 100; ++i)
+		h.recordValue(i);
+
+	Histogram copy(h);
+	h.reset();
+
+	EXPECT_EQ(0, h.getTotalCount());
+	EXPECT_EQ(100, copy.getTotalCount());
+	EXPECT_EQ(100, copy.getMax());
+}
+
+TEST(TestHistogram, TestConcurrentRecord)
+{
+	Histogram h;
+	int nThreads = 4, nValues = 100000;
+	std::vector<boost::shared_ptr<boost::thread>> threads;
+
+	for (int t = 0; t < nThreads; ++t)
+		threads.push_back(boost::make_shared<boost::thread>([&h, nValues](){
+			for (int i = 1; i <= nValues; ++i)
+				h.recordValue(i);
+		}));
+
+	for (auto& t:threads) t->join();
+
+	EXPECT_EQ(nThreads*nValues, h.getTotalCount());
+	EXPECT_EQ(1, h.getMin());
+	EXPECT_EQ(nValues, h.getMax());
+}
+
+TEST(TestHistogram, TestStatisticsStorage)
+{
+	boost::shared_ptr<StatisticsStorage> storage(StatisticsStorage::createConsumerStatistics());
+
+	for (int i = 1; i <= 100; ++i)
+		storage->recordValue(HistogramIndicator::CaptureToPlay, i*1000);
+
+	StatisticsStorage::StatRepo repo = storage->getIndicators();
+	EXPECT_NEAR(50, repo[Indicator::LatencyP50], 1);
+	EXPECT_NEAR(99, repo[Indicator::LatencyP99], 1);
+	EXPECT_EQ(100, repo[Indicator::LatencyMax]);
+	EXPECT_EQ(0, repo[Indicator::DrdP99]);
+
+	// copies are snapshots
+	StatisticsStorage copy(*storage);
+	storage->recordValue(HistogramIndicator::CaptureToPlay, 1000000);
+	EXPECT_EQ(100, copy.getHistogram(HistogramIndicator::CaptureToPlay)->getTotalCount());
+	EXPECT_EQ(101, storage->getHistogram(HistogramIndicator::CaptureToPlay)->getTotalCount());
+
+	// producer statistics do not track histograms
+	boost::shared_ptr<StatisticsStorage> pstorage(StatisticsStorage::createProducerStatistics());
+	pstorage->recordValue(HistogramIndicator::CaptureToPlay, 1000);
+	EXPECT_FALSE(pstorage->getHistogram(HistogramIndicator::CaptureToPlay));
+}
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,337 @@
+//
+// test-interest-control-sim.cc
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+// Simulation harness for Interest pipeline strategies. Runs consumer's
+// InterestControl, DrdEstimator and LatencyControl against a simulated live
+// producer behind a bottleneck link (capacity, drop-tail queue, propagation
+// delay, jitter and random loss) in virtual time and compares strategies.
+// This binary provides its own ndnrtc::clock implementation (virtual time),
+// hence src/clock.cpp must not be linked.
+//
+
+#include <stdlib.h>
+#include <cmath>
+#include <map>
+#include <random>
+#include <algorithm>
+#include <boost/function.hpp>
+
+#include "gtest/gtest.h"
+#include "interest-control.hpp"
+#include "latency-control.hpp"
+#include "drd-estimator.hpp"
+#include "statistics.hpp"
+#include "clock.hpp"
+
+#include "tests-helpers.hpp"
+
+using namespace ndnrtc;
+using namespace ndnrtc::statistics;
+
+// #define ENABLE_LOGGING
+
+namespace {
+	int64_t VirtualTimeUsec = 0;
+}
+
+namespace ndnrtc {
+	namespace clock {
+		int64_t millisecondTimestamp() { return VirtualTimeUsec/1000; }
+		int64_t microsecondTimestamp() { return VirtualTimeUsec; }
+		int64_t nanosecondTimestamp() { return VirtualTimeUsec*1000; }
+		double unixTimestamp() { return (double)VirtualTimeUsec/1E6; }
+		int64_t millisecSinceEpoch() { return VirtualTimeUsec/1000; }
+	}
+}
+
+namespace {
+
+typedef struct _LinkParams {
+	std::string name_;
+	double capacityKbps_;
+	std::vector<double> capacityScheduleKbps_; // capacity changes every SchedulePeriodMs
+	unsigned int queueBytes_;   // drop-tail bottleneck queue size
+	unsigned int owdMs_;        // one-way propagation delay
+	unsigned int jitterMs_;     // uniform jitter added to data delivery
+	double loss_;               // random loss probability
+} LinkParams;
+
+typedef struct _SimResult {
+	double meanLatency_, p95Latency_;
+	double meanQueueDelay_, maxQueueDelay_;
+	double meanPipeline_;
+	unsigned int nDelivered_, nDropped_;
+	double lateRatio_;
+} SimResult;
+
+class PipelineAdjuster : public ILatencyControlObserver {
+public:
+	PipelineAdjuster(InterestControl& ictrl):ictrl_(ictrl){}
+	bool needPipelineAdjustment(const PipelineAdjust& cmd)
+	{
+		if (cmd == PipelineAdjust::IncreasePipeline)
+			ictrl_.burst();
+		if (cmd == PipelineAdjust::DecreasePipeline)
+			ictrl_.withhold();
+		return (cmd != PipelineAdjust::KeepPipeline);
+	}
+private:
+	InterestControl& ictrl_;
+};
+
+class Simulation {
+public:
+	static const unsigned int Fps = 30, Gop = 30;
+	static const unsigned int KeyBytes = 25000, DeltaBytes = 3500;
+	static const unsigned int SchedulePeriodMs = 3000;
+	static const unsigned int RtxTimeoutMs = 300;
+	static const unsigned int LateThresholdMs = 250;
+
+	Simulation(const LinkParams& link, boost::shared_ptr<IInterestControlStrategy> strategy):
+		link_(link), rng_(0x5eed),
+		drd_(boost::make_shared<DrdEstimator>()),
+		storage_(StatisticsStorage::createConsumerStatistics()),
+		ictrl_(drd_, storage_, strategy),
+		lctrl_(1000, drd_, storage_),
+		adjuster_(ictrl_),
+		linkFreeUsec_(0), queuedBytes_(0), nextSample_(0), rateSet_(false),
+		nDropped_(0), pipelineSum_(0), nPipelineSamples_(0)
+	{
+		drd_->attach(&ictrl_);
+		drd_->attach(&lctrl_);
+		lctrl_.registerObserver(&adjuster_);
+#ifdef ENABLE_LOGGING
+		ictrl_.setLogger(&ndnlog::new_api::Logger::getLogger(""));
+#endif
+	}
+
+	SimResult run(unsigned int durationMs)
+	{
+		VirtualTimeUsec = 0;
+
+		// bootstrap, as pipeline control state machine does
+		double initialDrd = drd_->getOriginalEstimation();
+		int pipelineSize = ictrl_.getCurrentStrategy()->calculateDemand(Fps, initialDrd, initialDrd*0.05);
+		ictrl_.initialize(Fps, pipelineSize);
+		ictrl_.markLowerLimit(pipelineSize);
+		fillUp();
+
+		while (events_.size() && events_.begin()->first <= (int64_t)durationMs*1000)
+		{
+			std::multimap<int64_t, boost::function<void()>>::iterator it = events_.begin();
+			VirtualTimeUsec = it->first;
+			boost::function<void()> event = it->second;
+			events_.erase(it);
+			event();
+		}
+
+		return result();
+	}
+
+private:
+	LinkParams link_;
+	std::mt19937 rng_;
+	boost::shared_ptr<DrdEstimator> drd_;
+	boost::shared_ptr<StatisticsStorage> storage_;
+	InterestControl ictrl_;
+	LatencyControl lctrl_;
+	PipelineAdjuster adjuster_;
+	std::multimap<int64_t, boost::function<void()>> events_;
+	int64_t linkFreeUsec_;
+	int64_t queuedBytes_;
+	unsigned int nextSample_;
+	bool rateSet_;
+	std::vector<double> latencies_, queueDelays_;
+	unsigned int nDropped_;
+	double pipelineSum_;
+	unsigned int nPipelineSamples_;
+
+	int64_t produceTimeUsec(unsigned int n) const { return (int64_t)n*1000000/Fps; }
+	unsigned int sampleBytes(unsigned int n) const { return (n%Gop == 0 ? KeyBytes : DeltaBytes); }
+
+	double capacityKbps(int64_t usec) const
+	{
+		if (link_.capacityScheduleKbps_.size() == 0)
+			return link_.capacityKbps_;
+		size_t idx = (usec/1000/SchedulePeriodMs) % link_.capacityScheduleKbps_.size();
+		return link_.capacityScheduleKbps_[idx];
+	}
+
+	void schedule(int64_t usec, boost::function<void()> event)
+	{
+		events_.insert(std::pair<int64_t, boost::function<void()>>(usec, event));
+	}
+
+	void fillUp()
+	{
+		while (ictrl_.room() > 0 && ictrl_.increment())
+			request(nextSample_++);
+
+		pipelineSum_ += ictrl_.pipelineLimit();
+		nPipelineSamples_++;
+	}
+
+	void request(unsigned int n)
+	{
+		int64_t requestUsec = VirtualTimeUsec;
+		int64_t atProducerUsec = requestUsec + link_.owdMs_*1000;
+		int64_t readyUsec = std::max(atProducerUsec, produceTimeUsec(n));
+
+		schedule(readyUsec, [this, n, requestUsec, atProducerUsec](){
+			send(n, requestUsec, VirtualTimeUsec-atProducerUsec);
+		});
+	}
+
+	void send(unsigned int n, int64_t requestUsec, int64_t dGenUsec)
+	{
+		unsigned int bytes = sampleBytes(n);
+		int64_t now = VirtualTimeUsec;
+
+		// drop-tail queue: bytes still waiting for transmission
+		double kbps = capacityKbps(now);
+		queuedBytes_ = std::max((int64_t)0, (int64_t)((linkFreeUsec_-now)*kbps/8000.));
+
+		if (queuedBytes_ + bytes > link_.queueBytes_ ||
+			std::uniform_real_distribution<double>(0,1)(rng_) < link_.loss_)
+		{
+			nDropped_++;
+			schedule(requestUsec + RtxTimeoutMs*1000, [this, n](){ request(n); });
+			return;
+		}
+
+		int64_t startUsec = std::max(now, linkFreeUsec_);
+		linkFreeUsec_ = startUsec + (int64_t)(bytes*8000./kbps);
+
+		int64_t jitterUsec = (link_.jitterMs_ ? std::uniform_int_distribution<int>(0, link_.jitterMs_*1000)(rng_) : 0);
+		int64_t queueDelayUsec = startUsec-now;
+
+		schedule(linkFreeUsec_ + link_.owdMs_*1000 + jitterUsec,
+			[this, n, requestUsec, dGenUsec, queueDelayUsec](){
+				arrived(n, requestUsec, dGenUsec, queueDelayUsec);
+			});
+	}
+
+	void arrived(unsigned int n, int64_t requestUsec, int64_t dGenUsec, int64_t queueDelayUsec)
+	{
+		int64_t now = VirtualTimeUsec;
+
+		drd_->newValue((double)(now-requestUsec-dGenUsec)/1000., true, (double)dGenUsec/1000.);
+		if (!rateSet_)
+		{
+			rateSet_ = true;
+			ictrl_.targetRateUpdate(Fps);
+			lctrl_.targetRateUpdate(Fps);
+		}
+
+		ictrl_.decrement();
+		ictrl_.sampleArrived(n);
+		lctrl_.sampleArrived(n);
+
+		latencies_.push_back((double)(now-produceTimeUsec(n))/1000.);
+		queueDelays_.push_back((double)queueDelayUsec/1000.);
+
+		fillUp();
+	}
+
+	SimResult result()
+	{
+		SimResult r = {0,0,0,0,0,0,0,0};
+
+		// skip warm-up
+		size_t skip = latencies_.size()/10;
+		std::vector<double> latencies(latencies_.begin()+skip, latencies_.end());
+		std::vector<double> queueDelays(queueDelays_.begin()+skip, queueDelays_.end());
+
+		if (latencies.size() == 0)
+			return r;
+
+		unsigned int nLate = 0;
+		for (size_t i = 0; i < latencies.size(); ++i)
+		{
+			r.meanLatency_ += latencies[i]/latencies.size();
+			r.meanQueueDelay_ += queueDelays[i]/queueDelays.size();
+			r.maxQueueDelay_ = std::max(r.maxQueueDelay_, queueDelays[i]);
+			if (latencies[i] > link_.owdMs_ + LateThresholdMs)
+				nLate++;
+		}
+
+		std::sort(latencies.begin(), latencies.end());
+		r.p95Latency_ = latencies[(size_t)(0.95*(latencies.size()-1))];
+		r.meanPipeline_ = pipelineSum_/nPipelineSamples_;
+		r.nDelivered_ = latencies_.size();
+		r.nDropped_ = nDropped_;
+		r.lateRatio_ = (double)nLate/latencies.size();
+
+		return r;
+	}
+};
+
+std::vector<LinkParams> links()
+{
+	std::vector<LinkParams> l;
+	l.push_back({"clean", 5000, {}, 500000, 50, 2, 0});
+	l.push_back({"lossy-jitter", 3000, {}, 100000, 50, 40, 0.02});
+	l.push_back({"variable", 0, {2500, 900, 1800, 1100}, 60000, 40, 10, 0.005});
+	l.push_back({"narrow", 1300, {}, 40000, 60, 10, 0.01});
+	return l;
+}
+
+void print(const std::string& strategy, const LinkParams& link, const SimResult& r)
+{
+	GT_PRINTF("%-14s %-8s latency mean %7.1f p95 %7.1f | queue mean %6.1f max %6.1f | "
+		"pipeline %5.1f | late %5.1f%% | delivered %5d dropped %4d\n",
+		link.name_.c_str(), strategy.c_str(), r.meanLatency_, r.p95Latency_,
+		r.meanQueueDelay_, r.maxQueueDelay_, r.meanPipeline_, r.lateRatio_*100,
+		r.nDelivered_, r.nDropped_);
+}
+
+}
+
+TEST(TestInterestControlSim, TestCompareStrategies)
+{
+#ifdef ENABLE_LOGGING
+	ndnlog::new_api::Logger::getLogger("").setLogLevel(ndnlog::NdnLoggerDetailLevelDebug);
+#endif
+
+	unsigned int durationMs = 60000;
+
+	for (auto& link:links())
+	{
+		SimResult def = Simulation(link, boost::make_shared<InterestControl::StrategyDefault>()).run(durationMs);
+		SimResult bbr = Simulation(link, boost::make_shared<InterestControl::StrategyBbr>()).run(durationMs);
+
+		print("default", link, def);
+		print("bbr", link, bbr);
+
+		// both strategies must keep up with the live stream
+		EXPECT_GT(def.nDelivered_, 0.9*durationMs*Simulation::Fps/1000) << link.name_;
+		EXPECT_GT(bbr.nDelivered_, 0.9*durationMs*Simulation::Fps/1000) << link.name_;
+
+		// bbr must not build up larger queues, lose more or be later than default
+		EXPECT_LE(bbr.maxQueueDelay_, def.maxQueueDelay_ + 5) << link.name_;
+		EXPECT_LE(bbr.nDropped_, def.nDropped_) << link.name_;
+		EXPECT_LE(bbr.meanLatency_, def.meanLatency_ + 5) << link.name_;
+		EXPECT_LE(bbr.lateRatio_, def.lateRatio_ + 0.015) << link.name_;
+	}
+}
+
+TEST(TestInterestControlSim, TestBbrEstimations)
+{
+	LinkParams link = {"clean", 5000, {}, 500000, 50, 0, 0};
+	boost::shared_ptr<InterestControl::StrategyBbr> bbr = boost::make_shared<InterestControl::StrategyBbr>();
+	Simulation(link, bbr).run(10000);
+
+	// min DRD is a round-trip propagation plus serialization of a delta frame
+	EXPECT_NEAR(2*link.owdMs_, bbr->getMinDrd(), 10);
+	// when pipeline is large enough, delivery rate is capped by producer
+	EXPECT_LE((double)Simulation::Fps, bbr->getDeliveryRate());
+	EXPECT_FALSE(bbr->isQueueBuilding());
+}
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
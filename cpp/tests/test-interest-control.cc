@@ -159,6 +159,113 @@ TEST(TestInterestControl, TestViolationsOfLowerBoundary)
 	}
 }
 
+TEST(TestInterestControl, TestStrategyBbr)
+{
+	boost::shared_ptr<DrdEstimator> drd(boost::make_shared<DrdEstimator>(150, 1));
+	InterestControl::StrategyBbr bbr;
+	InterestControl::StrategyDefault def;
+	unsigned int lower, upper, defLower, defUpper;
+
+	drd->newValue(100, true, 0);
+
+	// no estimations yet - same as default
+	bbr.getLimits(30., drd, lower, upper);
+	def.getLimits(30., drd, defLower, defUpper);
+	EXPECT_EQ(defLower, lower);
+	EXPECT_EQ(defUpper, upper);
+
+	int64_t t = 1000;
+	for (int i = 0; i < 60; ++i, t += 33)
+	{
+		bbr.sampleArrived(t);
+		bbr.drdUpdate(t, 100 + (i%2)*20);
+	}
+
+	EXPECT_NEAR(30., bbr.getDeliveryRate(), 1.);
+	EXPECT_EQ(100, bbr.getMinDrd());
+	EXPECT_FALSE(bbr.isQueueBuilding());
+
+	// BDP is slightly above 3 samples, hence demand is 4
+	bbr.getLimits(30., drd, lower, upper);
+	EXPECT_EQ(8, lower);
+	EXPECT_EQ(10, upper);
+	EXPECT_EQ(2, bbr.burst(8, lower, upper));
+	EXPECT_EQ(-1, bbr.withhold(10, lower, upper));
+	EXPECT_EQ(0, bbr.withhold(8, lower, upper));
+
+	// queue is building up
+	for (int i = 0; i < 15; ++i, t += 33)
+	{
+		bbr.sampleArrived(t);
+		bbr.drdUpdate(t, 120 + i*10);
+	}
+
+	EXPECT_TRUE(bbr.isQueueBuilding());
+	EXPECT_EQ(100, bbr.getMinDrd());
+	bbr.getLimits(30., drd, lower, upper);
+	EXPECT_EQ(4, lower);
+	EXPECT_EQ(4, upper);
+	EXPECT_EQ(0, bbr.burst(8, lower, upper));
+}
+
+namespace {
+	class FixedLimitsStrategy : public InterestControl::StrategyDefault {
+	public:
+		FixedLimitsStrategy(bool isStrict):isStrict_(isStrict), lower_(3), upper_(30){}
+
+		void getLimits(double, boost::shared_ptr<DrdEstimator>,
+			unsigned int &lowerLimit, unsigned int &upperLimit) override
+		{
+			lowerLimit = lower_;
+			upperLimit = upper_;
+		}
+		bool hasStrictLimits() const override { return isStrict_; }
+
+		bool isStrict_;
+		unsigned int lower_, upper_;
+	};
+}
+
+TEST(TestInterestControl, TestStrictLimits)
+{
+	for (int isStrict = 0; isStrict < 2; ++isStrict)
+	{
+		boost::shared_ptr<DrdEstimator> drd(boost::make_shared<DrdEstimator>(150, 1));
+		boost::shared_ptr<StatisticsStorage> storage(StatisticsStorage::createConsumerStatistics());
+		boost::shared_ptr<FixedLimitsStrategy> strategy(boost::make_shared<FixedLimitsStrategy>(isStrict != 0));
+		InterestControl ictrl(drd, storage, strategy);
+
+		ictrl.initialize(30., 3);
+		ictrl.targetRateUpdate(30.);
+		ictrl.markLowerLimit(10);
+		EXPECT_EQ(10, ictrl.pipelineLimit());
+
+		// strategy drains below marked lower limit
+		strategy->lower_ = 4;
+		strategy->upper_ = 6;
+		ictrl.targetRateUpdate(30.);
+
+		if (isStrict)
+		{
+			EXPECT_EQ(6, ictrl.pipelineLimit());
+			EXPECT_TRUE(ictrl.withhold());
+			EXPECT_EQ(5, ictrl.pipelineLimit());
+		}
+		else
+		{
+			// lower limit never goes below the marked one, current limit
+			// is not clamped by the upper limit
+			EXPECT_EQ(10, ictrl.pipelineLimit());
+			EXPECT_FALSE(ictrl.withhold());
+			EXPECT_EQ(10, ictrl.pipelineLimit());
+		}
+
+		// limit never goes below lower limit
+		ictrl.burst();
+		EXPECT_LE(isStrict ? 4 : 10, ictrl.pipelineLimit());
+	}
+}
+
 int main(int argc, char **argv) {
 	::testing::InitGoogleTest(&argc, argv);
 	return RUN_ALL_TESTS();
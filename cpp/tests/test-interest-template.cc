@@ -0,0 +1,80 @@
+//
+// test-interest-template.cc
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#include <stdlib.h>
+
+#include "gtest/gtest.h"
+#include "include/name-components.hpp"
+#include "src/interest-template.hpp"
+
+using namespace ndnrtc;
+using namespace std;
+using namespace ndn;
+
+TEST(TestInterestTemplate, TestMakeInterests)
+{
+	Name prefix("/ndn/edu/ucla/remap/peter/ndncon/instance1/ndnrtc/");
+	prefix.appendVersion(NameComponents::nameApiVersion()).append(Name("video/camera/hi/d")).appendSequenceNumber(7);
+
+	InterestTemplate it(1000);
+	vector<boost::shared_ptr<const Interest>> interests;
+	unsigned int nData = InterestTemplate::PreEncodedSegmentsNum+2;
+
+	it.makeInterests(prefix, nData, false, interests);
+	it.makeInterests(prefix, 3, true, interests);
+	ASSERT_EQ(nData+3, interests.size());
+
+	for (int segNo = 0; segNo < nData; ++segNo)
+	{
+		// must be the same as interests built from scratch
+		Interest i(Name(prefix).appendSegment(segNo), 1000);
+		i.setMustBeFresh(false);
+
+		EXPECT_EQ(i.getName(), interests[segNo]->getName());
+		EXPECT_EQ(1000, interests[segNo]->getInterestLifetimeMilliseconds());
+		EXPECT_FALSE(interests[segNo]->getMustBeFresh());
+		EXPECT_EQ(i.wireEncode().size(), interests[segNo]->wireEncode().size());
+	}
+
+	for (int segNo = 0; segNo < 3; ++segNo)
+	{
+		Name n(prefix);
+		n.append(NameComponents::NameComponentParity).appendSegment(segNo);
+		EXPECT_EQ(n, interests[nData+segNo]->getName());
+
+		NamespaceInfo info;
+		ASSERT_TRUE(NameComponents::extractInfo(interests[nData+segNo]->getName(), info));
+		EXPECT_TRUE(info.isParity_);
+		EXPECT_EQ(7, info.sampleNo_);
+		EXPECT_EQ(segNo, info.segNo_);
+	}
+}
+
+TEST(TestInterestTemplate, TestLifetime)
+{
+	Name n("/ndn/test/%00%01");
+	InterestTemplate it(1000);
+	vector<boost::shared_ptr<const Interest>> interests;
+
+	it.makeInterests(n, 1, false, interests);
+	it.setLifetime(500);
+	it.makeInterests(n, 1, false, interests);
+
+	EXPECT_EQ(1000, interests[0]->getInterestLifetimeMilliseconds());
+	EXPECT_EQ(500, interests[1]->getInterestLifetimeMilliseconds());
+	EXPECT_EQ(500, it.getLifetime());
+
+	boost::shared_ptr<Interest> i = it.makeInterest(n);
+	EXPECT_EQ(n, i->getName());
+	EXPECT_EQ(500, i->getInterestLifetimeMilliseconds());
+	EXPECT_FALSE(i->getMustBeFresh());
+}
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
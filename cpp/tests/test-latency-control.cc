@@ -812,6 +812,75 @@ TEST(TestLatencyControl, TestLatestDataDetection)
 	t.join();
 }
 #endif
+TEST(TestLatencyControl, TestPercentileStrategy)
+{
+	LatencyControl::PercentileStrategy strategy(95.);
+	estimators::Average drd(boost::make_shared<estimators::SampleWindow>(10));
+	double period = 1000./30.;
+	int64_t t = 1000;
+	PacketNumber n = 0;
+	unsigned int target = 0;
+
+	srand(0);
+	EXPECT_EQ(150, strategy.getTargetPlayoutSize(drd, 150));
+
+	// calm network: few milliseconds of jitter
+	for (int i = 0; i < 300; ++i, ++n)
+	{
+		int64_t arrival = t + (int64_t)(n*period) + rand()%5;
+		strategy.sampleArrived(arrival, n, period);
+		strategy.drdUpdate(100 + rand()%5);
+		drd.newValue(100 + rand()%5);
+		target = strategy.getTargetPlayoutSize(drd, 0);
+	}
+
+	EXPECT_GE(10, strategy.getArrivalDelay());
+	EXPECT_GE(10, strategy.getDrdJitter());
+	EXPECT_LE((unsigned int)period, target);
+	EXPECT_GE(50, target);
+	// default strategy stays conservative on the same network
+	LatencyControl::DefaultStrategy defaultStrategy(2);
+	EXPECT_EQ(150, defaultStrategy.getTargetPlayoutSize(drd, 150));
+	EXPECT_GE(50, strategy.getTargetPlayoutSize(drd, 0));
+
+	// every 10th sample is 100ms late - target grows immediately
+	for (int i = 0; i < 300; ++i, ++n)
+	{
+		int64_t arrival = t + (int64_t)(n*period) + rand()%5 + (n%10 == 0 ? 100 : 0);
+		strategy.sampleArrived(arrival, n, period);
+		strategy.drdUpdate(100 + rand()%5 + (n%10 == 0 ? 100 : 0));
+		target = strategy.getTargetPlayoutSize(drd, 0);
+	}
+
+	EXPECT_LE(100, strategy.getArrivalDelay());
+	EXPECT_LE(130, target);
+
+	// network is calm again - target shrinks no faster than DecreaseRateMs per second
+	unsigned int jitteryTarget = target;
+	for (int i = 0; i < 30; ++i, ++n)
+	{
+		int64_t arrival = t + (int64_t)(n*period) + rand()%5;
+		strategy.sampleArrived(arrival, n, period);
+		strategy.drdUpdate(100 + rand()%5);
+		target = strategy.getTargetPlayoutSize(drd, 0);
+	}
+
+	EXPECT_GE(jitteryTarget, target);
+	EXPECT_LE(jitteryTarget - LatencyControl::PercentileStrategy::DecreaseRateMs - 1, target);
+
+	for (int i = 0; i < 1500; ++i, ++n)
+	{
+		int64_t arrival = t + (int64_t)(n*period) + rand()%5;
+		strategy.sampleArrived(arrival, n, period);
+		strategy.drdUpdate(100 + rand()%5);
+		target = strategy.getTargetPlayoutSize(drd, 0);
+	}
+
+	EXPECT_GE(50, target);
+	// lower limit is respected
+	EXPECT_EQ(70, strategy.getTargetPlayoutSize(drd, 70));
+}
+
 int main(int argc, char **argv) {
 	::testing::InitGoogleTest(&argc, argv);
 	return RUN_ALL_TESTS();
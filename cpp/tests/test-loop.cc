@@ -27,6 +27,7 @@
 #include "client/src/video-source.hpp"
 #include "client/src/frame-io.hpp"
 #include "estimators.hpp"
+#include "loopback-face.hpp"
 
 #include "mock-objects/external-capturer-mock.hpp"
 #include "mock-objects/external-renderer-mock.hpp"
@@ -131,61 +132,184 @@ std::string createUnitTestFolder(const std::vector<std::string> &comps)
 #endif
 }
 
-TEST(TestLoop, TestVideo)
+// Runs producer side of video loop tests: IO threads, test video source and
+// local "camera" stream published under appPrefix_. Tests pick faces for
+// producer and consumer, set up remote streams and check the results.
+class VideoLoop
 {
-    if (!checkNfd()) return;
+  public:
+    VideoLoop()
+        : appPrefix_("/ndn/edu/ucla/remap/peter/app"),
+          keyChain_(memoryKeyChain(appPrefix_)),
+          work_(boost::make_shared<boost::asio::io_service::work>(io_)),
+          t_([this](){ io_.run(); }),
+          workSource_(boost::make_shared<boost::asio::io_service::work>(ioSource_)),
+          tSource_([this](){ ioSource_.run(); }),
+          frame_(boost::make_shared<ArgbFrame>(320,240)),
+          source_(ioSource_, resources_path+"/test-source-320x240.argb", frame_),
+          stopped_(false)
+    {
+        source_.addCapturer(&capturer_);
 
 #ifdef ENABLE_LOGGING
-    std::string testCaseLogsFolder = createUnitTestFolder({ logs_path, 
-                                                            ::testing::UnitTest::GetInstance()->current_test_info()->name(), 
-                                                            ::testing::UnitTest::GetInstance()->current_test_info()->test_case_name() });
-    std::string remoteStreamLoggerPath = testCaseLogsFolder + "/" + "consumer-loop.log";
-    std::string localStreamLoggerPath = testCaseLogsFolder + "/" + "producer-loop.log";
-    std::string statLoggerPath = testCaseLogsFolder + "/" + "stats.log";
+        logsFolder_ = createUnitTestFolder({ logs_path, 
+                                             ::testing::UnitTest::GetInstance()->current_test_info()->name(), 
+                                             ::testing::UnitTest::GetInstance()->current_test_info()->test_case_name() });
+        GT_PRINTF("For this test, see logs at %s\n", logsFolder_.c_str());
+        ndnlog::new_api::Logger::initAsyncLogging();
+#endif
+    }
 
-    GT_PRINTF("For this test, see logs at %s\n", testCaseLogsFolder.c_str());
+    ~VideoLoop()
+    {
+        stop();
+    }
 
-    ndnlog::new_api::Logger::initAsyncLogging();
-    ndnlog::new_api::Logger::getLogger(remoteStreamLoggerPath).setLogLevel(ndnlog::NdnLoggerDetailLevelAll);
-    ndnlog::new_api::Logger::getLogger(localStreamLoggerPath).setLogLevel(ndnlog::NdnLoggerDetailLevelAll);
+    // producer and consumer talk through local NFD
+    void connectNfd()
+    {
+        publisherFace_ = boost::make_shared<ThreadsafeFace>(io_);
+        consumerFace_ = boost::make_shared<ThreadsafeFace>(io_);
+
+        publisherFace_->setCommandSigningInfo(*keyChain_, certName(keyName(appPrefix_)));
+        publisherFace_->registerPrefix(Name(appPrefix_), OnInterestCallback(),
+                                       [](const boost::shared_ptr<const Name>&){
+                                           ASSERT_FALSE(true);
+                                       });
+        // making sure that prefix registration gets through
+        boost::this_thread::sleep_for(boost::chrono::milliseconds(2000));
+    }
+
+    // producer and consumer talk through in-process network
+    void connectLoopback(const boost::shared_ptr<LoopbackNetwork> &network,
+                         const LoopbackNetwork::LinkSettings &publisherLink,
+                         const LoopbackNetwork::LinkSettings &consumerLink)
+    {
+        publisherFace_ = network->createFace(publisherLink);
+        consumerFace_ = network->createFace(consumerLink);
+    }
+
+    // starts publishing test video at 30 FPS
+    void startPublishing()
+    {
+        MediaStreamSettings settings(io_, getSampleVideoParams());
+        settings.face_ = publisherFace_.get();
+        settings.keyChain_ = keyChain_.get();
+        localStream_ = boost::make_shared<LocalVideoStream>(appPrefix_, settings);
+        setLogger(*localStream_, "producer-loop.log");
+
+        LocalVideoStream *localStream = localStream_.get();
+        boost::function<int(const unsigned int,const unsigned int, unsigned char*, unsigned int)>
+        incomingRawFrame =[localStream](const unsigned int w,const unsigned int h, unsigned char* data, unsigned int size){
+            EXPECT_NO_THROW(localStream->incomingArgbFrame(w, h, data, size));
+            return 0;
+        };
+
+        EXPECT_CALL(capturer_, incomingArgbFrame(320, 240, _, _))
+          .WillRepeatedly(Invoke(incomingRawFrame));
+
+        keyChain_->setFace(consumerFace_.get());
+        GT_PRINTF("Started publishing stream\n");
+        source_.start(30);
+    }
+
+    // stops publishing, shuts down faces and IO threads
+    void stop()
+    {
+        if (stopped_)
+            return;
+        stopped_ = true;
+
+        if (localStream_)
+        {
+            source_.stop();
+            localStream_.reset();
+        }
+
+        workSource_.reset();
+        tSource_.join();
+        ioSource_.stop();
+
+        boost::shared_ptr<Face> consumerFace = consumerFace_, publisherFace = publisherFace_;
+        io_.dispatch([consumerFace, publisherFace]{
+          if (consumerFace) consumerFace->shutdown();
+          if (publisherFace) publisherFace->shutdown();
+        });
+        work_.reset();
+        t_.join();
+        io_.stop();
+    }
+
+    std::string getLogPath(const std::string &fileName) const
+    {
+        std::string path = logsFolder_ + "/" + fileName;
+#ifdef ENABLE_LOGGING
+        ndnlog::new_api::Logger::getLogger(path).setLogLevel(ndnlog::NdnLoggerDetailLevelAll);
 #endif
-    
-    boost::asio::io_service io_source;
-    boost::shared_ptr<boost::asio::io_service::work> work_source(boost::make_shared<boost::asio::io_service::work>(io_source));
-    boost::thread t_source([&io_source](){
-        io_source.run();
-    });
-    
-    boost::asio::io_service io;
-    boost::shared_ptr<boost::asio::io_service::work> work(boost::make_shared<boost::asio::io_service::work>(io));
-    boost::thread t([&io](){
-        io.run();
-    });
-    
-    // video source
-    boost::shared_ptr<RawFrame> frame(boost::make_shared<ArgbFrame>(320,240));
-    std::string testVideoSource = resources_path+"/test-source-320x240.argb";
-    VideoSource source(io_source, testVideoSource, frame);
-    MockExternalCapturer capturer;
-    MockExternalRenderer renderer;
-    source.addCapturer(&capturer);
-    
-    boost::shared_ptr<MemoryPrivateKeyStorage> privateKeyStorage(boost::make_shared<MemoryPrivateKeyStorage>());
-    std::string appPrefix = "/ndn/edu/ucla/remap/peter/app";
-    boost::shared_ptr<Face> publisherFace(boost::make_shared<ThreadsafeFace>(io));
-    boost::shared_ptr<Face> consumerFace(boost::make_shared<ThreadsafeFace>(io));
-    boost::shared_ptr<KeyChain> keyChain = memoryKeyChain(appPrefix);
-    
-    publisherFace->setCommandSigningInfo(*keyChain, certName(keyName(appPrefix)));
-    publisherFace->registerPrefix(Name(appPrefix), OnInterestCallback(),
-                                  [](const boost::shared_ptr<const Name>&){
-                                      ASSERT_FALSE(true);
-                                  });
-    // making sure that prefix registration gets through
-    boost::this_thread::sleep_for(boost::chrono::milliseconds(2000));
+        return path;
+    }
+
+    template <typename T>
+    void setLogger(T &component, const std::string &fileName) const
+    {
+#ifdef ENABLE_LOGGING
+        component.setLogger(ndnlog::new_api::Logger::getLoggerPtr(getLogPath(fileName)));
+#endif
+    }
+
+    // waits for remote stream to fetch stream metadata
+    static void waitForThreads(RemoteVideoStream &rs)
+    {
+        int waitThreads = 0;
+        while (rs.getThreads().size() == 0 && waitThreads++ < 5)
+            boost::this_thread::sleep_for(boost::chrono::milliseconds(1500));
+    }
+
+    std::string appPrefix_;
+    boost::asio::io_service io_;
+    boost::shared_ptr<KeyChain> keyChain_;
+    boost::shared_ptr<Face> publisherFace_, consumerFace_;
+
+  private:
+    boost::shared_ptr<boost::asio::io_service::work> work_;
+    boost::thread t_;
+    boost::asio::io_service ioSource_;
+    boost::shared_ptr<boost::asio::io_service::work> workSource_;
+    boost::thread tSource_;
+    boost::shared_ptr<RawFrame> frame_;
+    MockExternalCapturer capturer_;
+    VideoSource source_;
+    boost::shared_ptr<LocalVideoStream> localStream_;
+    std::string logsFolder_;
+    bool stopped_;
+};
+
+// renderer hands out frame's buffer and counts rendered frames
+void expectRendering(MockExternalRenderer &renderer,
+                     const boost::shared_ptr<RawFrame> &frame, int &nRendered)
+{
+    int w = frame->getWidth(), h = frame->getHeight();
+
+    EXPECT_CALL(renderer, getFrameBuffer(w,h))
+      .Times(AtLeast(1))
+      .WillRepeatedly(Return(frame->getBuffer().get()));
+    EXPECT_CALL(renderer, renderBGRAFrame(_,w,h,_))
+      .Times(AtLeast(1))
+      .WillRepeatedly(Invoke([&nRendered](const FrameInfo&,int,int,const uint8_t*){
+        nRendered++;
+      }));
+}
+
+TEST(TestLoop, TestVideo)
+{
+    if (!checkNfd()) return;
 
+    VideoLoop loop;
+    loop.connectNfd();
+
+    std::string statLoggerPath = loop.getLogPath("stats.log");
     boost::atomic<bool> done(false);
-    boost::asio::deadline_timer statTimer(io);
+    boost::asio::deadline_timer statTimer(loop.io_);
     boost::function<void(const boost::system::error_code&)> queryStat;
     boost::function<void()> setupTimer = [&statTimer, &queryStat, &done](){
       if (!done)
@@ -198,28 +322,12 @@ TEST(TestLoop, TestVideo)
     int rebufferingsNum = 0, nRendered = 0, state = 0;
     estimators::Average bufferLevel(boost::make_shared<estimators::SampleWindow>(10));
     {
-      MediaStreamSettings settings(io, getSampleVideoParams());
-      settings.face_ = publisherFace.get();
-      settings.keyChain_ = keyChain.get();
-      LocalVideoStream localStream(appPrefix, settings);
-      
-#ifdef ENABLE_LOGGING
-      localStream.setLogger(ndnlog::new_api::Logger::getLoggerPtr(localStreamLoggerPath));
-#endif
-      
-      boost::function<int(const unsigned int,const unsigned int, unsigned char*, unsigned int)>
-      incomingRawFrame =[&localStream](const unsigned int w,const unsigned int h, unsigned char* data, unsigned int size){
-          EXPECT_NO_THROW(localStream.incomingArgbFrame(w, h, data, size));
-          return 0;
-      };
-      
-      EXPECT_CALL(capturer, incomingArgbFrame(320, 240, _, _))
-        .WillRepeatedly(Invoke(incomingRawFrame));
-      
       int runTime = 10000;
-      
-      keyChain->setFace(consumerFace.get());
-      RemoteVideoStream rs(io, consumerFace, keyChain, appPrefix, getSampleVideoParams().streamName_);
+      MockExternalRenderer renderer;
+      boost::shared_ptr<RawFrame> frame(boost::make_shared<ArgbFrame>(320,240));
+      RemoteVideoStream rs(loop.io_, loop.consumerFace_, loop.keyChain_, loop.appPrefix_,
+                           getSampleVideoParams().streamName_);
+      loop.setLogger(rs, "consumer-loop.log");
 
       queryStat = [&statTimer, &rs, &setupTimer, &rebufferingsNum, &bufferLevel, &state, statLoggerPath]
       (const boost::system::error_code& err)
@@ -248,10 +356,6 @@ TEST(TestLoop, TestVideo)
       };
       setupTimer();
       
-#ifdef ENABLE_LOGGING
-      rs.setLogger(ndnlog::new_api::Logger::getLoggerPtr(remoteStreamLoggerPath));
-#endif
-      
       EXPECT_CALL(renderer, getFrameBuffer(320,240))
         .Times(AtLeast(1))
         .WillRepeatedly(Return(frame->getBuffer().get()));
@@ -275,12 +379,8 @@ TEST(TestLoop, TestVideo)
         .Times(AtLeast(1))
         .WillRepeatedly(Invoke(renderFrame));
 
-      GT_PRINTF("Started publishing stream\n");
-      source.start(30);
-
-      int waitThreads = 0;
-      while (rs.getThreads().size() == 0 && waitThreads++ < 5)
-          boost::this_thread::sleep_for(boost::chrono::milliseconds(1500));
+      loop.startPublishing();
+      VideoLoop::waitForThreads(rs);
       ASSERT_LT(0, rs.getThreads().size());
 
       // wait random milliseconds before fetching
@@ -292,21 +392,9 @@ TEST(TestLoop, TestVideo)
       boost::this_thread::sleep_for(boost::chrono::milliseconds(runTime));
       done = true;
       rs.stop();
-      source.stop();
       statTimer.cancel();
     }
-
-    work_source.reset();
-    t_source.join();
-    io_source.stop();
-    
-    io.dispatch([consumerFace, publisherFace]{
-      consumerFace->shutdown();
-      publisherFace->shutdown();
-    });
-    work.reset();
-    t.join();
-    io.stop();
+    loop.stop();
 
     GT_PRINTF("Rebufferins: %d, Buffer Level: %.2f, Rendered frames: %d\n",
       rebufferingsNum, bufferLevel.value(), nRendered);
@@ -316,6 +404,157 @@ TEST(TestLoop, TestVideo)
     EXPECT_LT(110, bufferLevel.value());
     EXPECT_GT(200, bufferLevel.value());
 }
+
+TEST(TestLoop, TestVideoLossyLoopback)
+{
+    VideoLoop loop;
+    // in-process network instead of NFD: 30ms RTT with up to 20ms of
+    // jitter and 2% loss on consumer's link (seeded - same pattern every run)
+    boost::shared_ptr<LoopbackNetwork> network(boost::make_shared<LoopbackNetwork>(loop.io_, 2018));
+    loop.connectLoopback(network, LoopbackNetwork::LinkSettings(5),
+                         LoopbackNetwork::LinkSettings(10, 10, 0.02));
+
+    int nRendered = 0, runTime = 10000;
+    StatisticsStorage storage;
+    {
+      MockExternalRenderer renderer;
+      boost::shared_ptr<RawFrame> frame(boost::make_shared<ArgbFrame>(320,240));
+      RemoteVideoStream rs(loop.io_, loop.consumerFace_, loop.keyChain_, loop.appPrefix_,
+                           getSampleVideoParams().streamName_);
+      loop.setLogger(rs, "consumer-loop.log");
+      expectRendering(renderer, frame, nRendered);
+
+      loop.startPublishing();
+      VideoLoop::waitForThreads(rs);
+      ASSERT_LT(0, rs.getThreads().size());
+
+      rs.start(rs.getThreads()[0], &renderer);
+      boost::this_thread::sleep_for(boost::chrono::milliseconds(runTime));
+      storage = rs.getStatistics();
+      rs.stop();
+    }
+    loop.stop();
+
+    LoopbackNetwork::Counters counters = network->getCounters();
+    GT_PRINTF("Rendered frames: %d, lost packets: %d, retransmissions: %d, rebufferings: %d\n",
+      nRendered, (int)counters.droppedNum_, (int)storage[Indicator::RtxNum],
+      (int)storage[Indicator::RebufferingsNum]);
+
+    // lost segments are recovered (retransmissions, FEC) and playback
+    // goes on: at least half of the frames is rendered
+    EXPECT_LT(0u, counters.droppedNum_);
+    EXPECT_LT(0, storage[Indicator::RtxNum]);
+    EXPECT_LT(runTime/1000*30/2, nRendered);
+    EXPECT_GE(storage[Indicator::State], 5);
+}
+
+TEST(TestLoop, TestVideoPreview)
+{
+    if (!checkNfd()) return;
+
+    VideoLoop loop;
+    loop.connectNfd();
+
+    int nRendered = 0;
+    StatisticsStorage storage;
+    {
+      MockExternalRenderer renderer;
+      RemoteVideoStream rs(loop.io_, loop.consumerFace_, loop.keyChain_, loop.appPrefix_,
+                           getSampleVideoParams().streamName_);
+      loop.setLogger(rs, "consumer-loop.log");
+
+      // preview is rendered at half resolution
+      boost::shared_ptr<RawFrame> previewFrame(boost::make_shared<ArgbFrame>(160,120));
+      EXPECT_CALL(renderer, getFrameBuffer(160,120))
+        .Times(AtLeast(1))
+        .WillRepeatedly(Return(previewFrame->getBuffer().get()));
+      EXPECT_CALL(renderer, renderBGRAFrame(_,160,120,_))
+        .Times(AtLeast(1))
+        .WillRepeatedly(Invoke([&nRendered](const FrameInfo& finfo,int,int,const uint8_t*){
+          EXPECT_TRUE(finfo.isKey_);
+          nRendered++;
+        }));
+
+      loop.startPublishing();
+      VideoLoop::waitForThreads(rs);
+      ASSERT_LT(0, rs.getThreads().size());
+
+      RemoteVideoStream::PreviewSettings preview;
+      preview.keyStep_ = 1;
+      preview.scale_ = 0.5;
+
+      rs.start(rs.getThreads()[0], preview, &renderer);
+      boost::this_thread::sleep_for(boost::chrono::milliseconds(5000));
+      storage = rs.getStatistics();
+      rs.stop();
+    }
+    loop.stop();
+
+    GT_PRINTF("Preview: rendered %d key frames, %.0f bytes received\n",
+      nRendered, storage[Indicator::BytesReceived]);
+
+    // one key frame per second (GOP 30 at 30 FPS), no delta frames requested
+    EXPECT_LE(3, nRendered);
+    EXPECT_GE(6, nRendered);
+    EXPECT_EQ(0, storage[Indicator::RequestedNum]);
+    EXPECT_LT(0, storage[Indicator::TimeToFirstFrame]);
+}
+
+TEST(TestLoop, TestSharedFetching)
+{
+    if (!checkNfd()) return;
+
+    VideoLoop loop;
+    loop.connectNfd();
+
+    int nOwnerRendered = 0, nSubscriberRendered = 0;
+    StatisticsStorage ownerStorage, subscriberStorage;
+    {
+      MockExternalRenderer ownerRenderer, subscriberRenderer;
+      boost::shared_ptr<RawFrame> ownerFrame(boost::make_shared<ArgbFrame>(320,240));
+      boost::shared_ptr<RawFrame> subscriberFrame(boost::make_shared<ArgbFrame>(320,240));
+      RemoteVideoStream owner(loop.io_, loop.consumerFace_, loop.keyChain_, loop.appPrefix_,
+                              getSampleVideoParams().streamName_);
+      RemoteVideoStream subscriber(loop.io_, loop.consumerFace_, loop.keyChain_, loop.appPrefix_,
+                                   getSampleVideoParams().streamName_);
+      owner.setSharedFetching(true);
+      subscriber.setSharedFetching(true);
+      loop.setLogger(owner, "consumer-owner.log");
+      loop.setLogger(subscriber, "consumer-subscriber.log");
+      expectRendering(ownerRenderer, ownerFrame, nOwnerRendered);
+      expectRendering(subscriberRenderer, subscriberFrame, nSubscriberRendered);
+
+      loop.startPublishing();
+      VideoLoop::waitForThreads(owner);
+      VideoLoop::waitForThreads(subscriber);
+      ASSERT_LT(0, owner.getThreads().size());
+      ASSERT_LT(0, subscriber.getThreads().size());
+
+      owner.start(owner.getThreads()[0], &ownerRenderer);
+      boost::this_thread::sleep_for(boost::chrono::milliseconds(1000));
+      subscriber.start(subscriber.getThreads()[0], &subscriberRenderer);
+      boost::this_thread::sleep_for(boost::chrono::milliseconds(5000));
+
+      ownerStorage = owner.getStatistics();
+      subscriberStorage = subscriber.getStatistics();
+      subscriber.stop();
+      owner.stop();
+    }
+    loop.stop();
+
+    GT_PRINTF("Shared fetching: owner rendered %d frames (%.0f interests), "
+      "subscriber rendered %d frames (%.0f interests, %.0f shared segments)\n",
+      nOwnerRendered, ownerStorage[Indicator::RequestedNum],
+      nSubscriberRendered, subscriberStorage[Indicator::RequestedNum],
+      subscriberStorage[Indicator::SharedSegmentsNum]);
+
+    // subscriber plays out owner's segments without expressing Interests
+    EXPECT_LT(0, nSubscriberRendered);
+    EXPECT_EQ(0, subscriberStorage[Indicator::RequestedNum]);
+    EXPECT_LT(0, subscriberStorage[Indicator::SharedSegmentsNum]);
+    EXPECT_LT(0, ownerStorage[Indicator::RequestedNum]);
+    EXPECT_EQ(0, ownerStorage[Indicator::SharedSegmentsNum]);
+}
 #if 0
 TEST(TestLoop, TestAudio)
 {
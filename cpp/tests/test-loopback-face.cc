@@ -0,0 +1,258 @@
+//
+// test-loopback-face.cc
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#include <stdlib.h>
+#include <boost/asio.hpp>
+#include <boost/atomic.hpp>
+#include <boost/chrono.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/thread.hpp>
+#include <ndn-cpp/interest-filter.hpp>
+#include <ndn-cpp/network-nack.hpp>
+#include <ndn-cpp/util/memory-content-cache.hpp>
+
+#include "gtest/gtest.h"
+#include "src/loopback-face.hpp"
+
+using namespace ndnrtc;
+using namespace ndn;
+
+namespace {
+	const Name prefix("/ndn/edu/ucla/remap/peter/ndncon/instance1/ndnrtc/%FD%03/video/camera/hi");
+
+	class IoThread {
+	public:
+		IoThread():work_(new boost::asio::io_service::work(io_)),
+			t_([this](){ io_.run(); }) {}
+		~IoThread() { work_.reset(); io_.stop(); t_.join(); }
+
+		boost::asio::io_service io_;
+	private:
+		boost::shared_ptr<boost::asio::io_service::work> work_;
+		boost::thread t_;
+	};
+
+	// producer answers every Interest with Data of the given size
+	OnInterestCallback producer(size_t size = 1000)
+	{
+		return [size](const ptr_lib::shared_ptr<const Name>&, const ptr_lib::shared_ptr<const Interest>& i,
+			Face& face, uint64_t, const ptr_lib::shared_ptr<const InterestFilter>&){
+			Data d(i->getName());
+			d.setContent(std::vector<uint8_t>(size, 0));
+			face.putData(d);
+		};
+	}
+
+	int64_t nowMs()
+	{
+		return boost::chrono::duration_cast<boost::chrono::milliseconds>(boost::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+}
+
+TEST(TestLoopbackFace, TestInterestData)
+{
+	IoThread t;
+	boost::shared_ptr<LoopbackNetwork> network = boost::make_shared<LoopbackNetwork>(t.io_);
+	boost::shared_ptr<LoopbackFace> producerFace = network->createFace(LoopbackNetwork::LinkSettings(25));
+	boost::shared_ptr<LoopbackFace> consumerFace = network->createFace(LoopbackNetwork::LinkSettings(25));
+	boost::atomic<int> nData(0), nTimeouts(0);
+	boost::atomic<int64_t> rtt(0);
+
+	producerFace->setInterestFilter(prefix, producer());
+	boost::this_thread::sleep_for(boost::chrono::milliseconds(10));
+
+	int64_t start = nowMs();
+	consumerFace->expressInterest(Name(prefix).appendSequenceNumber(1),
+		[&](const ptr_lib::shared_ptr<const Interest>&, const ptr_lib::shared_ptr<Data>& d){
+			EXPECT_EQ(1000, d->getContent().size());
+			rtt = nowMs() - start;
+			nData++;
+		},
+		[&](const ptr_lib::shared_ptr<const Interest>&){ nTimeouts++; });
+
+	boost::this_thread::sleep_for(boost::chrono::milliseconds(300));
+
+	EXPECT_EQ(1, nData);
+	EXPECT_EQ(0, nTimeouts);
+	// Interest and Data cross two links each
+	EXPECT_LE(100, rtt);
+	EXPECT_GT(200, rtt);
+	EXPECT_EQ(1, network->getCounters().interestsNum_);
+	EXPECT_EQ(1, network->getCounters().dataNum_);
+	EXPECT_EQ(0, network->getPitSize());
+}
+
+TEST(TestLoopbackFace, TestNackAndTimeout)
+{
+	IoThread t;
+	boost::shared_ptr<LoopbackNetwork> network = boost::make_shared<LoopbackNetwork>(t.io_);
+	boost::shared_ptr<LoopbackFace> producerFace = network->createFace();
+	boost::shared_ptr<LoopbackFace> consumerFace = network->createFace();
+	boost::atomic<int> nData(0), nTimeouts(0), nNacks(0);
+
+	producerFace->setInterestFilter(prefix, [](const ptr_lib::shared_ptr<const Name>&,
+		const ptr_lib::shared_ptr<const Interest>&, Face&, uint64_t,
+		const ptr_lib::shared_ptr<const InterestFilter>&){
+		// never answers
+	});
+	boost::this_thread::sleep_for(boost::chrono::milliseconds(10));
+
+	Interest noRoute(Name("/some/other/prefix"), 1000);
+	consumerFace->expressInterest(noRoute,
+		[&](const ptr_lib::shared_ptr<const Interest>&, const ptr_lib::shared_ptr<Data>&){ nData++; },
+		[&](const ptr_lib::shared_ptr<const Interest>&){ nTimeouts++; },
+		[&](const ptr_lib::shared_ptr<const Interest>&, const ptr_lib::shared_ptr<NetworkNack>& nack){
+			EXPECT_EQ(ndn_NetworkNackReason_NO_ROUTE, nack->getReason());
+			nNacks++;
+		});
+
+	Interest unanswered(Name(prefix).appendSequenceNumber(1), 100);
+	consumerFace->expressInterest(unanswered,
+		[&](const ptr_lib::shared_ptr<const Interest>&, const ptr_lib::shared_ptr<Data>&){ nData++; },
+		[&](const ptr_lib::shared_ptr<const Interest>&){ nTimeouts++; });
+
+	boost::this_thread::sleep_for(boost::chrono::milliseconds(50));
+	EXPECT_EQ(1, nNacks);
+	EXPECT_EQ(0, nTimeouts);
+	EXPECT_EQ(1, network->getPitSize());
+
+	boost::this_thread::sleep_for(boost::chrono::milliseconds(150));
+	EXPECT_EQ(0, nData);
+	EXPECT_EQ(1, nNacks);
+	EXPECT_EQ(1, nTimeouts);
+	EXPECT_EQ(1, network->getCounters().nacksNum_);
+}
+
+TEST(TestLoopbackFace, TestAggregation)
+{
+	IoThread t;
+	boost::shared_ptr<LoopbackNetwork> network = boost::make_shared<LoopbackNetwork>(t.io_);
+	boost::shared_ptr<LoopbackFace> producerFace = network->createFace(LoopbackNetwork::LinkSettings(20));
+	boost::shared_ptr<LoopbackFace> c1 = network->createFace(), c2 = network->createFace();
+	boost::atomic<int> nData(0), nInterests(0);
+	OnInterestCallback onInterest = producer();
+
+	producerFace->setInterestFilter(prefix, [&](const ptr_lib::shared_ptr<const Name>& p,
+		const ptr_lib::shared_ptr<const Interest>& i, Face& f, uint64_t id,
+		const ptr_lib::shared_ptr<const InterestFilter>& filter){
+		nInterests++;
+		onInterest(p, i, f, id, filter);
+	});
+	boost::this_thread::sleep_for(boost::chrono::milliseconds(10));
+
+	OnData onData = [&](const ptr_lib::shared_ptr<const Interest>&, const ptr_lib::shared_ptr<Data>&){ nData++; };
+	c1->expressInterest(Name(prefix).appendSequenceNumber(1), onData, OnTimeout());
+	c2->expressInterest(Name(prefix).appendSequenceNumber(1), onData, OnTimeout());
+
+	boost::this_thread::sleep_for(boost::chrono::milliseconds(150));
+	EXPECT_EQ(1, nInterests);
+	EXPECT_EQ(2, nData);
+	EXPECT_EQ(1, network->getCounters().aggregatedNum_);
+	EXPECT_EQ(0, network->getPitSize());
+}
+
+TEST(TestLoopbackFace, TestDeterministicLoss)
+{
+	int nInterests = 200;
+	std::vector<std::vector<int>> runs;
+
+	for (int run = 0; run < 2; ++run)
+	{
+		IoThread t;
+		boost::shared_ptr<LoopbackNetwork> network = boost::make_shared<LoopbackNetwork>(t.io_, 1234);
+		boost::shared_ptr<LoopbackFace> producerFace = network->createFace();
+		boost::shared_ptr<LoopbackFace> consumerFace = network->createFace(LoopbackNetwork::LinkSettings(0, 0, 0.1));
+		boost::mutex m;
+		std::vector<int> satisfied;
+
+		producerFace->setInterestFilter(prefix, producer(100));
+		boost::this_thread::sleep_for(boost::chrono::milliseconds(10));
+
+		// express from io thread so packets (and random draws) keep the same order
+		t.io_.post([&](){
+			for (int i = 0; i < nInterests; ++i)
+				consumerFace->expressInterest(Interest(Name(prefix).appendSequenceNumber(i), 100),
+					[&, i](const ptr_lib::shared_ptr<const Interest>&, const ptr_lib::shared_ptr<Data>&){
+						boost::lock_guard<boost::mutex> scopedLock(m);
+						satisfied.push_back(i);
+					}, OnTimeout());
+		});
+
+		boost::this_thread::sleep_for(boost::chrono::milliseconds(200));
+		boost::lock_guard<boost::mutex> scopedLock(m);
+		// loss on both directions of consumer's link: ~19%
+		EXPECT_LT(nInterests*0.7, satisfied.size());
+		EXPECT_GT(nInterests*0.9, satisfied.size());
+		EXPECT_EQ(nInterests - satisfied.size(), network->getCounters().droppedNum_);
+		runs.push_back(satisfied);
+	}
+
+	EXPECT_EQ(runs[0], runs[1]);
+}
+
+TEST(TestLoopbackFace, TestBandwidth)
+{
+	IoThread t;
+	boost::shared_ptr<LoopbackNetwork> network = boost::make_shared<LoopbackNetwork>(t.io_);
+	boost::shared_ptr<LoopbackFace> producerFace = network->createFace(LoopbackNetwork::LinkSettings(0, 0, 0, 800));
+	boost::shared_ptr<LoopbackFace> consumerFace = network->createFace();
+	boost::atomic<int> nData(0);
+	boost::atomic<int64_t> lastMs(0);
+
+	producerFace->setInterestFilter(prefix, producer(1000));
+	boost::this_thread::sleep_for(boost::chrono::milliseconds(10));
+
+	// 10 Data packets of ~1KB over 800Kbps link take ~100ms
+	int64_t start = nowMs();
+	for (int i = 0; i < 10; ++i)
+		consumerFace->expressInterest(Name(prefix).appendSequenceNumber(i),
+			[&](const ptr_lib::shared_ptr<const Interest>&, const ptr_lib::shared_ptr<Data>&){
+				lastMs = nowMs() - start;
+				nData++;
+			}, OnTimeout());
+
+	boost::this_thread::sleep_for(boost::chrono::milliseconds(300));
+	EXPECT_EQ(10, nData);
+	EXPECT_LE(100, lastMs);
+	EXPECT_GT(250, lastMs);
+}
+
+TEST(TestLoopbackFace, TestMemoryContentCache)
+{
+	IoThread t;
+	boost::shared_ptr<LoopbackNetwork> network = boost::make_shared<LoopbackNetwork>(t.io_);
+	boost::shared_ptr<LoopbackFace> producerFace = network->createFace(LoopbackNetwork::LinkSettings(10, 5));
+	boost::shared_ptr<LoopbackFace> consumerFace = network->createFace(LoopbackNetwork::LinkSettings(10, 5));
+	MemoryContentCache cache(producerFace.get());
+	boost::atomic<int> nData(0), nRegistered(0);
+
+	cache.registerPrefix(prefix, [](const ptr_lib::shared_ptr<const Name>&){},
+		[&](const ptr_lib::shared_ptr<const Name>&, uint64_t){ nRegistered++; });
+	for (int i = 0; i < 5; ++i)
+	{
+		Data d(Name(prefix).appendSequenceNumber(i));
+		d.getMetaInfo().setFreshnessPeriod(1000);
+		cache.add(d);
+	}
+	boost::this_thread::sleep_for(boost::chrono::milliseconds(10));
+	EXPECT_EQ(1, nRegistered);
+
+	for (int i = 0; i < 5; ++i)
+		consumerFace->expressInterest(Name(prefix).appendSequenceNumber(i),
+			[&](const ptr_lib::shared_ptr<const Interest>&, const ptr_lib::shared_ptr<Data>&){
+				nData++;
+			}, OnTimeout());
+
+	boost::this_thread::sleep_for(boost::chrono::milliseconds(200));
+	EXPECT_EQ(5, nData);
+	EXPECT_EQ(0, network->getCounters().unsolicitedNum_);
+}
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
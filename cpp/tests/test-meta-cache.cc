@@ -0,0 +1,107 @@
+//
+// test-meta-cache.cc
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#include <stdlib.h>
+#include <boost/make_shared.hpp>
+
+#include "gtest/gtest.h"
+#include "src/meta-cache.hpp"
+#include "src/frame-data.hpp"
+
+using namespace ndnrtc;
+
+namespace {
+	const std::string streamPrefix = "/ndn/edu/ucla/remap/peter/ndncon/instance1/ndnrtc/%FD%03/video/camera";
+
+	boost::shared_ptr<MediaStreamMeta> streamMeta(uint64_t timestamp)
+	{
+		boost::shared_ptr<MediaStreamMeta> meta = boost::make_shared<MediaStreamMeta>(timestamp);
+		meta->addThread("low");
+		meta->addThread("hi");
+		return meta;
+	}
+
+	boost::shared_ptr<NetworkData> threadMeta()
+	{
+		return boost::make_shared<NetworkData>(std::vector<uint8_t>(10, 1));
+	}
+}
+
+TEST(TestMetaCache, TestStoreAndGet)
+{
+	MetaCache *cache = MetaCache::getSharedInstance();
+	MetaCache::Entry entry;
+
+	cache->clear();
+	EXPECT_FALSE(cache->get(streamPrefix, entry));
+
+	cache->storeStreamMeta(streamPrefix, streamMeta(1526305815742));
+	EXPECT_EQ(1, cache->size());
+
+	// incomplete until all threads are cached
+	EXPECT_FALSE(cache->get(streamPrefix, entry));
+	cache->storeThreadMeta(streamPrefix, "low", threadMeta());
+	EXPECT_FALSE(cache->get(streamPrefix, entry));
+
+	// unknown threads are ignored
+	cache->storeThreadMeta(streamPrefix, "ultra", threadMeta());
+	cache->storeThreadMeta(streamPrefix, "hi", threadMeta());
+
+	ASSERT_TRUE(cache->get(streamPrefix, entry));
+	EXPECT_EQ(1526305815742, entry.streamMeta_->getStreamTimestamp());
+	EXPECT_EQ(2, entry.threadsMeta_.size());
+	EXPECT_EQ(1, entry.threadsMeta_.count("low"));
+	EXPECT_EQ(1, entry.threadsMeta_.count("hi"));
+
+	EXPECT_FALSE(cache->get(streamPrefix+"2", entry));
+	cache->clear();
+}
+
+TEST(TestMetaCache, TestStreamRestart)
+{
+	MetaCache *cache = MetaCache::getSharedInstance();
+	MetaCache::Entry entry;
+
+	cache->clear();
+	cache->storeStreamMeta(streamPrefix, streamMeta(1526305815742));
+	cache->storeThreadMeta(streamPrefix, "low", threadMeta());
+	cache->storeThreadMeta(streamPrefix, "hi", threadMeta());
+	ASSERT_TRUE(cache->get(streamPrefix, entry));
+
+	// same timestamp keeps threads meta
+	cache->storeStreamMeta(streamPrefix, streamMeta(1526305815742));
+	EXPECT_TRUE(cache->get(streamPrefix, entry));
+
+	// new timestamp drops it
+	cache->storeStreamMeta(streamPrefix, streamMeta(1526305819999));
+	EXPECT_FALSE(cache->get(streamPrefix, entry));
+
+	cache->invalidate(streamPrefix);
+	EXPECT_EQ(0, cache->size());
+}
+
+TEST(TestMetaCache, TestMaxAge)
+{
+	MetaCache *cache = MetaCache::getSharedInstance();
+	MetaCache::Entry entry;
+
+	cache->clear();
+	cache->storeStreamMeta(streamPrefix, streamMeta(1526305815742));
+	cache->storeThreadMeta(streamPrefix, "low", threadMeta());
+	cache->storeThreadMeta(streamPrefix, "hi", threadMeta());
+
+	usleep(20000);
+	EXPECT_TRUE(cache->get(streamPrefix, entry));
+	EXPECT_TRUE(cache->get(streamPrefix, entry, 1000));
+	EXPECT_FALSE(cache->get(streamPrefix, entry, 10));
+	cache->clear();
+}
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,288 @@
+//
+// test-mosaic-renderer.cc
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#include <stdlib.h>
+#include <string.h>
+#include <boost/make_shared.hpp>
+
+#include "gtest/gtest.h"
+#include "src/mosaic-renderer-impl.hpp"
+
+using namespace ndnrtc;
+using namespace ndnrtc::statistics;
+
+namespace {
+	class SolidFrame {
+	public:
+		SolidFrame(int w, int h, uint8_t y, uint8_t u, uint8_t v):
+			y_(w*h, y), u_((w/2)*(h/2), u), v_((w/2)*(h/2), v)
+		{
+			frame_.bufferIdx_ = 0;
+			frame_.width_ = w;
+			frame_.height_ = h;
+			frame_.nPlanes_ = 3;
+			frame_.planes_[0] = y_.data();
+			frame_.planes_[1] = u_.data();
+			frame_.planes_[2] = v_.data();
+			frame_.strides_[0] = w;
+			frame_.strides_[1] = w/2;
+			frame_.strides_[2] = w/2;
+		}
+
+		PlanarFrame frame_;
+
+	private:
+		std::vector<uint8_t> y_, u_, v_;
+	};
+
+	class CountingReleaser : public IRenderBufferReleaser {
+	public:
+		CountingReleaser():nReleased_(0){}
+		void releaseFrame(const PlanarFrame& frame) { nReleased_++; }
+		int nReleased_;
+	};
+
+	class TestOutput : public IExternalPlanarRenderer {
+	public:
+		TestOutput(bool hold = false):hold_(hold), nRendered_(0), releaser_(nullptr){}
+
+		PixelFormat getPixelFormat() const { return kI420; }
+		void renderFrame(const FrameInfo& frameInfo, const PlanarFrame& frame,
+			IRenderBufferReleaser* releaser)
+		{
+			nRendered_++;
+			frame_ = frame;
+			releaser_ = releaser;
+			if (!hold_)
+				releaser->releaseFrame(frame);
+		}
+
+		uint8_t y(int x, int y) const { return frame_.planes_[0][y*frame_.strides_[0]+x]; }
+		uint8_t u(int x, int y) const { return frame_.planes_[1][(y/2)*frame_.strides_[1]+x/2]; }
+
+		bool hold_;
+		int nRendered_;
+		PlanarFrame frame_;
+		IRenderBufferReleaser* releaser_;
+	};
+
+	FrameInfo frameInfo(int playbackNo)
+	{
+		return FrameInfo({0, playbackNo, "", false});
+	}
+}
+
+TEST(TestMosaicRenderer, TestComposeGrid)
+{
+	MosaicRendererImpl mosaic(640, 360, 2);
+	CountingReleaser releaser;
+	TestOutput output;
+	std::vector<IExternalPlanarRenderer*> tiles;
+
+	for (int row = 0; row < 2; ++row)
+		for (int col = 0; col < 2; ++col)
+			tiles.push_back(mosaic.addTile({col*320, row*180, 320, 180}));
+	EXPECT_EQ(4, mosaic.getTilesNum());
+	EXPECT_EQ(IExternalPlanarRenderer::kI420, tiles[0]->getPixelFormat());
+
+	// downscaled and upscaled frames
+	SolidFrame f1(640, 360, 0x50, 0x60, 0x70);
+	SolidFrame f2(160, 90, 0xa0, 0xb0, 0xc0);
+	tiles[0]->renderFrame(frameInfo(1), f1.frame_, &releaser);
+	tiles[3]->renderFrame(frameInfo(1), f2.frame_, &releaser);
+
+	ASSERT_TRUE(mosaic.compose(&output));
+	EXPECT_EQ(1, output.nRendered_);
+	EXPECT_EQ(640, output.frame_.width_);
+	EXPECT_EQ(360, output.frame_.height_);
+	EXPECT_EQ(3, output.frame_.nPlanes_);
+
+	EXPECT_EQ(0x50, output.y(10, 10));
+	EXPECT_EQ(0x50, output.y(319, 179));
+	EXPECT_EQ(0x60, output.u(100, 100));
+	EXPECT_EQ(0xa0, output.y(320, 180));
+	EXPECT_EQ(0xa0, output.y(639, 359));
+	EXPECT_EQ(0xb0, output.u(500, 300));
+	// tiles without frames are black
+	EXPECT_EQ(16, output.y(400, 10));
+	EXPECT_EQ(128, output.u(400, 10));
+	EXPECT_EQ(16, output.y(10, 300));
+	EXPECT_EQ(0, releaser.nReleased_);
+}
+
+TEST(TestMosaicRenderer, TestAspectRatio)
+{
+	MosaicRendererImpl mosaic(640, 360, 1);
+	CountingReleaser releaser;
+	TestOutput output;
+	IExternalPlanarRenderer *tile = mosaic.addTile({0, 0, 320, 180});
+	SolidFrame square(100, 100, 0x80, 0x80, 0x80);
+
+	tile->renderFrame(frameInfo(1), square.frame_, &releaser);
+	ASSERT_TRUE(mosaic.compose(&output));
+
+	// 180x180 centered in 320x180 tile
+	EXPECT_EQ(16, output.y(10, 90));
+	EXPECT_EQ(16, output.y(310, 90));
+	EXPECT_EQ(0x80, output.y(70, 0));
+	EXPECT_EQ(0x80, output.y(160, 90));
+	EXPECT_EQ(0x80, output.y(249, 179));
+	EXPECT_EQ(16, output.y(250, 90));
+}
+
+TEST(TestMosaicRenderer, TestOnlyUpdatedTilesScaled)
+{
+	MosaicRendererImpl mosaic(640, 360, 2);
+	CountingReleaser releaser;
+	TestOutput output;
+	IExternalPlanarRenderer *t1 = mosaic.addTile({0, 0, 320, 360});
+	IExternalPlanarRenderer *t2 = mosaic.addTile({320, 0, 320, 360});
+	SolidFrame f(320, 240, 0x50, 0x60, 0x70);
+
+	t1->renderFrame(frameInfo(1), f.frame_, &releaser);
+	t2->renderFrame(frameInfo(1), f.frame_, &releaser);
+
+	// each of 3 swap buffers is composed once
+	for (int i = 0; i < MosaicRendererImpl::DefaultSwapBuffersNum; ++i)
+		ASSERT_TRUE(mosaic.compose(&output));
+	EXPECT_EQ(6, mosaic.getStatistics()[Indicator::MosaicTilesScaledNum]);
+
+	// buffers already contain latest frames
+	ASSERT_TRUE(mosaic.compose(&output));
+	EXPECT_EQ(6, mosaic.getStatistics()[Indicator::MosaicTilesScaledNum]);
+
+	t2->renderFrame(frameInfo(2), f.frame_, &releaser);
+	ASSERT_TRUE(mosaic.compose(&output));
+	EXPECT_EQ(7, mosaic.getStatistics()[Indicator::MosaicTilesScaledNum]);
+	EXPECT_EQ(5, mosaic.getStatistics()[Indicator::MosaicComposedNum]);
+
+	// layout change re-draws all tiles
+	mosaic.removeTile(t1);
+	ASSERT_TRUE(mosaic.compose(&output));
+	EXPECT_EQ(8, mosaic.getStatistics()[Indicator::MosaicTilesScaledNum]);
+	EXPECT_EQ(16, output.y(10, 10));
+	EXPECT_EQ(0x50, output.y(330, 180));
+}
+
+TEST(TestMosaicRenderer, TestTileReleasesFrames)
+{
+	CountingReleaser releaser;
+	SolidFrame f(320, 240, 0x50, 0x60, 0x70);
+
+	{
+		MosaicRendererImpl mosaic(640, 360, 1);
+		IExternalPlanarRenderer *t1 = mosaic.addTile({0, 0, 320, 360});
+		IExternalPlanarRenderer *t2 = mosaic.addTile({320, 0, 320, 360});
+
+		t1->renderFrame(frameInfo(1), f.frame_, &releaser);
+		EXPECT_EQ(0, releaser.nReleased_);
+		t1->renderFrame(frameInfo(2), f.frame_, &releaser);
+		EXPECT_EQ(1, releaser.nReleased_);
+
+		mosaic.removeTile(t1);
+		EXPECT_EQ(2, releaser.nReleased_);
+		EXPECT_ANY_THROW(mosaic.removeTile(t1));
+
+		t2->renderFrame(frameInfo(1), f.frame_, &releaser);
+		EXPECT_EQ(2, releaser.nReleased_);
+	}
+
+	EXPECT_EQ(3, releaser.nReleased_);
+}
+
+TEST(TestMosaicRenderer, TestOutputBusy)
+{
+	MosaicRendererImpl mosaic(640, 360, 1);
+	TestOutput output(true);
+
+	for (int i = 0; i < MosaicRendererImpl::DefaultSwapBuffersNum; ++i)
+		ASSERT_TRUE(mosaic.compose(&output));
+
+	EXPECT_FALSE(mosaic.compose(&output));
+	EXPECT_EQ(1, mosaic.getStatistics()[Indicator::MosaicSkippedNum]);
+
+	output.releaser_->releaseFrame(output.frame_);
+	EXPECT_TRUE(mosaic.compose(&output));
+	EXPECT_EQ(MosaicRendererImpl::DefaultSwapBuffersNum+1, output.nRendered_);
+}
+
+TEST(TestMosaicRenderer, TestRestartWhileHeld)
+{
+	class NV12Output : public TestOutput {
+	public:
+		NV12Output():TestOutput(false){}
+		PixelFormat getPixelFormat() const { return kNV12; }
+		unsigned int getSwapBuffersNum() const { return 2; }
+	};
+
+	MosaicRendererImpl mosaic(640, 360, 1);
+	TestOutput heldOutput(true), output;
+	NV12Output nv12Output;
+
+	// previous output holds a composed frame
+	ASSERT_TRUE(mosaic.compose(&heldOutput));
+	EXPECT_EQ(1, mosaic.getHeldBuffersNum());
+
+	// buffers can't be re-allocated while held
+	EXPECT_ANY_THROW(mosaic.start(50, &nv12Output));
+	EXPECT_FALSE(mosaic.isRunning());
+
+	// same format and number of buffers - buffers are kept
+	mosaic.start(50, &output);
+	usleep(100000);
+	mosaic.stop();
+	EXPECT_LT(0, output.nRendered_);
+	EXPECT_EQ(1, mosaic.getHeldBuffersNum());
+
+	heldOutput.releaser_->releaseFrame(heldOutput.frame_);
+	EXPECT_EQ(0, mosaic.getHeldBuffersNum());
+
+	mosaic.start(50, &nv12Output);
+	usleep(100000);
+	mosaic.stop();
+	EXPECT_LT(0, nv12Output.nRendered_);
+	EXPECT_EQ(2, nv12Output.frame_.nPlanes_);
+}
+
+TEST(TestMosaicRenderer, TestOutputTicks)
+{
+	MosaicRendererImpl mosaic(640, 360, 2);
+	TestOutput output;
+
+	mosaic.start(50, &output);
+	EXPECT_TRUE(mosaic.isRunning());
+	EXPECT_ANY_THROW(mosaic.start(50, &output));
+
+	usleep(500000);
+	mosaic.stop();
+	EXPECT_FALSE(mosaic.isRunning());
+
+	int nRendered = output.nRendered_;
+	EXPECT_LE(15, nRendered);
+	EXPECT_GE(30, nRendered);
+
+	usleep(100000);
+	EXPECT_EQ(nRendered, output.nRendered_);
+}
+
+TEST(TestMosaicRenderer, TestBadTiles)
+{
+	MosaicRendererImpl mosaic(640, 360, 1);
+
+	EXPECT_ANY_THROW(mosaic.addTile({640, 0, 100, 100}));
+	EXPECT_ANY_THROW(mosaic.addTile({0, 0, 1, 100}));
+	EXPECT_EQ(0, mosaic.getTilesNum());
+
+	// clipped to output frame
+	EXPECT_NO_THROW(mosaic.addTile({600, 300, 100, 100}));
+	EXPECT_EQ(1, mosaic.getTilesNum());
+}
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -368,6 +368,33 @@ TEST(TestNameCompo, TestNameExtraction)
 		ASSERT_TRUE(NameComponents::extractInfo("/icear/user/mt1/ndnrtc/%FD%03/video/back_camera/%FC%00%00%01kG%A2%FB%D4/t/_meta", info));
 	}
 }
+
+TEST(TestNameCompo, TestTemporalLayerExtraction)
+{
+	{
+		NamespaceInfo info;
+		ASSERT_TRUE(NameComponents::extractInfo("/icear/user/mt1/ndnrtc/%FD%03/video/back_camera/%FC%00%00%01kG%A2%FB%D4/t/d/%FE%07/%00%00", info));
+		EXPECT_TRUE(info.isDelta_);
+		EXPECT_EQ(0, info.temporalLayer_);
+	}
+	{
+		NamespaceInfo info;
+		ASSERT_TRUE(NameComponents::extractInfo("/icear/user/mt1/ndnrtc/%FD%03/video/back_camera/%FC%00%00%01kG%A2%FB%D4/t/d2/%FE%07/%00%00", info));
+		EXPECT_TRUE(info.isDelta_);
+		EXPECT_EQ(SampleClass::Delta, info.class_);
+		EXPECT_EQ(2, info.temporalLayer_);
+		EXPECT_EQ(7, info.sampleNo_);
+		EXPECT_EQ(Name("/icear/user/mt1/ndnrtc/%FD%03/video/back_camera/%FC%00%00%01kG%A2%FB%D4/t/d2/%FE%07"), info.getPrefix(prefix_filter::Sample));
+	}
+	{
+		NamespaceInfo info;
+		ASSERT_TRUE(NameComponents::extractInfo("/icear/user/mt1/ndnrtc/%FD%03/video/back_camera/%FC%00%00%01kG%A2%FB%D4/t/k/%FE%07/%00%00", info));
+		EXPECT_FALSE(info.isDelta_);
+		EXPECT_EQ(0, info.temporalLayer_);
+	}
+	EXPECT_EQ("d", NameComponents::deltaComponent(0));
+	EXPECT_EQ("d1", NameComponents::deltaComponent(1));
+}
 #if 0
 TEST(TestNameComponents, TestSuffixFiltering)
 {
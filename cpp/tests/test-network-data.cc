@@ -701,6 +701,9 @@ TEST(TestDataSegment, TestSlice)
     header.playbackNo_ = 0;
     header.pairedSequenceNo_ = 1;
     header.paritySegmentsNum_ = 2;
+    // full header, including temporal layers extension
+    header.temporalLayer_ = 1;
+    header.temporalLayersNum_ = 2;
 
     for (auto &s : segments)
     {
@@ -1099,6 +1102,32 @@ TEST(TestVideoThreadMeta, TestCreate)
     }
 }
 
+TEST(TestVideoThreadMeta, TestTemporalLayers)
+{
+    FrameSegmentsInfo segInfo({5.6, 2.3, 54.3, 12.3});
+    VideoCoderParams coder = sampleVideoCoderParams();
+    VideoThreadMeta meta(27, 465, 15, 14, segInfo, coder);
+
+    coder.temporalLayers_ = 3;
+    VideoThreadMeta svcMeta(27, 465, 15, 14, segInfo, coder);
+
+    // layers are published only if there is more than one
+    EXPECT_EQ(meta.getLength() + 1, svcMeta.getLength());
+
+    NetworkData nd(boost::move(meta)), svcNd(boost::move(svcMeta));
+    VideoThreadMeta meta2(boost::move(nd)), svcMeta2(boost::move(svcNd));
+
+    EXPECT_TRUE(meta2.isValid());
+    EXPECT_EQ(14, meta2.getGopPos());
+    EXPECT_EQ(coder.gop_, meta2.getCoderParams().gop_);
+    EXPECT_EQ(1, meta2.getCoderParams().temporalLayers_);
+
+    EXPECT_TRUE(svcMeta2.isValid());
+    EXPECT_EQ(14, svcMeta2.getGopPos());
+    EXPECT_EQ(coder.gop_, svcMeta2.getCoderParams().gop_);
+    EXPECT_EQ(3, svcMeta2.getCoderParams().temporalLayers_);
+}
+
 TEST(TestVideoThreadMeta, TestCreateFail)
 {
     uint8_t const data[] = {0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39,
@@ -1285,6 +1314,16 @@ TEST(TestWireData, TestVideoFrameSegment)
             EXPECT_EQ(header.interestArrivalMs_ + idx, wd.header().interestArrivalMs_);
             EXPECT_EQ(header.generationDelayMs_, wd.header().generationDelayMs_);
 
+            // cached view is parsed once and returned without copying
+            EXPECT_EQ(header.playbackNo_ + idx, wd.getHeader().playbackNo_);
+            EXPECT_EQ(header.pairedSequenceNo_, wd.getHeader().pairedSequenceNo_);
+            EXPECT_EQ(&wd.getHeader(), &wd.getHeader());
+            EXPECT_EQ((const void *)&wd.getHeader(), (const void *)&wd.header());
+            EXPECT_EQ(d->getContent().buf() + d->getContent().size(), wd.getPayload().data() + wd.getPayload().size());
+            ASSERT_EQ(wd.segment().getPayload().size(), wd.getPayload().size());
+            EXPECT_TRUE(std::equal(wd.getPayload().begin(), wd.getPayload().end(),
+                                   wd.segment().getPayload().begin()));
+
             idx++;
         }
     }
@@ -1328,6 +1367,8 @@ TEST(TestWireData, TestWrongData)
     WireData<VideoFrameSegmentHeader> wd(ds, boost::make_shared<ndn::Interest>(n));
     EXPECT_TRUE(wd.isValid());
     EXPECT_FALSE(wd.segment().isValid());
+    EXPECT_THROW(wd.header(), std::runtime_error);
+    EXPECT_THROW(wd.getHeader(), std::runtime_error);
 }
 
 TEST(TestWireData, TestWrongHeader)
@@ -1362,6 +1403,7 @@ TEST(TestWireData, TestWrongHeader)
         EXPECT_TRUE(wd.isValid());
         EXPECT_FALSE(wd.segment().isValid());
         EXPECT_TRUE(wd.isOriginal());
+        EXPECT_THROW(wd.getHeader(), std::runtime_error);
 
         EXPECT_EQ(header.interestNonce_, wd.header().interestNonce_);
         EXPECT_EQ(header.interestArrivalMs_, wd.header().interestArrivalMs_);
@@ -1497,6 +1539,218 @@ TEST(TestWireData, TestMergeVideoFramePacket)
     }
 }
 
+TEST(TestWireData, TestWireFormatV2)
+{
+    EXPECT_EQ(WireFormat::V1, wireFormat(WireFormatV1ApiVersion));
+    EXPECT_EQ(WireFormat::V2, wireFormat(WireFormatV2ApiVersion));
+    EXPECT_EQ(WireFormat::Unknown, wireFormat(0));
+
+    CommonHeader hdr;
+    hdr.sampleRate_ = 24.7;
+    hdr.publishTimestampMs_ = 488589553;
+    hdr.publishUnixTimestamp_ = 1460488589;
+
+    size_t frameLen = 4300;
+    int32_t size = webrtc::CalcBufferSize(webrtc::kI420, 640, 480);
+    uint8_t *buffer = (uint8_t *)malloc(frameLen);
+    for (int i = 0; i < frameLen; ++i)
+        buffer[i] = i % 255;
+
+    webrtc::EncodedImage frame(buffer, frameLen, size);
+    frame._encodedWidth = 640;
+    frame._encodedHeight = 480;
+    frame._timeStamp = 1460488589;
+    frame.capture_time_ms_ = 1460488569;
+    frame._frameType = webrtc::kVideoFrameKey;
+    frame._completeFrame = true;
+
+    VideoFramePacket vp(frame);
+    vp.setHeader(hdr);
+
+    std::vector<VideoFrameSegment> frameSegments = VideoFrameSegment::slice(vp, 1000);
+    VideoFrameSegmentHeader header;
+    header.interestNonce_ = 0x1234;
+    header.generationDelayMs_ = 200;
+    header.totalSegmentsNum_ = frameSegments.size();
+    header.playbackNo_ = 777;
+    header.pairedSequenceNo_ = 1;
+    header.temporalLayer_ = 1;
+    header.temporalLayersNum_ = 2;
+
+    std::string frameName = "/ndn/edu/ucla/remap/ndncon/instance1/ndnrtc/%FD%04/video/camera/hi/d/%FE%00";
+    std::vector<uint8_t> packetBytes;
+    int idx = 0;
+
+    for (auto &s : frameSegments)
+    {
+        s.setHeader(header);
+
+        boost::shared_ptr<NetworkData> v1 = s.getNetworkData(WireFormat::V1);
+        boost::shared_ptr<NetworkData> v2 = s.getNetworkData(WireFormat::V2, (idx == 0 ? &hdr : nullptr));
+
+        // same overhead, except for packet header copy in segment 0
+        EXPECT_EQ(v1->getLength() + (idx == 0 ? sizeof(CommonHeader) : 0), v2->getLength());
+        EXPECT_EQ((uint8_t)WireFormat::V2, v2->getData()[0]);
+
+        ndn::Name n(frameName);
+        n.appendSegment(idx);
+        boost::shared_ptr<ndn::Data> ds(boost::make_shared<ndn::Data>(n));
+        ds->getMetaInfo().setFinalBlockId(ndn::Name::Component::fromSegment(frameSegments.size() - 1));
+        ds->setContent(v2->getData(), v2->getLength());
+
+        WireData<VideoFrameSegmentHeader> wd(ds, boost::make_shared<ndn::Interest>(n, 1000));
+
+        EXPECT_EQ(WireFormatV2ApiVersion, wd.getApiVersion());
+        EXPECT_EQ(WireFormat::V2, wd.getWireFormat());
+        EXPECT_EQ(header.interestNonce_, wd.header().interestNonce_);
+        EXPECT_EQ(header.generationDelayMs_, wd.header().generationDelayMs_);
+        EXPECT_EQ(header.playbackNo_, wd.getHeader().playbackNo_);
+        EXPECT_EQ(header.pairedSequenceNo_, wd.getHeader().pairedSequenceNo_);
+        EXPECT_EQ(header.playbackNo_, wd.getPlaybackNo());
+        EXPECT_EQ(header.temporalLayer_, wd.getHeader().temporalLayer_);
+        EXPECT_EQ(header.temporalLayersNum_, wd.getHeader().temporalLayersNum_);
+
+        // headers are read in place
+        EXPECT_EQ(ds->getContent().buf() + sizeof(SegmentPrefixV2), (const uint8_t *)&wd.getHeader());
+
+        if (idx == 0)
+        {
+            EXPECT_EQ(hdr.sampleRate_, wd.packetHeader().sampleRate_);
+            EXPECT_EQ(hdr.publishTimestampMs_, wd.packetHeader().publishTimestampMs_);
+            EXPECT_EQ(hdr.publishUnixTimestamp_, wd.packetHeader().publishUnixTimestamp_);
+        }
+        else
+            EXPECT_ANY_THROW(wd.packetHeader());
+
+        ASSERT_EQ(s.getPayload().size(), wd.getPayload().size());
+        EXPECT_TRUE(std::equal(s.getPayload().begin(), s.getPayload().end(), wd.getPayload().begin()));
+        packetBytes.insert(packetBytes.end(), wd.getPayload().begin(), wd.getPayload().end());
+        idx++;
+    }
+
+    // packet format is the same for both segment formats
+    NetworkData packetData(boost::move(packetBytes));
+    VideoFramePacket packet(boost::move(packetData));
+
+    EXPECT_EQ(hdr.publishTimestampMs_, packet.getHeader().publishTimestampMs_);
+    EXPECT_EQ(frame._encodedWidth, packet.getFrame()._encodedWidth);
+    ASSERT_EQ(frame._length, packet.getFrame()._length);
+    EXPECT_TRUE(std::equal(frame._buffer, frame._buffer + frame._length, packet.getFrame()._buffer));
+
+    // every segment reserves space for packet header copy, so no V2 segment
+    // exceeds segment wire length and all but the last one have equal payload
+    size_t reserve = VideoFrameSegment::packetHeaderReserve(WireFormat::V2);
+    std::vector<VideoFrameSegment> v2Segments = VideoFrameSegment::slice(vp, 1000, reserve);
+
+    EXPECT_EQ(sizeof(CommonHeader), reserve);
+    EXPECT_EQ(0, VideoFrameSegment::packetHeaderReserve(WireFormat::V1));
+    EXPECT_EQ(VideoFrameSegment::numSlices(vp, 1000, reserve), v2Segments.size());
+    EXPECT_EQ(frameSegments[0].getPayload().size() - reserve, v2Segments[0].getPayload().size());
+
+    size_t payloadSize = 0;
+    idx = 0;
+    for (auto &s : v2Segments)
+    {
+        s.setHeader(header);
+        EXPECT_GE(1000, s.getNetworkData(WireFormat::V2, (idx == 0 ? &hdr : nullptr))->getLength());
+        if (++idx < v2Segments.size())
+            EXPECT_EQ(VideoFrameSegment::slicePayloadLength(1000, reserve), s.getPayload().size());
+        payloadSize += s.getPayload().size();
+    }
+    EXPECT_EQ(vp.getLength(), payloadSize);
+
+    free(buffer);
+}
+
+TEST(TestWireData, TestHeaderExtension)
+{
+    std::vector<uint8_t> data;
+    for (int i = 0; i < 3000; ++i)
+        data.push_back((uint8_t)i);
+
+    NetworkData nd(data);
+    size_t minSize = HeaderTraits<VideoFrameSegmentHeader>::minSize();
+
+    EXPECT_EQ(sizeof(VideoFrameSegmentHeader) - 2, minSize);
+
+    for (auto format : {WireFormat::V1, WireFormat::V2})
+        for (unsigned char layersNum = 1; layersNum <= 3; layersNum += 2)
+        {
+            std::vector<VideoFrameSegment> segments = VideoFrameSegment::slice(nd, 1000);
+            VideoFrameSegment &s = segments.front();
+            VideoFrameSegmentHeader header;
+            header.interestNonce_ = 0x1234;
+            header.totalSegmentsNum_ = segments.size();
+            header.playbackNo_ = 777;
+            header.pairedSequenceNo_ = 1;
+            header.paritySegmentsNum_ = 2;
+            header.temporalLayer_ = (layersNum > 1 ? 2 : 0);
+            header.temporalLayersNum_ = layersNum;
+            s.setHeader(header);
+
+            // extension is not published for threads without temporal layers
+            size_t headerSize = (layersNum > 1 ? sizeof(VideoFrameSegmentHeader) : minSize);
+            boost::shared_ptr<NetworkData> segmentData = s.getNetworkData(format);
+
+            EXPECT_EQ(DataPacket::wireLength(s.getPayload().size(), headerSize), s.size());
+            EXPECT_EQ(s.size(), segmentData->getLength());
+
+            ndn::Name n((format == WireFormat::V1 ?
+                "/ndn/edu/ucla/remap/ndncon/instance1/ndnrtc/%FD%03/video/camera/hi/d/%FE%00" :
+                "/ndn/edu/ucla/remap/ndncon/instance1/ndnrtc/%FD%04/video/camera/hi/d/%FE%00"));
+            n.appendSegment(0);
+            boost::shared_ptr<ndn::Data> ds(boost::make_shared<ndn::Data>(n));
+            ds->getMetaInfo().setFinalBlockId(ndn::Name::Component::fromSegment(segments.size() - 1));
+            ds->setContent(segmentData->getData(), segmentData->getLength());
+
+            WireData<VideoFrameSegmentHeader> wd(ds, boost::make_shared<ndn::Interest>(n, 1000));
+
+            EXPECT_TRUE(wd.isValid());
+            EXPECT_EQ(header.interestNonce_, wd.header().interestNonce_);
+            EXPECT_EQ(header.totalSegmentsNum_, wd.getHeader().totalSegmentsNum_);
+            EXPECT_EQ(header.playbackNo_, wd.getHeader().playbackNo_);
+            EXPECT_EQ(header.pairedSequenceNo_, wd.getHeader().pairedSequenceNo_);
+            EXPECT_EQ(header.paritySegmentsNum_, wd.getHeader().paritySegmentsNum_);
+            EXPECT_EQ(header.temporalLayer_, wd.getHeader().temporalLayer_);
+            EXPECT_EQ(header.temporalLayersNum_, wd.getHeader().temporalLayersNum_);
+            // header copy is made once
+            EXPECT_EQ(&wd.getHeader(), &wd.getHeader());
+
+            ASSERT_EQ(s.getPayload().size(), wd.getPayload().size());
+            EXPECT_TRUE(std::equal(s.getPayload().begin(), s.getPayload().end(), wd.getPayload().begin()));
+
+            if (format == WireFormat::V1)
+            {
+                EXPECT_TRUE(wd.segment().isValid());
+                EXPECT_EQ(header.playbackNo_, wd.segment().getHeader().playbackNo_);
+                EXPECT_EQ(header.temporalLayersNum_, wd.segment().getHeader().temporalLayersNum_);
+            }
+        }
+}
+
+TEST(TestWireData, TestWireFormatV2Malformed)
+{
+    std::string frameName = "/ndn/edu/ucla/remap/ndncon/instance1/ndnrtc/%FD%04/video/camera/hi/d/%FE%00/%00%00";
+    boost::shared_ptr<ndn::Data> ds(boost::make_shared<ndn::Data>(ndn::Name(frameName)));
+    ds->getMetaInfo().setFinalBlockId(ndn::Name::Component::fromSegment(0));
+
+    SegmentPrefixV2 prefix;
+    prefix.format_ = (uint8_t)WireFormat::V2;
+    prefix.flags_ = SegmentFlagPacketHeader;
+    prefix.headerSize_ = sizeof(VideoFrameSegmentHeader);
+
+    // content is shorter than headers declared in prefix
+    std::vector<uint8_t> content((uint8_t *)&prefix, (uint8_t *)&prefix + sizeof(prefix));
+    content.resize(content.size() + sizeof(VideoFrameSegmentHeader), 0);
+    ds->setContent(content);
+
+    WireData<VideoFrameSegmentHeader> wd(ds, boost::make_shared<ndn::Interest>(ds->getName(), 1000));
+    EXPECT_EQ(WireFormat::V2, wd.getWireFormat());
+    EXPECT_THROW(wd.header(), std::runtime_error);
+    EXPECT_THROW(wd.packetHeader(), std::runtime_error);
+    EXPECT_EQ(0, wd.getPayload().size());
+}
+
 TEST(TestWireData, TestMergeAudioBundle)
 {
     int data_len = 247;
@@ -1605,6 +1859,25 @@ TEST(TestManifest, TestWithDummySignature)
 
     for (auto &o : allObjects)
         EXPECT_TRUE(m.hasData(*o));
+    EXPECT_TRUE(m.hasData(allSegments));
+
+    // manifest stores implicit digests
+    for (int i = 0; i < m.getBlobsNum(); ++i)
+    {
+        ndn::Blob digest = (*allSegments[i]->getFullName())[-1].getValue();
+        EXPECT_TRUE(ndn::Blob(m.getBlob(i).data(), m.getBlob(i).size()).equals(digest));
+    }
+
+    {
+        boost::shared_ptr<ndn::Data> alien(boost::make_shared<ndn::Data>(*allObjects[0]));
+        alien->setContent((const uint8_t *)"alien", 5);
+
+        std::vector<boost::shared_ptr<const ndn::Data>> withAlien(allSegments);
+        withAlien.push_back(alien);
+
+        EXPECT_FALSE(m.hasData(*alien));
+        EXPECT_FALSE(m.hasData(withAlien));
+    }
 
     GT_PRINTF("Manifest packet of %d segments (frame size %d bytes) has total length of %d bytes\n",
               m.size(), frameSize, m.getLength());
@@ -1618,6 +1891,40 @@ TEST(TestManifest, TestWithDummySignature)
         EXPECT_TRUE(im.hasData(*o));
 }
 
+TEST(TestManifest, TestNeverEncoded)
+{
+    std::string frameName = "/ndn/edu/ucla/remap/ndncon/instance1/ndnrtc/%FD%03/video/camera/hi/d/%FE%07";
+    VideoFramePacket vp = getVideoFramePacket(10000);
+    std::vector<VideoFrameSegment> segments = sliceFrame(vp);
+    std::vector<boost::shared_ptr<ndn::Data>> dataObjects = dataFromSegments(frameName, segments);
+    std::vector<boost::shared_ptr<const ndn::Data>> allSegments;
+
+    // unsigned data, neither encoded nor asked for full name
+    for (auto &o : dataObjects)
+    {
+        ASSERT_EQ(0, o->getDefaultWireEncoding().size());
+        allSegments.push_back(o);
+    }
+
+    Manifest m(allSegments);
+
+    ASSERT_EQ(allSegments.size(), m.size());
+    for (int i = 0; i < m.getBlobsNum(); ++i)
+    {
+        // copy of data, so manifest can't rely on encoding cached above
+        ndn::Data d(*dataObjects[i]);
+        ndn::Blob digest = (*d.getFullName())[-1].getValue();
+        EXPECT_TRUE(ndn::Blob(m.getBlob(i).data(), m.getBlob(i).size()).equals(digest));
+    }
+
+    // distinct segments have distinct digests
+    for (int i = 1; i < m.getBlobsNum(); ++i)
+        EXPECT_FALSE(ndn::Blob(m.getBlob(i).data(), m.getBlob(i).size()).equals(ndn::Blob(m.getBlob(0).data(), m.getBlob(0).size())));
+
+    for (auto &o : dataObjects)
+        EXPECT_TRUE(m.hasData(ndn::Data(*o)));
+}
+
 //******************************************************************************
 int main(int argc, char **argv)
 {
@@ -0,0 +1,131 @@
+//
+// test-object-pool.cc
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#include <stdlib.h>
+#include <stdexcept>
+
+#include <boost/make_shared.hpp>
+#include <boost/weak_ptr.hpp>
+
+#include "gtest/gtest.h"
+#include "src/object-pool.hpp"
+
+using namespace ndnrtc;
+
+namespace {
+	class Sample {
+	public:
+		int value_;
+
+		Sample(int value) : value_(value) { nAlive++; }
+		~Sample() { nAlive--; }
+
+		static int nAlive;
+	};
+
+	int Sample::nAlive = 0;
+
+	class Throwing {
+	public:
+		Throwing(bool fail) { if (fail) throw std::runtime_error("failed"); }
+	};
+
+	class Private {
+	public:
+		int value_;
+	private:
+		friend class ndnrtc::ObjectPool;
+		Private(int value) : value_(value) {}
+	};
+}
+
+TEST(TestObjectPool, TestReuse)
+{
+	boost::shared_ptr<ObjectPool> pool = boost::make_shared<ObjectPool>();
+	void *p = nullptr;
+
+	{
+		boost::shared_ptr<Sample> s = pool->make<Sample>(1);
+		EXPECT_EQ(1, s->value_);
+		EXPECT_EQ(1, Sample::nAlive);
+		p = s.get();
+	}
+
+	EXPECT_EQ(0, Sample::nAlive);
+	// object and its' control block are back in the pool
+	EXPECT_EQ(2, pool->getFreeBlocksNum());
+	EXPECT_EQ(2, pool->getHeapAllocationsNum());
+
+	for (int i = 0; i < 100; ++i)
+	{
+		boost::shared_ptr<Sample> s = pool->make<Sample>(i);
+		EXPECT_EQ(p, s.get());
+		EXPECT_EQ(i, s->value_);
+	}
+
+	EXPECT_EQ(2, pool->getHeapAllocationsNum());
+	EXPECT_EQ(0, Sample::nAlive);
+}
+
+TEST(TestObjectPool, TestGrow)
+{
+	boost::shared_ptr<ObjectPool> pool = boost::make_shared<ObjectPool>();
+	std::vector<boost::shared_ptr<Sample>> samples;
+
+	for (int i = 0; i < 10; ++i)
+		samples.push_back(pool->make<Sample>(i));
+
+	EXPECT_EQ(20, pool->getHeapAllocationsNum());
+	EXPECT_EQ(0, pool->getFreeBlocksNum());
+
+	samples.clear();
+	EXPECT_EQ(20, pool->getFreeBlocksNum());
+
+	for (int i = 0; i < 10; ++i)
+		samples.push_back(pool->make<Sample>(i));
+	EXPECT_EQ(20, pool->getHeapAllocationsNum());
+}
+
+TEST(TestObjectPool, TestOutlivesOwner)
+{
+	boost::shared_ptr<ObjectPool> pool = boost::make_shared<ObjectPool>();
+	boost::weak_ptr<ObjectPool> weakPool(pool);
+	boost::shared_ptr<Sample> s = pool->make<Sample>(7);
+
+	// stream is destroyed while segment is still held elsewhere
+	pool.reset();
+	EXPECT_FALSE(weakPool.expired());
+	EXPECT_EQ(7, s->value_);
+
+	s.reset();
+	EXPECT_TRUE(weakPool.expired());
+	EXPECT_EQ(0, Sample::nAlive);
+}
+
+TEST(TestObjectPool, TestConstructorThrows)
+{
+	boost::shared_ptr<ObjectPool> pool = boost::make_shared<ObjectPool>();
+
+	EXPECT_ANY_THROW(pool->make<Throwing>(true));
+	EXPECT_EQ(1, pool->getFreeBlocksNum());
+
+	boost::shared_ptr<Throwing> t = pool->make<Throwing>(false);
+	EXPECT_EQ(2, pool->getHeapAllocationsNum());
+}
+
+TEST(TestObjectPool, TestPrivateConstructor)
+{
+	boost::shared_ptr<ObjectPool> pool = boost::make_shared<ObjectPool>();
+	boost::shared_ptr<Private> p = pool->make<Private>(3);
+
+	EXPECT_EQ(3, p->value_);
+}
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
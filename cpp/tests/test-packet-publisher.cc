@@ -922,6 +922,60 @@ TEST(TestPacketPublisher, TestBenchmarkNoSigning)
     }
 }
 
+TEST(TestPacketPublisher, TestRawBytesNoSigning)
+{
+    Face face("aleph.ndn.ucla.edu");
+    std::string appPrefix = "/ndn/edu/ucla/remap/peter/app";
+    boost::shared_ptr<KeyChain> keyChain = memoryKeyChain(appPrefix);
+    boost::shared_ptr<MemoryContentCache> memCache = boost::make_shared<MemoryContentCache>(&face);
+
+    PublisherSettings settings;
+
+    int wireLength = 1000;
+    int freshness = 1000;
+    settings.keyChain_ = keyChain.get();
+    settings.memoryCache_ = memCache.get();
+    settings.segmentWireLength_ = wireLength;
+    settings.freshnessPeriodMs_ = freshness;
+    settings.statStorage_ = StatisticsStorage::createProducerStatistics();
+    // segments are never signed (thus never encoded) before publishing
+    settings.sign_ = false;
+
+    VideoPacketPublisher publisher(settings);
+    Name packetName("/test/1");
+    int frameLen = 5000;
+    uint8_t *buffer = (uint8_t *)malloc(frameLen);
+    for (int i = 0; i < frameLen; ++i)
+        buffer[i] = i % 255;
+
+    webrtc::EncodedImage frame(buffer, frameLen, frameLen);
+    frame._encodedWidth = 640;
+    frame._encodedHeight = 480;
+    frame._frameType = webrtc::kVideoFrameKey;
+    frame._completeFrame = true;
+
+    CommonHeader hdr;
+    VideoFramePacket vp(frame);
+    vp.setSyncList(std::map<std::string, PacketNumber>());
+    vp.setHeader(hdr);
+
+    VideoFrameSegmentHeader segHdr;
+    segHdr.totalSegmentsNum_ = VideoFrameSegment::numSlices(vp, wireLength);
+    PublishedDataPtrVector segments = publisher.publish(packetName, vp, segHdr, freshness);
+
+    size_t payloadBytes = 0, wireBytes = 0;
+    for (auto s : segments)
+    {
+        payloadBytes += s->getContent().size();
+        wireBytes += Data(*s).wireEncode().size();
+    }
+
+    ASSERT_LT(0, segments.size());
+    EXPECT_EQ(payloadBytes, (*settings.statStorage_)[Indicator::BytesPublished]);
+    EXPECT_LT(payloadBytes, (*settings.statStorage_)[Indicator::RawBytesPublished]);
+    EXPECT_EQ(wireBytes, (*settings.statStorage_)[Indicator::RawBytesPublished]);
+}
+
 int main(int argc, char **argv)
 {
     ::testing::InitGoogleTest(&argc, argv);
@@ -352,6 +352,95 @@ TEST(TestPipeliner, TestSegmentsArrive)
     }
 }
 
+TEST(TestPipeliner, TestParityOnDemand)
+{
+#ifdef ENABLE_LOGGING
+    ndnlog::new_api::Logger::initAsyncLogging();
+    ndnlog::new_api::Logger::getLogger("").setLogLevel(ndnlog::NdnLoggerDetailLevelAll);
+#endif
+
+    boost::shared_ptr<statistics::StatisticsStorage> sstorage(statistics::StatisticsStorage::createConsumerStatistics());
+    boost::shared_ptr<SampleEstimator> sampleEstimator(boost::make_shared<SampleEstimator>(sstorage));
+    boost::shared_ptr<StatisticsStorage> storage(StatisticsStorage::createConsumerStatistics());
+    boost::shared_ptr<Buffer> buffer(boost::make_shared<Buffer>(storage));
+    boost::shared_ptr<MockInterestControl> interestControl(boost::make_shared<MockInterestControl>());
+    boost::shared_ptr<MockInterestQueue> interestQueue(boost::make_shared<MockInterestQueue>());
+    boost::shared_ptr<MockPlaybackQueue> playbackQueue(boost::make_shared<MockPlaybackQueue>());
+    boost::shared_ptr<MockSegmentController> segmentController(boost::make_shared<MockSegmentController>());
+    PipelinerSettings ppSettings({1000, sampleEstimator, buffer, interestControl,
+                                  interestQueue, playbackQueue, segmentController, sstorage});
+
+    Name prefix("/ndn/edu/ucla/remap/peter/ndncon/instance1/ndnrtc/");
+    prefix.appendVersion(NameComponents::nameApiVersion()).append(Name("video/camera/hi"));
+
+    Pipeliner pp(ppSettings, boost::make_shared<Pipeliner::VideoNameScheme>());
+    pp.setParityOnDemand(true);
+
+#ifdef ENABLE_LOGGING
+    pp.setLogger(ndnlog::new_api::Logger::getLoggerPtr(""));
+#endif
+
+    OnData onData = [](const boost::shared_ptr<const ndn::Interest> &,
+                       const boost::shared_ptr<ndn::Data> &) {};
+    OnTimeout onTimeout = [](const boost::shared_ptr<const ndn::Interest> &i) {};
+
+    sampleEstimator->segmentArrived(getFakeSegment(prefix.toUri(), SampleClass::Key, SegmentClass::Data, 7, 0));
+    sampleEstimator->segmentArrived(getFakeSegment(prefix.toUri(), SampleClass::Key, SegmentClass::Parity, 7, 0));
+
+    EXPECT_CALL(*segmentController, getOnDataCallback())
+        .WillRepeatedly(Return(onData));
+    EXPECT_CALL(*segmentController, getOnTimeoutCallback())
+        .WillRepeatedly(Return(onTimeout));
+    EXPECT_CALL(*segmentController, getOnNetworkNackCallback())
+        .Times(AnyNumber());
+
+    // only data segments are requested
+    std::vector<boost::shared_ptr<const ndn::Interest>> requested;
+    EXPECT_CALL(*interestQueue, enqueueInterest(_, _, _, _, _))
+        .Times(30)
+        .WillRepeatedly(Invoke([&requested](const boost::shared_ptr<const ndn::Interest> &i,
+                                            boost::shared_ptr<ndnrtc::DeadlinePriority>, OnData, OnTimeout, OnNetworkNack) {
+            NamespaceInfo info;
+            ASSERT_TRUE(NameComponents::extractInfo(i->getName(), info));
+            EXPECT_EQ(SegmentClass::Data, info.segmentClass_);
+            requested.push_back(i);
+        }));
+
+    pp.setSequenceNumber(7, SampleClass::Key);
+    pp.setNeedSample(SampleClass::Key);
+    pp.express(prefix, true);
+
+    ASSERT_EQ(30, requested.size());
+    EXPECT_EQ(0, (*sstorage)[Indicator::ParityRequestedNum]);
+
+    // parity segments are requested upon first data timeout
+    EXPECT_CALL(*interestQueue, enqueueInterest(_, _, _, _, _))
+        .Times(6)
+        .WillRepeatedly(Invoke([prefix](const boost::shared_ptr<const ndn::Interest> &i,
+                                        boost::shared_ptr<ndnrtc::DeadlinePriority>, OnData, OnTimeout, OnNetworkNack) {
+            NamespaceInfo info;
+            ASSERT_TRUE(NameComponents::extractInfo(i->getName(), info));
+            EXPECT_EQ(SegmentClass::Parity, info.segmentClass_);
+            EXPECT_EQ(7, info.sampleNo_);
+        }));
+
+    NamespaceInfo info;
+    ASSERT_TRUE(NameComponents::extractInfo(requested[3]->getName(), info));
+    pp.segmentRequestTimeout(info, requested[3]);
+    EXPECT_EQ(6, (*sstorage)[Indicator::ParityRequestedNum]);
+
+    // parity is requested only once per sample
+    ASSERT_TRUE(NameComponents::extractInfo(requested[5]->getName(), info));
+    pp.segmentRequestTimeout(info, requested[5]);
+    pp.onRetransmissionRequired({requested[3], requested[5]});
+    EXPECT_EQ(6, (*sstorage)[Indicator::ParityRequestedNum]);
+
+    // sample that is not in the buffer
+    boost::shared_ptr<Interest> i = boost::make_shared<Interest>(Name(prefix).append(NameComponents::NameComponentDelta).appendSequenceNumber(1).appendSegment(0), 1000);
+    pp.onRetransmissionRequired({i});
+    EXPECT_EQ(6, (*sstorage)[Indicator::ParityRequestedNum]);
+}
+
 int main(int argc, char **argv)
 {
     ::testing::InitGoogleTest(&argc, argv);
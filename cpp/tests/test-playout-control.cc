@@ -78,6 +78,54 @@ TEST(TestPlayoutControl, TestDefault)
     }
 }
 #endif
+TEST(TestCatchUpController, TestSpeedUp)
+{
+    CatchUpController cuc;
+    double period = 1000./30.;
+    int64_t now = 1000;
+
+    // within tolerance
+    CatchUpController::Action a = cuc.update(now, 200, 150, period);
+    EXPECT_EQ(1., a.speed_);
+    EXPECT_FALSE(a.skip_);
+
+    // moderate excess - play faster, proportionally to excess
+    a = cuc.update(now += 300, 350, 150, period);
+    EXPECT_DOUBLE_EQ(1.1, a.speed_);
+    EXPECT_FALSE(a.skip_);
+
+    a = cuc.update(now += 300, 950, 150, period);
+    EXPECT_DOUBLE_EQ(1.+CatchUpController::MaxSpeedup, a.speed_);
+    EXPECT_FALSE(a.skip_);
+
+    // keeps accelerating until excess is mostly drained
+    a = cuc.update(now += 300, 200, 150, period);
+    EXPECT_LT(1., a.speed_);
+    a = cuc.update(now += 300, 180, 150, period);
+    EXPECT_EQ(1., a.speed_);
+    EXPECT_EQ(1., cuc.getSpeed());
+}
+
+TEST(TestCatchUpController, TestSkip)
+{
+    CatchUpController cuc;
+    double period = 1000./30.;
+    int64_t now = 10000;
+
+    CatchUpController::Action a = cuc.update(now, 150+CatchUpController::SkipThresholdMs+100, 150, period);
+    EXPECT_TRUE(a.skip_);
+    EXPECT_LT(1., a.speed_);
+
+    // skip didn't help (e.g. no key frame) - don't retry too often
+    a = cuc.update(now += 300, 150+CatchUpController::SkipThresholdMs+100, 150, period);
+    EXPECT_FALSE(a.skip_);
+    a = cuc.update(now += CatchUpController::SkipIntervalMs, 150+CatchUpController::SkipThresholdMs+100, 150, period);
+    EXPECT_TRUE(a.skip_);
+
+    cuc.reset();
+    EXPECT_EQ(1., cuc.getSpeed());
+}
+
 int main(int argc, char **argv)
 {
     ::testing::InitGoogleTest(&argc, argv);
@@ -223,6 +223,56 @@ TEST(TestPlaybackQueue, TestPlay)
 	consumerWork.reset();
 	consumer.join();
 }
+
+TEST(TestPlaybackQueue, TestSkipToKey)
+{
+	int nSamples = 40, gop = 10;
+	double fps = 30;
+	int64_t ts = 488589553, uts = 1460488589;
+	int period = (int)(1000./fps);
+	std::string streamPrefix = "/ndn/edu/ucla/remap/peter/ndncon/instance1/ndnrtc/%FD%02/video/camera";
+	std::string threadPrefix = "/ndn/edu/ucla/remap/peter/ndncon/instance1/ndnrtc/%FD%02/video/camera/hi";
+
+	boost::shared_ptr<SlotPool> pool(boost::make_shared<SlotPool>(nSamples));
+	boost::shared_ptr<StatisticsStorage> storage(StatisticsStorage::createConsumerStatistics());
+	boost::shared_ptr<Buffer> buffer(boost::make_shared<Buffer>(storage, pool));
+	boost::shared_ptr<PlaybackQueue> pqueue(boost::make_shared<PlaybackQueue>(Name(streamPrefix), buffer));
+
+	for (int n = 0; n < nSamples; ++n)
+	{
+		Name frameName(threadPrefix);
+		if (n%gop == 0)
+			frameName.append(NameComponents::NameComponentKey);
+		else
+			frameName.append(NameComponents::NameComponentDelta);
+		frameName.appendSequenceNumber(n);
+
+		VideoFramePacket vp = getVideoFramePacket(1000, fps, ts+n*period, uts+n*period);
+		std::vector<VideoFrameSegment> segments = sliceFrame(vp);
+		std::vector<boost::shared_ptr<Interest>> interests = getInterests(frameName.toUri(), 0, segments.size());
+		std::vector<boost::shared_ptr<Data>> data = dataFromSegments(frameName.toUri(), segments);
+
+		EXPECT_TRUE(buffer->requested(makeInterestsConst(interests)));
+		int idx = 0;
+		for (auto d:data)
+			buffer->received(boost::make_shared<WireData<VideoFrameSegmentHeader>>(d, interests[idx++]));
+	}
+
+	ASSERT_EQ(nSamples*period, pqueue->size());
+
+	// latest key frame leaving at least 300ms in the queue is #30
+	EXPECT_EQ(30*period, pqueue->skipToKey(300));
+	EXPECT_EQ((nSamples-30)*period, pqueue->size());
+	EXPECT_EQ(30, (*storage)[Indicator::CatchUpSkippedNum]);
+
+	// nothing to skip to - key frame #30 is in front
+	EXPECT_EQ(0, pqueue->skipToKey(0));
+
+	pqueue->pop([](const boost::shared_ptr<const BufferSlot>& slot, double playTimeMs){
+		EXPECT_FALSE(slot->getNameInfo().isDelta_);
+		EXPECT_EQ(30, slot->getNameInfo().sampleNo_);
+	});
+}
 #if 1
 TEST(TestPlayout, TestPlay)
 {
@@ -0,0 +1,271 @@
+//
+// test-preview-fetcher.cc
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#include <stdlib.h>
+#include <boost/asio.hpp>
+#include <boost/make_shared.hpp>
+#include <ndn-cpp/network-nack.hpp>
+
+#include "gtest/gtest.h"
+#include "tests-helpers.hpp"
+#include "src/preview-fetcher.hpp"
+#include "src/frame-data.hpp"
+#include "statistics.hpp"
+
+#include "mock-objects/ndn-cpp-mock.hpp"
+#include "mock-objects/buffer-observer-mock.hpp"
+#include "mock-objects/video-playout-consumer-mock.hpp"
+
+using namespace ::testing;
+using namespace ndnrtc;
+using namespace ndnrtc::statistics;
+using namespace ndn;
+
+namespace {
+	const Name threadPrefix("/ndn/edu/ucla/remap/peter/ndncon/instance1/ndnrtc/%FD%03/video/camera/%FC%00%00%01c_%27%DE%D6/hi");
+
+	typedef struct _Expressed {
+		boost::shared_ptr<const Interest> interest_;
+		OnData onData_;
+		OnTimeout onTimeout_;
+		OnNetworkNack onNack_;
+	} Expressed;
+
+	// records interests expressed by the fetcher, test answers them
+	class Network {
+	public:
+		Network():face_(boost::make_shared<MockNdnFace>())
+		{
+			ON_CALL(*face_, expressInterest(_, _, _, _, _))
+				.WillByDefault(Invoke([this](const Interest& i, const OnData& onData,
+					const OnTimeout& onTimeout, const OnNetworkNack& onNack, WireFormat&){
+					expressed_.push_back(Expressed({boost::make_shared<Interest>(i), onData, onTimeout, onNack}));
+					return expressed_.size();
+				}));
+			EXPECT_CALL(*face_, expressInterest(_, _, _, _, _)).Times(AnyNumber());
+		}
+
+		Expressed pop()
+		{
+			EXPECT_LT(0, expressed_.size());
+			Expressed e = expressed_.front();
+			expressed_.erase(expressed_.begin());
+			return e;
+		}
+
+		void reply(const Expressed& e, const boost::shared_ptr<Data>& d) { e.onData_(e.interest_, d); }
+		void timeout(const Expressed& e) { e.onTimeout_(e.interest_); }
+		void nack(const Expressed& e) { e.onNack_(e.interest_, boost::make_shared<NetworkNack>()); }
+
+		boost::shared_ptr<MockNdnFace> face_;
+		std::vector<Expressed> expressed_;
+	};
+
+	VideoThreadMeta threadMeta()
+	{
+		return VideoThreadMeta(30, 234, 7, 0, FrameSegmentsInfo(7, 3, 35, 5),
+			sampleVideoCoderParams());
+	}
+
+	// data segments (no parity) of key frame
+	std::vector<boost::shared_ptr<Data>> keyFrame(PacketNumber seqNo, PacketNumber playbackNo)
+	{
+		VideoFramePacket vp = getVideoFramePacket(5000);
+		std::vector<VideoFrameSegment> segments = sliceFrame(vp, playbackNo);
+		return dataFromSegments(Name(threadPrefix).append(NameComponents::NameComponentKey).appendSequenceNumber(seqNo).toUri(),
+			segments);
+	}
+
+	boost::shared_ptr<PreviewFetcher> makeFetcher(boost::asio::io_service& io, Network& network,
+		const boost::shared_ptr<StatisticsStorage>& storage, unsigned int keyStep = 1,
+		const boost::shared_ptr<IBufferObserver>& validator = boost::shared_ptr<IBufferObserver>())
+	{
+		return boost::make_shared<PreviewFetcher>(io, network.face_, threadPrefix, threadMeta(),
+			keyStep, storage, validator);
+	}
+}
+
+TEST(TestPreviewFetcher, TestFetchKeyFrames)
+{
+	boost::asio::io_service io;
+	Network network;
+	boost::shared_ptr<StatisticsStorage> storage(StatisticsStorage::createConsumerStatistics());
+	boost::shared_ptr<MockBufferObserver> validator(boost::make_shared<MockBufferObserver>());
+	MockVideoPlayoutConsumer consumer;
+	boost::shared_ptr<PreviewFetcher> fetcher = makeFetcher(io, network, storage, 2, validator);
+	std::vector<boost::shared_ptr<Data>> frame = keyFrame(7, 70);
+
+	ASSERT_LT(1, frame.size());
+	EXPECT_CALL(*validator, onNewRequest(_)).Times(1);
+	EXPECT_CALL(*validator, onNewData(_)).Times(frame.size());
+	EXPECT_CALL(consumer, processFrame(_, _))
+		.WillOnce(Invoke([](const FrameInfo& finfo, const webrtc::EncodedImage& image){
+			EXPECT_EQ(70, finfo.playbackNo_);
+			EXPECT_TRUE(checkVideoFrame(image));
+		}));
+
+	fetcher->start(&consumer);
+	EXPECT_EQ(2000, fetcher->getPreviewIntervalMs());
+
+	// latest key frame
+	ASSERT_EQ(1, network.expressed_.size());
+	Expressed rightmost = network.pop();
+	EXPECT_EQ(Name(threadPrefix).append(NameComponents::NameComponentKey), rightmost.interest_->getName());
+	EXPECT_EQ(1, rightmost.interest_->getChildSelector());
+	EXPECT_TRUE(rightmost.interest_->getMustBeFresh());
+
+	// first segment triggers requests for remaining data segments
+	network.reply(rightmost, frame[0]);
+	ASSERT_EQ(frame.size()-1, network.expressed_.size());
+	for (size_t i = 1; i < frame.size(); ++i)
+		EXPECT_EQ(frame[i]->getName(), network.expressed_[i-1].interest_->getName());
+
+	std::vector<Expressed> segments(network.expressed_);
+	network.expressed_.clear();
+	for (size_t i = 1; i < frame.size(); ++i)
+		network.reply(segments[i-1], frame[i]);
+
+	// first segment of keyStep-th next key frame, waiting for it to be published
+	ASSERT_EQ(1, network.expressed_.size());
+	Expressed next = network.pop();
+	EXPECT_EQ(Name(threadPrefix).append(NameComponents::NameComponentKey).appendSequenceNumber(9).appendSegment(0),
+		next.interest_->getName());
+	EXPECT_EQ(fetcher->getPreviewIntervalMs() + PreviewFetcher::DefaultInterestLifetimeMs,
+		next.interest_->getInterestLifetimeMilliseconds());
+
+	EXPECT_EQ(1, (*storage)[Indicator::PlayedKeyNum]);
+	EXPECT_EQ(7, (*storage)[Indicator::LastPlayedKeyNo]);
+	EXPECT_EQ(frame.size(), (*storage)[Indicator::SegmentsReceivedNum]);
+	EXPECT_EQ(0, (*storage)[Indicator::SkippedNum]);
+
+	fetcher->stop();
+}
+
+TEST(TestPreviewFetcher, TestTimeoutRtx)
+{
+	boost::asio::io_service io;
+	Network network;
+	boost::shared_ptr<StatisticsStorage> storage(StatisticsStorage::createConsumerStatistics());
+	MockVideoPlayoutConsumer consumer;
+	boost::shared_ptr<PreviewFetcher> fetcher = makeFetcher(io, network, storage);
+	std::vector<boost::shared_ptr<Data>> frame = keyFrame(7, 70);
+
+	EXPECT_CALL(consumer, processFrame(_, _)).Times(1);
+	fetcher->start(&consumer);
+
+	// timeout of first interest - latest key frame is requested again
+	network.timeout(network.pop());
+	ASSERT_EQ(1, network.expressed_.size());
+	EXPECT_EQ(1, network.expressed_[0].interest_->getChildSelector());
+
+	network.reply(network.pop(), frame[0]);
+	ASSERT_EQ(frame.size()-1, network.expressed_.size());
+
+	// missing segment is re-requested once
+	Expressed seg1 = network.pop();
+	network.timeout(seg1);
+	ASSERT_EQ(frame.size()-1, network.expressed_.size());
+	Expressed rtx = network.expressed_.back();
+	network.expressed_.pop_back();
+	EXPECT_EQ(seg1.interest_->getName(), rtx.interest_->getName());
+	EXPECT_EQ(1, (*storage)[Indicator::RtxNum]);
+
+	// retransmission arrives, frame is assembled
+	network.reply(rtx, frame[1]);
+	std::vector<Expressed> segments(network.expressed_);
+	network.expressed_.clear();
+	for (size_t i = 2; i < frame.size(); ++i)
+		network.reply(segments[i-2], frame[i]);
+
+	EXPECT_EQ(1, (*storage)[Indicator::PlayedKeyNum]);
+	EXPECT_EQ(0, (*storage)[Indicator::SkippedNum]);
+	EXPECT_EQ(2, (*storage)[Indicator::TimeoutsNum]);
+	ASSERT_EQ(1, network.expressed_.size());
+	EXPECT_EQ(Name(threadPrefix).append(NameComponents::NameComponentKey).appendSequenceNumber(8).appendSegment(0),
+		network.expressed_[0].interest_->getName());
+
+	fetcher->stop();
+}
+
+TEST(TestPreviewFetcher, TestDrop)
+{
+	boost::asio::io_service io;
+	Network network;
+	boost::shared_ptr<StatisticsStorage> storage(StatisticsStorage::createConsumerStatistics());
+	MockVideoPlayoutConsumer consumer;
+	boost::shared_ptr<PreviewFetcher> fetcher = makeFetcher(io, network, storage);
+	std::vector<boost::shared_ptr<Data>> frame = keyFrame(7, 70);
+
+	EXPECT_CALL(consumer, processFrame(_, _)).Times(0);
+	fetcher->start(&consumer);
+	network.reply(network.pop(), frame[0]);
+
+	Expressed seg1 = network.pop();
+	std::vector<Expressed> segments(network.expressed_);
+	network.expressed_.clear();
+
+	// segment times out twice - frame is dropped, next key frame is requested
+	network.timeout(seg1);
+	ASSERT_EQ(1, network.expressed_.size());
+	network.timeout(network.pop());
+
+	EXPECT_EQ(1, (*storage)[Indicator::SkippedNum]);
+	ASSERT_EQ(1, network.expressed_.size());
+	EXPECT_EQ(Name(threadPrefix).append(NameComponents::NameComponentKey).appendSequenceNumber(8).appendSegment(0),
+		network.expressed_[0].interest_->getName());
+
+	// late segments of dropped frame are ignored
+	size_t nReceived = (*storage)[Indicator::SegmentsReceivedNum];
+	for (size_t i = 2; i < frame.size(); ++i)
+		network.reply(segments[i-2], frame[i]);
+	EXPECT_EQ(nReceived, (*storage)[Indicator::SegmentsReceivedNum]);
+	EXPECT_EQ(0, (*storage)[Indicator::PlayedKeyNum]);
+	EXPECT_EQ(1, network.expressed_.size());
+
+	fetcher->stop();
+}
+
+TEST(TestPreviewFetcher, TestNackRetry)
+{
+	boost::asio::io_service io;
+	Network network;
+	boost::shared_ptr<StatisticsStorage> storage(StatisticsStorage::createConsumerStatistics());
+	MockVideoPlayoutConsumer consumer;
+	boost::shared_ptr<PreviewFetcher> fetcher = makeFetcher(io, network, storage);
+
+	EXPECT_CALL(consumer, processFrame(_, _)).Times(0);
+	fetcher->start(&consumer);
+
+	// latest key frame is re-requested after a pause, on io thread
+	network.nack(network.pop());
+	EXPECT_EQ(0, network.expressed_.size());
+	EXPECT_EQ(1, (*storage)[Indicator::NacksNum]);
+
+	io.run_one();
+	ASSERT_EQ(1, network.expressed_.size());
+	EXPECT_EQ(1, network.expressed_[0].interest_->getChildSelector());
+
+	// application NACK is handled the same way
+	boost::shared_ptr<Data> appNack(boost::make_shared<Data>(Name(threadPrefix).append(NameComponents::NameComponentKey).appendSequenceNumber(7).appendSegment(0)));
+	appNack->getMetaInfo().setType(ndn_ContentType_NACK);
+	network.reply(network.pop(), appNack);
+	EXPECT_EQ(0, network.expressed_.size());
+	EXPECT_EQ(1, (*storage)[Indicator::AppNackNum]);
+
+	io.reset();
+	io.run_one();
+	ASSERT_EQ(1, network.expressed_.size());
+	EXPECT_EQ(1, network.expressed_[0].interest_->getChildSelector());
+
+	fetcher->stop();
+}
+
+int main(int argc, char **argv)
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,191 @@
+//
+// test-rate-adaptation.cc
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#include <stdlib.h>
+#include <algorithm>
+
+#include "gtest/gtest.h"
+#include "src/rate-adaptation-module.hpp"
+#include "src/drd-estimator.hpp"
+#include "statistics.hpp"
+
+using namespace ndnrtc;
+using namespace ndnrtc::statistics;
+
+namespace {
+	StreamEntry streams[] = {{0, 1000, 0.2}, {1, 300, 0.2}, {2, 3000, 0.2}};
+
+	double streamLoad(unsigned int streamId)
+	{
+		for (auto& s:streams)
+			if (s.id_ == streamId) return s.bitrate_*(1+s.parityRatio_);
+		return 0;
+	}
+
+	// simulates fetching over the link of given capacity for durationMs.
+	// whatever exceeds link capacity is lost. returns timestamp of the last tick
+	int64_t fetch(RateAdaptationModule& ram, int64_t startMs, int64_t durationMs,
+		double capacityKbps, unsigned int& streamId)
+	{
+		static const int tickMs = 50, segSize = 1000;
+		double bytes = 0, lostBytes = 0;
+		double rate;
+
+		for (int64_t t = startMs+tickMs; t <= startMs+durationMs; t += tickMs)
+		{
+			double load = streamLoad(streamId);
+
+			bytes += std::min(load, capacityKbps)*tickMs/8.;
+			lostBytes += std::max(0., load-capacityKbps)*tickMs/8.;
+			for (; bytes >= segSize; bytes -= segSize)
+			{
+				ram.interestExpressed("/seg", streamId);
+				ram.dataReceived("/seg", streamId, segSize, 100, 0);
+			}
+			for (; lostBytes >= segSize; lostBytes -= segSize)
+			{
+				ram.interestExpressed("/seg", streamId);
+				ram.interestTimeout("/seg", streamId);
+			}
+			ram.getInterestRate(t, rate, streamId);
+		}
+
+		return startMs+durationMs;
+	}
+}
+
+TEST(TestRateAdaptation, TestInitialize)
+{
+	boost::shared_ptr<DrdEstimator> drd;
+	boost::shared_ptr<StatisticsStorage> storage;
+	RateAdaptationModule ram(drd, storage);
+
+	EXPECT_EQ(-1, ram.initialize(CodecModeNormal, 0, streams));
+	EXPECT_EQ(-1, ram.initialize(CodecModeNormal, 3, nullptr));
+	EXPECT_EQ(-2, ram.initialize(CodecModeSVC, 3, streams));
+	EXPECT_EQ(0, ram.initialize(CodecModeNormal, 3, streams));
+
+	// starts from the lowest bitrate stream
+	EXPECT_EQ(1, ram.getCurrentStream());
+
+	ram.setCurrentStream(2);
+	EXPECT_EQ(2, ram.getCurrentStream());
+	ram.setCurrentStream(5);
+	EXPECT_EQ(2, ram.getCurrentStream());
+}
+
+TEST(TestRateAdaptation, TestStepDownOnLoss)
+{
+	boost::shared_ptr<StatisticsStorage> storage(StatisticsStorage::createConsumerStatistics());
+	boost::shared_ptr<DrdEstimator> drd;
+	RateAdaptationModule ram(drd, storage);
+	unsigned int streamId = 2;
+	double rate;
+
+	ASSERT_EQ(0, ram.initialize(CodecModeNormal, 3, streams));
+	ram.setCurrentStream(streamId);
+	ram.getInterestRate(1000, rate, streamId);
+
+	int64_t t = fetch(ram, 1000, 3000, 5000, streamId);
+	EXPECT_EQ(2, streamId);
+	EXPECT_FALSE(ram.isCongested());
+	EXPECT_NEAR(3600, ram.getThroughputKbps(), 200);
+	EXPECT_NEAR(3600, (*storage)[Indicator::ThroughputEstimate], 200);
+
+	// 450 segments of 1000 bytes per second
+	ram.getInterestRate(t, rate, streamId);
+	EXPECT_NEAR(450, rate, 30);
+
+	// link can sustain only 1300Kbps - should switch to 1000Kbps stream
+	t = fetch(ram, t, 3000, 1300, streamId);
+	EXPECT_EQ(0, streamId);
+	EXPECT_EQ(0, ram.getCurrentStream());
+	EXPECT_FALSE(ram.isCongested());
+}
+
+TEST(TestRateAdaptation, TestStepUpAfterHold)
+{
+	boost::shared_ptr<DrdEstimator> drd;
+	boost::shared_ptr<StatisticsStorage> storage;
+	RateAdaptationModule ram(drd, storage);
+	unsigned int streamId = 1;
+	double rate;
+
+	ASSERT_EQ(0, ram.initialize(CodecModeNormal, 3, streams));
+	ram.getInterestRate(1000, rate, streamId);
+
+	int64_t t = fetch(ram, 1000, RateAdaptationModule::UpswitchHoldMs-500, 5000, streamId);
+	EXPECT_EQ(1, streamId);
+
+	// probes one step up at a time
+	t = fetch(ram, t, 1000, 5000, streamId);
+	EXPECT_EQ(0, streamId);
+
+	t = fetch(ram, t, RateAdaptationModule::UpswitchHoldMs-1000, 5000, streamId);
+	EXPECT_EQ(0, streamId);
+	t = fetch(ram, t, 1500, 5000, streamId);
+	EXPECT_EQ(2, streamId);
+}
+
+TEST(TestRateAdaptation, TestFailedProbeBacksOff)
+{
+	boost::shared_ptr<DrdEstimator> drd;
+	boost::shared_ptr<StatisticsStorage> storage;
+	RateAdaptationModule ram(drd, storage);
+	unsigned int streamId = 0;
+	double rate;
+
+	ASSERT_EQ(0, ram.initialize(CodecModeNormal, 3, streams));
+	ram.setCurrentStream(streamId);
+	ram.getInterestRate(1000, rate, streamId);
+
+	int64_t t = fetch(ram, 1000, RateAdaptationModule::UpswitchHoldMs+500, 2000, streamId);
+	ASSERT_EQ(2, streamId);
+
+	// higher stream doesn't fit - back to lower one
+	t = fetch(ram, t, 2000, 2000, streamId);
+	ASSERT_EQ(0, streamId);
+
+	// next probe must wait twice as long
+	t = fetch(ram, t, RateAdaptationModule::UpswitchHoldMs+500, 2000, streamId);
+	EXPECT_EQ(0, streamId);
+	t = fetch(ram, t, RateAdaptationModule::UpswitchHoldMs-1500, 2000, streamId);
+	EXPECT_EQ(2, streamId);
+}
+
+TEST(TestRateAdaptation, TestDrdGrowth)
+{
+	boost::shared_ptr<DrdEstimator> drd(new DrdEstimator());
+	boost::shared_ptr<StatisticsStorage> storage;
+	RateAdaptationModule ram(drd, storage);
+	unsigned int streamId = 2;
+	double rate;
+
+	ASSERT_EQ(0, ram.initialize(CodecModeNormal, 3, streams));
+	ram.setCurrentStream(streamId);
+	ram.getInterestRate(1000, rate, streamId);
+
+	for (int i = 0; i < 50; ++i)
+		drd->newValue(100+i%2, true, 0);
+
+	int64_t t = fetch(ram, 1000, 2000, 5000, streamId);
+	EXPECT_FALSE(ram.isCongested());
+	EXPECT_EQ(2, streamId);
+
+	// queues are building up - no losses yet, but DRD grows
+	for (int i = 0; i < 100; ++i)
+		drd->newValue(400+i%2, true, 0);
+
+	t = fetch(ram, t, 500, 5000, streamId);
+	EXPECT_TRUE(ram.isCongested());
+	EXPECT_EQ(0, streamId);
+}
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
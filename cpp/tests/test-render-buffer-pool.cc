@@ -0,0 +1,156 @@
+//
+// test-render-buffer-pool.cc
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <boost/weak_ptr.hpp>
+
+#include "gtest/gtest.h"
+#include "src/render-buffer-pool.hpp"
+
+using namespace ndnrtc;
+
+namespace {
+	WebRtcVideoFrame makeFrame(int w, int h)
+	{
+		rtc::scoped_refptr<WebRtcVideoFrameBuffer> buffer = WebRtcVideoFrameBuffer::Create(w, h);
+
+		for (int row = 0; row < h; ++row)
+			memset(buffer->MutableDataY() + row*buffer->StrideY(), 0x10, w);
+		for (int row = 0; row < (h+1)/2; ++row)
+		{
+			memset(buffer->MutableDataU() + row*buffer->StrideU(), 0x20, (w+1)/2);
+			memset(buffer->MutableDataV() + row*buffer->StrideV(), 0x30, (w+1)/2);
+		}
+
+		return WebRtcVideoFrame(buffer, webrtc::kVideoRotation_0, 0);
+	}
+}
+
+TEST(TestRenderBufferPool, TestI420ZeroCopy)
+{
+	RenderBufferPool pool(IExternalPlanarRenderer::kI420, 3);
+	WebRtcVideoFrame frame = makeFrame(640, 480);
+	PlanarFrame pf;
+
+	ASSERT_TRUE(pool.acquire(frame, pf));
+	EXPECT_EQ(3, pf.nPlanes_);
+	EXPECT_EQ(640, pf.width_);
+	EXPECT_EQ(480, pf.height_);
+	EXPECT_EQ(frame.video_frame_buffer()->DataY(), pf.planes_[0]);
+	EXPECT_EQ(frame.video_frame_buffer()->DataU(), pf.planes_[1]);
+	EXPECT_EQ(frame.video_frame_buffer()->DataV(), pf.planes_[2]);
+	EXPECT_EQ(frame.video_frame_buffer()->StrideY(), pf.strides_[0]);
+	EXPECT_EQ(2, pool.getFreeNum());
+
+	pool.releaseFrame(pf);
+	EXPECT_EQ(3, pool.getFreeNum());
+}
+
+TEST(TestRenderBufferPool, TestNV12)
+{
+	int w = 15, h = 11;
+	RenderBufferPool pool(IExternalPlanarRenderer::kNV12, 2);
+	WebRtcVideoFrame frame = makeFrame(w, h);
+	PlanarFrame pf;
+
+	ASSERT_TRUE(pool.acquire(frame, pf));
+	EXPECT_EQ(2, pf.nPlanes_);
+	EXPECT_EQ(w, pf.strides_[0]);
+	EXPECT_EQ(16, pf.strides_[1]);
+
+	for (int row = 0; row < h; ++row)
+		for (int col = 0; col < w; ++col)
+			EXPECT_EQ(0x10, pf.planes_[0][row*pf.strides_[0]+col]);
+
+	for (int row = 0; row < (h+1)/2; ++row)
+		for (int col = 0; col < (w+1)/2; ++col)
+		{
+			EXPECT_EQ(0x20, pf.planes_[1][row*pf.strides_[1]+2*col]);
+			EXPECT_EQ(0x30, pf.planes_[1][row*pf.strides_[1]+2*col+1]);
+		}
+
+	pool.releaseFrame(pf);
+}
+
+TEST(TestRenderBufferPool, TestExhausted)
+{
+	RenderBufferPool pool(IExternalPlanarRenderer::kI420, 3);
+	WebRtcVideoFrame frame = makeFrame(320, 240);
+	PlanarFrame pf[4];
+
+	for (int i = 0; i < 3; ++i)
+		ASSERT_TRUE(pool.acquire(frame, pf[i]));
+
+	EXPECT_FALSE(pool.acquire(frame, pf[3]));
+	EXPECT_EQ(0, pool.getFreeNum());
+
+	// release out of order
+	pool.releaseFrame(pf[1]);
+	ASSERT_TRUE(pool.acquire(frame, pf[3]));
+	EXPECT_EQ(pf[1].bufferIdx_, pf[3].bufferIdx_);
+
+	pool.releaseFrame(pf[0]);
+	pool.releaseFrame(pf[2]);
+	pool.releaseFrame(pf[3]);
+	EXPECT_EQ(3, pool.getFreeNum());
+}
+
+TEST(TestRenderBufferPool, TestDecoderBufferHeld)
+{
+	RenderBufferPool pool(IExternalPlanarRenderer::kI420, 3);
+	PlanarFrame pf;
+
+	{
+		WebRtcVideoFrame frame = makeFrame(320, 240);
+		ASSERT_TRUE(pool.acquire(frame, pf));
+		EXPECT_FALSE(frame.video_frame_buffer()->HasOneRef());
+	}
+
+	// frame is gone, but its buffer must still be valid until released
+	EXPECT_EQ(0x10, pf.planes_[0][0]);
+	pool.releaseFrame(pf);
+}
+
+TEST(TestRenderBufferPool, TestOutlivesOwner)
+{
+	boost::shared_ptr<RenderBufferPool> pool = RenderBufferPool::create(IExternalPlanarRenderer::kNV12, 3);
+	boost::weak_ptr<RenderBufferPool> weakPool(pool);
+	IRenderBufferReleaser *releaser = pool.get();
+	PlanarFrame pf1, pf2;
+
+	ASSERT_TRUE(pool->acquire(makeFrame(320, 240), pf1));
+	ASSERT_TRUE(pool->acquire(makeFrame(320, 240), pf2));
+
+	// stream replaced or destroyed the pool while renderer holds frames
+	pool.reset();
+	EXPECT_FALSE(weakPool.expired());
+	EXPECT_EQ(0x10, pf1.planes_[0][0]);
+
+	releaser->releaseFrame(pf1);
+	EXPECT_FALSE(weakPool.expired());
+	EXPECT_EQ(0x10, pf2.planes_[0][0]);
+
+	releaser->releaseFrame(pf2);
+	EXPECT_TRUE(weakPool.expired());
+}
+
+TEST(TestRenderBufferPool, TestBadRelease)
+{
+	RenderBufferPool pool(IExternalPlanarRenderer::kI420, 3);
+	PlanarFrame pf;
+	pf.bufferIdx_ = 3;
+
+	EXPECT_ANY_THROW(pool.releaseFrame(pf));
+	EXPECT_ANY_THROW(RenderBufferPool(IExternalPlanarRenderer::kNV12, 0));
+}
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
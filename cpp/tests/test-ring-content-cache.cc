@@ -0,0 +1,239 @@
+//
+// test-ring-content-cache.cc
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#include <stdlib.h>
+#include <boost/make_shared.hpp>
+#include <ndn-cpp/face.hpp>
+
+#include "gtest/gtest.h"
+#include "src/ring-content-cache.hpp"
+#include "statistics.hpp"
+
+using namespace ndnrtc;
+using namespace ndnrtc::statistics;
+using namespace ndn;
+
+namespace {
+	const Name threadPrefix("/ndn/edu/ucla/remap/peter/ndncon/instance1/ndnrtc/%FD%03/video/camera/%FC%00%00%01c_%27%DE%D6/hi");
+
+	Name segmentName(std::string cls, PacketNumber seqNo, unsigned int segNo)
+	{
+		return Name(threadPrefix).append(cls).appendSequenceNumber(seqNo).appendSegment(segNo);
+	}
+
+	Data makeData(const Name& name, size_t size = 1000, unsigned int freshnessMs = 1000)
+	{
+		Data d(name);
+		std::vector<uint8_t> content(size, 0);
+
+		d.setContent(content);
+		d.getMetaInfo().setFreshnessPeriod(freshnessMs);
+		return d;
+	}
+}
+
+TEST(TestRingContentCache, TestAddFind)
+{
+	Face face("aleph.ndn.ucla.edu");
+	boost::shared_ptr<StatisticsStorage> storage(StatisticsStorage::createProducerStatistics());
+	RingContentCache cache(&face, 1024*1024, storage);
+
+	for (int seg = 0; seg < 3; ++seg)
+	{
+		cache.add(makeData(segmentName("d", 7, seg)));
+		cache.add(makeData(segmentName("k", 7, seg)));
+	}
+	cache.add(makeData(Name(threadPrefix).append("d").appendSequenceNumber(7).append("_parity").appendSegment(0)));
+
+	{ // exact segment name
+		boost::shared_ptr<const Data> d = cache.find(Interest(segmentName("d", 7, 1)));
+		ASSERT_TRUE(d.get());
+		EXPECT_EQ(segmentName("d", 7, 1), d->getName());
+	}
+	{ // key and delta samples don't collide
+		boost::shared_ptr<const Data> d = cache.find(Interest(segmentName("k", 7, 2)));
+		ASSERT_TRUE(d.get());
+		EXPECT_EQ(segmentName("k", 7, 2), d->getName());
+	}
+	{ // parity
+		Name n = Name(threadPrefix).append("d").appendSequenceNumber(7).append("_parity").appendSegment(0);
+		boost::shared_ptr<const Data> d = cache.find(Interest(n));
+		ASSERT_TRUE(d.get());
+		EXPECT_EQ(n, d->getName());
+	}
+	{ // sample prefix
+		boost::shared_ptr<const Data> d = cache.find(Interest(Name(threadPrefix).append("d").appendSequenceNumber(7)));
+		ASSERT_TRUE(d.get());
+	}
+
+	EXPECT_FALSE(cache.find(Interest(segmentName("d", 7, 3))).get());
+	EXPECT_FALSE(cache.find(Interest(segmentName("d", 8, 0))).get());
+	EXPECT_LT(0, (*storage)[Indicator::CacheBytes]);
+	EXPECT_EQ(cache.getBytes(), (*storage)[Indicator::CacheBytes]);
+}
+
+TEST(TestRingContentCache, TestByteBudget)
+{
+	Face face("aleph.ndn.ucla.edu");
+	boost::shared_ptr<StatisticsStorage> storage(StatisticsStorage::createProducerStatistics());
+	RingContentCache cache(&face, 5000, storage);
+
+	for (int seq = 0; seq < 10; ++seq)
+	{
+		cache.add(makeData(segmentName("d", seq, 0)));
+		EXPECT_GE(cache.getByteBudget(), cache.getBytes());
+	}
+
+	// oldest segments are evicted first
+	EXPECT_FALSE(cache.find(Interest(segmentName("d", 0, 0))).get());
+	EXPECT_TRUE(cache.find(Interest(segmentName("d", 9, 0))).get());
+	EXPECT_LT(0, (*storage)[Indicator::CacheEvictedNum]);
+}
+
+TEST(TestRingContentCache, TestUnsignedDataSize)
+{
+	Face face("aleph.ndn.ucla.edu");
+	boost::shared_ptr<StatisticsStorage> storage(StatisticsStorage::createProducerStatistics());
+	RingContentCache cache(&face, 1024*1024, storage);
+	// never signed nor encoded
+	Data d = makeData(segmentName("d", 1, 0));
+
+	ASSERT_EQ(0, d.getDefaultWireEncoding().size());
+	cache.add(d);
+
+	size_t wireSize = Data(d).wireEncode().size();
+	EXPECT_LT(1000, wireSize);
+	EXPECT_EQ(wireSize, cache.getBytes());
+	EXPECT_EQ(wireSize, (*storage)[Indicator::CacheBytes]);
+
+	boost::shared_ptr<const Data> cached = cache.find(Interest(segmentName("d", 1, 0)));
+	ASSERT_TRUE(cached.get());
+	EXPECT_EQ(wireSize, cached->getDefaultWireEncoding().size());
+}
+
+TEST(TestRingContentCache, TestRingOverwrite)
+{
+	Face face("aleph.ndn.ucla.edu");
+	boost::shared_ptr<StatisticsStorage> storage(StatisticsStorage::createProducerStatistics());
+	RingContentCache cache(&face, 1024*1024, storage, 4);
+
+	for (int seq = 0; seq < 6; ++seq)
+		for (int seg = 0; seg < 2; ++seg)
+			cache.add(makeData(segmentName("d", seq, seg)));
+
+	// samples 0 and 1 were replaced by 4 and 5
+	EXPECT_FALSE(cache.find(Interest(segmentName("d", 0, 0))).get());
+	EXPECT_FALSE(cache.find(Interest(segmentName("d", 1, 1))).get());
+	EXPECT_TRUE(cache.find(Interest(segmentName("d", 2, 0))).get());
+	EXPECT_TRUE(cache.find(Interest(segmentName("d", 5, 1))).get());
+	EXPECT_EQ(4, (*storage)[Indicator::CacheEvictedNum]);
+
+	// late segments of overwritten samples are not cached
+	size_t bytes = cache.getBytes();
+	cache.add(makeData(segmentName("d", 1, 2)));
+	EXPECT_EQ(bytes, cache.getBytes());
+	EXPECT_FALSE(cache.find(Interest(segmentName("d", 1, 2))).get());
+}
+
+TEST(TestRingContentCache, TestFreshness)
+{
+	Face face("aleph.ndn.ucla.edu");
+	boost::shared_ptr<StatisticsStorage> storage(StatisticsStorage::createProducerStatistics());
+	RingContentCache cache(&face, 1024*1024, storage);
+
+	cache.setMinimumCacheLifetime(1000);
+	cache.add(makeData(segmentName("d", 1, 0), 100, 10));
+	usleep(20000);
+
+	Interest fresh(segmentName("d", 1, 0));
+	fresh.setMustBeFresh(true);
+	Interest any(segmentName("d", 1, 0));
+	any.setMustBeFresh(false);
+
+	// stale segment is kept for minimum lifetime, but only served to
+	// interests that don't require fresh data
+	EXPECT_FALSE(cache.find(fresh).get());
+	EXPECT_TRUE(cache.find(any).get());
+}
+
+TEST(TestRingContentCache, TestMeta)
+{
+	Face face("aleph.ndn.ucla.edu");
+	boost::shared_ptr<StatisticsStorage> storage(StatisticsStorage::createProducerStatistics());
+	RingContentCache cache(&face, 1024*1024, storage);
+	Name metaPrefix = Name(threadPrefix).append("_meta");
+
+	for (int v = 0; v < 3; ++v)
+		cache.add(makeData(Name(metaPrefix).appendVersion(v).appendSegment(0)));
+
+	Interest rightmost(metaPrefix);
+	rightmost.setChildSelector(1);
+	boost::shared_ptr<const Data> d = cache.find(rightmost);
+	ASSERT_TRUE(d.get());
+	EXPECT_EQ(Name(metaPrefix).appendVersion(2).appendSegment(0), d->getName());
+
+	d = cache.find(Interest(metaPrefix));
+	ASSERT_TRUE(d.get());
+	EXPECT_EQ(Name(metaPrefix).appendVersion(0).appendSegment(0), d->getName());
+
+	EXPECT_FALSE(cache.find(Interest(Name(threadPrefix).append("_other"))).get());
+}
+
+TEST(TestRingContentCache, TestLatestKey)
+{
+	Face face("aleph.ndn.ucla.edu");
+	boost::shared_ptr<StatisticsStorage> storage(StatisticsStorage::createProducerStatistics());
+	RingContentCache cache(&face, 1024*1024, storage, 4);
+	Name keyPrefix = Name(threadPrefix).append("k");
+
+	Interest rightmost(keyPrefix);
+	rightmost.setChildSelector(1);
+	rightmost.setMustBeFresh(true);
+	EXPECT_FALSE(cache.find(rightmost).get());
+
+	// ring of 4 slots - samples 0 and 1 are overwritten
+	for (int seq = 0; seq < 6; ++seq)
+		cache.add(makeData(segmentName("k", seq, 0)));
+	cache.add(makeData(segmentName("d", 100, 0)));
+
+	boost::shared_ptr<const Data> d = cache.find(rightmost);
+	ASSERT_TRUE(d.get());
+	EXPECT_EQ(segmentName("k", 5, 0), d->getName());
+}
+
+TEST(TestRingContentCache, TestPendingInterests)
+{
+	Face face("aleph.ndn.ucla.edu");
+	boost::shared_ptr<StatisticsStorage> storage(StatisticsStorage::createProducerStatistics());
+	RingContentCache cache(&face, 1024*1024, storage);
+
+	cache.onInterest(boost::make_shared<Name>(threadPrefix),
+		boost::make_shared<Interest>(Name(threadPrefix).append("d").appendSequenceNumber(10)),
+		face, 0, boost::shared_ptr<const InterestFilter>());
+	cache.onInterest(boost::make_shared<Name>(threadPrefix),
+		boost::make_shared<Interest>(segmentName("k", 2, 0)),
+		face, 0, boost::shared_ptr<const InterestFilter>());
+
+	EXPECT_EQ(2, cache.getPendingInterestsNum());
+	EXPECT_EQ(2, (*storage)[Indicator::CacheMissNum]);
+	EXPECT_EQ(0, (*storage)[Indicator::CacheHitNum]);
+
+	RingContentCache::PendingInterests pending;
+	cache.getPendingInterestsForName(segmentName("d", 10, 3), pending);
+	EXPECT_EQ(1, pending.size());
+
+	cache.getPendingInterestsWithPrefix(threadPrefix, pending);
+	EXPECT_EQ(2, pending.size());
+
+	cache.getPendingInterestsForName(segmentName("d", 11, 0), pending);
+	EXPECT_EQ(0, pending.size());
+}
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,164 @@
+//
+// test-scaling-pyramid.cc
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "gtest/gtest.h"
+#include "src/scaling-pyramid.hpp"
+#include "statistics.hpp"
+
+using namespace ndnrtc;
+using namespace ndnrtc::statistics;
+
+namespace {
+	WebRtcVideoFrame makeFrame(int w, int h)
+	{
+		rtc::scoped_refptr<WebRtcVideoFrameBuffer> buffer = WebRtcVideoFrameBuffer::Create(w, h);
+
+		for (int row = 0; row < h; ++row)
+			memset(buffer->MutableDataY() + row*buffer->StrideY(), 0x10, w);
+		for (int row = 0; row < (h+1)/2; ++row)
+		{
+			memset(buffer->MutableDataU() + row*buffer->StrideU(), 0x20, (w+1)/2);
+			memset(buffer->MutableDataV() + row*buffer->StrideV(), 0x30, (w+1)/2);
+		}
+
+		return WebRtcVideoFrame(buffer, webrtc::kVideoRotation_0, 0);
+	}
+}
+
+TEST(TestScalingPyramid, TestLevels)
+{
+	boost::shared_ptr<StatisticsStorage> storage(StatisticsStorage::createProducerStatistics());
+	ScalingPyramid pyramid(storage);
+	WebRtcVideoFrame frame = makeFrame(1280, 720);
+	std::vector<std::pair<unsigned int, unsigned int>> levels;
+	std::vector<webrtc::VideoFrameBuffer*> buffers;
+
+	pyramid.addLevel(320, 180);
+	pyramid.addLevel(1280, 720);
+	pyramid.addLevel(640, 360);
+	pyramid.addLevel(1280, 720);
+	EXPECT_EQ(3, pyramid.getLevelsNum());
+
+	pyramid.scale(frame, [&levels, &buffers](unsigned int w, unsigned int h, const WebRtcVideoFrame& f){
+		EXPECT_EQ(w, f.width());
+		EXPECT_EQ(h, f.height());
+		levels.push_back(std::make_pair(w, h));
+		buffers.push_back(f.video_frame_buffer().get());
+	});
+
+	// largest first
+	ASSERT_EQ(3, levels.size());
+	EXPECT_EQ(std::make_pair(1280u, 720u), levels[0]);
+	EXPECT_EQ(std::make_pair(640u, 360u), levels[1]);
+	EXPECT_EQ(std::make_pair(320u, 180u), levels[2]);
+
+	// input resolution is not scaled
+	EXPECT_EQ(frame.video_frame_buffer().get(), buffers[0]);
+	EXPECT_EQ(1, (*storage)[Indicator::ScaleSkippedNum]);
+	EXPECT_EQ(2, (*storage)[Indicator::ScaledNum]);
+
+	// level is removed when there are no more users
+	pyramid.removeLevel(1280, 720);
+	EXPECT_EQ(3, pyramid.getLevelsNum());
+	pyramid.removeLevel(1280, 720);
+	EXPECT_EQ(2, pyramid.getLevelsNum());
+}
+
+TEST(TestScalingPyramid, TestScaledContent)
+{
+	boost::shared_ptr<StatisticsStorage> storage(StatisticsStorage::createProducerStatistics());
+	ScalingPyramid pyramid(storage);
+	WebRtcVideoFrame frame = makeFrame(1920, 1080);
+	int nLevels = 0;
+
+	pyramid.addLevel(1280, 720);
+	pyramid.addLevel(640, 360);
+	pyramid.addLevel(320, 180);
+
+	pyramid.scale(frame, [&nLevels](unsigned int w, unsigned int h, const WebRtcVideoFrame& f){
+		rtc::scoped_refptr<webrtc::VideoFrameBuffer> b = f.video_frame_buffer();
+
+		// uniform planes stay uniform after scaling from any level
+		EXPECT_EQ(0x10, b->DataY()[(h/2)*b->StrideY() + w/2]);
+		EXPECT_EQ(0x20, b->DataU()[(h/4)*b->StrideU() + w/4]);
+		EXPECT_EQ(0x30, b->DataV()[(h/4)*b->StrideV() + w/4]);
+		nLevels++;
+	});
+
+	EXPECT_EQ(3, nLevels);
+	EXPECT_EQ(0, (*storage)[Indicator::ScaleSkippedNum]);
+	EXPECT_EQ(3, (*storage)[Indicator::ScaledNum]);
+	EXPECT_LE(0, (*storage)[Indicator::ScaleTime]);
+}
+
+TEST(TestScalingPyramid, TestBufferReuse)
+{
+	boost::shared_ptr<StatisticsStorage> storage(StatisticsStorage::createProducerStatistics());
+	ScalingPyramid pyramid(storage);
+	WebRtcVideoFrame frame = makeFrame(1280, 720);
+	webrtc::VideoFrameBuffer *released = nullptr, *reused = nullptr, *fresh = nullptr;
+	std::vector<WebRtcVideoFrame> held;
+
+	pyramid.addLevel(640, 360);
+
+	// buffer is returned to the pool once frame is released
+	pyramid.scale(frame, [&released](unsigned int, unsigned int, const WebRtcVideoFrame& f){
+		released = f.video_frame_buffer().get();
+	});
+	pyramid.scale(frame, [&reused, &held](unsigned int, unsigned int, const WebRtcVideoFrame& f){
+		reused = f.video_frame_buffer().get();
+		held.push_back(f);
+	});
+	EXPECT_EQ(released, reused);
+
+	// buffer held by encoder is not re-used
+	pyramid.scale(frame, [&fresh](unsigned int, unsigned int, const WebRtcVideoFrame& f){
+		fresh = f.video_frame_buffer().get();
+	});
+	EXPECT_NE(reused, fresh);
+}
+
+TEST(TestScalingPyramid, TestAspectRatio)
+{
+	boost::shared_ptr<StatisticsStorage> storage(StatisticsStorage::createProducerStatistics());
+	ScalingPyramid pyramid(storage);
+	WebRtcVideoFrame frame = makeFrame(1280, 720);
+	rtc::scoped_refptr<WebRtcVideoFrameBuffer> input(static_cast<WebRtcVideoFrameBuffer*>(frame.video_frame_buffer().get()));
+
+	// side bands which are cropped out of 4:3 frame
+	for (int row = 0; row < 720; ++row)
+	{
+		memset(input->MutableDataY() + row*input->StrideY(), 0x80, 160);
+		memset(input->MutableDataY() + row*input->StrideY() + 1120, 0x80, 160);
+	}
+
+	pyramid.addLevel(640, 480);
+	pyramid.addLevel(320, 180);
+
+	// 16:9 level is scaled from the input, not from (cropped) 4:3 level
+	int nLevels = 0;
+	pyramid.scale(frame, [&nLevels](unsigned int w, unsigned int h, const WebRtcVideoFrame& f){
+		rtc::scoped_refptr<webrtc::VideoFrameBuffer> b = f.video_frame_buffer();
+		uint8_t edge = (w == 640 ? 0x10 : 0x80);
+
+		EXPECT_EQ(edge, b->DataY()[(h/2)*b->StrideY() + 5]);
+		EXPECT_EQ(edge, b->DataY()[(h/2)*b->StrideY() + w - 5]);
+		EXPECT_EQ(0x10, b->DataY()[(h/2)*b->StrideY() + w/2]);
+		nLevels++;
+	});
+
+	EXPECT_EQ(2, nLevels);
+	EXPECT_EQ(2, (*storage)[Indicator::ScaledNum]);
+}
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,234 @@
+//
+// test-shared-fetch-observer.cc
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#include <stdlib.h>
+#include <boost/asio.hpp>
+#include <boost/make_shared.hpp>
+
+#include "gtest/gtest.h"
+#include "src/shared-fetch-observer.hpp"
+#include "src/stream-registry.hpp"
+#include "src/frame-data.hpp"
+#include "statistics.hpp"
+#include "tests-helpers.hpp"
+#include "mock-objects/buffer-mock.hpp"
+#include "mock-objects/segment-controller-observer-mock.hpp"
+
+using namespace ::testing;
+using namespace ndnrtc;
+using namespace ndnrtc::statistics;
+
+namespace {
+	const std::string threadPrefix = "/ndn/edu/ucla/remap/peter/ndncon/instance1/ndnrtc/%FD%03/video/camera/%FC%00%00%01c_%27%DE%D6/hi";
+
+	std::string sampleName(PacketNumber seqNo)
+	{
+		ndn::Name n(threadPrefix);
+		n.append(NameComponents::NameComponentDelta).appendSequenceNumber(seqNo);
+		return n.toUri();
+	}
+
+	ndn::Name samplePrefix(const boost::shared_ptr<BufferSlot> &slot)
+	{
+		return slot->getNameInfo().getPrefix(prefix_filter::Sample);
+	}
+
+	// owner's slot with all segments of a sample received
+	std::vector<BufferReceipt> receiveSample(const std::string &frameName,
+		boost::shared_ptr<BufferSlot> &slot)
+	{
+		VideoFramePacket vp = getVideoFramePacket();
+		std::vector<VideoFrameSegment> segments = sliceFrame(vp);
+		std::vector<boost::shared_ptr<ndn::Data>> dataObjects = dataFromSegments(frameName, segments);
+		std::vector<boost::shared_ptr<ndn::Interest>> interests = getInterests(frameName, 0, dataObjects.size());
+		std::vector<BufferReceipt> receipts;
+
+		slot = boost::make_shared<BufferSlot>();
+		slot->segmentsRequested(makeInterestsConst(interests));
+
+		for (int idx = 0; idx < dataObjects.size(); ++idx)
+		{
+			boost::shared_ptr<WireData<VideoFrameSegmentHeader>> wd(
+				boost::make_shared<WireData<VideoFrameSegmentHeader>>(dataObjects[idx], interests[idx]));
+			BufferReceipt receipt;
+
+			receipt.oldState_ = slot->getState();
+			receipt.segment_ = slot->segmentReceived(wd);
+			receipt.slot_ = slot;
+			receipts.push_back(receipt);
+		}
+
+		return receipts;
+	}
+
+	void drain(boost::asio::io_service &io)
+	{
+		io.run();
+		io.reset();
+	}
+}
+
+TEST(TestSharedFetchObserver, TestHoldUntilVerified)
+{
+	boost::asio::io_service io;
+	boost::shared_ptr<MockBuffer> buffer = boost::make_shared<MockBuffer>();
+	boost::shared_ptr<MockSegmentControllerObserver> bufferControl = boost::make_shared<MockSegmentControllerObserver>();
+	boost::shared_ptr<StatisticsStorage> sstorage(StatisticsStorage::createConsumerStatistics());
+	SharedFetchObserver observer(io, buffer, bufferControl, sstorage);
+	boost::shared_ptr<BufferSlot> slot;
+	std::vector<BufferReceipt> receipts = receiveSample(sampleName(1), slot);
+
+	ASSERT_LT(1, receipts.size());
+	EXPECT_CALL(*buffer, requested(_)).Times(0);
+	EXPECT_CALL(*bufferControl, segmentArrived(_)).Times(0);
+
+	for (auto &r : receipts)
+		observer.onNewData(r);
+	drain(io);
+	EXPECT_EQ(1, observer.getPendingSamplesNum());
+	Mock::VerifyAndClearExpectations(buffer.get());
+	Mock::VerifyAndClearExpectations(bufferControl.get());
+
+	// segments go through requested() and then buffer control, on this
+	// stream's thread only
+	{
+		InSequence s;
+		EXPECT_CALL(*buffer, requested(SizeIs(receipts.size()))).WillOnce(Return(true));
+		EXPECT_CALL(*buffer, isRequested(_)).Times(receipts.size()).WillRepeatedly(Return(true));
+	}
+	EXPECT_CALL(*bufferControl, segmentArrived(_)).Times(receipts.size());
+
+	observer.onVerified(samplePrefix(slot), BufferSlot::Verification::Verified);
+	EXPECT_EQ(0, observer.getPendingSamplesNum());
+	drain(io);
+
+	EXPECT_EQ(receipts.size(), (*sstorage)[Indicator::SharedSegmentsNum]);
+}
+
+TEST(TestSharedFetchObserver, TestDropOnValidationFailure)
+{
+	boost::asio::io_service io;
+	boost::shared_ptr<MockBuffer> buffer = boost::make_shared<MockBuffer>();
+	boost::shared_ptr<MockSegmentControllerObserver> bufferControl = boost::make_shared<MockSegmentControllerObserver>();
+	boost::shared_ptr<StatisticsStorage> sstorage(StatisticsStorage::createConsumerStatistics());
+	SharedFetchObserver observer(io, buffer, bufferControl, sstorage);
+	boost::shared_ptr<BufferSlot> slot1, slot2;
+	std::vector<BufferReceipt> receipts1 = receiveSample(sampleName(1), slot1);
+	std::vector<BufferReceipt> receipts2 = receiveSample(sampleName(2), slot2);
+
+	EXPECT_CALL(*buffer, requested(_)).Times(0);
+	EXPECT_CALL(*buffer, isRequested(_)).Times(0);
+	EXPECT_CALL(*bufferControl, segmentArrived(_)).Times(0);
+
+	for (auto &r : receipts1)
+		observer.onNewData(r);
+	for (auto &r : receipts2)
+		observer.onNewData(r);
+	EXPECT_EQ(2, observer.getPendingSamplesNum());
+
+	// failed and unverifiable samples are dropped
+	observer.onVerified(samplePrefix(slot1), BufferSlot::Verification::Failed);
+	observer.onVerified(samplePrefix(slot2), BufferSlot::Verification::Unknown);
+	EXPECT_EQ(0, observer.getPendingSamplesNum());
+
+	// and can't be forwarded afterwards
+	observer.onVerified(samplePrefix(slot1), BufferSlot::Verification::Verified);
+	drain(io);
+
+	EXPECT_EQ(0, (*sstorage)[Indicator::SharedSegmentsNum]);
+}
+
+TEST(TestSharedFetchObserver, TestEviction)
+{
+	boost::asio::io_service io;
+	boost::shared_ptr<MockBuffer> buffer = boost::make_shared<MockBuffer>();
+	boost::shared_ptr<MockSegmentControllerObserver> bufferControl = boost::make_shared<MockSegmentControllerObserver>();
+	boost::shared_ptr<StatisticsStorage> sstorage(StatisticsStorage::createConsumerStatistics());
+	SharedFetchObserver observer(io, buffer, bufferControl, sstorage);
+	std::vector<boost::shared_ptr<BufferSlot>> slots;
+	size_t nSegments = 0;
+
+	for (PacketNumber seqNo = 0; seqNo <= SharedFetchObserver::MaxPendingSamples; ++seqNo)
+	{
+		boost::shared_ptr<BufferSlot> slot;
+		std::vector<BufferReceipt> receipts = receiveSample(sampleName(seqNo), slot);
+
+		slots.push_back(slot);
+		nSegments = receipts.size();
+		for (auto &r : receipts)
+			observer.onNewData(r);
+	}
+
+	// oldest sample was never verified by owner and has been evicted
+	EXPECT_EQ(SharedFetchObserver::MaxPendingSamples, observer.getPendingSamplesNum());
+
+	EXPECT_CALL(*buffer, requested(_)).Times(1).WillOnce(Return(true));
+	EXPECT_CALL(*buffer, isRequested(_)).Times(nSegments).WillRepeatedly(Return(true));
+	EXPECT_CALL(*bufferControl, segmentArrived(_)).Times(nSegments);
+
+	observer.onVerified(samplePrefix(slots.front()), BufferSlot::Verification::Verified);
+	observer.onVerified(samplePrefix(slots.back()), BufferSlot::Verification::Verified);
+	drain(io);
+
+	EXPECT_EQ(SharedFetchObserver::MaxPendingSamples-1, observer.getPendingSamplesNum());
+}
+
+TEST(TestSharedFetchObserver, TestOwnerLeft)
+{
+	StreamRegistry *registry = StreamRegistry::getSharedInstance();
+	boost::asio::io_service io;
+	boost::shared_ptr<MockBuffer> buffer = boost::make_shared<MockBuffer>();
+	boost::shared_ptr<MockSegmentControllerObserver> bufferControl = boost::make_shared<MockSegmentControllerObserver>();
+	boost::shared_ptr<StatisticsStorage> sstorage(StatisticsStorage::createConsumerStatistics());
+	boost::shared_ptr<SharedFetchObserver> subscriber = boost::make_shared<SharedFetchObserver>(io, buffer, bufferControl, sstorage);
+	int nClosed = 0;
+	bool isOwner = false;
+
+	boost::shared_ptr<FetchFanOut> owner = registry->acquire(threadPrefix, nullptr, FetchFanOut::OnClosed(), isOwner);
+	ASSERT_TRUE(isOwner);
+	registry->acquire(threadPrefix, subscriber.get(), [&nClosed](){ nClosed++; }, isOwner,
+		[subscriber](const ndn::Name &samplePrefix, BufferSlot::Verification status){
+			subscriber->onVerified(samplePrefix, status);
+		});
+	ASSERT_FALSE(isOwner);
+
+	boost::shared_ptr<BufferSlot> slot1, slot2;
+	std::vector<BufferReceipt> receipts1 = receiveSample(sampleName(1), slot1);
+	std::vector<BufferReceipt> receipts2 = receiveSample(sampleName(2), slot2);
+
+	for (auto &r : receipts1)
+		owner->onNewData(r);
+	EXPECT_EQ(1, subscriber->getPendingSamplesNum());
+
+	// owner's reset drops pending samples and resets subscriber's buffer
+	EXPECT_CALL(*buffer, reset()).Times(1);
+	owner->onReset();
+	EXPECT_EQ(0, subscriber->getPendingSamplesNum());
+	drain(io);
+
+	for (auto &r : receipts2)
+		owner->onNewData(r);
+	EXPECT_EQ(1, subscriber->getPendingSamplesNum());
+
+	// owner leaves before verifying the sample - subscriber gets notified
+	// and verification results of the old owner are not delivered anymore
+	EXPECT_CALL(*buffer, requested(_)).Times(0);
+	EXPECT_CALL(*bufferControl, segmentArrived(_)).Times(0);
+
+	registry->release(owner);
+	EXPECT_EQ(1, nClosed);
+	owner->onVerified(samplePrefix(slot2), BufferSlot::Verification::Verified);
+	drain(io);
+
+	EXPECT_EQ(1, subscriber->getPendingSamplesNum());
+	EXPECT_EQ(0, registry->size());
+}
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
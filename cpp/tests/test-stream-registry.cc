@@ -0,0 +1,157 @@
+//
+// test-stream-registry.cc
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#include <stdlib.h>
+#include <boost/make_shared.hpp>
+
+#include "gtest/gtest.h"
+#include "src/stream-registry.hpp"
+#include "mock-objects/buffer-observer-mock.hpp"
+
+using namespace ::testing;
+using namespace ndnrtc;
+
+namespace {
+	const std::string threadPrefix = "/ndn/edu/ucla/remap/peter/ndncon/instance1/ndnrtc/%FD%03/video/camera/hi";
+}
+
+TEST(TestStreamRegistry, TestOwnerAndSubscribers)
+{
+	StreamRegistry *registry = StreamRegistry::getSharedInstance();
+	MockBufferObserver s1, s2;
+	int nClosed = 0;
+	bool isOwner = false;
+
+	EXPECT_FALSE(registry->isFetched(threadPrefix));
+
+	boost::shared_ptr<FetchFanOut> owner = registry->acquire(threadPrefix, &s1, [&nClosed](){ nClosed++; }, isOwner);
+	ASSERT_TRUE(owner.get());
+	EXPECT_TRUE(isOwner);
+	EXPECT_TRUE(registry->isFetched(threadPrefix));
+	EXPECT_EQ(0, owner->getSubscribersNum());
+
+	boost::shared_ptr<FetchFanOut> f1 = registry->acquire(threadPrefix, &s1, [&nClosed](){ nClosed++; }, isOwner);
+	EXPECT_FALSE(isOwner);
+	EXPECT_EQ(owner, f1);
+	boost::shared_ptr<FetchFanOut> f2 = registry->acquire(threadPrefix, &s2, [&nClosed](){ nClosed++; }, isOwner);
+	EXPECT_FALSE(isOwner);
+	EXPECT_EQ(owner, f2);
+	EXPECT_EQ(2, owner->getSubscribersNum());
+	EXPECT_EQ(1, registry->size());
+
+	BufferReceipt receipt;
+	EXPECT_CALL(s1, onNewData(_)).Times(2);
+	EXPECT_CALL(s2, onNewData(_)).Times(1);
+	EXPECT_CALL(s1, onReset()).Times(1);
+	EXPECT_CALL(s2, onReset()).Times(1);
+
+	owner->onNewData(receipt);
+	owner->onReset();
+	f2->unsubscribe(&s2);
+	EXPECT_EQ(1, owner->getSubscribersNum());
+	owner->onNewData(receipt);
+
+	registry->release(owner);
+	EXPECT_EQ(1, nClosed);
+	EXPECT_FALSE(registry->isFetched(threadPrefix));
+	EXPECT_EQ(0, owner->getSubscribersNum());
+	EXPECT_EQ(0, registry->size());
+}
+
+TEST(TestStreamRegistry, TestSubscriberTakesOver)
+{
+	StreamRegistry *registry = StreamRegistry::getSharedInstance();
+	MockBufferObserver s1, s2;
+	boost::shared_ptr<FetchFanOut> newOwner;
+	bool isOwner = false;
+
+	boost::shared_ptr<FetchFanOut> owner = registry->acquire(threadPrefix, nullptr, FetchFanOut::OnClosed(), isOwner);
+	ASSERT_TRUE(isOwner);
+
+	// first subscriber to get notified becomes the new owner,
+	// second subscribes to it
+	registry->acquire(threadPrefix, &s1, [&](){
+		bool o = false;
+		newOwner = registry->acquire(threadPrefix, &s1, FetchFanOut::OnClosed(), o);
+		EXPECT_TRUE(o);
+	}, isOwner);
+	registry->acquire(threadPrefix, &s2, [&](){
+		bool o = true;
+		EXPECT_EQ(newOwner, registry->acquire(threadPrefix, &s2, FetchFanOut::OnClosed(), o));
+		EXPECT_FALSE(o);
+	}, isOwner);
+
+	registry->release(owner);
+	ASSERT_TRUE(newOwner.get());
+	EXPECT_NE(owner, newOwner);
+	EXPECT_EQ(1, newOwner->getSubscribersNum());
+
+	// stale fan-out can't release thread prefix
+	registry->release(owner);
+	EXPECT_TRUE(registry->isFetched(threadPrefix));
+
+	registry->release(newOwner);
+	EXPECT_EQ(0, registry->size());
+}
+
+TEST(TestStreamRegistry, TestThreadsAreIndependent)
+{
+	StreamRegistry *registry = StreamRegistry::getSharedInstance();
+	bool isOwner = false;
+
+	boost::shared_ptr<FetchFanOut> hi = registry->acquire(threadPrefix, nullptr, FetchFanOut::OnClosed(), isOwner);
+	EXPECT_TRUE(isOwner);
+	boost::shared_ptr<FetchFanOut> low = registry->acquire(threadPrefix+"-low", nullptr, FetchFanOut::OnClosed(), isOwner);
+	EXPECT_TRUE(isOwner);
+	EXPECT_NE(hi, low);
+	EXPECT_EQ(2, registry->size());
+
+	registry->release(hi);
+	registry->release(low);
+	EXPECT_EQ(0, registry->size());
+}
+
+TEST(TestStreamRegistry, TestVerificationFanOut)
+{
+	StreamRegistry *registry = StreamRegistry::getSharedInstance();
+	MockBufferObserver s1, s2;
+	std::vector<std::pair<ndn::Name, BufferSlot::Verification>> results;
+	bool isOwner = false;
+
+	boost::shared_ptr<FetchFanOut> owner = registry->acquire(threadPrefix, nullptr, FetchFanOut::OnClosed(), isOwner);
+	ASSERT_TRUE(isOwner);
+
+	registry->acquire(threadPrefix, &s1, FetchFanOut::OnClosed(), isOwner,
+		[&results](const ndn::Name& samplePrefix, BufferSlot::Verification status){
+			results.push_back(std::make_pair(samplePrefix, status));
+		});
+	// subscribers may not care about verification
+	registry->acquire(threadPrefix, &s2, FetchFanOut::OnClosed(), isOwner);
+	EXPECT_FALSE(isOwner);
+
+	ndn::Name samplePrefix(threadPrefix);
+	samplePrefix.append("d").appendSequenceNumber(1);
+	owner->onVerified(samplePrefix, BufferSlot::Verification::Verified);
+	owner->onVerified(samplePrefix, BufferSlot::Verification::Failed);
+
+	ASSERT_EQ(2, results.size());
+	EXPECT_EQ(samplePrefix, results[0].first);
+	EXPECT_EQ(BufferSlot::Verification::Verified, results[0].second);
+	EXPECT_EQ(BufferSlot::Verification::Failed, results[1].second);
+
+	owner->unsubscribe(&s1);
+	owner->onVerified(samplePrefix, BufferSlot::Verification::Verified);
+	EXPECT_EQ(2, results.size());
+
+	registry->release(owner);
+	EXPECT_EQ(0, registry->size());
+}
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,89 @@
+//
+// test-temporal-layers.cc
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#include <stdlib.h>
+
+#include "gtest/gtest.h"
+#include "src/temporal-layers.hpp"
+
+using namespace ndnrtc;
+
+TEST(TestTemporalLayers, TestPattern)
+{
+	EXPECT_EQ(1, TemporalLayers(0).getLayersNum());
+	EXPECT_EQ(3, TemporalLayers(10).getLayersNum());
+
+	{
+		TemporalLayers l(1);
+		EXPECT_EQ(1, l.getPeriod());
+		for (int i = 0; i < 10; ++i) EXPECT_EQ(0, l.getLayer(i));
+	}
+	{
+		TemporalLayers l(2);
+		unsigned int pattern[] = {0, 1, 0, 1, 0, 1};
+		EXPECT_EQ(2, l.getPeriod());
+		for (int i = 0; i < 6; ++i) EXPECT_EQ(pattern[i], l.getLayer(i));
+	}
+	{
+		TemporalLayers l(3);
+		unsigned int pattern[] = {0, 2, 1, 2, 0, 2, 1, 2};
+		EXPECT_EQ(4, l.getPeriod());
+		for (int i = 0; i < 8; ++i) EXPECT_EQ(pattern[i], l.getLayer(i));
+	}
+}
+
+TEST(TestTemporalLayers, TestDeltaLayer)
+{
+	TemporalLayers l(3);
+
+	// key frame takes pattern position 0, deltas follow
+	EXPECT_EQ(2, l.getDeltaLayer(0));
+	EXPECT_EQ(1, l.getDeltaLayer(1));
+	EXPECT_EQ(2, l.getDeltaLayer(2));
+	EXPECT_EQ(0, l.getDeltaLayer(3));
+	EXPECT_EQ(2, l.getDeltaLayer(4));
+
+	EXPECT_EQ(3, l.nextDelta(0, 0));
+	EXPECT_EQ(1, l.nextDelta(0, 1));
+	EXPECT_EQ(0, l.nextDelta(0, 2));
+	EXPECT_EQ(3, l.nextDelta(3, 0));
+	EXPECT_EQ(7, l.nextDelta(4, 0));
+	EXPECT_EQ(5, l.nextDelta(4, 1));
+
+	// single layer never skips
+	for (int i = 0; i < 10; ++i) EXPECT_EQ(i, TemporalLayers(1).nextDelta(i, 0));
+}
+
+TEST(TestTemporalLayers, TestReferenceDistance)
+{
+	TemporalLayers l(3);
+
+	EXPECT_EQ(4, l.getReferenceDistance(0));
+	EXPECT_EQ(2, l.getReferenceDistance(1));
+	EXPECT_EQ(1, l.getReferenceDistance(2));
+	EXPECT_EQ(1, l.getReferenceDistance(3));
+	EXPECT_EQ(1, TemporalLayers(1).getReferenceDistance(0));
+}
+
+TEST(TestTemporalLayers, TestAligned)
+{
+	TemporalLayers l(3);
+
+	EXPECT_TRUE(l.isAligned(0));
+	EXPECT_FALSE(l.isAligned(1));
+	EXPECT_FALSE(l.isAligned(2));
+	EXPECT_TRUE(l.isAligned(4));
+	EXPECT_TRUE(l.isAligned(8));
+
+	// any GOP length for single layer
+	EXPECT_TRUE(TemporalLayers(1).isAligned(3));
+}
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -234,6 +234,41 @@ TEST(TestCoder, TestEncode)
         EXPECT_ANY_THROW(vc.onRawFrame(convertedFrame));
     }
 }
+TEST(TestCoder, TestCoresChange)
+{
+    int nFrames = 60;
+    int width = 320, height = 240;
+    std::vector<WebRtcVideoFrame> frames = getFrameSequence(width, height, nFrames);
+    VideoCoderParams vcp(sampleVideoCoderParams());
+    vcp.gop_ = 10;
+    vcp.encodeWidth_ = width;
+    vcp.encodeHeight_ = height;
+    vcp.dropFramesOn_ = false;
+    MockEncoderDelegate coderDelegate;
+    coderDelegate.setDefaults();
+    VideoCoder vc(vcp, &coderDelegate, VideoCoder::KeyEnforcement::Gop);
+    unsigned int nCores = vc.getCoresNum();
+
+    EXPECT_CALL(coderDelegate, onEncodingStarted()).Times(nFrames);
+    EXPECT_CALL(coderDelegate, onEncodedFrame(_)).Times(nFrames);
+    EXPECT_CALL(coderDelegate, onDroppedFrame()).Times(0);
+
+    for (int i = 0; i < nFrames; ++i)
+    {
+        // short-lived change is never applied
+        if (i == 3) vc.onCoresAllocated(nCores + 1);
+        if (i == 12) vc.onCoresAllocated(nCores);
+        // lasting change is applied at the second GOP start
+        if (i == 33) vc.onCoresAllocated(nCores + 1);
+
+        vc.onRawFrame(frames[i]);
+        EXPECT_EQ((i < 50 ? nCores : nCores + 1), vc.getCoresNum());
+    }
+
+    // no extra key frames
+    EXPECT_EQ(nFrames / vcp.gop_, coderDelegate.getKey());
+}
+
 #if 0
 TEST(TestCoder, TestEncode700K)
 {